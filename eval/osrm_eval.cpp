@@ -1,7 +1,3 @@
-#include <cstdlib>
-#include <iostream>
-#include <random>
-
 #include "osrm/engine_config.hpp"
 #include "osrm/multi_target_parameters.hpp"
 #include "osrm/osrm.hpp"
@@ -9,165 +5,594 @@
 
 #include "util/coordinate.hpp"
 #include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+#include "util/timing_util.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace osrm;
 using namespace osrm::util;
-using namespace osrm::util::json;
 
-std::mt19937 gen;
-// std::uniform_real_distribution<> lat_dist{49.379, 51.724};
-// std::uniform_real_distribution<> lng_dist{7.696, 10.267};
-std::uniform_real_distribution<> lat_dist{47.27, 55.05};
-std::uniform_real_distribution<> lng_dist{5.87, 15.03};
+namespace
+{
+
+const constexpr char WORKLOAD_HEADER[] = "osrm-eval-workload";
+const constexpr unsigned WORKLOAD_VERSION = 1;
+
+// One source and its targets, answered either from or towards the source
+struct Query
+{
+    bool forward;
+    std::vector<Coordinate> coordinates;
+};
+
+struct Workload
+{
+    std::uint64_t seed;
+    std::vector<Query> queries;
+};
+
+struct Options
+{
+    boost::filesystem::path dataset;
+    bool use_shared_memory = false;
+
+    std::uint64_t seed = 42;
+    unsigned number_of_queries = 100;
+    unsigned number_of_targets = 1000;
+    double backward_share = 0.5;
+    // min_lon, min_lat, max_lon, max_lat, defaults to Germany
+    std::vector<double> bbox{5.87, 47.27, 15.03, 55.05};
+
+    std::string workload_in;
+    std::string workload_out;
+
+    std::vector<std::string> apis{"multitarget", "table"};
+    unsigned concurrency = 1;
+    unsigned repeat = 1;
+
+    bool diff = false;
+    double tolerance = 0.;
+    unsigned max_mismatch_samples = 20;
+
+    std::string output;
+};
 
-FloatCoordinate make_coord(double lat, double lng)
+Workload generateWorkload(const Options &options)
 {
-    return FloatCoordinate{FloatLongitude{lng}, FloatLatitude{lat}};
+    std::mt19937_64 gen(options.seed);
+    std::uniform_real_distribution<> lon_dist{options.bbox[0], options.bbox[2]};
+    std::uniform_real_distribution<> lat_dist{options.bbox[1], options.bbox[3]};
+    std::bernoulli_distribution backward_dist{options.backward_share};
+
+    Workload workload{options.seed, {}};
+    workload.queries.reserve(options.number_of_queries);
+    for (unsigned i = 0; i < options.number_of_queries; ++i)
+    {
+        Query query{!backward_dist(gen), {}};
+        query.coordinates.reserve(options.number_of_targets + 1);
+        for (unsigned j = 0; j <= options.number_of_targets; ++j)
+        {
+            query.coordinates.emplace_back(FloatLongitude{lon_dist(gen)},
+                                           FloatLatitude{lat_dist(gen)});
+        }
+        workload.queries.push_back(std::move(query));
+    }
+    return workload;
 }
 
-void eval_forward(OSRM& osrm)
+// Coordinates are stored in fixed point, so a replay sends exactly the same queries
+void writeWorkload(const Workload &workload, const std::string &path)
 {
-    auto const one = make_coord(lat_dist(gen), lng_dist(gen));
-    std::vector<FloatCoordinate> many;
-    for (int i = 0; i < 1000; ++i)
+    std::ofstream out(path);
+    if (!out)
+    {
+        throw std::runtime_error("Can not write workload " + path);
+    }
+
+    out << WORKLOAD_HEADER << ' ' << WORKLOAD_VERSION << '\n';
+    out << workload.seed << ' ' << workload.queries.size() << '\n';
+    for (const auto &query : workload.queries)
     {
-        many.push_back(make_coord(lat_dist(gen), lng_dist(gen)));
+        out << (query.forward ? 'f' : 'b') << ' ' << query.coordinates.size();
+        for (const auto coordinate : query.coordinates)
+        {
+            out << ' ' << static_cast<std::int32_t>(coordinate.lon) << ' '
+                << static_cast<std::int32_t>(coordinate.lat);
+        }
+        out << '\n';
     }
+}
 
-    MultiTargetParameters mt_params;
-    mt_params.coordinates.push_back(one);
-    std::copy(begin(many), end(many), std::back_inserter(mt_params.coordinates));
+Workload readWorkload(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw std::runtime_error("Can not read workload " + path);
+    }
 
-    json::Object mt_result;
-    auto const mt_status = osrm.MultiTarget(mt_params, mt_result);
-    if (mt_status != Status::Ok)
+    std::string header;
+    unsigned version;
+    in >> header >> version;
+    if (header != WORKLOAD_HEADER || version != WORKLOAD_VERSION)
     {
-        std::cout << "FWD: bad one-to-many status" << std::endl;
-        std::exit(1);
+        throw std::runtime_error(path + " is not a version " + std::to_string(WORKLOAD_VERSION) +
+                                 " workload");
     }
 
-    TableParameters tab_params;
-    tab_params.coordinates.push_back(one);
-    std::copy(begin(many), end(many), std::back_inserter(tab_params.coordinates));
-    tab_params.sources.push_back(0);
-    for (auto i = 0u; i < many.size(); ++i)
+    Workload workload;
+    std::size_t number_of_queries;
+    in >> workload.seed >> number_of_queries;
+    workload.queries.resize(number_of_queries);
+    for (auto &query : workload.queries)
     {
-        tab_params.destinations.push_back(i + 1);
+        char direction;
+        std::size_t number_of_coordinates;
+        in >> direction >> number_of_coordinates;
+        query.forward = direction == 'f';
+        query.coordinates.resize(number_of_coordinates);
+        for (auto &coordinate : query.coordinates)
+        {
+            std::int32_t lon, lat;
+            in >> lon >> lat;
+            coordinate = Coordinate{FixedLongitude{lon}, FixedLatitude{lat}};
+        }
     }
 
-    json::Object tab_result;
-    auto const tab_status = osrm.Table(tab_params, tab_result);
-    if (tab_status != Status::Ok)
+    if (!in)
     {
-        std::cout << "FWD: bad table status" << std::endl;
-        std::exit(1);
+        throw std::runtime_error("Workload " + path + " is truncated");
     }
+    return workload;
+}
 
-    auto mt_costs = mt_result.values["costs"].get<Array>().values;
-    auto tab_durations = tab_result.values["durations"].get<Array>().values[0].get<Array>().values;
+MultiTargetParameters makeMultiTargetParameters(const Query &query)
+{
+    MultiTargetParameters parameters;
+    parameters.forward = query.forward;
+    parameters.coordinates = query.coordinates;
+    return parameters;
+}
 
-    if (mt_costs.size() != tab_durations.size())
+// The equivalent one-to-many or many-to-one table
+TableParameters makeTableParameters(const Query &query)
+{
+    TableParameters parameters;
+    parameters.coordinates = query.coordinates;
+    auto &single = query.forward ? parameters.sources : parameters.destinations;
+    auto &many = query.forward ? parameters.destinations : parameters.sources;
+    single.push_back(0);
+    many.resize(query.coordinates.size() - 1);
+    std::iota(many.begin(), many.end(), 1);
+    return parameters;
+}
+
+// Durations per target, none for unreachable targets. Empty if the query failed.
+using Durations = std::vector<boost::optional<double>>;
+
+boost::optional<double> getDuration(const json::Value &value)
+{
+    // Unreachable targets are either null or carry the invalid weight
+    if (value.is<json::Number>() &&
+        value.get<json::Number>().value < std::numeric_limits<std::int32_t>::max())
     {
-        std::cout << "FWD: result size mismatch: " << mt_costs.size() << " != " << tab_durations.size();
-        std::exit(1);
+        return value.get<json::Number>().value;
     }
+    return boost::none;
+}
 
-    for (auto i = 0u; i < mt_costs.size(); ++i)
+Durations runMultiTarget(OSRM &osrm, const Query &query)
+{
+    json::Object result;
+    if (osrm.MultiTarget(makeMultiTargetParameters(query), result) != Status::Ok)
     {
-        auto const mt_dur = mt_costs[i].get<Object>().values.at("duration").get<Number>().value;
-        auto const tab_dur = tab_durations[i].get<Number>().value;
+        return {};
+    }
 
-        if (std::abs(mt_dur - tab_dur) > std::numeric_limits<double>::epsilon())
-        {
-            std::cout << "FWD: distance mismatch: " << mt_dur << " != " << tab_dur << std::endl;
-            std::exit(1);
-        }
+    Durations durations;
+    for (const auto &cost : result.values.at("costs").get<json::Array>().values)
+    {
+        durations.push_back(getDuration(cost.get<json::Object>().values.at("duration")));
     }
+    return durations;
 }
 
-void eval_backward(OSRM& osrm)
+Durations runTable(OSRM &osrm, const Query &query)
 {
-    auto const one = make_coord(lat_dist(gen), lng_dist(gen));
-    std::vector<FloatCoordinate> many;
-    for (int i = 0; i < 100; ++i)
+    json::Object result;
+    if (osrm.Table(makeTableParameters(query), result) != Status::Ok)
     {
-        many.push_back(make_coord(lat_dist(gen), lng_dist(gen)));
+        return {};
     }
 
-    MultiTargetParameters mt_params;
-    mt_params.forward = false;
-    mt_params.coordinates.push_back(one);
-    std::copy(begin(many), end(many), std::back_inserter(mt_params.coordinates));
+    Durations durations;
+    const auto &rows = result.values.at("durations").get<json::Array>().values;
+    if (query.forward)
+    {
+        for (const auto &duration : rows.front().get<json::Array>().values)
+        {
+            durations.push_back(getDuration(duration));
+        }
+    }
+    else
+    {
+        for (const auto &row : rows)
+        {
+            durations.push_back(getDuration(row.get<json::Array>().values.front()));
+        }
+    }
+    return durations;
+}
 
-    json::Object mt_result;
-    auto const mt_status = osrm.MultiTarget(mt_params, mt_result);
-    if (mt_status != Status::Ok)
+Durations runQuery(OSRM &osrm, const std::string &api, const Query &query)
+{
+    if (api == "multitarget")
     {
-        std::cout << "BWD: bad one-to-many status" << std::endl;
-        std::exit(1);
+        return runMultiTarget(osrm, query);
     }
+    BOOST_ASSERT(api == "table");
+    return runTable(osrm, query);
+}
 
-    TableParameters tab_params;
-    tab_params.coordinates.push_back(one);
-    std::copy(begin(many), end(many), std::back_inserter(tab_params.coordinates));
-    tab_params.destinations.push_back(0);
-    for (auto i = 0u; i < many.size(); ++i)
+json::Object summarizeLatencies(std::vector<std::uint64_t> latencies_us)
+{
+    json::Object summary;
+    if (latencies_us.empty())
     {
-        tab_params.sources.push_back(i + 1);
+        return summary;
     }
 
-    json::Object tab_result;
-    auto const tab_status = osrm.Table(tab_params, tab_result);
-    if (tab_status != Status::Ok)
+    std::sort(latencies_us.begin(), latencies_us.end());
+    const auto percentile = [&](const double p) {
+        const auto rank = static_cast<std::size_t>(std::ceil(p * latencies_us.size()));
+        return latencies_us[std::min(latencies_us.size(), std::max<std::size_t>(rank, 1)) - 1];
+    };
+
+    summary.values["mean"] =
+        std::accumulate(latencies_us.begin(), latencies_us.end(), 0.) / latencies_us.size();
+    summary.values["min"] = latencies_us.front();
+    summary.values["p50"] = percentile(0.5);
+    summary.values["p90"] = percentile(0.9);
+    summary.values["p99"] = percentile(0.99);
+    summary.values["p999"] = percentile(0.999);
+    summary.values["max"] = latencies_us.back();
+
+    // Power of two buckets, each counting the latencies up to its bound
+    json::Array histogram;
+    std::uint64_t bound = 1;
+    auto begin = latencies_us.begin();
+    while (begin != latencies_us.end())
     {
-        std::cout << "BWD: bad table status" << std::endl;
-        std::exit(1);
+        const auto end = std::upper_bound(begin, latencies_us.end(), bound);
+        if (end != begin)
+        {
+            json::Object bucket;
+            bucket.values["le_us"] = bound;
+            bucket.values["count"] = static_cast<std::uint64_t>(std::distance(begin, end));
+            histogram.values.push_back(std::move(bucket));
+        }
+        begin = end;
+        bound *= 2;
     }
+    summary.values["histogram"] = std::move(histogram);
 
-    auto mt_costs = mt_result.values["costs"].get<Array>().values;
-    auto tab_durations = tab_result.values["durations"].get<Array>().values;
+    return summary;
+}
+
+json::Object benchmark(OSRM &osrm,
+                       const std::string &api,
+                       const Workload &workload,
+                       const Options &options)
+{
+    const auto number_of_runs = workload.queries.size() * options.repeat;
+    std::atomic<std::size_t> next_run{0};
+    std::atomic<std::size_t> errors{0};
+
+    std::vector<std::vector<std::uint64_t>> latencies(options.concurrency);
+    const auto worker = [&](const unsigned thread_id) {
+        auto &thread_latencies = latencies[thread_id];
+        for (auto run = next_run++; run < number_of_runs; run = next_run++)
+        {
+            const auto &query = workload.queries[run % workload.queries.size()];
 
-    if (mt_costs.size() != tab_durations.size())
+            TIMER_START(query);
+            const auto durations = runQuery(osrm, api, query);
+            TIMER_STOP(query);
+
+            thread_latencies.push_back(TIMER_USEC(query));
+            if (durations.empty())
+            {
+                ++errors;
+            }
+        }
+    };
+
+    TIMER_START(wall);
+    std::vector<std::thread> threads;
+    for (unsigned thread_id = 0; thread_id < options.concurrency; ++thread_id)
     {
-        std::cout << "BWD: result size mismatch: " << mt_costs.size() << " != " << tab_durations.size();
-        std::exit(1);
+        threads.emplace_back(worker, thread_id);
     }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    TIMER_STOP(wall);
+
+    std::vector<std::uint64_t> all_latencies;
+    for (const auto &thread_latencies : latencies)
+    {
+        all_latencies.insert(all_latencies.end(), thread_latencies.begin(), thread_latencies.end());
+    }
+
+    const auto wall_time = TIMER_SEC(wall);
+
+    json::Object result;
+    result.values["queries"] = number_of_runs;
+    result.values["errors"] = errors.load();
+    result.values["concurrency"] = options.concurrency;
+    result.values["wall_time_s"] = wall_time;
+    result.values["throughput_qps"] = wall_time > 0 ? number_of_runs / wall_time : 0.;
+    result.values["latency_us"] = summarizeLatencies(std::move(all_latencies));
+    return result;
+}
+
+// Compares every MultiTarget duration against the equivalent table entry
+json::Object diff(OSRM &osrm, const Workload &workload, const Options &options)
+{
+    std::uint64_t compared = 0;
+    std::uint64_t mismatches = 0;
+    std::uint64_t failed_queries = 0;
+    json::Array samples;
 
-    for (auto i = 0u; i < mt_costs.size(); ++i)
+    const auto add_sample = [&](const std::size_t query_index,
+                                const std::size_t target,
+                                const boost::optional<double> multi_target_duration,
+                                const boost::optional<double> table_duration) {
+        if (samples.values.size() >= options.max_mismatch_samples)
+        {
+            return;
+        }
+        json::Object sample;
+        sample.values["query"] = query_index;
+        sample.values["target"] = target;
+        sample.values["multitarget"] = multi_target_duration
+                                           ? json::Value{json::Number{*multi_target_duration}}
+                                           : json::Value{json::Null()};
+        sample.values["table"] = table_duration ? json::Value{json::Number{*table_duration}}
+                                                : json::Value{json::Null()};
+        samples.values.push_back(std::move(sample));
+    };
+
+    for (std::size_t query_index = 0; query_index < workload.queries.size(); ++query_index)
     {
-        auto const mt_dur = mt_costs[i].get<Object>().values.at("duration").get<Number>().value;
-        auto const tab_dur = tab_durations[i].get<Array>().values[0].get<Number>().value;
+        const auto &query = workload.queries[query_index];
+        const auto multi_target_durations = runMultiTarget(osrm, query);
+        const auto table_durations = runTable(osrm, query);
 
-        if (std::abs(mt_dur - tab_dur) > std::numeric_limits<double>::epsilon())
+        if (multi_target_durations.empty() || table_durations.empty() ||
+            multi_target_durations.size() != table_durations.size())
         {
-            std::cout << "distance mismatch: " << mt_dur << " != " << tab_dur << std::endl;
-            std::exit(1);
+            ++failed_queries;
+            continue;
+        }
+
+        for (std::size_t target = 0; target < table_durations.size(); ++target)
+        {
+            ++compared;
+            const auto &lhs = multi_target_durations[target];
+            const auto &rhs = table_durations[target];
+            const bool equal = (!lhs && !rhs) ||
+                               (lhs && rhs && std::abs(*lhs - *rhs) <= options.tolerance);
+            if (!equal)
+            {
+                ++mismatches;
+                add_sample(query_index, target, lhs, rhs);
+            }
         }
     }
+
+    json::Object result;
+    result.values["compared"] = compared;
+    result.values["mismatches"] = mismatches;
+    result.values["failed_queries"] = failed_queries;
+    result.values["tolerance"] = options.tolerance;
+    result.values["samples"] = std::move(samples);
+    return result;
 }
 
-int main(int argc, char **argv)
+// Returns false if the program should exit right away
+bool parseOptions(int argc, char **argv, Options &options, int &exit_code)
 {
-    if (argc < 2)
+    namespace po = boost::program_options;
+
+    po::options_description generic_options("Options");
+    generic_options.add_options()("help,h", "Show this help message");
+
+    po::options_description workload_options("Workload");
+    workload_options.add_options()(
+        "seed", po::value<std::uint64_t>(&options.seed)->default_value(42), "Random seed")(
+        "queries,q",
+        po::value<unsigned>(&options.number_of_queries)->default_value(100),
+        "Number of generated queries")(
+        "targets,n",
+        po::value<unsigned>(&options.number_of_targets)->default_value(1000),
+        "Targets per generated query")(
+        "backward-share",
+        po::value<double>(&options.backward_share)->default_value(0.5),
+        "Share of generated queries towards the source")(
+        "bbox",
+        po::value<std::vector<double>>(&options.bbox)->multitoken(),
+        "Area of generated coordinates as min_lon min_lat max_lon max_lat")(
+        "workload,w",
+        po::value<std::string>(&options.workload_in),
+        "Replay the queries of a workload file instead of generating them")(
+        "write-workload",
+        po::value<std::string>(&options.workload_out),
+        "Save the queries to a workload file");
+
+    po::options_description run_options("Run");
+    run_options.add_options()(
+        "api",
+        po::value<std::vector<std::string>>(&options.apis)->multitoken(),
+        "APIs to benchmark: multitarget, table")(
+        "concurrency,c",
+        po::value<unsigned>(&options.concurrency)->default_value(1),
+        "Number of threads sending queries")(
+        "repeat,r",
+        po::value<unsigned>(&options.repeat)->default_value(1),
+        "How often every query is sent")(
+        "diff",
+        po::bool_switch(&options.diff),
+        "Compare MultiTarget against Table durations instead of benchmarking")(
+        "tolerance",
+        po::value<double>(&options.tolerance)->default_value(0.),
+        "Max. duration difference in seconds accepted by --diff")(
+        "shared-memory,s",
+        po::bool_switch(&options.use_shared_memory),
+        "Use the dataset loaded by osrm-datastore")(
+        "output,o",
+        po::value<std::string>(&options.output),
+        "Write the JSON report to this file instead of stdout");
+
+    po::options_description hidden_options("Hidden options");
+    hidden_options.add_options()("dataset", po::value<boost::filesystem::path>(&options.dataset));
+
+    po::positional_options_description positional_options;
+    positional_options.add("dataset", 1);
+
+    po::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(workload_options).add(run_options).add(
+        hidden_options);
+
+    po::options_description visible_options("Usage: osrm-eval <dataset.osrm> [options]");
+    visible_options.add(generic_options).add(workload_options).add(run_options);
+
+    po::variables_map option_variables;
+    try
     {
-        std::cout << "usage: ./osrm-eval /path/to/dataset.osrm" << std::endl;
-        return 1;
+        po::store(po::command_line_parser(argc, argv)
+                      .options(cmdline_options)
+                      .positional(positional_options)
+                      .run(),
+                  option_variables);
+        po::notify(option_variables);
+    }
+    catch (const po::error &error)
+    {
+        std::cerr << error.what() << std::endl;
+        exit_code = EXIT_FAILURE;
+        return false;
     }
 
-    EngineConfig config;
-    config.storage_config = {argv[1]};
-    config.use_shared_memory = false;
+    if (option_variables.count("help"))
+    {
+        std::cout << visible_options;
+        exit_code = EXIT_SUCCESS;
+        return false;
+    }
+
+    const bool has_dataset = option_variables.count("dataset") > 0;
+    const bool apis_valid = std::all_of(
+        options.apis.begin(), options.apis.end(), [](const std::string &api) {
+            return api == "multitarget" || api == "table";
+        });
+    if ((!has_dataset && !options.use_shared_memory) || options.bbox.size() != 4 ||
+        options.concurrency == 0 || options.number_of_targets == 0 || !apis_valid)
+    {
+        std::cerr << visible_options;
+        exit_code = EXIT_FAILURE;
+        return false;
+    }
+
+    return true;
+}
+}
+
+int main(int argc, char **argv) try
+{
+    Options options;
+    int exit_code = EXIT_SUCCESS;
+    if (!parseOptions(argc, argv, options, exit_code))
+    {
+        return exit_code;
+    }
+
+    const auto workload =
+        options.workload_in.empty() ? generateWorkload(options) : readWorkload(options.workload_in);
+    if (!options.workload_out.empty())
+    {
+        writeWorkload(workload, options.workload_out);
+    }
 
+    EngineConfig config;
+    config.storage_config = {options.dataset};
+    config.use_shared_memory = options.use_shared_memory;
     OSRM osrm{config};
 
-    for (int x = 0; x < 100; ++x)
+    json::Object report;
+    report.values["dataset"] = options.dataset.string();
+    report.values["seed"] = workload.seed;
+    report.values["queries"] = workload.queries.size();
+    if (!workload.queries.empty())
+    {
+        report.values["coordinates_per_query"] = workload.queries.front().coordinates.size();
+    }
+
+    if (options.diff)
+    {
+        auto diff_report = diff(osrm, workload, options);
+        const auto &mismatches = diff_report.values.at("mismatches").get<json::Number>().value;
+        const auto &failed = diff_report.values.at("failed_queries").get<json::Number>().value;
+        if (mismatches > 0 || failed > 0)
+        {
+            exit_code = EXIT_FAILURE;
+        }
+        report.values["diff"] = std::move(diff_report);
+    }
+    else
     {
-        std::cout << "test" << x << std::endl;
-        eval_forward(osrm);
-        eval_backward(osrm);
+        json::Object apis;
+        for (const auto &api : options.apis)
+        {
+            apis.values[api] = benchmark(osrm, api, workload, options);
+        }
+        report.values["apis"] = std::move(apis);
     }
 
-    std::cout << "success" << std::endl;
+    if (options.output.empty())
+    {
+        json::render(std::cout, report);
+        std::cout << std::endl;
+    }
+    else
+    {
+        std::ofstream out(options.output);
+        json::render(out, report);
+        out << std::endl;
+    }
 
-    return 0;
+    return exit_code;
+}
+catch (const std::exception &error)
+{
+    std::cerr << "[error] " << error.what() << std::endl;
+    return EXIT_FAILURE;
 }
@@ -287,7 +287,7 @@ module.exports = function () {
                  q.defer(rename, file);
              });
 
-            ['osrm.edge_penalties', 'osrm.edge_segment_lookup'].forEach(file => {
+            ['osrm.edge_penalties', 'osrm.edge_segment_lookup', 'osrm.landmarks'].forEach(file => {
                 q.defer(renameIfExists, file);
             });
 
@@ -63,14 +63,24 @@ class Contractor
                        util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list,
                        util::DeallocatingVector<QueryEdge> &contracted_edge_list,
                        std::vector<EdgeWeight> &&node_weights,
+                       const std::vector<EdgeLength> &node_lengths,
                        std::vector<bool> &is_core_node,
                        std::vector<float> &inout_node_levels) const;
+    void CustomizeGraph(
+        const EdgeID max_edge_id,
+        const util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list);
     void WriteCoreNodeMarker(std::vector<bool> &&is_core_node) const;
+    void ReadCoreNodeMarker(std::vector<bool> &is_core_node) const;
+    void WriteCoreLandmarks(const util::DeallocatingVector<QueryEdge> &contracted_edge_list,
+                            const std::vector<bool> &is_core_node) const;
     void WriteNodeLevels(std::vector<float> &&node_levels) const;
     void ReadNodeLevels(std::vector<float> &contraction_order) const;
+    void ComputeNodeLengths(const EdgeID max_edge_id, std::vector<EdgeLength> &node_lengths) const;
     std::size_t
     WriteContractedGraph(unsigned number_of_edge_based_nodes,
                          const util::DeallocatingVector<QueryEdge> &contracted_edge_list);
+    void WriteLengths(const std::vector<EdgeLength> &node_lengths,
+                      const util::DeallocatingVector<QueryEdge> &contracted_edge_list) const;
     void FindComponents(unsigned max_edge_id,
                         const util::DeallocatingVector<extractor::EdgeBasedEdge> &edges,
                         std::vector<extractor::EdgeBasedNode> &nodes) const;
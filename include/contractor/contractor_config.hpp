@@ -39,14 +39,20 @@ namespace contractor
 
 struct ContractorConfig
 {
-    ContractorConfig() : requested_num_threads(0) {}
+    ContractorConfig()
+        : use_cached_hierarchy(false), customizable(false), write_dataset(true),
+          requested_num_threads(0), number_of_core_landmarks(16)
+    {
+    }
 
     // Infer the output names from the path of the .osrm file
     void UseDefaultOutputNames()
     {
         level_output_path = osrm_input_path.string() + ".level";
         core_output_path = osrm_input_path.string() + ".core";
+        landmarks_output_path = osrm_input_path.string() + ".landmarks";
         graph_output_path = osrm_input_path.string() + ".hsgr";
+        length_output_path = osrm_input_path.string() + ".lengths";
         edge_based_graph_path = osrm_input_path.string() + ".ebg";
         edge_segment_lookup_path = osrm_input_path.string() + ".edge_segment_lookup";
         edge_penalty_path = osrm_input_path.string() + ".edge_penalties";
@@ -55,6 +61,7 @@ struct ContractorConfig
         rtree_leaf_path = osrm_input_path.string() + ".fileIndex";
         datasource_names_path = osrm_input_path.string() + ".datasource_names";
         datasource_indexes_path = osrm_input_path.string() + ".datasource_indexes";
+        dataset_output_path = osrm_input_path.string() + ".dataset";
     }
 
     boost::filesystem::path config_file_path;
@@ -62,7 +69,9 @@ struct ContractorConfig
 
     std::string level_output_path;
     std::string core_output_path;
+    std::string landmarks_output_path;
     std::string graph_output_path;
+    std::string length_output_path;
     std::string edge_based_graph_path;
 
     std::string edge_segment_lookup_path;
@@ -70,7 +79,17 @@ struct ContractorConfig
     std::string node_based_graph_path;
     std::string geometry_path;
     std::string rtree_leaf_path;
+    std::string dataset_output_path;
     bool use_cached_priority;
+    // Keeps the hierarchy of the last run (.hsgr) and only derives its weights from the
+    // updated edge-based graph instead of contracting it again. Needs a customizable hierarchy.
+    bool use_cached_hierarchy;
+    // Contracts without witness searches, so that use_cached_hierarchy gives exact weights for
+    // any speeds later on
+    bool customizable;
+    // Collects everything osrm-datastore and osrm-routed read into a single dataset file once
+    // the hierarchy is written
+    bool write_dataset;
 
     unsigned requested_num_threads;
 
@@ -80,6 +99,9 @@ struct ContractorConfig
     //(e.g. 0.8 contracts 80 percent of the hierarchy, leaving a core of 20%)
     double core_factor;
 
+    // Number of landmarks selected on the core for goal directed core searches, 0 disables them
+    unsigned number_of_core_landmarks;
+
     std::vector<std::string> segment_speed_lookup_paths;
     std::vector<std::string> turn_penalty_lookup_paths;
     std::string datasource_indexes_path;
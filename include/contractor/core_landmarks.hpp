@@ -0,0 +1,276 @@
+#ifndef CORE_LANDMARKS_HPP
+#define CORE_LANDMARKS_HPP
+
+#include "contractor/query_edge.hpp"
+#include "util/binary_heap.hpp"
+#include "util/integer_range.hpp"
+#include "util/io.hpp"
+#include "util/landmark_potential.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <tbb/parallel_invoke.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace osrm
+{
+namespace contractor
+{
+
+// Landmarks of the core of a partially contracted graph and the distances of every core node
+// to and from them. The engine uses them as lower bounds to search the core goal directed.
+struct CoreLandmarks
+{
+    std::vector<NodeID> landmarks;
+    // position of a node in the core, SPECIAL_NODEID if it was contracted. The distances of the
+    // node start at core_index[node] * landmarks.size().
+    std::vector<NodeID> core_index;
+    std::vector<util::LandmarkDistance> distances;
+};
+
+// The .landmarks file holds the checksum of the .hsgr the distances were computed on, followed
+// by the landmarks, the core index and the distances. It has no landmarks if the graph was
+// contracted completely.
+inline bool writeCoreLandmarks(const boost::filesystem::path &path,
+                               const unsigned checksum,
+                               const CoreLandmarks &core_landmarks)
+{
+    boost::filesystem::ofstream stream(path, std::ios::binary);
+    return util::writeFingerprint(stream) &&
+           stream.write(reinterpret_cast<const char *>(&checksum), sizeof(checksum)) &&
+           util::serializeVector(stream, core_landmarks.landmarks) &&
+           util::serializeVector(stream, core_landmarks.core_index) &&
+           util::serializeVector(stream, core_landmarks.distances);
+}
+
+// Fails if the file is missing, broken or belongs to a different .hsgr
+inline bool readCoreLandmarks(const boost::filesystem::path &path,
+                              const unsigned checksum,
+                              CoreLandmarks &core_landmarks)
+{
+    boost::filesystem::ifstream stream(path, std::ios::binary);
+    unsigned file_checksum = 0;
+    if (!stream || !util::readAndCheckFingerprint(stream) ||
+        !stream.read(reinterpret_cast<char *>(&file_checksum), sizeof(file_checksum)) ||
+        file_checksum != checksum || !util::deserializeVector(stream, core_landmarks.landmarks) ||
+        !util::deserializeVector(stream, core_landmarks.core_index) ||
+        !util::deserializeVector(stream, core_landmarks.distances))
+    {
+        return false;
+    }
+
+    const auto number_of_landmarks = core_landmarks.landmarks.size();
+    const auto number_of_core_nodes =
+        number_of_landmarks == 0 ? 0 : core_landmarks.distances.size() / number_of_landmarks;
+    return std::all_of(core_landmarks.core_index.begin(),
+                       core_landmarks.core_index.end(),
+                       [number_of_core_nodes](const NodeID index) {
+                           return index == SPECIAL_NODEID || index < number_of_core_nodes;
+                       });
+}
+
+namespace detail
+{
+
+// Adjacency of the core in one direction, indexed by position in the core
+struct CoreAdjacency
+{
+    struct Edge
+    {
+        NodeID target;
+        EdgeWeight weight;
+    };
+
+    std::vector<std::uint32_t> offsets;
+    std::vector<Edge> edges;
+};
+
+struct LandmarkHeapData
+{
+};
+
+using LandmarkHeap = util::BinaryHeap<NodeID,
+                                      NodeID,
+                                      EdgeWeight,
+                                      LandmarkHeapData,
+                                      util::ArrayStorage<NodeID, NodeID>>;
+
+// Distances from a core node to all others, INVALID_EDGE_WEIGHT for unreachable ones
+inline void ComputeCoreDistances(const CoreAdjacency &adjacency,
+                                 const NodeID source,
+                                 std::vector<EdgeWeight> &distances)
+{
+    const auto number_of_core_nodes = static_cast<NodeID>(adjacency.offsets.size() - 1);
+    distances.assign(number_of_core_nodes, INVALID_EDGE_WEIGHT);
+
+    LandmarkHeap heap(number_of_core_nodes);
+    heap.Insert(source, 0, {});
+    while (!heap.Empty())
+    {
+        const NodeID node = heap.DeleteMin();
+        const EdgeWeight distance = heap.GetKey(node);
+        distances[node] = distance;
+
+        for (const auto index : util::irange(adjacency.offsets[node], adjacency.offsets[node + 1]))
+        {
+            const auto &edge = adjacency.edges[index];
+            const EdgeWeight to_distance = distance + edge.weight;
+            if (!heap.WasInserted(edge.target))
+            {
+                heap.Insert(edge.target, to_distance, {});
+            }
+            else if (!heap.WasRemoved(edge.target) && to_distance < heap.GetKey(edge.target))
+            {
+                heap.DecreaseKey(edge.target, to_distance);
+            }
+        }
+    }
+}
+}
+
+// Selects landmarks on the core and computes the distances between them and all core nodes.
+//
+// Landmarks are picked one after the other as the core node farthest away from all previous
+// ones, summing up the distances in both directions. Nodes no landmark reaches count as
+// farthest, so every strongly connected part of the core gets a landmark if there are enough.
+// The distances of a landmark in both directions are computed in parallel.
+template <typename EdgeContainerT>
+CoreLandmarks ComputeCoreLandmarks(const EdgeContainerT &edges,
+                                   const std::vector<bool> &is_core_node,
+                                   const unsigned number_of_landmarks)
+{
+    CoreLandmarks result;
+
+    std::vector<NodeID> core_nodes;
+    result.core_index.resize(is_core_node.size(), SPECIAL_NODEID);
+    for (const auto node : util::irange<NodeID>(0, is_core_node.size()))
+    {
+        if (is_core_node[node])
+        {
+            result.core_index[node] = core_nodes.size();
+            core_nodes.push_back(node);
+        }
+    }
+    const auto number_of_core_nodes = static_cast<NodeID>(core_nodes.size());
+    if (number_of_core_nodes == 0 || number_of_landmarks == 0)
+    {
+        result.core_index.clear();
+        return result;
+    }
+
+    // Contraction keeps the edges of the core at both of their nodes, the forward edges of a
+    // node lead away from it and its backward edges lead to it.
+    detail::CoreAdjacency forward_adjacency, backward_adjacency;
+    forward_adjacency.offsets.resize(number_of_core_nodes + 1, 0);
+    backward_adjacency.offsets.resize(number_of_core_nodes + 1, 0);
+    const auto is_core_edge = [&](const QueryEdge &edge) {
+        return edge.source < is_core_node.size() && edge.target < is_core_node.size() &&
+               is_core_node[edge.source] && is_core_node[edge.target];
+    };
+    for (const QueryEdge &edge : edges)
+    {
+        if (is_core_edge(edge))
+        {
+            const auto source = result.core_index[edge.source];
+            forward_adjacency.offsets[source + 1] += edge.data.forward;
+            backward_adjacency.offsets[source + 1] += edge.data.backward;
+        }
+    }
+    std::partial_sum(forward_adjacency.offsets.begin(),
+                     forward_adjacency.offsets.end(),
+                     forward_adjacency.offsets.begin());
+    std::partial_sum(backward_adjacency.offsets.begin(),
+                     backward_adjacency.offsets.end(),
+                     backward_adjacency.offsets.begin());
+    forward_adjacency.edges.resize(forward_adjacency.offsets.back());
+    backward_adjacency.edges.resize(backward_adjacency.offsets.back());
+
+    std::vector<std::uint32_t> forward_position(forward_adjacency.offsets.begin(),
+                                                forward_adjacency.offsets.end() - 1);
+    std::vector<std::uint32_t> backward_position(backward_adjacency.offsets.begin(),
+                                                 backward_adjacency.offsets.end() - 1);
+    for (const QueryEdge &edge : edges)
+    {
+        if (is_core_edge(edge))
+        {
+            const auto source = result.core_index[edge.source];
+            const auto target = result.core_index[edge.target];
+            if (edge.data.forward)
+            {
+                forward_adjacency.edges[forward_position[source]++] = {target,
+                                                                       edge.data.distance};
+            }
+            if (edge.data.backward)
+            {
+                backward_adjacency.edges[backward_position[source]++] = {target,
+                                                                         edge.data.distance};
+            }
+        }
+    }
+
+    const auto landmarks_to_select = std::min<NodeID>(number_of_landmarks, number_of_core_nodes);
+    result.distances.resize(static_cast<std::size_t>(number_of_core_nodes) * landmarks_to_select);
+
+    // sum of the distances in both directions to the closest landmark
+    std::vector<std::int64_t> separation(number_of_core_nodes,
+                                         std::numeric_limits<std::int64_t>::max());
+    std::vector<EdgeWeight> from_landmark, to_landmark;
+
+    // the first landmark is the node farthest away from an arbitrary start node
+    detail::ComputeCoreDistances(forward_adjacency, 0, from_landmark);
+    NodeID next_landmark = 0;
+    for (const auto node : util::irange<NodeID>(0, number_of_core_nodes))
+    {
+        if (from_landmark[node] != INVALID_EDGE_WEIGHT &&
+            from_landmark[node] > from_landmark[next_landmark])
+        {
+            next_landmark = node;
+        }
+    }
+
+    for (const auto landmark : util::irange<NodeID>(0, landmarks_to_select))
+    {
+        result.landmarks.push_back(core_nodes[next_landmark]);
+        tbb::parallel_invoke(
+            [&] {
+                detail::ComputeCoreDistances(forward_adjacency, next_landmark, from_landmark);
+            },
+            [&] {
+                detail::ComputeCoreDistances(backward_adjacency, next_landmark, to_landmark);
+            });
+
+        for (const auto node : util::irange<NodeID>(0, number_of_core_nodes))
+        {
+            auto &distance =
+                result.distances[static_cast<std::size_t>(node) * landmarks_to_select + landmark];
+            distance.to_landmark = to_landmark[node];
+            distance.from_landmark = from_landmark[node];
+
+            if (distance.to_landmark != INVALID_EDGE_WEIGHT &&
+                distance.from_landmark != INVALID_EDGE_WEIGHT)
+            {
+                separation[node] =
+                    std::min<std::int64_t>(separation[node],
+                                           static_cast<std::int64_t>(distance.to_landmark) +
+                                               distance.from_landmark);
+            }
+        }
+
+        next_landmark = static_cast<NodeID>(
+            std::max_element(separation.begin(), separation.end()) - separation.begin());
+    }
+
+    return result;
+}
+}
+}
+
+#endif // CORE_LANDMARKS_HPP
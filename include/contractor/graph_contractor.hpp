@@ -20,6 +20,8 @@
 #include <tbb/parallel_sort.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <vector>
@@ -35,22 +37,24 @@ class GraphContractor
     struct ContractorEdgeData
     {
         ContractorEdgeData()
-            : distance(0), id(0), originalEdges(0), shortcut(0), forward(0), backward(0),
-              is_original_via_node_ID(false)
+            : distance(0), length(0), id(0), originalEdges(0), shortcut(0), forward(0),
+              backward(0), is_original_via_node_ID(false)
         {
         }
         ContractorEdgeData(unsigned distance,
+                           EdgeLength length,
                            unsigned original_edges,
                            unsigned id,
                            bool shortcut,
                            bool forward,
                            bool backward)
-            : distance(distance), id(id),
+            : distance(distance), length(length), id(id),
               originalEdges(std::min((unsigned)1 << 28, original_edges)), shortcut(shortcut),
               forward(forward), backward(backward), is_original_via_node_ID(false)
         {
         }
         unsigned distance;
+        EdgeLength length;
         unsigned id;
         unsigned originalEdges : 28;
         bool shortcut : 1;
@@ -93,8 +97,9 @@ class GraphContractor
     {
         int edges_deleted_count;
         int edges_added_count;
-        int original_edges_deleted_count;
-        int original_edges_added_count;
+        // wide enough for the unpacked sizes of shortcuts without witness searches
+        std::int64_t original_edges_deleted_count;
+        std::int64_t original_edges_added_count;
         ContractionStats()
             : edges_deleted_count(0), edges_added_count(0), original_edges_deleted_count(0),
               original_edges_added_count(0)
@@ -134,17 +139,26 @@ class GraphContractor
   public:
     template <class ContainerT>
     GraphContractor(int nodes, ContainerT &input_edge_list)
-        : GraphContractor(nodes, input_edge_list, {}, {})
+        : GraphContractor(nodes, input_edge_list, {}, {}, {})
     {
     }
 
+    // node_lengths holds the geometric length of every edge-based node in decimeters. If it is
+    // empty all edges of the contracted graph get a length of zero.
     template <class ContainerT>
     GraphContractor(int nodes,
                     ContainerT &input_edge_list,
                     std::vector<float> &&node_levels_,
-                    std::vector<EdgeWeight> &&node_weights_)
+                    std::vector<EdgeWeight> &&node_weights_,
+                    const std::vector<EdgeLength> &node_lengths)
         : node_levels(std::move(node_levels_)), node_weights(std::move(node_weights_))
     {
+        BOOST_ASSERT(node_lengths.empty() ||
+                     node_lengths.size() >= static_cast<std::size_t>(nodes));
+        const auto get_edge_length = [&node_lengths](const NodeID source, const NodeID target) {
+            return node_lengths.empty() ? 0 : node_lengths[source] + node_lengths[target];
+        };
+
         std::vector<ContractorEdge> edges;
         edges.reserve(input_edge_list.size() * 2);
 
@@ -166,6 +180,7 @@ class GraphContractor
             edges.emplace_back(diter->source,
                                diter->target,
                                static_cast<unsigned int>(std::max(diter->weight, 1)),
+                               get_edge_length(diter->source, diter->target),
                                1,
                                diter->edge_id,
                                false,
@@ -175,6 +190,7 @@ class GraphContractor
             edges.emplace_back(diter->target,
                                diter->source,
                                static_cast<unsigned int>(std::max(diter->weight, 1)),
+                               get_edge_length(diter->target, diter->source),
                                1,
                                diter->edge_id,
                                false,
@@ -208,6 +224,8 @@ class GraphContractor
             forward_edge.data.shortcut = reverse_edge.data.shortcut = false;
             forward_edge.data.id = reverse_edge.data.id = id;
             forward_edge.data.originalEdges = reverse_edge.data.originalEdges = 1;
+            // all parallel edges connect the same two nodes and thus share their length
+            forward_edge.data.length = reverse_edge.data.length = edges[i].data.length;
             forward_edge.data.distance = reverse_edge.data.distance = INVALID_EDGE_WEIGHT;
             // remove parallel edges
             while (i < edges.size() && edges[i].source == source && edges[i].target == target)
@@ -256,8 +274,13 @@ class GraphContractor
         util::SimpleLogger().Write() << "contractor finished initalization";
     }
 
-    void Run(double core_factor = 1.0)
+    // A customizable hierarchy is contracted without witness searches: every path over a
+    // contracted node gets a shortcut, so GraphCustomizer can derive the weights of the hierarchy
+    // for other weights of the same graph. It has more shortcuts than a pruned one.
+    void Run(double core_factor = 1.0, const bool customizable_ = false)
     {
+        customizable = customizable_;
+
         // for the preperation we can use a big grain size, which is much faster (probably cache)
         const constexpr size_t InitGrainSize = 100000;
         const constexpr size_t PQGrainSize = 100000;
@@ -377,7 +400,7 @@ class GraphContractor
                         const NodeID target = contractor_graph->GetTarget(current_edge);
                         if (SPECIAL_NODEID == new_node_id_from_orig_id_map[source])
                         {
-                            external_edge_list.push_back({source, target, data});
+                            external_edge_list.push_back({source, target, data, data.length});
                         }
                         else
                         {
@@ -520,6 +543,10 @@ class GraphContractor
             {
                 for (const ContractorEdge &edge : data->inserted_edges)
                 {
+                    if (customizable && MergeParallelEdge(edge))
+                    {
+                        continue;
+                    }
                     const EdgeID current_edge_ID =
                         contractor_graph->FindEdge(edge.source, edge.target);
                     if (current_edge_ID < contractor_graph->EndEdges(edge.source))
@@ -602,6 +629,8 @@ class GraphContractor
         util::SimpleLogger().Write() << "[core] " << remaining_nodes.size() << " nodes "
                                      << contractor_graph->GetNumberOfEdges() << " edges."
                                      << std::endl;
+        util::SimpleLogger().Write() << "[lengths] " << number_of_unmerged_shortcuts
+                                     << " shortcuts not merged because their lengths differ";
 
         thread_data_list.data.clear();
     }
@@ -644,6 +673,7 @@ class GraphContractor
                     BOOST_ASSERT_MSG(SPECIAL_NODEID != new_edge.source, "Source id invalid");
                     BOOST_ASSERT_MSG(SPECIAL_NODEID != new_edge.target, "Target id invalid");
                     new_edge.data.distance = data.distance;
+                    new_edge.length = data.length;
                     new_edge.data.shortcut = data.shortcut;
                     if (!data.is_original_via_node_ID && !orig_node_id_from_new_node_id_map.empty())
                     {
@@ -821,7 +851,7 @@ class GraphContractor
                 const EdgeWeight path_distance = in_data.distance + out_data.distance;
                 if (target == source)
                 {
-                    if (path_distance < node_weights[node])
+                    if (customizable || path_distance < node_weights[node])
                     {
                         if (RUNSIMULATION)
                         {
@@ -845,6 +875,7 @@ class GraphContractor
                             inserted_edges.emplace_back(source,
                                                         target,
                                                         path_distance,
+                                                        in_data.length + out_data.length,
                                                         out_data.originalEdges +
                                                             in_data.originalEdges,
                                                         node,
@@ -855,6 +886,7 @@ class GraphContractor
                             inserted_edges.emplace_back(target,
                                                         source,
                                                         path_distance,
+                                                        in_data.length + out_data.length,
                                                         out_data.originalEdges +
                                                             in_data.originalEdges,
                                                         node,
@@ -873,13 +905,14 @@ class GraphContractor
                 }
             }
 
-            if (RUNSIMULATION)
+            // without a witness search all targets keep an infinite distance
+            if (RUNSIMULATION && !customizable)
             {
                 const int constexpr SIMULATION_SEARCH_SPACE_SIZE = 1000;
                 Dijkstra(
                     max_distance, number_of_targets, SIMULATION_SEARCH_SPACE_SIZE, *data, node);
             }
-            else
+            else if (!customizable)
             {
                 const int constexpr FULL_SEARCH_SPACE_SIZE = 2000;
                 Dijkstra(max_distance, number_of_targets, FULL_SEARCH_SPACE_SIZE, *data, node);
@@ -910,6 +943,7 @@ class GraphContractor
                         inserted_edges.emplace_back(source,
                                                     target,
                                                     path_distance,
+                                                    in_data.length + out_data.length,
                                                     out_data.originalEdges + in_data.originalEdges,
                                                     node,
                                                     SHORTCUT_ARC,
@@ -919,6 +953,7 @@ class GraphContractor
                         inserted_edges.emplace_back(target,
                                                     source,
                                                     path_distance,
+                                                    in_data.length + out_data.length,
                                                     out_data.originalEdges + in_data.originalEdges,
                                                     node,
                                                     SHORTCUT_ARC,
@@ -954,6 +989,13 @@ class GraphContractor
                     {
                         continue;
                     }
+                    // the length of an edge has to be the one of the path it unpacks to, so
+                    // shortcuts via different paths of the same weight stay apart
+                    if (inserted_edges[other].data.length != inserted_edges[i].data.length)
+                    {
+                        ++number_of_unmerged_shortcuts;
+                        continue;
+                    }
                     inserted_edges[other].data.forward |= inserted_edges[i].data.forward;
                     inserted_edges[other].data.backward |= inserted_edges[i].data.backward;
                     found = true;
@@ -993,6 +1035,28 @@ class GraphContractor
         }
     }
 
+    // Without witness searches the same shortcut comes up over every common neighbour of its
+    // ends, so it is merged into any parallel edge of the same directions.
+    inline bool MergeParallelEdge(const ContractorEdge &edge)
+    {
+        for (auto current_edge : contractor_graph->GetAdjacentEdgeRange(edge.source))
+        {
+            ContractorGraph::EdgeData &current_data = contractor_graph->GetEdgeData(current_edge);
+            if (contractor_graph->GetTarget(current_edge) != edge.target ||
+                edge.data.forward != current_data.forward ||
+                edge.data.backward != current_data.backward)
+            {
+                continue;
+            }
+            if (edge.data.distance < current_data.distance)
+            {
+                current_data = edge.data;
+            }
+            return true;
+        }
+        return false;
+    }
+
     inline bool UpdateNodeNeighbours(std::vector<float> &priorities,
                                      std::vector<NodeDepth> &node_depth,
                                      ContractorThreadData *const data,
@@ -1114,7 +1178,12 @@ class GraphContractor
     // self-loops are added.
     std::vector<EdgeWeight> node_weights;
     std::vector<bool> is_core_node;
+    // contract without witness searches, see Run
+    bool customizable = false;
     util::XORFastHash<> fast_hash;
+    // Forward and backward shortcuts that would have been merged into one edge if lengths were
+    // ignored, i.e. the edges the lengths add to the hierarchy
+    std::atomic<std::size_t> number_of_unmerged_shortcuts{0};
 };
 }
 }
@@ -0,0 +1,492 @@
+#ifndef GRAPH_CUSTOMIZER_HPP
+#define GRAPH_CUSTOMIZER_HPP
+
+#include "contractor/query_edge.hpp"
+#include "extractor/edge_based_edge.hpp"
+#include "util/deallocating_vector.hpp"
+#include "util/exception.hpp"
+#include "util/integer_range.hpp"
+#include "util/static_graph.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace osrm
+{
+namespace contractor
+{
+
+// Derives the weights of an existing contraction hierarchy from new weights of the edge-based
+// graph without contracting it again.
+//
+// This only works for hierarchies contracted without witness searches (see
+// GraphContractor::Run), in which every path over a contracted node got a shortcut. Their
+// topology does not depend on the weights: each pair of nodes the hierarchy connects gets the
+// smaller of the weight of the edge-based edges between them and the weights of all paths over
+// a common neighbour that was contracted before both. The best path decides whether the pair
+// becomes an original edge or a shortcut and which middle node the shortcut has.
+//
+// The pairs of a node only depend on the pairs of nodes contracted before it, so nodes are
+// grouped into levels and the pairs of each level are computed in parallel, bottom-up.
+// Hierarchies pruned by witness searches are rejected, their shortcuts only stay shortest as
+// long as the witnesses do.
+class GraphCustomizer
+{
+  public:
+    using QueryGraph = util::StaticGraph<QueryEdge::EdgeData>;
+
+    // Groups the pairs of the graph and checks that it is customizable, which does not depend on
+    // any weights
+    explicit GraphCustomizer(const QueryGraph &graph)
+    {
+        BuildPairs(graph);
+        GroupPairsByLevel();
+        CheckCustomizable();
+    }
+
+    std::size_t GetNumberOfLevels() const { return level_offsets.size() - 1; }
+
+    // Writes the edges of the graph with their new weights. node_lengths holds the length of
+    // every node of the graph, it can be empty. A pair gets a bidirectional edge if both of its
+    // directions resolve to the same path and an edge per direction otherwise.
+    void Run(const util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list,
+             const std::vector<EdgeLength> &node_lengths,
+             util::DeallocatingVector<QueryEdge> &edges) const
+    {
+        BOOST_ASSERT(node_lengths.empty() || node_lengths.size() + 1 >= pair_offsets.size());
+
+        std::vector<Arc> arcs;
+        arcs.reserve(2 * edge_based_edge_list.size());
+        for (const extractor::EdgeBasedEdge &edge : edge_based_edge_list)
+        {
+            // the hierarchy has no loops of single edge-based edges
+            if (edge.source == edge.target)
+            {
+                continue;
+            }
+            const EdgeWeight weight = std::max(edge.weight, 1);
+            if (edge.forward)
+            {
+                arcs.push_back(Arc{edge.source, edge.target, weight, edge.edge_id});
+            }
+            if (edge.backward)
+            {
+                arcs.push_back(Arc{edge.target, edge.source, weight, edge.edge_id});
+            }
+        }
+        tbb::parallel_sort(arcs.begin(), arcs.end());
+
+        for (const auto &arc : arcs)
+        {
+            if (!HasDirection(arc.source, arc.target))
+            {
+                throw util::exception("Edge from " + std::to_string(arc.source) + " to " +
+                                      std::to_string(arc.target) +
+                                      " is not part of the hierarchy, contract it again");
+            }
+        }
+
+        std::vector<Path> paths(2 * pairs.size());
+        for (const auto level : util::irange<std::size_t>(0, GetNumberOfLevels()))
+        {
+            tbb::parallel_for(
+                tbb::blocked_range<std::size_t>(level_offsets[level], level_offsets[level + 1]),
+                [&](const tbb::blocked_range<std::size_t> &range) {
+                    for (auto index = range.begin(), end = range.end(); index != end; ++index)
+                    {
+                        ComputePaths(pairs_by_level[index], arcs, node_lengths, paths);
+                    }
+                });
+        }
+
+        edges.clear();
+        for (const auto index : util::irange<std::size_t>(0, pairs.size()))
+        {
+            const auto &pair = pairs[index];
+            const auto &forward_path = paths[2 * index + FORWARD];
+            const auto &backward_path = paths[2 * index + BACKWARD];
+            const auto add_edge = [&](const Path &path, const bool forward, const bool backward) {
+                QueryEdge::EdgeData data;
+                data.distance = path.weight;
+                data.id = path.id;
+                data.shortcut = path.shortcut;
+                data.forward = forward;
+                data.backward = backward;
+                edges.push_back(QueryEdge(pair.source, pair.target, data, path.length));
+            };
+
+            if (pair.forward && pair.backward && forward_path == backward_path)
+            {
+                add_edge(forward_path, true, true);
+                continue;
+            }
+            if (pair.forward)
+            {
+                add_edge(forward_path, true, false);
+            }
+            if (pair.backward)
+            {
+                add_edge(backward_path, false, true);
+            }
+        }
+    }
+
+  private:
+    static const constexpr std::size_t NO_PAIR = std::numeric_limits<std::size_t>::max();
+
+    // Directions a pair can be used in, the paths are stored per pair and direction
+    enum Direction : unsigned
+    {
+        FORWARD = 0,
+        BACKWARD = 1
+    };
+
+    // Two nodes the hierarchy connects, at the node that stores their edges. It is upward if
+    // source was contracted before target, i.e. target does not store the pair as well. Pairs of
+    // the core and loops are not.
+    struct Pair
+    {
+        NodeID source;
+        NodeID target;
+        bool forward;
+        bool backward;
+        bool upward;
+    };
+
+    // Edge-based edge in the direction it can be traversed in
+    struct Arc
+    {
+        NodeID source;
+        NodeID target;
+        EdgeWeight weight;
+        EdgeID edge_id;
+
+        bool operator<(const Arc &rhs) const
+        {
+            return std::tie(source, target, weight, edge_id) <
+                   std::tie(rhs.source, rhs.target, rhs.weight, rhs.edge_id);
+        }
+    };
+
+    // Best path of a pair in one direction, id is the edge-based edge of an original edge and the
+    // middle node of a shortcut
+    struct Path
+    {
+        EdgeWeight weight = INVALID_EDGE_WEIGHT;
+        NodeID id = SPECIAL_NODEID;
+        EdgeLength length = 0;
+        bool shortcut = false;
+
+        bool operator==(const Path &rhs) const
+        {
+            return std::tie(weight, id, length, shortcut) ==
+                   std::tie(rhs.weight, rhs.id, rhs.length, rhs.shortcut);
+        }
+    };
+
+    // Merges the parallel edges of the graph into pairs, sorted by source and target
+    void BuildPairs(const QueryGraph &graph)
+    {
+        const auto number_of_nodes = graph.GetNumberOfNodes();
+        pair_offsets.reserve(number_of_nodes + 1);
+        for (const auto node : util::irange(0u, number_of_nodes))
+        {
+            pair_offsets.push_back(pairs.size());
+            const auto first = pairs.size();
+            for (const auto edge : graph.GetAdjacentEdgeRange(node))
+            {
+                const auto &data = graph.GetEdgeData(edge);
+                pairs.push_back(
+                    Pair{node, graph.GetTarget(edge), data.forward, data.backward, false});
+            }
+            std::sort(pairs.begin() + first, pairs.end(), [](const Pair &lhs, const Pair &rhs) {
+                return lhs.target < rhs.target;
+            });
+
+            auto last = first;
+            for (auto index = first; index < pairs.size(); ++index)
+            {
+                if (last > first && pairs[last - 1].target == pairs[index].target)
+                {
+                    pairs[last - 1].forward |= pairs[index].forward;
+                    pairs[last - 1].backward |= pairs[index].backward;
+                }
+                else
+                {
+                    pairs[last++] = pairs[index];
+                }
+            }
+            pairs.resize(last);
+        }
+        pair_offsets.push_back(pairs.size());
+
+        for (auto &pair : pairs)
+        {
+            pair.upward =
+                pair.source != pair.target && FindPair(pair.target, pair.source) == NO_PAIR;
+        }
+
+        // the lower pairs of a node come from its lower neighbours, sorted by them
+        lower_offsets.assign(number_of_nodes + 1, 0);
+        for (const auto &pair : pairs)
+        {
+            if (pair.upward)
+            {
+                ++lower_offsets[pair.target + 1];
+            }
+        }
+        std::partial_sum(lower_offsets.begin(), lower_offsets.end(), lower_offsets.begin());
+        lower_pairs.resize(lower_offsets.back());
+        auto positions = lower_offsets;
+        for (const auto index : util::irange<std::size_t>(0, pairs.size()))
+        {
+            if (pairs[index].upward)
+            {
+                lower_pairs[positions[pairs[index].target]++] = index;
+            }
+        }
+    }
+
+    // The level of a node is one more than the highest level of its lower neighbours, the pairs
+    // of a node have its level. Fails if the upward pairs contain a cycle, which no contraction
+    // produces.
+    void GroupPairsByLevel()
+    {
+        const auto number_of_nodes = pair_offsets.size() - 1;
+        std::vector<std::uint32_t> levels(number_of_nodes, 0);
+        std::vector<std::size_t> remaining_lower(number_of_nodes);
+        std::vector<NodeID> queue;
+        for (const auto node : util::irange<std::size_t>(0, number_of_nodes))
+        {
+            remaining_lower[node] = lower_offsets[node + 1] - lower_offsets[node];
+            if (remaining_lower[node] == 0)
+            {
+                queue.push_back(static_cast<NodeID>(node));
+            }
+        }
+        for (std::size_t head = 0; head < queue.size(); ++head)
+        {
+            const NodeID node = queue[head];
+            for (const auto index : util::irange(pair_offsets[node], pair_offsets[node + 1]))
+            {
+                const auto &pair = pairs[index];
+                if (!pair.upward)
+                {
+                    continue;
+                }
+                levels[pair.target] = std::max(levels[pair.target], levels[node] + 1);
+                if (--remaining_lower[pair.target] == 0)
+                {
+                    queue.push_back(pair.target);
+                }
+            }
+        }
+        if (queue.size() != number_of_nodes)
+        {
+            throw util::exception("Contracted graph has cyclic shortcuts, contract it again");
+        }
+
+        const auto number_of_levels =
+            number_of_nodes == 0 ? 0 : *std::max_element(levels.begin(), levels.end()) + 1;
+        level_offsets.assign(number_of_levels + 1, 0);
+        for (const auto &pair : pairs)
+        {
+            ++level_offsets[levels[pair.source] + 1];
+        }
+        std::partial_sum(level_offsets.begin(), level_offsets.end(), level_offsets.begin());
+
+        pairs_by_level.resize(pairs.size());
+        auto positions = level_offsets;
+        for (const auto index : util::irange<std::size_t>(0, pairs.size()))
+        {
+            pairs_by_level[positions[levels[pairs[index].source]]++] = index;
+        }
+    }
+
+    // Every path over a contracted node needs a pair in its direction, so that the pair can take
+    // the weight of the path whatever the weights are
+    void CheckCustomizable() const
+    {
+        std::atomic<NodeID> pruned_node{SPECIAL_NODEID};
+        const auto number_of_nodes = pair_offsets.size() - 1;
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, number_of_nodes),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                for (auto node = range.begin(), end = range.end(); node != end; ++node)
+                {
+                    for (const auto in : util::irange(pair_offsets[node], pair_offsets[node + 1]))
+                    {
+                        if (!pairs[in].upward || !pairs[in].backward)
+                        {
+                            continue;
+                        }
+                        for (const auto out :
+                             util::irange(pair_offsets[node], pair_offsets[node + 1]))
+                        {
+                            if (pairs[out].upward && pairs[out].forward &&
+                                !HasDirection(pairs[in].target, pairs[out].target))
+                            {
+                                pruned_node = static_cast<NodeID>(node);
+                            }
+                        }
+                    }
+                }
+            });
+
+        if (pruned_node != SPECIAL_NODEID)
+        {
+            throw util::exception("Contracted graph is not customizable, a shortcut over node " +
+                                  std::to_string(pruned_node.load()) +
+                                  " is missing. Contract it with --customizable first.");
+        }
+    }
+
+    // Index of the pair stored at source for target, NO_PAIR if there is none
+    std::size_t FindPair(const NodeID source, const NodeID target) const
+    {
+        const auto begin = pairs.begin() + pair_offsets[source];
+        const auto end = pairs.begin() + pair_offsets[source + 1];
+        const auto pair = std::lower_bound(
+            begin, end, target, [](const Pair &lhs, const NodeID rhs) { return lhs.target < rhs; });
+        if (pair == end || pair->target != target)
+        {
+            return NO_PAIR;
+        }
+        return std::distance(pairs.begin(), pair);
+    }
+
+    // Whether the hierarchy can get from one node to the other with a single edge
+    bool HasDirection(const NodeID from, const NodeID to) const
+    {
+        const auto forward_pair = FindPair(from, to);
+        if (forward_pair != NO_PAIR && pairs[forward_pair].forward)
+        {
+            return true;
+        }
+        const auto backward_pair = FindPair(to, from);
+        return backward_pair != NO_PAIR && pairs[backward_pair].backward;
+    }
+
+    // Calls f(first, second) for all nodes contracted before both from and to that store a pair
+    // for each of them, first is the pair for from and second the one for to
+    template <typename Callback>
+    void ForEachLowerNeighbour(const NodeID from, const NodeID to, Callback &&f) const
+    {
+        auto first = lower_pairs.begin() + lower_offsets[from];
+        const auto first_end = lower_pairs.begin() + lower_offsets[from + 1];
+        auto second = lower_pairs.begin() + lower_offsets[to];
+        const auto second_end = lower_pairs.begin() + lower_offsets[to + 1];
+        while (first != first_end && second != second_end)
+        {
+            const NodeID first_source = pairs[*first].source;
+            const NodeID second_source = pairs[*second].source;
+            if (first_source < second_source)
+            {
+                ++first;
+            }
+            else if (second_source < first_source)
+            {
+                ++second;
+            }
+            else
+            {
+                f(*first++, *second++);
+            }
+        }
+    }
+
+    // Best path from one node to the other: the cheapest edge-based edge or the cheapest path
+    // over a lower neighbour, whose pairs have already been computed
+    Path FindBestPath(const NodeID from,
+                      const NodeID to,
+                      const EdgeLength length,
+                      const std::vector<Arc> &arcs,
+                      const std::vector<Path> &paths) const
+    {
+        Path best;
+        const auto arc = std::lower_bound(
+            arcs.begin(), arcs.end(), Arc{from, to, std::numeric_limits<EdgeWeight>::min(), 0});
+        if (arc != arcs.end() && arc->source == from && arc->target == to)
+        {
+            best.weight = arc->weight;
+            best.id = arc->edge_id;
+            best.length = length;
+        }
+
+        ForEachLowerNeighbour(from, to, [&](const std::size_t first, const std::size_t second) {
+            if (!pairs[first].backward || !pairs[second].forward)
+            {
+                return;
+            }
+            const auto &to_middle = paths[2 * first + BACKWARD];
+            const auto &from_middle = paths[2 * second + FORWARD];
+            BOOST_ASSERT(to_middle.weight != INVALID_EDGE_WEIGHT);
+            BOOST_ASSERT(from_middle.weight != INVALID_EDGE_WEIGHT);
+            const EdgeWeight weight = to_middle.weight + from_middle.weight;
+            if (weight < best.weight)
+            {
+                best.weight = weight;
+                best.id = pairs[first].source;
+                best.length = to_middle.length + from_middle.length;
+                best.shortcut = true;
+            }
+        });
+        return best;
+    }
+
+    void ComputePaths(const std::size_t index,
+                      const std::vector<Arc> &arcs,
+                      const std::vector<EdgeLength> &node_lengths,
+                      std::vector<Path> &paths) const
+    {
+        const auto &pair = pairs[index];
+        const EdgeLength length =
+            node_lengths.empty() ? 0 : node_lengths[pair.source] + node_lengths[pair.target];
+
+        if (pair.forward)
+        {
+            paths[2 * index + FORWARD] =
+                FindBestPath(pair.source, pair.target, length, arcs, paths);
+        }
+        if (pair.backward)
+        {
+            paths[2 * index + BACKWARD] =
+                FindBestPath(pair.target, pair.source, length, arcs, paths);
+        }
+
+        if ((pair.forward && paths[2 * index + FORWARD].weight == INVALID_EDGE_WEIGHT) ||
+            (pair.backward && paths[2 * index + BACKWARD].weight == INVALID_EDGE_WEIGHT))
+        {
+            throw util::exception("Edge from " + std::to_string(pair.source) + " to " +
+                                  std::to_string(pair.target) +
+                                  " does not match the edge-based graph, contract it again");
+        }
+    }
+
+    std::vector<Pair> pairs;
+    // the pairs stored at a node start at its offset
+    std::vector<std::size_t> pair_offsets;
+    // upward pairs by target, the ones of a node start at its offset
+    std::vector<std::size_t> lower_pairs;
+    std::vector<std::size_t> lower_offsets;
+    // pairs sorted by level, the pairs of a level start at its offset
+    std::vector<std::size_t> pairs_by_level;
+    std::vector<std::size_t> level_offsets;
+};
+}
+}
+
+#endif // GRAPH_CUSTOMIZER_HPP
@@ -1,6 +1,7 @@
 #ifndef QUERYEDGE_HPP
 #define QUERYEDGE_HPP
 
+#include "util/edge_direction_split.hpp"
 #include "util/typedefs.hpp"
 
 #include <tuple>
@@ -32,17 +33,26 @@ struct QueryEdge
         bool forward : 1;
         bool backward : 1;
     } data;
+    // Geometric length of the edge, kept next to the edge data instead of inside it so the
+    // search graph stays compact. Every edge counts the full length of both edge-based nodes
+    // it connects, which makes the value independent of the direction the edge is used in.
+    // Along a path every node but the first and the last one is therefore counted twice.
+    EdgeLength length;
 
-    QueryEdge() : source(SPECIAL_NODEID), target(SPECIAL_NODEID) {}
+    QueryEdge() : source(SPECIAL_NODEID), target(SPECIAL_NODEID), length(0) {}
 
-    QueryEdge(NodeID source, NodeID target, EdgeData data)
-        : source(source), target(target), data(std::move(data))
+    QueryEdge(NodeID source, NodeID target, EdgeData data, EdgeLength length = 0)
+        : source(source), target(target), data(std::move(data)), length(length)
     {
     }
 
+    // Groups the edges of a node by direction, so every search direction iterates a contiguous
+    // range of them, see util::EdgeDirectionSplit
     bool operator<(const QueryEdge &rhs) const
     {
-        return std::tie(source, target) < std::tie(rhs.source, rhs.target);
+        const auto group = util::GetEdgeDirectionGroup(data);
+        const auto rhs_group = util::GetEdgeDirectionGroup(rhs.data);
+        return std::tie(source, group, target) < std::tie(rhs.source, rhs_group, rhs.target);
     }
 
     bool operator==(const QueryEdge &right) const
@@ -50,7 +60,7 @@ struct QueryEdge
         return (source == right.source && target == right.target &&
                 data.distance == right.data.distance && data.shortcut == right.data.shortcut &&
                 data.forward == right.data.forward && data.backward == right.data.backward &&
-                data.id == right.data.id);
+                data.id == right.data.id && length == right.length);
     }
 };
 }
@@ -29,7 +29,14 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define ENGINE_API_MULTI_TARGET_PARAMETERS_HPP
 
 #include "engine/api/base_parameters.hpp"
+#include "engine/status.hpp"
+#include "util/json_container.hpp"
 
+#include <boost/optional.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <functional>
 #include <vector>
 
 namespace osrm
@@ -50,9 +57,25 @@ struct MultiTargetParameters : public BaseParameters
     }
 
     bool forward = true;
+    // Durations only if false, which saves looking up the path of every target
+    bool calculate_distance = true;
+    // Targets further away than this many seconds are reported as unreachable
+    boost::optional<double> max_duration;
+    // Only the k closest targets are reported
+    boost::optional<std::size_t> k;
 
-    bool IsValid() const { return coordinates.size() > 1 && BaseParameters::IsValid(); }
+    bool IsValid() const
+    {
+        return coordinates.size() > 1 && BaseParameters::IsValid() &&
+               (!max_duration || (std::isfinite(*max_duration) && *max_duration >= 0)) &&
+               (!k || *k > 0);
+    }
 };
+
+// Receives the result of a sub-query of a batch as soon as it is computed, in batch order.
+// Runs inside the batch, which keeps its dataset alive, so it should hand the result off quickly.
+using MultiTargetBatchHandler =
+    std::function<void(std::size_t index, Status status, util::json::Object &result)>;
 }
 }
 }
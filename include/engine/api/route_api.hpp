@@ -49,7 +49,7 @@ class RouteAPI : public BaseAPI
                                      raw_route.target_traversed_in_reverse);
         if (raw_route.has_alternative())
         {
-            std::vector<std::vector<PathData>> wrapped_leg(1);
+            std::vector<PathDataList> wrapped_leg(1);
             wrapped_leg.front() = std::move(raw_route.unpacked_alternative);
             routes.values[1] = MakeRoute(raw_route.segment_end_coordinates,
                                          wrapped_leg,
@@ -80,7 +80,7 @@ class RouteAPI : public BaseAPI
     }
 
     util::json::Object MakeRoute(const std::vector<PhantomNodes> &segment_end_coordinates,
-                                 const std::vector<std::vector<PathData>> &unpacked_path_segments,
+                                 const std::vector<PathDataList> &unpacked_path_segments,
                                  const std::vector<bool> &source_traversed_in_reverse,
                                  const std::vector<bool> &target_traversed_in_reverse) const
     {
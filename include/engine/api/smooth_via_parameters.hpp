@@ -50,6 +50,8 @@ struct SmoothViaParameters : public BaseParameters
     }
 
     std::vector<std::vector<util::Coordinate>> waypoints;
+    // Adds the per request metrics to the response
+    bool debug = false;
 
     bool IsValid() const { return waypoints.size() > 2 && BaseParameters::IsValid(); }
 };
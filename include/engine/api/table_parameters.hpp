@@ -30,6 +30,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "engine/api/base_parameters.hpp"
 
+#include <boost/optional.hpp>
+
+#include <cmath>
 #include <cstddef>
 
 #include <algorithm>
@@ -51,6 +54,8 @@ namespace api
  *             use all coordinates as sources
  *  - destinations: indices into coordinates indicating destinations for the Table service, no
  *                  destinations means use all coordinates as destinations
+ *  - max_duration: durations above this many seconds are reported as unreachable
+ *  - k: only the k closest destinations of every source are reported
  *
  * \see OSRM, Coordinate, Hint, Bearing, RouteParame, RouteParameters, TableParameters,
  *      NearestParameters, TripParameters, MatchParameters and TileParameters
@@ -59,6 +64,8 @@ struct TableParameters : public BaseParameters
 {
     std::vector<std::size_t> sources;
     std::vector<std::size_t> destinations;
+    boost::optional<double> max_duration;
+    boost::optional<std::size_t> k;
 
     TableParameters() = default;
     template <typename... Args>
@@ -97,6 +104,12 @@ struct TableParameters : public BaseParameters
         if (std::any_of(begin(destinations), end(destinations), not_in_range))
             return false;
 
+        if (max_duration && (!std::isfinite(*max_duration) || *max_duration < 0))
+            return false;
+
+        if (k && *k == 0)
+            return false;
+
         return true;
     }
 };
@@ -10,9 +10,12 @@
 #include "extractor/guidance/turn_lane_types.hpp"
 #include "engine/phantom_node.hpp"
 #include "util/exception.hpp"
+#include "util/edge_direction_split.hpp"
+#include "util/shortcut_children.hpp"
 #include "util/guidance/bearing_class.hpp"
 #include "util/guidance/entry_class.hpp"
 #include "util/integer_range.hpp"
+#include "util/landmark_potential.hpp"
 #include "util/string_util.hpp"
 #include "util/typedefs.hpp"
 
@@ -52,12 +55,29 @@ class BaseDataFacade
 
     virtual const EdgeData &GetEdgeData(const EdgeID e) const = 0;
 
+    // false if the data set was prepared without node and edge lengths
+    virtual bool HasLengths() const = 0;
+
+    // length of the geometry of a node in decimeters
+    virtual EdgeLength GetNodeLength(const NodeID n) const = 0;
+
+    // length of an edge in decimeters, see contractor::QueryEdge::length
+    virtual EdgeLength GetEdgeLength(const EdgeID e) const = 0;
+
     virtual EdgeID BeginEdges(const NodeID n) const = 0;
 
     virtual EdgeID EndEdges(const NodeID n) const = 0;
 
     virtual EdgeRange GetAdjacentEdgeRange(const NodeID node) const = 0;
 
+    // adjacency of a node with the ranges of its forward and backward edges
+    virtual util::DirectedEdgeRanges GetDirectedEdgeRanges(const NodeID node) const = 0;
+
+    // edges a shortcut is made of, when it is used from its source to its target (forward) or
+    // the other way around
+    virtual util::ShortcutChildren GetShortcutChildren(const EdgeID shortcut,
+                                                       const bool forward) const = 0;
+
     // searches for a specific edge
     virtual EdgeID FindEdge(const NodeID from, const NodeID to) const = 0;
 
@@ -158,6 +178,12 @@ class BaseDataFacade
 
     virtual std::size_t GetCoreSize() const = 0;
 
+    // 0 if the data set has no landmarks for the core
+    virtual unsigned GetNumberOfLandmarks() const = 0;
+
+    // GetNumberOfLandmarks() distances of a core node, nullptr for nodes outside of the core
+    virtual const util::LandmarkDistance *GetLandmarkDistances(const NodeID id) const = 0;
+
     virtual std::string GetTimestamp() const = 0;
 
     virtual bool GetContinueStraightDefault() const = 0;
@@ -18,6 +18,8 @@
 #include "util/graph_loader.hpp"
 #include "util/guidance/turn_lanes.hpp"
 #include "util/io.hpp"
+#include "util/landmark_potential.hpp"
+#include "util/mapped_file.hpp"
 #include "util/packed_vector.hpp"
 #include "util/range_table.hpp"
 #include "util/rectangle.hpp"
@@ -35,6 +37,7 @@
 #include <algorithm>
 #include <fstream>
 #include <ios>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <string>
@@ -60,7 +63,7 @@ class InternalDataFacade final : public BaseDataFacade
 
   private:
     using super = BaseDataFacade;
-    using QueryGraph = util::StaticGraph<typename super::EdgeData>;
+    using QueryGraph = util::StaticGraph<typename super::EdgeData, true>;
     using InputEdge = QueryGraph::InputEdge;
     using RTreeLeaf = super::RTreeLeaf;
     using InternalRTree =
@@ -69,9 +72,23 @@ class InternalDataFacade final : public BaseDataFacade
 
     InternalDataFacade() {}
 
+    // Blocks that are stored the same way in memory as in their files are used in place
+    bool m_map_files = false;
+    util::MappedFile m_graph_file;
+    util::MappedFile m_lengths_file;
+    util::MappedFile m_landmarks_file;
+    util::MappedFile m_geometry_file;
+    util::MappedFile m_datasource_file;
+    util::MappedFile m_lane_data_file;
+
     unsigned m_check_sum;
     unsigned m_number_of_nodes;
     std::unique_ptr<QueryGraph> m_query_graph;
+    util::ShM<util::EdgeDirectionSplit, false>::vector m_edge_direction_splits;
+    util::ShM<EdgeID, false>::vector m_shortcut_children_offsets;
+    util::ShM<util::ShortcutChildren, false>::vector m_shortcut_children;
+    util::ShM<EdgeLength, true>::vector m_node_lengths;
+    util::ShM<EdgeLength, true>::vector m_edge_lengths;
     std::string m_timestamp;
 
     util::ShM<util::Coordinate, false>::vector m_coordinate_list;
@@ -80,14 +97,17 @@ class InternalDataFacade final : public BaseDataFacade
     util::ShM<unsigned, false>::vector m_name_ID_list;
     util::ShM<extractor::guidance::TurnInstruction, false>::vector m_turn_instruction_list;
     util::ShM<LaneDataID, false>::vector m_lane_data_id;
-    util::ShM<util::guidance::LaneTupelIdPair, false>::vector m_lane_tupel_id_pairs;
+    util::ShM<util::guidance::LaneTupelIdPair, true>::vector m_lane_tupel_id_pairs;
     util::ShM<extractor::TravelMode, false>::vector m_travel_mode_list;
     util::ShM<char, false>::vector m_names_char_list;
-    util::ShM<unsigned, false>::vector m_geometry_indices;
-    util::ShM<extractor::CompressedEdgeContainer::CompressedEdge, false>::vector m_geometry_list;
+    util::ShM<unsigned, true>::vector m_geometry_indices;
+    util::ShM<extractor::CompressedEdgeContainer::CompressedEdge, true>::vector m_geometry_list;
     util::ShM<bool, false>::vector m_is_core_node;
+    unsigned m_number_of_landmarks = 0;
+    util::ShM<NodeID, true>::vector m_landmark_core_index;
+    util::ShM<util::LandmarkDistance, true>::vector m_landmark_distances;
     util::ShM<unsigned, false>::vector m_segment_weights;
-    util::ShM<uint8_t, false>::vector m_datasource_list;
+    util::ShM<uint8_t, true>::vector m_datasource_list;
     util::ShM<std::string, false>::vector m_datasource_names;
     util::ShM<std::uint32_t, false>::vector m_lane_description_offsets;
     util::ShM<extractor::guidance::TurnLaneType::Mask, false>::vector m_lane_description_masks;
@@ -125,16 +145,9 @@ class InternalDataFacade final : public BaseDataFacade
 
     void LoadLaneTupelIdPairs(const boost::filesystem::path &lane_data_path)
     {
-        boost::filesystem::ifstream in_stream(lane_data_path);
-        if (!in_stream)
-        {
-            throw util::exception("Could not open " + lane_data_path.string() + " for reading.");
-        }
-        std::uint64_t size;
-        in_stream.read(reinterpret_cast<char *>(&size), sizeof(size));
-        m_lane_tupel_id_pairs.resize(size);
-        in_stream.read(reinterpret_cast<char *>(&m_lane_tupel_id_pairs[0]),
-                       sizeof(m_lane_tupel_id_pairs[0]) * size);
+        m_lane_data_file = util::MappedFile(lane_data_path, m_map_files);
+        const auto size = m_lane_data_file.ReadValue<std::uint64_t>();
+        m_lane_tupel_id_pairs = m_lane_data_file.ReadBlock<util::guidance::LaneTupelIdPair>(size);
     }
 
     void LoadTimestamp(const boost::filesystem::path &timestamp_path)
@@ -148,26 +161,73 @@ class InternalDataFacade final : public BaseDataFacade
         getline(timestamp_stream, m_timestamp);
     }
 
+    // Same layout as read by readHSGRFromStream
     void LoadGraph(const boost::filesystem::path &hsgr_path)
     {
-        util::ShM<QueryGraph::NodeArrayEntry, false>::vector node_list;
-        util::ShM<QueryGraph::EdgeArrayEntry, false>::vector edge_list;
-
         util::SimpleLogger().Write() << "loading graph from " << hsgr_path.string();
 
-        m_number_of_nodes = readHSGRFromStream(hsgr_path, node_list, edge_list, &m_check_sum);
+        m_graph_file = util::MappedFile(hsgr_path, m_map_files);
+        if (0 == m_graph_file.GetSize())
+        {
+            throw util::exception("hsgr file is empty");
+        }
+
+        const auto fingerprint_loaded = m_graph_file.ReadValue<util::FingerPrint>();
+        if (!fingerprint_loaded.TestGraphUtil(util::FingerPrint::GetValid()))
+        {
+            util::SimpleLogger().Write(logWARNING) << ".hsgr was prepared with different build.\n"
+                                                      "Reprocess to get rid of this warning.";
+        }
+        util::CheckEdgeOrderVersion(hsgr_path.string(), m_graph_file.ReadValue<std::uint32_t>());
+
+        m_check_sum = m_graph_file.ReadValue<unsigned>();
+        m_number_of_nodes = m_graph_file.ReadValue<unsigned>();
+        const auto number_of_edges = m_graph_file.ReadValue<unsigned>();
+        auto node_list = m_graph_file.ReadBlock<QueryGraph::NodeArrayEntry>(m_number_of_nodes);
+        auto edge_list = m_graph_file.ReadBlock<QueryGraph::EdgeArrayEntry>(number_of_edges);
 
         BOOST_ASSERT_MSG(0 != node_list.size(), "node list empty");
-        // BOOST_ASSERT_MSG(0 != edge_list.size(), "edge list empty");
         util::SimpleLogger().Write()
             << "loaded " << node_list.size() << " nodes and " << edge_list.size() << " edges";
         m_query_graph = std::unique_ptr<QueryGraph>(new QueryGraph(node_list, edge_list));
 
-        BOOST_ASSERT_MSG(0 == node_list.size(), "node list not flushed");
-        BOOST_ASSERT_MSG(0 == edge_list.size(), "edge list not flushed");
+        m_edge_direction_splits.reserve(m_query_graph->GetNumberOfNodes());
+        util::BuildEdgeDirectionSplits(*m_query_graph,
+                                       std::back_inserter(m_edge_direction_splits));
+
+        util::SimpleLogger().Write() << "resolving shortcut children";
+        m_shortcut_children_offsets.reserve(m_query_graph->GetNumberOfEdges() + 1);
+        util::BuildShortcutChildren(*m_query_graph,
+                                    std::back_inserter(m_shortcut_children_offsets),
+                                    std::back_inserter(m_shortcut_children));
         util::SimpleLogger().Write() << "Data checksum is " << m_check_sum;
     }
 
+    // The lengths are optional, without them distances are computed from the geometry
+    void LoadLengths(const boost::filesystem::path &lengths_path)
+    {
+        try
+        {
+            m_lengths_file = util::MappedFile(lengths_path, m_map_files);
+            if (m_lengths_file.ReadAndCheckFingerprint())
+            {
+                const auto node_lengths = m_lengths_file.ReadVector<EdgeLength>();
+                const auto edge_lengths = m_lengths_file.ReadVector<EdgeLength>();
+                if (edge_lengths.size() == m_query_graph->GetNumberOfEdges())
+                {
+                    m_node_lengths = node_lengths;
+                    m_edge_lengths = edge_lengths;
+                    return;
+                }
+            }
+        }
+        catch (const util::exception &)
+        {
+        }
+        util::SimpleLogger().Write(logWARNING) << "Could not read lengths from "
+                                               << lengths_path.string();
+    }
+
     void LoadNodeAndEdgeInformation(const boost::filesystem::path &nodes_file,
                                     const boost::filesystem::path &edges_file)
     {
@@ -233,54 +293,64 @@ class InternalDataFacade final : public BaseDataFacade
         }
     }
 
-    void LoadGeometries(const boost::filesystem::path &geometry_file)
+    // The landmarks are optional, without them the core is searched without a goal direction.
+    // Same layout and checks as contractor::readCoreLandmarks.
+    void LoadCoreLandmarks(const boost::filesystem::path &landmarks_path)
     {
-        std::ifstream geometry_stream(geometry_file.string().c_str(), std::ios::binary);
-        unsigned number_of_indices = 0;
-        unsigned number_of_compressed_geometries = 0;
-
-        geometry_stream.read((char *)&number_of_indices, sizeof(unsigned));
-
-        m_geometry_indices.resize(number_of_indices);
-        if (number_of_indices > 0)
+        try
         {
-            geometry_stream.read((char *)&(m_geometry_indices[0]),
-                                 number_of_indices * sizeof(unsigned));
+            m_landmarks_file = util::MappedFile(landmarks_path, m_map_files);
+            if (m_landmarks_file.ReadAndCheckFingerprint() &&
+                m_landmarks_file.ReadValue<unsigned>() == m_check_sum)
+            {
+                const auto landmarks = m_landmarks_file.ReadVector<NodeID>();
+                const auto core_index = m_landmarks_file.ReadVector<NodeID>();
+                const auto distances = m_landmarks_file.ReadVector<util::LandmarkDistance>();
+
+                const auto number_of_core_nodes =
+                    landmarks.empty() ? 0 : distances.size() / landmarks.size();
+                if (std::all_of(core_index.begin(),
+                                core_index.end(),
+                                [number_of_core_nodes](const NodeID index) {
+                                    return index == SPECIAL_NODEID ||
+                                           index < number_of_core_nodes;
+                                }))
+                {
+                    m_number_of_landmarks = landmarks.size();
+                    m_landmark_core_index = core_index;
+                    m_landmark_distances = distances;
+                    return;
+                }
+            }
         }
+        catch (const util::exception &)
+        {
+        }
+        util::SimpleLogger().Write(logWARNING) << "Could not read landmarks from "
+                                               << landmarks_path.string();
+    }
 
-        geometry_stream.read((char *)&number_of_compressed_geometries, sizeof(unsigned));
+    void LoadGeometries(const boost::filesystem::path &geometry_file)
+    {
+        m_geometry_file = util::MappedFile(geometry_file, m_map_files);
 
-        BOOST_ASSERT(m_geometry_indices.back() == number_of_compressed_geometries);
-        m_geometry_list.resize(number_of_compressed_geometries);
+        const auto number_of_indices = m_geometry_file.ReadValue<unsigned>();
+        m_geometry_indices = m_geometry_file.ReadBlock<unsigned>(number_of_indices);
 
-        if (number_of_compressed_geometries > 0)
-        {
-            geometry_stream.read((char *)&(m_geometry_list[0]),
-                                 number_of_compressed_geometries *
-                                     sizeof(extractor::CompressedEdgeContainer::CompressedEdge));
-        }
+        const auto number_of_compressed_geometries = m_geometry_file.ReadValue<unsigned>();
+        BOOST_ASSERT(m_geometry_indices.empty() ||
+                     m_geometry_indices[number_of_indices - 1] == number_of_compressed_geometries);
+        m_geometry_list =
+            m_geometry_file.ReadBlock<extractor::CompressedEdgeContainer::CompressedEdge>(
+                number_of_compressed_geometries);
     }
 
     void LoadDatasourceInfo(const boost::filesystem::path &datasource_names_file,
                             const boost::filesystem::path &datasource_indexes_file)
     {
-        boost::filesystem::ifstream datasources_stream(datasource_indexes_file, std::ios::binary);
-        if (!datasources_stream)
-        {
-            throw util::exception("Could not open " + datasource_indexes_file.string() +
-                                  " for reading!");
-        }
-        BOOST_ASSERT(datasources_stream);
-
-        std::uint64_t number_of_datasources = 0;
-        datasources_stream.read(reinterpret_cast<char *>(&number_of_datasources),
-                                sizeof(number_of_datasources));
-        if (number_of_datasources > 0)
-        {
-            m_datasource_list.resize(number_of_datasources);
-            datasources_stream.read(reinterpret_cast<char *>(&(m_datasource_list[0])),
-                                    number_of_datasources * sizeof(uint8_t));
-        }
+        m_datasource_file = util::MappedFile(datasource_indexes_file, m_map_files);
+        const auto number_of_datasources = m_datasource_file.ReadValue<std::uint64_t>();
+        m_datasource_list = m_datasource_file.ReadBlock<uint8_t>(number_of_datasources);
 
         boost::filesystem::ifstream datasourcenames_stream(datasource_names_file, std::ios::binary);
         if (!datasourcenames_stream)
@@ -390,7 +460,10 @@ class InternalDataFacade final : public BaseDataFacade
         m_geospatial_query.reset();
     }
 
-    explicit InternalDataFacade(const storage::StorageConfig &config)
+    // With map_files set the blocks that are used in place are mapped read-only instead of
+    // read into memory, see util::MappedFile
+    explicit InternalDataFacade(const storage::StorageConfig &config, const bool map_files = false)
+        : m_map_files(map_files)
     {
         ram_index_path = config.ram_index_path;
         file_index_path = config.file_index_path;
@@ -398,12 +471,18 @@ class InternalDataFacade final : public BaseDataFacade
         util::SimpleLogger().Write() << "loading graph data";
         LoadGraph(config.hsgr_data_path);
 
+        util::SimpleLogger().Write() << "loading lengths";
+        LoadLengths(config.lengths_path);
+
         util::SimpleLogger().Write() << "loading edge information";
         LoadNodeAndEdgeInformation(config.nodes_data_path, config.edges_data_path);
 
         util::SimpleLogger().Write() << "loading core information";
         LoadCoreInformation(config.core_data_path);
 
+        util::SimpleLogger().Write() << "loading core landmarks";
+        LoadCoreLandmarks(config.landmarks_path);
+
         util::SimpleLogger().Write() << "loading geometries";
         LoadGeometries(config.geometries_path);
 
@@ -449,6 +528,20 @@ class InternalDataFacade final : public BaseDataFacade
         return m_query_graph->GetEdgeData(e);
     }
 
+    bool HasLengths() const override final { return !m_edge_lengths.empty(); }
+
+    EdgeLength GetNodeLength(const NodeID n) const override final
+    {
+        BOOST_ASSERT(n < m_node_lengths.size());
+        return m_node_lengths[n];
+    }
+
+    EdgeLength GetEdgeLength(const EdgeID e) const override final
+    {
+        BOOST_ASSERT(e < m_edge_lengths.size());
+        return m_edge_lengths[e];
+    }
+
     EdgeID BeginEdges(const NodeID n) const override final { return m_query_graph->BeginEdges(n); }
 
     EdgeID EndEdges(const NodeID n) const override final { return m_query_graph->EndEdges(n); }
@@ -458,6 +551,26 @@ class InternalDataFacade final : public BaseDataFacade
         return m_query_graph->GetAdjacentEdgeRange(node);
     }
 
+    util::DirectedEdgeRanges GetDirectedEdgeRanges(const NodeID node) const override final
+    {
+        BOOST_ASSERT(node < m_edge_direction_splits.size());
+        const auto &split = m_edge_direction_splits[node];
+        return {m_query_graph->BeginEdges(node),
+                split.first_bidirectional,
+                split.first_backward_only,
+                m_query_graph->EndEdges(node)};
+    }
+
+    util::ShortcutChildren GetShortcutChildren(const EdgeID shortcut,
+                                               const bool forward) const override final
+    {
+        BOOST_ASSERT(shortcut + 1 < m_shortcut_children_offsets.size());
+        const auto index = forward ? m_shortcut_children_offsets[shortcut]
+                                   : m_shortcut_children_offsets[shortcut + 1] - 1;
+        BOOST_ASSERT(index < m_shortcut_children.size());
+        return m_shortcut_children[index];
+    }
+
     // searches for a specific edge
     EdgeID FindEdge(const NodeID from, const NodeID to) const override final
     {
@@ -674,6 +787,18 @@ class InternalDataFacade final : public BaseDataFacade
 
     virtual std::size_t GetCoreSize() const override final { return m_is_core_node.size(); }
 
+    unsigned GetNumberOfLandmarks() const override final { return m_number_of_landmarks; }
+
+    const util::LandmarkDistance *GetLandmarkDistances(const NodeID id) const override final
+    {
+        if (id >= m_landmark_core_index.size() || m_landmark_core_index[id] == SPECIAL_NODEID)
+        {
+            return nullptr;
+        }
+        return &m_landmark_distances[static_cast<std::size_t>(m_landmark_core_index[id]) *
+                                     m_number_of_landmarks];
+    }
+
     virtual bool IsCoreNode(const NodeID id) const override final
     {
         if (m_is_core_node.size() > 0)
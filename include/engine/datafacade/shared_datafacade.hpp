@@ -3,10 +3,12 @@
 
 // implements all data storage when shared memory _IS_ used
 
+#include "storage/dataset_file.hpp"
 #include "storage/shared_datatype.hpp"
 #include "storage/shared_memory.hpp"
 #include "engine/datafacade/datafacade_base.hpp"
 
+#include "contractor/core_landmarks.hpp"
 #include "extractor/compressed_edge_container.hpp"
 #include "extractor/guidance/turn_instruction.hpp"
 #include "extractor/guidance/turn_lane_types.hpp"
@@ -35,8 +37,6 @@
 #include <vector>
 
 #include <boost/assert.hpp>
-#include <boost/thread/lock_guard.hpp>
-#include <boost/thread/shared_mutex.hpp>
 #include <boost/thread/tss.hpp>
 
 namespace osrm
@@ -64,16 +64,17 @@ class SharedDataFacade final : public BaseDataFacade
 
     storage::SharedDataLayout *data_layout;
     char *shared_memory;
-    storage::SharedDataTimestamp *data_timestamp_ptr;
-
-    storage::SharedDataType CURRENT_LAYOUT;
-    storage::SharedDataType CURRENT_DATA;
-    unsigned CURRENT_TIMESTAMP;
 
     unsigned m_check_sum;
     std::unique_ptr<QueryGraph> m_query_graph;
+    util::ShM<util::EdgeDirectionSplit, true>::vector m_edge_direction_splits;
+    util::ShM<EdgeID, true>::vector m_shortcut_children_offsets;
+    util::ShM<util::ShortcutChildren, true>::vector m_shortcut_children;
+    util::ShM<EdgeLength, true>::vector m_node_lengths;
+    util::ShM<EdgeLength, true>::vector m_edge_lengths;
     std::unique_ptr<storage::SharedMemory> m_layout_memory;
     std::unique_ptr<storage::SharedMemory> m_large_memory;
+    std::unique_ptr<storage::DatasetFile> m_dataset;
     std::string m_timestamp;
     extractor::ProfileProperties *m_profile_properties;
 
@@ -89,6 +90,9 @@ class SharedDataFacade final : public BaseDataFacade
     util::ShM<unsigned, true>::vector m_geometry_indices;
     util::ShM<extractor::CompressedEdgeContainer::CompressedEdge, true>::vector m_geometry_list;
     util::ShM<bool, true>::vector m_is_core_node;
+    unsigned m_number_of_landmarks = 0;
+    util::ShM<NodeID, true>::vector m_landmark_core_index;
+    util::ShM<util::LandmarkDistance, true>::vector m_landmark_distances;
     util::ShM<uint8_t, true>::vector m_datasource_list;
     util::ShM<std::uint32_t, true>::vector m_lane_description_offsets;
     util::ShM<extractor::guidance::TurnLaneType::Mask, true>::vector m_lane_description_masks;
@@ -167,6 +171,38 @@ class SharedDataFacade final : public BaseDataFacade
         util::ShM<GraphEdge, true>::vector edge_list(
             graph_edges_ptr, data_layout->num_entries[storage::SharedDataLayout::GRAPH_EDGE_LIST]);
         m_query_graph.reset(new QueryGraph(node_list, edge_list));
+
+        auto edge_direction_splits_ptr = data_layout->GetBlockPtr<util::EdgeDirectionSplit>(
+            shared_memory, storage::SharedDataLayout::GRAPH_EDGE_DIRECTION_SPLITS);
+        m_edge_direction_splits.reset(
+            edge_direction_splits_ptr,
+            data_layout->num_entries[storage::SharedDataLayout::GRAPH_EDGE_DIRECTION_SPLITS]);
+
+        auto shortcut_children_offsets_ptr = data_layout->GetBlockPtr<EdgeID>(
+            shared_memory, storage::SharedDataLayout::SHORTCUT_CHILDREN_OFFSETS);
+        m_shortcut_children_offsets.reset(
+            shortcut_children_offsets_ptr,
+            data_layout->num_entries[storage::SharedDataLayout::SHORTCUT_CHILDREN_OFFSETS]);
+
+        auto shortcut_children_ptr = data_layout->GetBlockPtr<util::ShortcutChildren>(
+            shared_memory, storage::SharedDataLayout::SHORTCUT_CHILDREN);
+        m_shortcut_children.reset(
+            shortcut_children_ptr,
+            data_layout->num_entries[storage::SharedDataLayout::SHORTCUT_CHILDREN]);
+
+        auto graph_node_lengths_ptr = data_layout->GetBlockPtr<EdgeLength>(
+            shared_memory, storage::SharedDataLayout::GRAPH_NODE_LENGTHS);
+        util::ShM<EdgeLength, true>::vector node_lengths(
+            graph_node_lengths_ptr,
+            data_layout->num_entries[storage::SharedDataLayout::GRAPH_NODE_LENGTHS]);
+        m_node_lengths = std::move(node_lengths);
+
+        auto graph_edge_lengths_ptr = data_layout->GetBlockPtr<EdgeLength>(
+            shared_memory, storage::SharedDataLayout::GRAPH_EDGE_LENGTHS);
+        util::ShM<EdgeLength, true>::vector edge_lengths(
+            graph_edge_lengths_ptr,
+            data_layout->num_entries[storage::SharedDataLayout::GRAPH_EDGE_LENGTHS]);
+        m_edge_lengths = std::move(edge_lengths);
     }
 
     void LoadNodeAndEdgeInformation()
@@ -281,6 +317,19 @@ class SharedDataFacade final : public BaseDataFacade
         util::ShM<bool, true>::vector is_core_node(
             core_marker_ptr, data_layout->num_entries[storage::SharedDataLayout::CORE_MARKER]);
         m_is_core_node = std::move(is_core_node);
+
+        m_number_of_landmarks =
+            data_layout->num_entries[storage::SharedDataLayout::CORE_LANDMARKS];
+        auto landmark_core_index_ptr = data_layout->GetBlockPtr<NodeID>(
+            shared_memory, storage::SharedDataLayout::CORE_LANDMARK_INDEX);
+        m_landmark_core_index.reset(
+            landmark_core_index_ptr,
+            data_layout->num_entries[storage::SharedDataLayout::CORE_LANDMARK_INDEX]);
+        auto landmark_distances_ptr = data_layout->GetBlockPtr<util::LandmarkDistance>(
+            shared_memory, storage::SharedDataLayout::CORE_LANDMARK_DISTANCES);
+        m_landmark_distances.reset(
+            landmark_distances_ptr,
+            data_layout->num_entries[storage::SharedDataLayout::CORE_LANDMARK_DISTANCES]);
     }
 
     void LoadGeometries()
@@ -363,105 +412,68 @@ class SharedDataFacade final : public BaseDataFacade
         m_entry_class_table = std::move(entry_class_table);
     }
 
-  public:
-    virtual ~SharedDataFacade() {}
-
-    boost::shared_mutex data_mutex;
-
-    SharedDataFacade()
+    // Loads all blocks of the current layout and data
+    void LoadData()
     {
-        if (!storage::SharedMemory::RegionExists(storage::CURRENT_REGIONS))
+        const auto file_index_ptr = data_layout->GetBlockPtr<char>(
+            shared_memory, storage::SharedDataLayout::FILE_INDEX_PATH);
+        file_index_path = boost::filesystem::path(file_index_ptr);
+        if (!boost::filesystem::exists(file_index_path))
         {
-            throw util::exception(
-                "No shared memory blocks found, have you forgotten to run osrm-datastore?");
+            util::SimpleLogger().Write(logDEBUG) << "Leaf file name " << file_index_path.string();
+            throw util::exception("Could not load leaf index file. "
+                                  "Is any data loaded into shared memory?");
         }
-        data_timestamp_ptr = static_cast<storage::SharedDataTimestamp *>(
-            storage::makeSharedMemory(
-                storage::CURRENT_REGIONS, sizeof(storage::SharedDataTimestamp), false, false)
-                ->Ptr());
-        CURRENT_LAYOUT = storage::LAYOUT_NONE;
-        CURRENT_DATA = storage::DATA_NONE;
-        CURRENT_TIMESTAMP = 0;
 
-        // load data
-        CheckAndReloadFacade();
+        LoadGraph();
+        LoadChecksum();
+        LoadNodeAndEdgeInformation();
+        LoadGeometries();
+        LoadTimestamp();
+        LoadViaNodeList();
+        LoadNames();
+        LoadTurnLaneDescriptions();
+        LoadCoreInformation();
+        LoadProfileProperties();
+        LoadRTree();
+        LoadIntersectionClasses();
+
+        util::SimpleLogger().Write() << "number of geometries: " << m_coordinate_list.size();
+        for (unsigned i = 0; i < m_coordinate_list.size(); ++i)
+        {
+            BOOST_ASSERT(GetCoordinateOfNode(i).IsValid());
+        }
     }
 
-    void CheckAndReloadFacade()
+  public:
+    virtual ~SharedDataFacade() {}
+
+    // Uses the regions of a dataset osrm-datastore loaded into shared memory. A facade stays
+    // with its dataset, a new dataset needs a new facade.
+    explicit SharedDataFacade(const storage::SharedDataTimestamp &regions)
     {
-        if (CURRENT_LAYOUT != data_timestamp_ptr->layout ||
-            CURRENT_DATA != data_timestamp_ptr->data ||
-            CURRENT_TIMESTAMP != data_timestamp_ptr->timestamp)
-        {
-            // Get exclusive lock
-            util::SimpleLogger().Write(logDEBUG) << "Updates available, getting exclusive lock";
-            const boost::lock_guard<boost::shared_mutex> lock(data_mutex);
+        m_layout_memory.reset(storage::makeSharedMemory(regions.layout));
+        data_layout = static_cast<storage::SharedDataLayout *>(m_layout_memory->Ptr());
 
-            if (CURRENT_LAYOUT != data_timestamp_ptr->layout ||
-                CURRENT_DATA != data_timestamp_ptr->data)
-            {
-                // release the previous shared memory segments
-                storage::SharedMemory::Remove(CURRENT_LAYOUT);
-                storage::SharedMemory::Remove(CURRENT_DATA);
+        m_large_memory.reset(storage::makeSharedMemory(regions.data));
+        shared_memory = (char *)(m_large_memory->Ptr());
+#ifdef __linux__
+        // transparent huge pages only show up once the queries touched them
+        m_large_memory->LogPageSizes();
+#endif
 
-                CURRENT_LAYOUT = data_timestamp_ptr->layout;
-                CURRENT_DATA = data_timestamp_ptr->data;
-                CURRENT_TIMESTAMP = 0; // Force trigger a reload
+        LoadData();
+    }
 
-                util::SimpleLogger().Write(logDEBUG)
-                    << "Current layout was different to new layout, swapping";
-            }
-            else
-            {
-                util::SimpleLogger().Write(logDEBUG)
-                    << "Current layout was same to new layout, not swapping";
-            }
+    // Uses the blocks of a dataset file in place instead of shared memory
+    explicit SharedDataFacade(std::unique_ptr<storage::DatasetFile> dataset_)
+        : m_dataset(std::move(dataset_))
+    {
+        // the blocks are only read, GetBlockPtr checks the canaries
+        data_layout = const_cast<storage::SharedDataLayout *>(&m_dataset->GetLayout());
+        shared_memory = const_cast<char *>(m_dataset->GetData());
 
-            if (CURRENT_TIMESTAMP != data_timestamp_ptr->timestamp)
-            {
-                CURRENT_TIMESTAMP = data_timestamp_ptr->timestamp;
-
-                util::SimpleLogger().Write(logDEBUG) << "Performing data reload";
-                m_layout_memory.reset(storage::makeSharedMemory(CURRENT_LAYOUT));
-
-                data_layout = static_cast<storage::SharedDataLayout *>(m_layout_memory->Ptr());
-
-                m_large_memory.reset(storage::makeSharedMemory(CURRENT_DATA));
-                shared_memory = (char *)(m_large_memory->Ptr());
-
-                const auto file_index_ptr = data_layout->GetBlockPtr<char>(
-                    shared_memory, storage::SharedDataLayout::FILE_INDEX_PATH);
-                file_index_path = boost::filesystem::path(file_index_ptr);
-                if (!boost::filesystem::exists(file_index_path))
-                {
-                    util::SimpleLogger().Write(logDEBUG) << "Leaf file name "
-                                                         << file_index_path.string();
-                    throw util::exception("Could not load leaf index file. "
-                                          "Is any data loaded into shared memory?");
-                }
-
-                LoadGraph();
-                LoadChecksum();
-                LoadNodeAndEdgeInformation();
-                LoadGeometries();
-                LoadTimestamp();
-                LoadViaNodeList();
-                LoadNames();
-                LoadTurnLaneDescriptions();
-                LoadCoreInformation();
-                LoadProfileProperties();
-                LoadRTree();
-                LoadIntersectionClasses();
-
-                util::SimpleLogger().Write() << "number of geometries: "
-                                             << m_coordinate_list.size();
-                for (unsigned i = 0; i < m_coordinate_list.size(); ++i)
-                {
-                    BOOST_ASSERT(GetCoordinateOfNode(i).IsValid());
-                }
-            }
-            util::SimpleLogger().Write(logDEBUG) << "Releasing exclusive lock";
-        }
+        LoadData();
     }
 
     // search graph access
@@ -481,6 +493,20 @@ class SharedDataFacade final : public BaseDataFacade
         return m_query_graph->GetEdgeData(e);
     }
 
+    bool HasLengths() const override final { return !m_edge_lengths.empty(); }
+
+    EdgeLength GetNodeLength(const NodeID n) const override final
+    {
+        BOOST_ASSERT(n < m_node_lengths.size());
+        return m_node_lengths[n];
+    }
+
+    EdgeLength GetEdgeLength(const EdgeID e) const override final
+    {
+        BOOST_ASSERT(e < m_edge_lengths.size());
+        return m_edge_lengths[e];
+    }
+
     EdgeID BeginEdges(const NodeID n) const override final { return m_query_graph->BeginEdges(n); }
 
     EdgeID EndEdges(const NodeID n) const override final { return m_query_graph->EndEdges(n); }
@@ -490,6 +516,26 @@ class SharedDataFacade final : public BaseDataFacade
         return m_query_graph->GetAdjacentEdgeRange(node);
     }
 
+    util::DirectedEdgeRanges GetDirectedEdgeRanges(const NodeID node) const override final
+    {
+        BOOST_ASSERT(node < m_edge_direction_splits.size());
+        const auto &split = m_edge_direction_splits[node];
+        return {m_query_graph->BeginEdges(node),
+                split.first_bidirectional,
+                split.first_backward_only,
+                m_query_graph->EndEdges(node)};
+    }
+
+    util::ShortcutChildren GetShortcutChildren(const EdgeID shortcut,
+                                               const bool forward) const override final
+    {
+        BOOST_ASSERT(shortcut + 1 < m_shortcut_children_offsets.size());
+        const auto index = forward ? m_shortcut_children_offsets[shortcut]
+                                   : m_shortcut_children_offsets[shortcut + 1] - 1;
+        BOOST_ASSERT(index < m_shortcut_children.size());
+        return m_shortcut_children[index];
+    }
+
     // searches for a specific edge
     EdgeID FindEdge(const NodeID from, const NodeID to) const override final
     {
@@ -737,6 +783,18 @@ class SharedDataFacade final : public BaseDataFacade
 
     virtual std::size_t GetCoreSize() const override final { return m_is_core_node.size(); }
 
+    unsigned GetNumberOfLandmarks() const override final { return m_number_of_landmarks; }
+
+    const util::LandmarkDistance *GetLandmarkDistances(const NodeID id) const override final
+    {
+        if (id >= m_landmark_core_index.size() || m_landmark_core_index[id] == SPECIAL_NODEID)
+        {
+            return nullptr;
+        }
+        return &m_landmark_distances[static_cast<std::size_t>(m_landmark_core_index[id]) *
+                                     m_number_of_landmarks];
+    }
+
     // Returns the data source ids that were used to supply the edge
     // weights.
     virtual void
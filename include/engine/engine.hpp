@@ -1,13 +1,14 @@
 #ifndef ENGINE_HPP
 #define ENGINE_HPP
 
-#include "storage/shared_barriers.hpp"
+#include "engine/api/multi_target_parameters.hpp"
 #include "engine/status.hpp"
 #include "util/json_container.hpp"
 
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace osrm
 {
@@ -35,16 +36,10 @@ struct TileParameters;
 struct MultiTargetParameters;
 struct SmoothViaParameters;
 }
+class PhantomNodeCache;
 namespace plugins
 {
-class ViaRoutePlugin;
-class TablePlugin;
-class NearestPlugin;
-class TripPlugin;
-class MatchPlugin;
-class TilePlugin;
-class MultiTargetPlugin;
-class SmoothViaPlugin;
+struct SmoothViaCounters;
 }
 // End fwd decls
 
@@ -57,7 +52,8 @@ class Engine final
 {
   public:
     // Needs to be public
-    struct EngineLock;
+    struct SharedDataset;
+    struct PluginSet;
 
     explicit Engine(EngineConfig &config);
 
@@ -74,21 +70,24 @@ class Engine final
     Status Match(const api::MatchParameters &parameters, util::json::Object &result);
     Status Tile(const api::TileParameters &parameters, std::string &result);
     Status MultiTarget(const api::MultiTargetParameters &parameters, util::json::Object &result);
+    Status MultiTargetBatch(const std::vector<api::MultiTargetParameters> &queries,
+                            const api::MultiTargetBatchHandler &handler);
     Status SmoothVia(const api::SmoothViaParameters &parameters, util::json::Object &result);
+    void SmoothViaCounters(util::json::Object &result) const;
+    void PhantomNodeCacheCounters(util::json::Object &result) const;
+    void HeapPoolCounters(util::json::Object &result) const;
 
   private:
-    std::unique_ptr<EngineLock> lock;
-
-    std::unique_ptr<plugins::ViaRoutePlugin> route_plugin;
-    std::unique_ptr<plugins::TablePlugin> table_plugin;
-    std::unique_ptr<plugins::NearestPlugin> nearest_plugin;
-    std::unique_ptr<plugins::TripPlugin> trip_plugin;
-    std::unique_ptr<plugins::MatchPlugin> match_plugin;
-    std::unique_ptr<plugins::TilePlugin> tile_plugin;
-    std::unique_ptr<plugins::MultiTargetPlugin> multi_target_plugin;
-    std::unique_ptr<plugins::SmoothViaPlugin> smooth_via_plugin;
+    // Totals over all datasets, the plugins of every dataset add to them
+    std::unique_ptr<plugins::SmoothViaCounters> smooth_via_counters;
+    // Only used without shared memory, with it every dataset has a cache of its own
+    std::unique_ptr<PhantomNodeCache> phantom_node_cache;
+    // Only used with shared memory, its plugins change with the dataset
+    std::unique_ptr<SharedDataset> shared_dataset;
 
     std::unique_ptr<datafacade::BaseDataFacade> query_data_facade;
+    // Declared after the facade, the plugins refer to it
+    std::unique_ptr<PluginSet> plugin_set;
 };
 }
 }
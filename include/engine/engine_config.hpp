@@ -52,7 +52,23 @@ namespace engine
  *  - Table
  *  - Match
  *
- * In addition, shared memory can be used for datasets loaded with osrm-datastore.
+ * Multi target requests with at least multi_target_parallel_threshold targets (-1 to disable)
+ * are split across up to max_multi_target_threads threads. Likewise table requests with at
+ * least table_parallel_threshold entries (sources times destinations, -1 to disable) run their
+ * searches on up to max_table_threads threads.
+ *
+ * MultiTarget and SmoothVia remember up to phantom_node_cache_size snapped coordinates
+ * (-1 to disable).
+ *
+ * Search heaps are checked out of a process-wide pool per request. At most
+ * max_full_size_heaps heaps that grew to full size are kept, counting the ones in use (-1 for
+ * unlimited), the pool frees the least recently used idle ones.
+ *
+ * In addition, shared memory can be used for datasets loaded with osrm-datastore. Otherwise
+ * the dataset is read from its files, with use_mmap the files are mapped read-only instead.
+ * A dataset file written by osrm-contract is used in place of the other files if it exists.
+ * Its block checksums are verified on startup when it is read, and with use_mmap only if
+ * verify_dataset is set since verifying reads the whole file.
  *
  * \see OSRM, StorageConfig
  */
@@ -65,7 +81,15 @@ struct EngineConfig final
     int max_locations_viaroute = -1;
     int max_locations_distance_table = -1;
     int max_locations_map_matching = -1;
+    int multi_target_parallel_threshold = -1;
+    int max_multi_target_threads = 4;
+    int table_parallel_threshold = -1;
+    int max_table_threads = 4;
+    int phantom_node_cache_size = -1;
+    int max_full_size_heaps = -1;
     bool use_shared_memory = true;
+    bool use_mmap = false;
+    bool verify_dataset = false;
 };
 }
 }
@@ -12,6 +12,7 @@
 #include "util/coordinate.hpp"
 #include "util/coordinate_calculation.hpp"
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -33,12 +34,23 @@ namespace guidance
 //                 |---| segment 2
 //                     |---| segment 3
 inline LegGeometry assembleGeometry(const datafacade::BaseDataFacade &facade,
-                                    const std::vector<PathData> &leg_data,
+                                    const PathDataList &leg_data,
                                     const PhantomNode &source_node,
                                     const PhantomNode &target_node)
 {
     LegGeometry geometry;
 
+    // every path point adds a location, the phantom nodes one each
+    const auto number_of_turns = std::count_if(
+        leg_data.begin(), leg_data.end(), [](const PathData &path_point) {
+            return path_point.turn_instruction.type != extractor::guidance::TurnType::NoTurn;
+        });
+    geometry.locations.reserve(leg_data.size() + 2);
+    geometry.osm_node_ids.reserve(leg_data.size() + 2);
+    geometry.annotations.reserve(leg_data.size() + 1);
+    geometry.segment_offsets.reserve(number_of_turns + 2);
+    geometry.segment_distances.reserve(number_of_turns + 1);
+
     // segment 0 first and last
     geometry.segment_offsets.push_back(0);
     geometry.locations.push_back(source_node.location);
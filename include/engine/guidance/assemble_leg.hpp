@@ -35,7 +35,7 @@ struct NamedSegment
 
 template <std::size_t SegmentNumber>
 
-std::array<std::uint32_t, SegmentNumber> summarizeRoute(const std::vector<PathData> &route_data,
+std::array<std::uint32_t, SegmentNumber> summarizeRoute(const PathDataList &route_data,
                                                         const PhantomNode &target_node,
                                                         const bool target_traversed_in_reverse)
 {
@@ -117,7 +117,7 @@ std::array<std::uint32_t, SegmentNumber> summarizeRoute(const std::vector<PathDa
 }
 
 inline RouteLeg assembleLeg(const datafacade::BaseDataFacade &facade,
-                            const std::vector<PathData> &route_data,
+                            const PathDataList &route_data,
                             const LegGeometry &leg_geometry,
                             const PhantomNode &source_node,
                             const PhantomNode &target_node,
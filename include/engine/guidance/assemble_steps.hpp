@@ -37,13 +37,13 @@ std::pair<short, short> getIntermediateBearings(const LegGeometry &leg_geometry,
                                                 const std::size_t segment_index);
 } // ns detail
 
-inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &facade,
-                                            const std::vector<PathData> &leg_data,
-                                            const LegGeometry &leg_geometry,
-                                            const PhantomNode &source_node,
-                                            const PhantomNode &target_node,
-                                            const bool source_traversed_in_reverse,
-                                            const bool target_traversed_in_reverse)
+inline RouteStepList assembleSteps(const datafacade::BaseDataFacade &facade,
+                                   const PathDataList &leg_data,
+                                   const LegGeometry &leg_geometry,
+                                   const PhantomNode &source_node,
+                                   const PhantomNode &target_node,
+                                   const bool source_traversed_in_reverse,
+                                   const bool target_traversed_in_reverse)
 {
     const double constexpr ZERO_DURATION = 0., ZERO_DISTANCE = 0.;
     const constexpr char *NO_ROTARY_NAME = "";
@@ -59,7 +59,13 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
 
     const auto number_of_segments = leg_geometry.GetNumberOfSegments();
 
-    std::vector<RouteStep> steps;
+    // the steps live in the arena of the path they describe
+    const util::ArenaAllocator<RouteStep> allocator(leg_data.get_allocator());
+    const auto make_intersections = [&allocator](const Intersection &intersection) {
+        return util::ArenaVector<Intersection>({intersection}, allocator);
+    };
+
+    RouteStepList steps(allocator);
     steps.reserve(number_of_segments);
 
     std::size_t segment_index = 0;
@@ -75,8 +81,8 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                           0};
 
     Intersection intersection{source_node.location,
-                              std::vector<short>({bearings.second}),
-                              std::vector<bool>({true}),
+                              util::ArenaVector<short>({bearings.second}, allocator),
+                              util::ArenaVector<bool>({true}, allocator),
                               Intersection::NO_INDEX,
                               0,
                               util::guidance::LaneTupel(),
@@ -118,7 +124,7 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                                           maneuver,
                                           leg_geometry.FrontIndex(segment_index),
                                           leg_geometry.BackIndex(segment_index) + 1,
-                                          {intersection}});
+                                          make_intersections(intersection)});
 
                 if (leg_data_index + 1 < leg_data.size())
                 {
@@ -176,7 +182,7 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                                   maneuver,
                                   leg_geometry.FrontIndex(segment_index),
                                   leg_geometry.BackIndex(segment_index) + 1,
-                                  {intersection}});
+                                  make_intersections(intersection)});
     }
     // In this case the source + target are on the same edge segment
     else
@@ -201,7 +207,7 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                                   std::move(maneuver),
                                   leg_geometry.FrontIndex(segment_index),
                                   leg_geometry.BackIndex(segment_index) + 1,
-                                  {intersection}});
+                                  make_intersections(intersection)});
     }
 
     BOOST_ASSERT(segment_index == number_of_segments - 1);
@@ -214,14 +220,15 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                 WaypointType::Arrive,
                 0};
 
-    intersection = {
-        target_node.location,
-        std::vector<short>({static_cast<short>(util::bearing::reverseBearing(bearings.first))}),
-        std::vector<bool>({true}),
-        0,
-        Intersection::NO_INDEX,
-        util::guidance::LaneTupel(),
-        {}};
+    intersection = {target_node.location,
+                    util::ArenaVector<short>(
+                        {static_cast<short>(util::bearing::reverseBearing(bearings.first))},
+                        allocator),
+                    util::ArenaVector<bool>({true}, allocator),
+                    0,
+                    Intersection::NO_INDEX,
+                    util::guidance::LaneTupel(),
+                    {}};
 
     BOOST_ASSERT(!leg_geometry.locations.empty());
     steps.push_back(RouteStep{target_node.name_id,
@@ -235,7 +242,7 @@ inline std::vector<RouteStep> assembleSteps(const datafacade::BaseDataFacade &fa
                               std::move(maneuver),
                               leg_geometry.locations.size() - 1,
                               leg_geometry.locations.size(),
-                              {intersection}});
+                              make_intersections(intersection)});
 
     BOOST_ASSERT(steps.front().intersections.size() == 1);
     BOOST_ASSERT(steps.front().intersections.front().bearings.size() == 1);
@@ -17,8 +17,8 @@ namespace guidance
 // we anticipate lane changes emitting only matching lanes early on.
 // the second parameter describes the duration that we feel two segments need to be apart to count
 // as separate maneuvers.
-std::vector<RouteStep> anticipateLaneChange(std::vector<RouteStep> steps,
-                                            const double min_duration_needed_for_lane_change = 15);
+RouteStepList anticipateLaneChange(RouteStepList steps,
+                                   const double min_duration_needed_for_lane_change = 15);
 
 } // namespace guidance
 } // namespace engine
@@ -20,7 +20,7 @@ struct RouteLeg
     double duration;
     double distance;
     std::string summary;
-    std::vector<RouteStep> steps;
+    RouteStepList steps;
 };
 }
 }
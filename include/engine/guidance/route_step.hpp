@@ -8,6 +8,7 @@
 #include "util/guidance/entry_class.hpp"
 
 #include "extractor/guidance/turn_lane_types.hpp"
+#include "util/arena.hpp"
 #include "util/guidance/turn_lanes.hpp"
 
 #include <cstddef>
@@ -29,12 +30,16 @@ namespace guidance
 // Arrive: a --> b --> t. The segment (b,t) is already covered by the previous segment.
 
 // A represenetation of intermediate intersections
+//
+// The steps of a route and their intersections are built per request, they allocate from the
+// arena of the route result they are assembled from (see assembleSteps). Copies keep the arena
+// of their source. Names and lane descriptions stay on the heap.
 struct Intersection
 {
     static const constexpr std::size_t NO_INDEX = std::numeric_limits<std::size_t>::max();
     util::Coordinate location;
-    std::vector<short> bearings;
-    std::vector<bool> entry;
+    util::ArenaVector<short> bearings;
+    util::ArenaVector<bool> entry;
     std::size_t in;
     std::size_t out;
 
@@ -68,9 +73,11 @@ struct RouteStep
     // indices into the locations array stored the LegGeometry
     std::size_t geometry_begin;
     std::size_t geometry_end;
-    std::vector<Intersection> intersections;
+    util::ArenaVector<Intersection> intersections;
 };
 
+using RouteStepList = util::ArenaVector<RouteStep>;
+
 inline RouteStep getInvalidRouteStep()
 {
     return {0,
@@ -0,0 +1,479 @@
+#ifndef HEAP_POOL_HPP
+#define HEAP_POOL_HPP
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Size a caller expects a heap to grow to, searches that settle large parts of the graph ask
+// for full-size heaps
+enum class HeapSize
+{
+    Sparse,
+    FullSize
+};
+
+// Process-wide pool of search heaps that threads check out for a request and return afterwards.
+//
+// Heaps start out sparse: with a paged index storage their footprint follows the part of the
+// graph they searched, so the heaps of short queries stay small. A heap that grew beyond
+// full_size_bytes counts as full-size. A full-size heap is shrunk when it is returned, so one
+// that served a short search after a long one becomes sparse again. Acquire prefers idle heaps
+// of the expected size, the most recently returned first.
+//
+// At most max_full_size_heaps full-size heaps are retained, counting the ones checked out.
+// Whenever a returned heap exceeds the cap the least recently used idle full-size heaps are
+// freed. The memory kept between requests is therefore bounded by the cap and not by the number
+// of threads that ever served a request.
+//
+// The idle heaps are split into shards with a lock each. A thread returns heaps to its own
+// shard and checks them out from there, so it usually takes a lock that no other thread holds.
+// It only looks into the other shards if its own has no idle heap.
+//
+// Heaps are only reused for the node count they were built for. The newest node count is the
+// one of the last heap acquired while no heap of that count was checked out, e.g. the one of a
+// dataset that was just loaded. Idle heaps of older node counts are kept while heaps of them are
+// still checked out, so queries on the old and on the new dataset can overlap during a swap,
+// and are freed with the last one that is returned.
+template <typename Heap> class HeapPool
+{
+  public:
+    static constexpr std::size_t UNLIMITED = std::numeric_limits<std::size_t>::max();
+    static constexpr std::size_t DEFAULT_FULL_SIZE_BYTES = std::size_t{4} << 20;
+    static constexpr std::size_t NUMBER_OF_SHARDS = 16;
+
+    struct Counters
+    {
+        // heaps constructed and idle heaps handed out again
+        std::size_t created = 0;
+        std::size_t reused = 0;
+        // idle heaps freed because of the cap or a changed node count
+        std::size_t evicted = 0;
+        // full-size heaps that were sparse again after shrinking
+        std::size_t shrunk = 0;
+        std::size_t checked_out = 0;
+        // most heaps that were checked out at the same time
+        std::size_t high_water_mark = 0;
+        // idle full-size heaps and the ones that were full-size when they were checked out
+        std::size_t full_size = 0;
+        std::size_t idle = 0;
+        std::size_t idle_full_size = 0;
+        std::size_t idle_bytes = 0;
+    };
+
+    explicit HeapPool(const std::size_t max_full_size_heaps_ = UNLIMITED,
+                      const std::size_t full_size_bytes_ = DEFAULT_FULL_SIZE_BYTES)
+        : max_full_size_heaps(max_full_size_heaps_), full_size_bytes(full_size_bytes_)
+    {
+    }
+
+    HeapPool(const HeapPool &) = delete;
+    HeapPool &operator=(const HeapPool &) = delete;
+
+    // Checks out an idle heap for number_of_nodes or builds a new one. The heap is cleared.
+    std::unique_ptr<Heap> Acquire(const std::size_t number_of_nodes,
+                                  const HeapSize expected_size = HeapSize::Sparse)
+    {
+        BeginUse(number_of_nodes);
+
+        Shard &shard = GetShard();
+        std::unique_ptr<Heap> heap;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            heap = TakeIdle(shard, number_of_nodes, expected_size);
+        }
+        if (!heap)
+        {
+            heap = StealIdle(shard, number_of_nodes, expected_size);
+        }
+        if (heap)
+        {
+            heap->Clear();
+        }
+        else
+        {
+            heap.reset(new Heap(number_of_nodes));
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            ++shard.created;
+            shard.checked_out[heap.get()] = Checkout{number_of_nodes, false};
+        }
+
+        const auto checked_out = ++number_of_checked_out;
+        auto high_water_mark = number_of_high_water_mark.load();
+        while (checked_out > high_water_mark &&
+               !number_of_high_water_mark.compare_exchange_weak(high_water_mark, checked_out))
+        {
+        }
+        return heap;
+    }
+
+    // Takes back a heap returned by Acquire
+    void Release(std::unique_ptr<Heap> heap)
+    {
+        BOOST_ASSERT(heap);
+        // measured outside of the lock, may walk the page table of the heap
+        std::size_t bytes = heap->MemoryUsage();
+        bool shrunk = false;
+        if (IsFullSize(bytes))
+        {
+            heap->ShrinkToFit();
+            bytes = heap->MemoryUsage();
+            shrunk = !IsFullSize(bytes);
+        }
+
+        // declared before the locks, so evicted heaps are freed after they were released
+        std::vector<std::unique_ptr<Heap>> evicted_heaps;
+        Shard &shard = GetShard();
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        Checkout checkout{0, false};
+        if (!TakeCheckout(shard, heap.get(), checkout))
+        {
+            // checked out by another thread
+            lock.unlock();
+            bool found = false;
+            for (auto &other_shard : shards)
+            {
+                if (&other_shard != &shard)
+                {
+                    std::lock_guard<std::mutex> other_lock(other_shard.mutex);
+                    found = TakeCheckout(other_shard, heap.get(), checkout);
+                    if (found)
+                    {
+                        break;
+                    }
+                }
+            }
+            BOOST_ASSERT(found);
+            (void)found;
+            lock.lock();
+        }
+        --number_of_checked_out;
+        shard.shrunk += shrunk;
+        if (checkout.full_size)
+        {
+            --number_of_full_size;
+        }
+
+        // decided under the lock of the shard, so a concurrent EvictStale sees the heap
+        if (EndUse(checkout.number_of_nodes))
+        {
+            ++shard.evicted;
+            evicted_heaps.push_back(std::move(heap));
+            lock.unlock();
+            EvictStale(evicted_heaps);
+            return;
+        }
+
+        shard.idle.push_front(Entry{std::move(heap), checkout.number_of_nodes, bytes});
+        shard.idle_bytes += bytes;
+        if (IsFullSize(bytes))
+        {
+            ++shard.idle_full_size;
+            ++number_of_full_size;
+            EvictFullSize(shard, evicted_heaps);
+        }
+        lock.unlock();
+
+        for (auto &other_shard : shards)
+        {
+            if (number_of_full_size.load() <= max_full_size_heaps.load())
+            {
+                break;
+            }
+            std::lock_guard<std::mutex> other_lock(other_shard.mutex);
+            EvictFullSize(other_shard, evicted_heaps);
+        }
+    }
+
+    // Changes the cap, idle full-size heaps above it are freed right away
+    void SetMaxFullSizeHeaps(const std::size_t max_full_size_heaps_)
+    {
+        std::vector<std::unique_ptr<Heap>> evicted_heaps;
+        max_full_size_heaps = max_full_size_heaps_;
+        for (auto &shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            EvictFullSize(shard, evicted_heaps);
+        }
+    }
+
+    Counters GetCounters() const
+    {
+        Counters counters;
+        for (const auto &shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            counters.created += shard.created;
+            counters.reused += shard.reused;
+            counters.evicted += shard.evicted;
+            counters.shrunk += shard.shrunk;
+            counters.idle += shard.idle.size();
+            counters.idle_full_size += shard.idle_full_size;
+            counters.idle_bytes += shard.idle_bytes;
+        }
+        counters.checked_out = number_of_checked_out.load();
+        counters.high_water_mark = number_of_high_water_mark.load();
+        counters.full_size = number_of_full_size.load();
+        return counters;
+    }
+
+  private:
+    struct Entry
+    {
+        std::unique_ptr<Heap> heap;
+        // the heap can only be used for graphs of this size
+        std::size_t number_of_nodes;
+        std::size_t bytes;
+    };
+
+    struct Checkout
+    {
+        std::size_t number_of_nodes;
+        // counted in number_of_full_size
+        bool full_size;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        // most recently returned first
+        std::list<Entry> idle;
+        std::unordered_map<const Heap *, Checkout> checked_out;
+
+        std::size_t created = 0;
+        std::size_t reused = 0;
+        std::size_t evicted = 0;
+        std::size_t shrunk = 0;
+        std::size_t idle_full_size = 0;
+        std::size_t idle_bytes = 0;
+    };
+
+    bool IsFullSize(const std::size_t bytes) const { return bytes > full_size_bytes; }
+
+    // Shard of the calling thread, threads are spread over the shards round robin
+    Shard &GetShard()
+    {
+        static std::atomic<std::size_t> number_of_threads{0};
+        static thread_local const std::size_t shard_index =
+            number_of_threads++ % NUMBER_OF_SHARDS;
+        return shards[shard_index];
+    }
+
+    // Hands out the most recently returned idle heap for number_of_nodes of the expected size,
+    // or any idle heap for number_of_nodes if there is none of that size. The heap is checked
+    // out in shard.
+    std::unique_ptr<Heap> TakeIdle(Shard &shard,
+                                   const std::size_t number_of_nodes,
+                                   const HeapSize expected_size)
+    {
+        const bool full_size = expected_size == HeapSize::FullSize;
+        auto iter = shard.idle.end();
+        for (auto entry = shard.idle.begin(); entry != shard.idle.end(); ++entry)
+        {
+            if (entry->number_of_nodes != number_of_nodes)
+            {
+                continue;
+            }
+            if (IsFullSize(entry->bytes) == full_size)
+            {
+                iter = entry;
+                break;
+            }
+            if (iter == shard.idle.end())
+            {
+                iter = entry;
+            }
+        }
+        if (iter == shard.idle.end())
+        {
+            return nullptr;
+        }
+
+        std::unique_ptr<Heap> heap = std::move(iter->heap);
+        const bool was_full_size = IsFullSize(iter->bytes);
+        // a full-size heap stays in number_of_full_size while it is checked out
+        shard.checked_out[heap.get()] = Checkout{iter->number_of_nodes, was_full_size};
+        shard.idle_bytes -= iter->bytes;
+        shard.idle_full_size -= was_full_size;
+        shard.idle.erase(iter);
+        ++shard.reused;
+        return heap;
+    }
+
+    // Checks out an idle heap of another shard in the shard of the calling thread. Shards that
+    // are locked by other threads are skipped.
+    std::unique_ptr<Heap>
+    StealIdle(Shard &shard, const std::size_t number_of_nodes, const HeapSize expected_size)
+    {
+        for (auto &other_shard : shards)
+        {
+            if (&other_shard == &shard)
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> other_lock(other_shard.mutex, std::try_to_lock);
+            if (!other_lock.owns_lock())
+            {
+                continue;
+            }
+            auto heap = TakeIdle(other_shard, number_of_nodes, expected_size);
+            if (!heap)
+            {
+                continue;
+            }
+            Checkout checkout{0, false};
+            TakeCheckout(other_shard, heap.get(), checkout);
+            other_lock.unlock();
+
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.checked_out[heap.get()] = checkout;
+            return heap;
+        }
+        return nullptr;
+    }
+
+    bool TakeCheckout(Shard &shard, const Heap *heap, Checkout &checkout)
+    {
+        const auto iter = shard.checked_out.find(heap);
+        if (iter == shard.checked_out.end())
+        {
+            return false;
+        }
+        checkout = iter->second;
+        shard.checked_out.erase(iter);
+        return true;
+    }
+
+    // Counts a heap for number_of_nodes as checked out. A node count that was not in use becomes
+    // the newest one, the idle heaps of older node counts that are not in use anymore are freed.
+    void BeginUse(const std::size_t number_of_nodes)
+    {
+        {
+            std::lock_guard<std::mutex> nodes_lock(nodes_mutex);
+            auto &checked_out = checked_out_by_number_of_nodes[number_of_nodes];
+            const bool is_newest = checked_out == 0 && number_of_nodes != newest_number_of_nodes;
+            ++checked_out;
+            if (!is_newest)
+            {
+                return;
+            }
+            newest_number_of_nodes = number_of_nodes;
+        }
+        std::vector<std::unique_ptr<Heap>> evicted_heaps;
+        EvictStale(evicted_heaps);
+    }
+
+    // Counts a heap for number_of_nodes as returned, true if the node count is not in use
+    // anymore and the heap is to be freed
+    bool EndUse(const std::size_t number_of_nodes)
+    {
+        std::lock_guard<std::mutex> nodes_lock(nodes_mutex);
+        const auto iter = checked_out_by_number_of_nodes.find(number_of_nodes);
+        BOOST_ASSERT(iter != checked_out_by_number_of_nodes.end() && iter->second > 0);
+        if (--iter->second > 0)
+        {
+            return false;
+        }
+        checked_out_by_number_of_nodes.erase(iter);
+        return number_of_nodes != newest_number_of_nodes;
+    }
+
+    // Whether idle heaps for number_of_nodes are kept, call with nodes_mutex held
+    bool IsInUse(const std::size_t number_of_nodes) const
+    {
+        return number_of_nodes == newest_number_of_nodes ||
+               checked_out_by_number_of_nodes.count(number_of_nodes) > 0;
+    }
+
+    // Frees the idle heaps of node counts that are not in use. nodes_mutex is taken inside the
+    // lock of a shard, like in Release.
+    void EvictStale(std::vector<std::unique_ptr<Heap>> &evicted_heaps)
+    {
+        for (auto &shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto iter = shard.idle.begin();
+            while (iter != shard.idle.end())
+            {
+                bool in_use;
+                {
+                    std::lock_guard<std::mutex> nodes_lock(nodes_mutex);
+                    in_use = IsInUse(iter->number_of_nodes);
+                }
+                if (in_use)
+                {
+                    ++iter;
+                    continue;
+                }
+
+                evicted_heaps.push_back(std::move(iter->heap));
+                shard.idle_bytes -= iter->bytes;
+                if (IsFullSize(iter->bytes))
+                {
+                    --shard.idle_full_size;
+                    --number_of_full_size;
+                }
+                ++shard.evicted;
+                iter = shard.idle.erase(iter);
+            }
+        }
+    }
+
+    // Frees the least recently used full-size heaps of shard until the cap holds again
+    void EvictFullSize(Shard &shard, std::vector<std::unique_ptr<Heap>> &evicted_heaps)
+    {
+        auto iter = shard.idle.end();
+        while (number_of_full_size.load() > max_full_size_heaps.load() &&
+               shard.idle_full_size > 0 && iter != shard.idle.begin())
+        {
+            --iter;
+            if (!IsFullSize(iter->bytes))
+            {
+                continue;
+            }
+
+            evicted_heaps.push_back(std::move(iter->heap));
+            shard.idle_bytes -= iter->bytes;
+            --shard.idle_full_size;
+            --number_of_full_size;
+            ++shard.evicted;
+            iter = shard.idle.erase(iter);
+        }
+    }
+
+    std::atomic<std::size_t> max_full_size_heaps;
+    const std::size_t full_size_bytes;
+    // checked out heaps by the node count they were built for, see BeginUse
+    std::mutex nodes_mutex;
+    std::unordered_map<std::size_t, std::size_t> checked_out_by_number_of_nodes;
+    std::size_t newest_number_of_nodes = 0;
+
+    std::array<Shard, NUMBER_OF_SHARDS> shards;
+    std::atomic<std::size_t> number_of_checked_out{0};
+    std::atomic<std::size_t> number_of_high_water_mark{0};
+    std::atomic<std::size_t> number_of_full_size{0};
+};
+
+template <typename Heap> constexpr std::size_t HeapPool<Heap>::UNLIMITED;
+template <typename Heap> constexpr std::size_t HeapPool<Heap>::DEFAULT_FULL_SIZE_BYTES;
+template <typename Heap> constexpr std::size_t HeapPool<Heap>::NUMBER_OF_SHARDS;
+}
+}
+
+#endif // HEAP_POOL_HPP
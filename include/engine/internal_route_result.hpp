@@ -5,6 +5,7 @@
 #include "extractor/travel_mode.hpp"
 #include "engine/phantom_node.hpp"
 #include "osrm/coordinate.hpp"
+#include "util/arena.hpp"
 #include "util/guidance/turn_lanes.hpp"
 #include "util/typedefs.hpp"
 
@@ -35,10 +36,14 @@ struct PathData
     EntryClassID entry_classid;
 };
 
+// Path data of a leg, allocated from the arena of the route result if it has one
+using PathDataList = util::ArenaVector<PathData>;
+
 struct InternalRouteResult
 {
-    std::vector<std::vector<PathData>> unpacked_path_segments;
-    std::vector<PathData> unpacked_alternative;
+    util::ArenaAllocator<PathData> allocator;
+    std::vector<PathDataList> unpacked_path_segments;
+    PathDataList unpacked_alternative;
     std::vector<PhantomNodes> segment_end_coordinates;
     std::vector<bool> source_traversed_in_reverse;
     std::vector<bool> target_traversed_in_reverse;
@@ -56,10 +61,23 @@ struct InternalRouteResult
         return (leg != unpacked_path_segments.size() - 1);
     }
 
+    // Adds or removes legs, new ones use the allocator of the result
+    void ResizeUnpackedPathSegments(const std::size_t number_of_legs)
+    {
+        unpacked_path_segments.resize(number_of_legs, PathDataList(allocator));
+    }
+
     InternalRouteResult()
         : shortest_path_length(INVALID_EDGE_WEIGHT), alternative_path_length(INVALID_EDGE_WEIGHT)
     {
     }
+
+    // Allocates the path data from an arena, the result must not outlive its next release
+    explicit InternalRouteResult(util::Arena &arena)
+        : allocator(arena), unpacked_alternative(allocator),
+          shortest_path_length(INVALID_EDGE_WEIGHT), alternative_path_length(INVALID_EDGE_WEIGHT)
+    {
+    }
 };
 }
 }
@@ -0,0 +1,134 @@
+#ifndef ENGINE_PHANTOM_NODE_CACHE_HPP
+#define ENGINE_PHANTOM_NODE_CACHE_HPP
+
+#include "engine/phantom_node.hpp"
+#include "util/coordinate.hpp"
+#include "util/sharded_clock_cache.hpp"
+#include "util/std_hash.hpp"
+
+#include <boost/optional.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Everything a snapping result depends on besides the dataset
+struct PhantomNodeCacheKey
+{
+    PhantomNodeCacheKey(const util::Coordinate coordinate,
+                        const boost::optional<double> radius = boost::none,
+                        const int bearing = -1,
+                        const int range = -1)
+        : lon(static_cast<std::int32_t>(coordinate.lon)),
+          lat(static_cast<std::int32_t>(coordinate.lat)), bearing(bearing), range(range),
+          radius(radius ? *radius : -1.)
+    {
+    }
+
+    std::int32_t lon;
+    std::int32_t lat;
+    std::int32_t bearing;
+    std::int32_t range;
+    double radius;
+
+    bool operator==(const PhantomNodeCacheKey &other) const
+    {
+        return lon == other.lon && lat == other.lat && bearing == other.bearing &&
+               range == other.range && radius == other.radius;
+    }
+};
+
+struct PhantomNodeCacheKeyHash
+{
+    std::size_t operator()(const PhantomNodeCacheKey &key) const
+    {
+        return hash_val(key.lon, key.lat, key.bearing, key.range, key.radius);
+    }
+};
+
+// Remembers the phantom nodes coordinates were snapped to, shared by all queries on one
+// dataset. Every dataset needs a cache of its own, the caches of several datasets can share
+// their counters.
+class PhantomNodeCache
+{
+  public:
+    struct Counters
+    {
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> misses{0};
+        std::atomic<std::uint64_t> evictions{0};
+        std::atomic<std::uint64_t> invalidations{0};
+    };
+
+    // Holds up to capacity results for each kind of snapping query
+    explicit PhantomNodeCache(const std::size_t capacity,
+                              std::shared_ptr<Counters> counters_ = std::make_shared<Counters>())
+        : nearest_cache(capacity), in_range_cache(capacity), counters(std::move(counters_))
+    {
+    }
+
+    // Result of NearestPhantomNodeWithAlternativeFromBigComponent, snap is called on a miss
+    template <typename SnapT>
+    PhantomNodePair GetNearestWithAlternative(const PhantomNodeCacheKey &key, SnapT &&snap)
+    {
+        return Get(nearest_cache, key, std::forward<SnapT>(snap));
+    }
+
+    // Result of NearestPhantomNodesInRange, snap is called on a miss
+    template <typename SnapT>
+    std::vector<PhantomNodeWithDistance> GetInRange(const PhantomNodeCacheKey &key, SnapT &&snap)
+    {
+        return Get(in_range_cache, key, std::forward<SnapT>(snap));
+    }
+
+    void Clear()
+    {
+        nearest_cache.Clear();
+        in_range_cache.Clear();
+        counters->invalidations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::size_t Size() const { return nearest_cache.Size() + in_range_cache.Size(); }
+
+    const Counters &GetCounters() const { return *counters; }
+
+  private:
+    template <typename CacheT, typename SnapT>
+    auto Get(CacheT &cache, const PhantomNodeCacheKey &key, SnapT &&snap) -> decltype(snap())
+    {
+        decltype(snap()) value;
+        if (cache.Find(key, value))
+        {
+            counters->hits.fetch_add(1, std::memory_order_relaxed);
+            return value;
+        }
+
+        counters->misses.fetch_add(1, std::memory_order_relaxed);
+        value = snap();
+        if (cache.Insert(key, value))
+        {
+            counters->evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+        return value;
+    }
+
+    util::ShardedClockCache<PhantomNodeCacheKey, PhantomNodePair, PhantomNodeCacheKeyHash>
+        nearest_cache;
+    util::ShardedClockCache<PhantomNodeCacheKey,
+                            std::vector<PhantomNodeWithDistance>,
+                            PhantomNodeCacheKeyHash>
+        in_range_cache;
+    std::shared_ptr<Counters> counters;
+};
+}
+}
+
+#endif // ENGINE_PHANTOM_NODE_CACHE_HPP
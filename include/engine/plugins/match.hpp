@@ -18,7 +18,7 @@ namespace engine
 namespace plugins
 {
 
-class MatchPlugin : public BasePlugin
+template <typename DataFacadeT> class MatchPlugin : public BasePlugin
 {
   public:
     using SubMatching = map_matching::SubMatching;
@@ -27,7 +27,7 @@ class MatchPlugin : public BasePlugin
     static const constexpr double DEFAULT_GPS_PRECISION = 5;
     static const constexpr double RADIUS_MULTIPLIER = 3;
 
-    MatchPlugin(datafacade::BaseDataFacade &facade_, const int max_locations_map_matching)
+    MatchPlugin(DataFacadeT &facade_, const int max_locations_map_matching)
         : BasePlugin(facade_), map_matching(&facade_, heaps, DEFAULT_GPS_PRECISION),
           shortest_path(&facade_, heaps), max_locations_map_matching(max_locations_map_matching)
     {
@@ -37,8 +37,8 @@ class MatchPlugin : public BasePlugin
 
   private:
     SearchEngineData heaps;
-    routing_algorithms::MapMatching<datafacade::BaseDataFacade> map_matching;
-    routing_algorithms::ShortestPathRouting<datafacade::BaseDataFacade> shortest_path;
+    routing_algorithms::MapMatching<DataFacadeT> map_matching;
+    routing_algorithms::ShortestPathRouting<DataFacadeT> shortest_path;
     int max_locations_map_matching;
 };
 }
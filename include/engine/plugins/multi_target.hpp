@@ -28,12 +28,18 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "engine/api/multi_target_parameters.hpp"
 #include "engine/datafacade/datafacade_base.hpp"
+#include "engine/phantom_node_cache.hpp"
 #include "engine/plugins/plugin_base.hpp"
 
 #include "engine/routing_algorithms/multi_target.hpp"
 #include "engine/search_engine_data.hpp"
 #include "util/json_container.hpp"
 
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace osrm
 {
 namespace engine
@@ -41,18 +47,55 @@ namespace engine
 namespace plugins
 {
 
-class MultiTargetPlugin final : public BasePlugin
+template <typename DataFacadeT> class MultiTargetPlugin final : public BasePlugin
 {
   private:
+    using ResultTable = std::vector<std::pair<double, double>>;
+    // Snapped coordinates of a batch
+    using SnappingCache =
+        std::unordered_map<PhantomNodeCacheKey, PhantomNodePair, PhantomNodeCacheKeyHash>;
+
     SearchEngineData heaps;
-    routing_algorithms::MultiTargetRouting<datafacade::BaseDataFacade, true> multi_target_forward;
-    routing_algorithms::MultiTargetRouting<datafacade::BaseDataFacade, false> multi_target_backward;
+    routing_algorithms::MultiTargetRouting<DataFacadeT, true> multi_target_forward;
+    routing_algorithms::MultiTargetRouting<DataFacadeT, false> multi_target_backward;
+
+    // Requests with at least this many targets are split across threads, -1 disables it
+    const int parallel_threshold;
+    // Number of threads a single request can occupy
+    const int max_threads;
+    // Shared by all requests, nullptr if disabled
+    PhantomNodeCache *const phantom_node_cache;
+
+    std::shared_ptr<ResultTable> Route(const std::vector<PhantomNode> &phantom_nodes,
+                                       const api::MultiTargetParameters &parameters) const;
+    std::shared_ptr<ResultTable> RouteInParallel(const std::vector<PhantomNode> &phantom_nodes,
+                                                 const api::MultiTargetParameters &parameters);
+    template <typename RoutingT>
+    std::shared_ptr<ResultTable> RouteInParallel(const RoutingT &routing,
+                                                 const std::vector<PhantomNode> &phantom_nodes,
+                                                 const api::MultiTargetParameters &parameters);
+
+    PhantomNodePair SnapCoordinate(const util::Coordinate coordinate,
+                                   const PhantomNodeCacheKey &key) const;
+    std::vector<PhantomNodePair> GetPhantomNodes(const api::MultiTargetParameters &parameters,
+                                                 SnappingCache *batch_cache);
+    Status HandleSnappedRequest(const api::MultiTargetParameters &parameters,
+                                std::vector<PhantomNodePair> phantom_node_pairs,
+                                util::json::Object &json_result);
 
   public:
-    explicit MultiTargetPlugin(datafacade::BaseDataFacade &facade);
+    explicit MultiTargetPlugin(DataFacadeT &facade,
+                               const int parallel_threshold = -1,
+                               const int max_threads = 4,
+                               PhantomNodeCache *phantom_node_cache = nullptr);
 
     Status HandleRequest(const api::MultiTargetParameters &parameters,
                          util::json::Object &json_result);
+
+    // Answers the queries in order on the calling thread, reusing its heaps and the snapped
+    // coordinates across queries. Fails if any of the queries failed.
+    Status HandleRequest(const std::vector<api::MultiTargetParameters> &queries,
+                         const api::MultiTargetBatchHandler &handler);
 };
 }
 }
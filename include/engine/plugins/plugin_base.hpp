@@ -11,7 +11,10 @@
 #include "util/integer_range.hpp"
 #include "util/json_container.hpp"
 
+#include <boost/optional.hpp>
+
 #include <algorithm>
+#include <cmath>
 #include <iterator>
 #include <string>
 #include <vector>
@@ -46,6 +49,19 @@ class BasePlugin
         return Status::Error;
     }
 
+    // Converts a duration limit in seconds to the largest weight that is within it
+    static EdgeWeight GetMaxWeight(const boost::optional<double> &max_duration)
+    {
+        if (!max_duration)
+        {
+            return INVALID_EDGE_WEIGHT;
+        }
+        // durations are reported with one decimal, so a limit equal to a reported duration
+        // has to include it despite rounding errors
+        return static_cast<EdgeWeight>(
+            std::min<double>(std::floor(*max_duration * 10. + 1e-6), INVALID_EDGE_WEIGHT));
+    }
+
     // Decides whether to use the phantom node from a big or small component if both are found.
     // Returns true if all phantom nodes are in the same component after snapping.
     std::vector<PhantomNode>
@@ -28,13 +28,21 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "engine/api/smooth_via_parameters.hpp"
 #include "engine/datafacade/datafacade_base.hpp"
+#include "engine/phantom_node_cache.hpp"
 #include "engine/plugins/plugin_base.hpp"
 
 #include "engine/routing_algorithms/direct_shortest_path.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
 #include "engine/routing_algorithms/shortest_path.hpp"
 #include "engine/search_engine_data.hpp"
 #include "util/json_container.hpp"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 namespace osrm
 {
 namespace engine
@@ -49,23 +57,132 @@ struct LegResult
     std::vector<Coordinate> polyline;
 };
 
-class SmoothViaPlugin final : public BasePlugin
+// Collected while handling a single request
+struct SmoothViaMetrics
+{
+    std::uint64_t waypoints = 0;
+    std::uint64_t candidates = 0;
+    // Coordinates snapped to the nearest big component because nothing was in range
+    std::uint64_t tiny_component_fallbacks = 0;
+    // Waypoints whose candidates are all part of tiny components
+    std::uint64_t all_tiny_waypoints = 0;
+    std::uint64_t failed_legs = 0;
+    bool found_route = false;
+
+    std::uint64_t snapping_us = 0;
+    std::uint64_t table_us = 0;
+    std::uint64_t unpacking_us = 0;
+};
+
+// Totals over all requests, updated without locking so they can be read at any time
+struct SmoothViaCounters
+{
+    std::atomic<std::uint64_t> requests{0};
+    std::atomic<std::uint64_t> requests_without_route{0};
+    std::atomic<std::uint64_t> waypoints{0};
+    std::atomic<std::uint64_t> candidates{0};
+    std::atomic<std::uint64_t> tiny_component_fallbacks{0};
+    std::atomic<std::uint64_t> all_tiny_waypoints{0};
+    std::atomic<std::uint64_t> failed_legs{0};
+    std::atomic<std::uint64_t> snapping_us{0};
+    std::atomic<std::uint64_t> table_us{0};
+    std::atomic<std::uint64_t> unpacking_us{0};
+
+    void Add(const SmoothViaMetrics &metrics);
+};
+
+// Candidate per waypoint of the cheapest chain through the leg tables and the sum of its leg
+// weights. The candidates are empty if no chain exists.
+struct ViaChain
+{
+    std::vector<std::size_t> candidates;
+    std::int64_t weight = 0;
+};
+
+// resolved_nodes holds the candidates per waypoint, leg_tables the row-major weight table
+// between the candidates of consecutive waypoints
+ViaChain FindBestChain(const std::vector<std::vector<PhantomNode>> &resolved_nodes,
+                       const std::vector<std::vector<EdgeWeight>> &leg_tables);
+
+// Routes the legs of the cheapest chain with route_leg(layer, source, target), which returns a
+// duration of std::numeric_limits<int>::max() for a leg it can not route although the table
+// found it. Such a leg is removed from leg_tables and the next best chain is tried, up to
+// max_chains chains. legs holds the legs of the returned chain, which is empty if no chain could
+// be routed.
+template <typename RouteLegT>
+ViaChain RouteBestChain(const std::vector<std::vector<PhantomNode>> &resolved_nodes,
+                        std::vector<std::vector<EdgeWeight>> &leg_tables,
+                        const std::size_t max_chains,
+                        RouteLegT &&route_leg,
+                        std::vector<LegResult> &legs,
+                        std::uint64_t &failed_legs)
+{
+    for (std::size_t attempt = 0; attempt < max_chains; ++attempt)
+    {
+        legs.clear();
+        const auto chain = FindBestChain(resolved_nodes, leg_tables);
+        const auto &candidates = chain.candidates;
+        if (candidates.empty())
+        {
+            return chain;
+        }
+
+        std::size_t layer = 1;
+        for (; layer < candidates.size(); ++layer)
+        {
+            auto leg = route_leg(layer, candidates[layer - 1], candidates[layer]);
+            if (leg.duration == std::numeric_limits<int>::max())
+            {
+                break;
+            }
+            legs.push_back(std::move(leg));
+        }
+        if (layer == candidates.size())
+        {
+            return chain;
+        }
+
+        ++failed_legs;
+        const auto number_of_targets = resolved_nodes[layer].size();
+        leg_tables[layer - 1][candidates[layer - 1] * number_of_targets + candidates[layer]] =
+            INVALID_EDGE_WEIGHT;
+    }
+    legs.clear();
+    return {};
+}
+
+util::json::Object MakeJSON(const SmoothViaMetrics &metrics);
+util::json::Object MakeJSON(const SmoothViaCounters &counters);
+
+template <typename DataFacadeT> class SmoothViaPlugin final : public BasePlugin
 {
   private:
+    // chains tried when the direct search can not route a leg the table found
+    static constexpr std::size_t MAX_ROUTED_CHAINS = 3;
+
     SearchEngineData heaps;
-    routing_algorithms::DirectShortestPathRouting<datafacade::BaseDataFacade> direct_shortest_path;
-    routing_algorithms::ShortestPathRouting<datafacade::BaseDataFacade> shortest_path;
+    // Owned by the engine, so the totals survive a change of the dataset
+    SmoothViaCounters &counters;
+    // Shared by all requests, nullptr if disabled
+    PhantomNodeCache *const phantom_node_cache;
+    routing_algorithms::DirectShortestPathRouting<DataFacadeT> direct_shortest_path;
+    routing_algorithms::ShortestPathRouting<DataFacadeT> shortest_path;
+    routing_algorithms::ManyToManyRouting<DataFacadeT> distance_table;
 
   public:
-    explicit SmoothViaPlugin(datafacade::BaseDataFacade &facade);
+    SmoothViaPlugin(DataFacadeT &facade,
+                    SmoothViaCounters &counters,
+                    PhantomNodeCache *phantom_node_cache = nullptr);
 
     Status HandleRequest(const api::SmoothViaParameters &params, util::json::Object &result);
 
   private:
-    std::vector<std::vector<PhantomNode>> ResolveNodes(const api::SmoothViaParameters &);
+    std::vector<std::vector<PhantomNode>> ResolveNodes(const api::SmoothViaParameters &,
+                                                       SmoothViaMetrics &metrics);
 
-    std::vector<std::vector<std::vector<LegResult>>>
-    RouteAllLegs(const std::vector<std::vector<PhantomNode>> &);
+    // One row-major duration table per leg, between the candidates of consecutive waypoints
+    std::vector<std::vector<EdgeWeight>>
+    ComputeLegTables(const std::vector<std::vector<PhantomNode>> &);
 
     LegResult RouteDirect(const PhantomNode &from, const PhantomNode &to);
 };
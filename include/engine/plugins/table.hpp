@@ -15,18 +15,24 @@ namespace engine
 namespace plugins
 {
 
-class TablePlugin final : public BasePlugin
+template <typename DataFacadeT> class TablePlugin final : public BasePlugin
 {
   public:
-    explicit TablePlugin(datafacade::BaseDataFacade &facade,
-                         const int max_locations_distance_table);
+    TablePlugin(DataFacadeT &facade,
+                const int max_locations_distance_table,
+                const int parallel_threshold,
+                const int max_threads);
 
     Status HandleRequest(const api::TableParameters &params, util::json::Object &result);
 
   private:
     SearchEngineData heaps;
-    routing_algorithms::ManyToManyRouting<datafacade::BaseDataFacade> distance_table;
+    routing_algorithms::ManyToManyRouting<DataFacadeT> distance_table;
     int max_locations_distance_table;
+    // Requests with at least this many entries are split across threads, -1 disables it
+    const int parallel_threshold;
+    // Number of threads a single request can occupy
+    const int max_threads;
 };
 }
 }
@@ -26,19 +26,19 @@ namespace engine
 namespace plugins
 {
 
-class TripPlugin final : public BasePlugin
+template <typename DataFacadeT> class TripPlugin final : public BasePlugin
 {
   private:
     SearchEngineData heaps;
-    routing_algorithms::ShortestPathRouting<datafacade::BaseDataFacade> shortest_path;
-    routing_algorithms::ManyToManyRouting<datafacade::BaseDataFacade> duration_table;
+    routing_algorithms::ShortestPathRouting<DataFacadeT> shortest_path;
+    routing_algorithms::ManyToManyRouting<DataFacadeT> duration_table;
     int max_locations_trip;
 
     InternalRouteResult ComputeRoute(const std::vector<PhantomNode> &phantom_node_list,
                                      const std::vector<NodeID> &trip);
 
   public:
-    explicit TripPlugin(datafacade::BaseDataFacade &facade_, const int max_locations_trip_)
+    explicit TripPlugin(DataFacadeT &facade_, const int max_locations_trip_)
         : BasePlugin(facade_), shortest_path(&facade_, heaps), duration_table(&facade_, heaps),
           max_locations_trip(max_locations_trip_)
     {
@@ -25,17 +25,17 @@ namespace engine
 namespace plugins
 {
 
-class ViaRoutePlugin final : public BasePlugin
+template <typename DataFacadeT> class ViaRoutePlugin final : public BasePlugin
 {
   private:
     SearchEngineData heaps;
-    routing_algorithms::ShortestPathRouting<datafacade::BaseDataFacade> shortest_path;
-    routing_algorithms::AlternativeRouting<datafacade::BaseDataFacade> alternative_path;
-    routing_algorithms::DirectShortestPathRouting<datafacade::BaseDataFacade> direct_shortest_path;
+    routing_algorithms::ShortestPathRouting<DataFacadeT> shortest_path;
+    routing_algorithms::AlternativeRouting<DataFacadeT> alternative_path;
+    routing_algorithms::DirectShortestPathRouting<DataFacadeT> direct_shortest_path;
     int max_locations_viaroute;
 
   public:
-    explicit ViaRoutePlugin(datafacade::BaseDataFacade &facade, int max_locations_viaroute);
+    explicit ViaRoutePlugin(DataFacadeT &facade, int max_locations_viaroute);
 
     Status HandleRequest(const api::RouteParameters &route_parameters,
                          util::json::Object &json_result);
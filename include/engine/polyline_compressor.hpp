@@ -13,6 +13,8 @@ namespace engine
 namespace detail
 {
 constexpr double POLYLINE_PRECISION = 1e5;
+// Lossless for our fixed point coordinates, used for packed request coordinates
+constexpr double POLYLINE6_PRECISION = 1e6;
 constexpr double COORDINATE_TO_POLYLINE = POLYLINE_PRECISION / COORDINATE_PRECISION;
 constexpr double POLYLINE_TO_COORDINATE = COORDINATE_PRECISION / POLYLINE_PRECISION;
 }
@@ -24,7 +26,8 @@ std::string encodePolyline(CoordVectorForwardIter begin, CoordVectorForwardIter
 
 // Decodes geometry from polyline format
 // See: https://developers.google.com/maps/documentation/utilities/polylinealgorithm
-std::vector<util::Coordinate> decodePolyline(const std::string &polyline);
+std::vector<util::Coordinate> decodePolyline(const std::string &polyline,
+                                             const double precision = detail::POLYLINE_PRECISION);
 }
 }
 
@@ -327,7 +327,7 @@ class AlternativeRouting final
         if (INVALID_EDGE_WEIGHT != upper_bound_to_shortest_path_distance)
         {
             BOOST_ASSERT(!packed_shortest_path.empty());
-            raw_route_data.unpacked_path_segments.resize(1);
+            raw_route_data.ResizeUnpackedPathSegments(1);
             raw_route_data.source_traversed_in_reverse.push_back(
                 (packed_shortest_path.front() !=
                  phantom_node_pair.source_phantom.forward_segment_id.id));
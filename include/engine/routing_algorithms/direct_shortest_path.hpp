@@ -132,7 +132,7 @@ class DirectShortestPathRouting final
         BOOST_ASSERT_MSG(!packed_leg.empty(), "packed path empty");
 
         raw_route_data.shortest_path_length = distance;
-        raw_route_data.unpacked_path_segments.resize(1);
+        raw_route_data.ResizeUnpackedPathSegments(1);
         raw_route_data.source_traversed_in_reverse.push_back(
             (packed_leg.front() != phantom_node_pair.source_phantom.forward_segment_id.id));
         raw_route_data.target_traversed_in_reverse.push_back(
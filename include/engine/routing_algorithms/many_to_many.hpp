@@ -3,13 +3,22 @@
 
 #include "engine/routing_algorithms/routing_base.hpp"
 #include "engine/search_engine_data.hpp"
+#include "util/integer_range.hpp"
 #include "util/typedefs.hpp"
 
 #include <boost/assert.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <memory>
-#include <unordered_map>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -25,20 +34,91 @@ class ManyToManyRouting final
 {
     using super = BasicRoutingInterface<DataFacadeT, ManyToManyRouting<DataFacadeT>>;
     using QueryHeap = SearchEngineData::QueryHeap;
+    using NearestQueue = typename super::NearestQueue;
     SearchEngineData &engine_working_data;
 
     struct NodeBucket
     {
-        unsigned target_id; // essentially a row in the distance matrix
+        unsigned target_id; // essentially a column in the distance matrix
         EdgeWeight distance;
-        NodeBucket(const unsigned target_id, const EdgeWeight distance)
-            : target_id(target_id), distance(distance)
+    };
+
+    // Node settled by a target search, before it is sorted into the bucket index
+    struct BucketEntry
+    {
+        NodeID node;
+        NodeBucket bucket;
+
+        bool operator<(const BucketEntry &rhs) const
         {
+            return std::tie(node, bucket.target_id) < std::tie(rhs.node, rhs.bucket.target_id);
         }
     };
 
-    // FIXME This should be replaced by an std::unordered_multimap, though this needs benchmarking
-    using SearchSpaceWithBuckets = std::unordered_map<NodeID, std::vector<NodeBucket>>;
+    // Buckets of all target searches grouped by node. The nodes that carry buckets are sorted,
+    // the buckets of nodes[i] are buckets[offsets[i]] up to buckets[offsets[i + 1]].
+    class BucketIndex
+    {
+      public:
+        BucketIndex(std::vector<BucketEntry> entries, const bool parallel)
+        {
+            if (parallel)
+            {
+                tbb::parallel_sort(entries.begin(), entries.end());
+            }
+            else
+            {
+                std::sort(entries.begin(), entries.end());
+            }
+
+            buckets.reserve(entries.size());
+            for (const auto &entry : entries)
+            {
+                if (nodes.empty() || nodes.back() != entry.node)
+                {
+                    nodes.push_back(entry.node);
+                    offsets.push_back(buckets.size());
+                }
+                buckets.push_back(entry.bucket);
+            }
+            offsets.push_back(buckets.size());
+        }
+
+        // Buckets of the node, an empty range if no target search settled it
+        std::pair<const NodeBucket *, const NodeBucket *> GetBuckets(const NodeID node) const
+        {
+            const auto position = std::lower_bound(nodes.begin(), nodes.end(), node);
+            if (position == nodes.end() || *position != node)
+            {
+                return {nullptr, nullptr};
+            }
+            const auto index = std::distance(nodes.begin(), position);
+            return {buckets.data() + offsets[index], buckets.data() + offsets[index + 1]};
+        }
+
+      private:
+        std::vector<NodeID> nodes;
+        std::vector<std::uint32_t> offsets;
+        std::vector<NodeBucket> buckets;
+    };
+
+    // Calls f(first, last) for consecutive parts of [0, count). In parallel the parts run
+    // concurrently in the task arena of the caller, each on heaps of the thread it runs on
+    // that are returned once it is done.
+    template <typename Callback>
+    static void ForEachRange(const std::size_t count, const bool parallel, Callback &&f)
+    {
+        if (!parallel)
+        {
+            f(std::size_t{0}, count);
+            return;
+        }
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, count),
+                          [&f](const tbb::blocked_range<std::size_t> &range) {
+                              SearchEngineData::ThreadLocalStorageScope heap_scope;
+                              f(range.begin(), range.end());
+                          });
+    }
 
   public:
     ManyToManyRouting(DataFacadeT *facade, SearchEngineData &engine_working_data)
@@ -46,9 +126,19 @@ class ManyToManyRouting final
     {
     }
 
+    // Durations above max_weight are reported as INVALID_EDGE_WEIGHT. If number_of_nearest is
+    // set, only that many of the closest targets are reported for every source. Both bounds
+    // stop the searches as soon as the remaining entries can not be part of the result.
+    //
+    // With parallel set the target searches and then the source searches are split across the
+    // task arena of the caller. The target searches fill buckets per thread that are merged
+    // into one index, every source search only writes its own row of the table.
     std::vector<EdgeWeight> operator()(const std::vector<PhantomNode> &phantom_nodes,
                                        const std::vector<std::size_t> &source_indices,
-                                       const std::vector<std::size_t> &target_indices) const
+                                       const std::vector<std::size_t> &target_indices,
+                                       const EdgeWeight max_weight = INVALID_EDGE_WEIGHT,
+                                       const std::size_t number_of_nearest = 0,
+                                       const bool parallel = false) const
     {
         const auto number_of_sources =
             source_indices.empty() ? phantom_nodes.size() : source_indices.size();
@@ -58,15 +148,35 @@ class ManyToManyRouting final
         std::vector<EdgeWeight> result_table(number_of_entries,
                                              std::numeric_limits<EdgeWeight>::max());
 
-        engine_working_data.InitializeOrClearFirstThreadLocalStorage(
-            super::facade->GetNumberOfNodes());
-
-        QueryHeap &query_heap = *(engine_working_data.forward_heap_1);
+        const auto get_source = [&](const std::size_t row_idx) -> const PhantomNode & {
+            return phantom_nodes[source_indices.empty() ? row_idx : source_indices[row_idx]];
+        };
+        const auto get_target = [&](const std::size_t column_idx) -> const PhantomNode & {
+            return phantom_nodes[target_indices.empty() ? column_idx : target_indices[column_idx]];
+        };
 
-        SearchSpaceWithBuckets search_space_with_buckets;
+        // The sources start at the negated offset, so no path is shorter than the
+        // distance of a target search plus this
+        EdgeWeight min_source_offset = 0;
+        for (const auto row_idx : util::irange<std::size_t>(0, number_of_sources))
+        {
+            const auto &phantom = get_source(row_idx);
+            if (phantom.forward_segment_id.enabled)
+            {
+                min_source_offset =
+                    std::min(min_source_offset, -phantom.GetForwardWeightPlusOffset());
+            }
+            if (phantom.reverse_segment_id.enabled)
+            {
+                min_source_offset =
+                    std::min(min_source_offset, -phantom.GetReverseWeightPlusOffset());
+            }
+        }
 
-        unsigned column_idx = 0;
-        const auto search_target_phantom = [&](const PhantomNode &phantom) {
+        const auto search_target_phantom = [&](const unsigned column_idx,
+                                               QueryHeap &query_heap,
+                                               std::vector<BucketEntry> &bucket_entries) {
+            const auto &phantom = get_target(column_idx);
             query_heap.Clear();
             // insert target(s) at distance 0
 
@@ -84,16 +194,17 @@ class ManyToManyRouting final
             }
 
             // explore search space
-            while (!query_heap.Empty())
+            while (!query_heap.Empty() && query_heap.MinKey() + min_source_offset <= max_weight)
             {
-                BackwardRoutingStep(column_idx, query_heap, search_space_with_buckets);
+                BackwardRoutingStep(column_idx, query_heap, bucket_entries);
             }
-            ++column_idx;
         };
 
         // for each source do forward search
-        unsigned row_idx = 0;
-        const auto search_source_phantom = [&](const PhantomNode &phantom) {
+        const auto search_source_phantom = [&](const unsigned row_idx,
+                                               QueryHeap &query_heap,
+                                               const BucketIndex &bucket_index) {
+            const auto &phantom = get_source(row_idx);
             query_heap.Clear();
             // insert target(s) at distance 0
 
@@ -110,49 +221,103 @@ class ManyToManyRouting final
                                   phantom.reverse_segment_id.id);
             }
 
+            NearestQueue nearest_queue;
+            std::size_t number_of_final_targets = 0;
+            const auto row_begin = result_table.begin() + row_idx * number_of_targets;
+
             // explore search space
             while (!query_heap.Empty())
             {
+                // the target distances are not negative, so every path that is still to be
+                // found is at least as long as the smallest distance in the heap
+                const EdgeWeight min_distance = query_heap.MinKey();
+                if (min_distance > max_weight)
+                {
+                    break;
+                }
+
+                // targets below that distance are final, stopping only at a larger distance
+                // also finds all targets tied with the last one
+                if (number_of_nearest > 0)
+                {
+                    while (!nearest_queue.empty() && nearest_queue.top().first < min_distance)
+                    {
+                        const auto &entry = nearest_queue.top();
+                        if (entry.first == row_begin[entry.second])
+                        {
+                            ++number_of_final_targets;
+                        }
+                        nearest_queue.pop();
+                    }
+                    if (number_of_final_targets >= number_of_nearest)
+                    {
+                        break;
+                    }
+                }
+
                 ForwardRoutingStep(row_idx,
                                    number_of_targets,
                                    query_heap,
-                                   search_space_with_buckets,
-                                   result_table);
+                                   bucket_index,
+                                   result_table,
+                                   number_of_nearest > 0 ? &nearest_queue : nullptr);
             }
-            ++row_idx;
-        };
 
-        if (target_indices.empty())
-        {
-            for (const auto &phantom : phantom_nodes)
+            std::replace_if(row_begin,
+                            row_begin + number_of_targets,
+                            [max_weight](const EdgeWeight weight) { return weight > max_weight; },
+                            INVALID_EDGE_WEIGHT);
+            if (number_of_nearest > 0 && number_of_nearest < number_of_targets)
             {
-                search_target_phantom(phantom);
+                super::SelectNearest(row_begin, number_of_targets, number_of_nearest);
             }
-        }
-        else
-        {
-            for (const auto index : target_indices)
-            {
-                const auto &phantom = phantom_nodes[index];
-                search_target_phantom(phantom);
-            }
-        }
+        };
+
+        const auto number_of_nodes = super::facade->GetNumberOfNodes();
+        tbb::enumerable_thread_specific<std::vector<BucketEntry>> thread_bucket_entries;
+        ForEachRange(
+            number_of_targets, parallel, [&](const std::size_t first, const std::size_t last) {
+                engine_working_data.InitializeOrClearFirstThreadLocalStorage(
+                    number_of_nodes, HeapSize::FullSize);
+                QueryHeap &query_heap = *(engine_working_data.forward_heap_1);
+                auto &bucket_entries = thread_bucket_entries.local();
+                for (const auto column_idx : util::irange(first, last))
+                {
+                    search_target_phantom(column_idx, query_heap, bucket_entries);
+                }
+            });
 
-        if (source_indices.empty())
+        std::vector<BucketEntry> bucket_entries;
+        if (thread_bucket_entries.size() == 1)
         {
-            for (const auto &phantom : phantom_nodes)
-            {
-                search_source_phantom(phantom);
-            }
+            bucket_entries = std::move(*thread_bucket_entries.begin());
         }
         else
         {
-            for (const auto index : source_indices)
+            std::size_t number_of_bucket_entries = 0;
+            for (const auto &entries : thread_bucket_entries)
             {
-                const auto &phantom = phantom_nodes[index];
-                search_source_phantom(phantom);
+                number_of_bucket_entries += entries.size();
+            }
+            bucket_entries.reserve(number_of_bucket_entries);
+            for (const auto &entries : thread_bucket_entries)
+            {
+                bucket_entries.insert(bucket_entries.end(), entries.begin(), entries.end());
             }
         }
+        thread_bucket_entries.clear();
+        const BucketIndex bucket_index(std::move(bucket_entries), parallel);
+
+        ForEachRange(
+            number_of_sources, parallel, [&](const std::size_t first, const std::size_t last) {
+                engine_working_data.InitializeOrClearFirstThreadLocalStorage(
+                    number_of_nodes, HeapSize::FullSize);
+                QueryHeap &query_heap = *(engine_working_data.forward_heap_1);
+                for (const auto row_idx : util::irange(first, last))
+                {
+                    search_source_phantom(row_idx, query_heap, bucket_index);
+                }
+            });
 
         return result_table;
     }
@@ -160,122 +325,60 @@ class ManyToManyRouting final
     void ForwardRoutingStep(const unsigned row_idx,
                             const unsigned number_of_targets,
                             QueryHeap &query_heap,
-                            const SearchSpaceWithBuckets &search_space_with_buckets,
-                            std::vector<EdgeWeight> &result_table) const
+                            const BucketIndex &bucket_index,
+                            std::vector<EdgeWeight> &result_table,
+                            NearestQueue *nearest_queue = nullptr) const
     {
         const NodeID node = query_heap.DeleteMin();
         const int source_distance = query_heap.GetKey(node);
 
         // check if each encountered node has an entry
-        const auto bucket_iterator = search_space_with_buckets.find(node);
-        // iterate bucket if there exists one
-        if (bucket_iterator != search_space_with_buckets.end())
+        const auto bucket_range = bucket_index.GetBuckets(node);
+        for (auto current_bucket = bucket_range.first; current_bucket != bucket_range.second;
+             ++current_bucket)
         {
-            const std::vector<NodeBucket> &bucket_list = bucket_iterator->second;
-            for (const NodeBucket &current_bucket : bucket_list)
+            // get target id from bucket entry
+            const unsigned column_idx = current_bucket->target_id;
+            const int target_distance = current_bucket->distance;
+            auto &current_distance = result_table[row_idx * number_of_targets + column_idx];
+            // check if new distance is better
+            EdgeWeight new_distance = source_distance + target_distance;
+            if (new_distance < 0)
             {
-                // get target id from bucket entry
-                const unsigned column_idx = current_bucket.target_id;
-                const int target_distance = current_bucket.distance;
-                auto &current_distance = result_table[row_idx * number_of_targets + column_idx];
-                // check if new distance is better
-                const EdgeWeight new_distance = source_distance + target_distance;
+                const EdgeWeight loop_weight = super::GetLoopWeight(node);
+                if (loop_weight == INVALID_EDGE_WEIGHT)
+                {
+                    continue;
+                }
+                new_distance += loop_weight;
                 if (new_distance < 0)
                 {
-                    const EdgeWeight loop_weight = super::GetLoopWeight(node);
-                    const int new_distance_with_loop = new_distance + loop_weight;
-                    if (loop_weight != INVALID_EDGE_WEIGHT && new_distance_with_loop >= 0)
-                    {
-                        current_distance = std::min(current_distance, new_distance_with_loop);
-                    }
+                    continue;
                 }
-                else if (new_distance < current_distance)
+            }
+            if (new_distance < current_distance)
+            {
+                current_distance = new_distance;
+                if (nearest_queue)
                 {
-                    result_table[row_idx * number_of_targets + column_idx] = new_distance;
+                    nearest_queue->emplace(new_distance, column_idx);
                 }
             }
         }
-        if (StallAtNode<true>(node, source_distance, query_heap))
-        {
-            return;
-        }
-        RelaxOutgoingEdges<true>(node, source_distance, query_heap);
+        super::RelaxOrStall(node, source_distance, query_heap, true);
     }
 
     void BackwardRoutingStep(const unsigned column_idx,
                              QueryHeap &query_heap,
-                             SearchSpaceWithBuckets &search_space_with_buckets) const
+                             std::vector<BucketEntry> &bucket_entries) const
     {
         const NodeID node = query_heap.DeleteMin();
         const int target_distance = query_heap.GetKey(node);
 
         // store settled nodes in search space bucket
-        search_space_with_buckets[node].emplace_back(column_idx, target_distance);
-
-        if (StallAtNode<false>(node, target_distance, query_heap))
-        {
-            return;
-        }
-
-        RelaxOutgoingEdges<false>(node, target_distance, query_heap);
-    }
-
-    template <bool forward_direction>
-    inline void
-    RelaxOutgoingEdges(const NodeID node, const EdgeWeight distance, QueryHeap &query_heap) const
-    {
-        for (auto edge : super::facade->GetAdjacentEdgeRange(node))
-        {
-            const auto &data = super::facade->GetEdgeData(edge);
-            const bool direction_flag = (forward_direction ? data.forward : data.backward);
-            if (direction_flag)
-            {
-                const NodeID to = super::facade->GetTarget(edge);
-                const int edge_weight = data.distance;
+        bucket_entries.push_back({node, {column_idx, target_distance}});
 
-                BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
-                const int to_distance = distance + edge_weight;
-
-                // New Node discovered -> Add to Heap + Node Info Storage
-                if (!query_heap.WasInserted(to))
-                {
-                    query_heap.Insert(to, to_distance, node);
-                }
-                // Found a shorter Path -> Update distance
-                else if (to_distance < query_heap.GetKey(to))
-                {
-                    // new parent
-                    query_heap.GetData(to).parent = node;
-                    query_heap.DecreaseKey(to, to_distance);
-                }
-            }
-        }
-    }
-
-    // Stalling
-    template <bool forward_direction>
-    inline bool
-    StallAtNode(const NodeID node, const EdgeWeight distance, QueryHeap &query_heap) const
-    {
-        for (auto edge : super::facade->GetAdjacentEdgeRange(node))
-        {
-            const auto &data = super::facade->GetEdgeData(edge);
-            const bool reverse_flag = ((!forward_direction) ? data.forward : data.backward);
-            if (reverse_flag)
-            {
-                const NodeID to = super::facade->GetTarget(edge);
-                const int edge_weight = data.distance;
-                BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
-                if (query_heap.WasInserted(to))
-                {
-                    if (query_heap.GetKey(to) + edge_weight < distance)
-                    {
-                        return true;
-                    }
-                }
-            }
-        }
-        return false;
+        super::RelaxOrStall(node, target_distance, query_heap, false);
     }
 };
 }
@@ -34,7 +34,15 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <boost/assert.hpp>
 
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -50,6 +58,7 @@ class MultiTargetRouting final
 {
     typedef BasicRoutingInterface<DataFacadeT, MultiTargetRouting<DataFacadeT, forward>> super;
     typedef SearchEngineData::QueryHeap QueryHeap;
+    typedef typename super::NearestQueue NearestQueue;
     SearchEngineData &engine_working_data;
 
   public:
@@ -60,8 +69,14 @@ class MultiTargetRouting final
 
     ~MultiTargetRouting() {}
 
+    // Returns duration and distance for each target. The distance is left at zero
+    // if calculate_distance is false. Targets further away than max_weight, or not among the
+    // number_of_nearest closest targets if that is set, get an INVALID_EDGE_WEIGHT duration.
     std::shared_ptr<std::vector<std::pair<double, double>>>
-    operator()(const std::vector<PhantomNode> &phantom_nodes_array) const
+    operator()(const std::vector<PhantomNode> &phantom_nodes_array,
+               const bool calculate_distance = true,
+               const EdgeWeight max_weight = INVALID_EDGE_WEIGHT,
+               const std::size_t number_of_nearest = 0) const
     {
         BOOST_ASSERT(phantom_nodes_array.size() >= 2);
 
@@ -76,42 +91,146 @@ class MultiTargetRouting final
         std::vector<std::reference_wrapper<const PhantomNode>> targets(
             std::next(begin(phantom_nodes_array)), end(phantom_nodes_array));
 
+        // Without precomputed lengths the distances are taken from the unpacked paths
+        const bool with_lengths = calculate_distance && super::facade->HasLengths();
+
+        // the target sweep settles the whole search space of the source
+        const bool sweep = (number_of_nearest == 0 || number_of_nearest >= targets.size()) &&
+                           super::facade->GetCoreSize() == 0;
         engine_working_data.InitializeOrClearFirstThreadLocalStorage(
-            super::facade->GetNumberOfNodes());
+            super::facade->GetNumberOfNodes(), sweep ? HeapSize::FullSize : HeapSize::Sparse);
 
         // The forward heap keeps the distances from the source.
-        // Therefore it will be reused for each target backward search.
+        // Therefore it will be reused for each target.
         QueryHeap &forward_heap = *(engine_working_data.forward_heap_1);
 
-        // The reverse heap will be cleared after each search from
-        // one of the targets to the source.
+        // The reverse heap either holds the labels of the target sweep or
+        // is cleared after each search from one of the targets to the source.
         QueryHeap &reverse_heap = *(engine_working_data.reverse_heap_1);
 
         // Fill forward heap with the source location phantom node(s).
         // The source location is located at index 0.
         // The target locations are located at index [1, ..., n].
-        EdgeWeight min_edge_offset = 0;
-        if (source.forward_segment_id.enabled)
+        EdgeWeight min_edge_offset = InsertPhantom(source, SOURCE_SIGN, with_lengths, forward_heap);
+
+        // No path to a target is shorter than an upward distance from the source plus this
+        EdgeWeight min_target_offset = 0;
+        for (const PhantomNode &target : targets)
         {
-            EdgeWeight offset = (forward ? -1 : 1) * source.GetForwardWeightPlusOffset();
-            forward_heap.Insert(source.forward_segment_id.id, offset,
-                                source.forward_segment_id.id);
-            min_edge_offset = std::min(min_edge_offset, offset);
+            min_target_offset = std::min(min_target_offset, GetMinOffset(target, TARGET_SIGN));
         }
-        if (source.reverse_segment_id.enabled)
+
+        // The bucket search of the nearest targets and the target sweep need the upward graph
+        // to be acyclic, which does not hold inside an uncontracted core. Fall back to one
+        // bidirectional search per target there.
+        if (number_of_nearest > 0 && number_of_nearest < targets.size() &&
+            super::facade->GetCoreSize() > 0)
         {
-            EdgeWeight offset = (forward ? -1 : 1) * source.GetReverseWeightPlusOffset();
-            forward_heap.Insert(source.reverse_segment_id.id,
-                                (forward ? -1 : 1) * source.GetReverseWeightPlusOffset(),
-                                source.reverse_segment_id.id);
-            min_edge_offset = std::min(min_edge_offset, offset);
+            // Only the weights first: once number_of_nearest targets were found, the searches to
+            // the others are bounded by the weight of the furthest of them
+            std::vector<Meeting> meetings;
+            meetings.reserve(targets.size());
+            std::vector<EdgeWeight> weights(targets.size(), INVALID_EDGE_WEIGHT);
+            std::priority_queue<EdgeWeight> nearest_weights;
+            for (std::size_t index = 0; index < targets.size(); ++index)
+            {
+                const EdgeWeight bound = nearest_weights.size() < number_of_nearest
+                                             ? max_weight
+                                             : std::min(max_weight, nearest_weights.top());
+                meetings.push_back(FindMeeting(
+                    targets[index], forward_heap, reverse_heap, min_edge_offset, with_lengths,
+                    bound));
+                if (SPECIAL_NODEID == meetings.back().node)
+                {
+                    continue;
+                }
+                weights[index] = meetings.back().weight;
+                nearest_weights.push(weights[index]);
+                if (nearest_weights.size() > number_of_nearest)
+                {
+                    nearest_weights.pop();
+                }
+            }
+
+            super::SelectNearest(weights.begin(), weights.size(), number_of_nearest);
+            for (std::size_t index = 0; index < targets.size(); ++index)
+            {
+                if (INVALID_EDGE_WEIGHT == weights[index])
+                {
+                    results->emplace_back(INVALID_EDGE_WEIGHT, 0);
+                }
+                else if (!calculate_distance || with_lengths)
+                {
+                    results->emplace_back(MakeResult(meetings[index]));
+                }
+                else
+                {
+                    // the path is unpacked from the search space of this target
+                    auto result = FindShortestPath(source, targets[index], forward_heap,
+                                                   reverse_heap, min_edge_offset,
+                                                   calculate_distance, with_lengths,
+                                                   weights[index]);
+                    BOOST_ASSERT(INVALID_EDGE_WEIGHT != result.first);
+                    results->emplace_back(std::move(result));
+                }
+            }
         }
+        else if (number_of_nearest > 0 && number_of_nearest < targets.size())
+        {
+            const auto weights = FindNearestTargets(targets, forward_heap, reverse_heap,
+                                                    min_edge_offset, min_target_offset,
+                                                    max_weight, number_of_nearest);
 
-        for (auto const &target : targets)
+            // Only the nearest targets need their paths, search them one by one
+            if (calculate_distance)
+            {
+                min_edge_offset = InsertPhantom(source, SOURCE_SIGN, with_lengths, forward_heap);
+            }
+
+            for (std::size_t index = 0; index < targets.size(); ++index)
+            {
+                if (INVALID_EDGE_WEIGHT == weights[index])
+                {
+                    results->emplace_back(INVALID_EDGE_WEIGHT, 0);
+                }
+                else if (!calculate_distance)
+                {
+                    results->emplace_back(static_cast<double>(weights[index]) / 10., 0.);
+                }
+                else
+                {
+                    auto result = FindShortestPath(source, targets[index], forward_heap,
+                                                   reverse_heap, min_edge_offset,
+                                                   calculate_distance, with_lengths,
+                                                   weights[index]);
+                    // A nearest target always has a path, if the search bounded by its
+                    // weight misses it continue the search up to max_weight.
+                    if (INVALID_EDGE_WEIGHT == result.first)
+                    {
+                        result = FindShortestPath(source, targets[index], forward_heap,
+                                                  reverse_heap, min_edge_offset,
+                                                  calculate_distance, with_lengths, max_weight);
+                    }
+                    BOOST_ASSERT(INVALID_EDGE_WEIGHT != result.first);
+                    results->emplace_back(std::move(result));
+                }
+            }
+        }
+        else if (super::facade->GetCoreSize() > 0)
         {
-            auto result = FindShortestPath(source, target, forward_heap, reverse_heap,
-                                           min_edge_offset);
-            results->emplace_back(std::move(result));
+            for (auto const &target : targets)
+            {
+                auto result = FindShortestPath(source, target, forward_heap, reverse_heap,
+                                               min_edge_offset, calculate_distance, with_lengths,
+                                               max_weight);
+                results->emplace_back(std::move(result));
+            }
+        }
+        else
+        {
+            SettleSourceSearchSpace(forward_heap, min_target_offset, with_lengths, max_weight);
+            SweepTargets(source, targets, forward_heap, reverse_heap, calculate_distance,
+                         with_lengths, max_weight, *results);
         }
 
         forward_heap.Clear();
@@ -120,87 +239,773 @@ class MultiTargetRouting final
         return results;
     }
 
+    // The upward search space of the source can be shared by threads that each sweep a part
+    // of the targets. This needs the target sweep, so it is not possible with a core.
+    bool CanShareSourceSearchSpace() const { return super::facade->GetCoreSize() == 0; }
+
+    // Settles the upward search space of the source phantom_nodes_array[0] in source_heap, for
+    // all targets phantom_nodes_array[1], ..., phantom_nodes_array[n] within max_weight.
+    void SearchSourceSearchSpace(const std::vector<PhantomNode> &phantom_nodes_array,
+                                 const bool calculate_distance,
+                                 const EdgeWeight max_weight,
+                                 QueryHeap &source_heap) const
+    {
+        BOOST_ASSERT(CanShareSourceSearchSpace());
+        BOOST_ASSERT(phantom_nodes_array.size() >= 2);
+
+        const bool with_lengths = calculate_distance && super::facade->HasLengths();
+
+        EdgeWeight min_target_offset = 0;
+        for (std::size_t index = 1; index < phantom_nodes_array.size(); ++index)
+        {
+            min_target_offset = std::min(min_target_offset,
+                                         GetMinOffset(phantom_nodes_array[index], TARGET_SIGN));
+        }
+
+        source_heap.Clear();
+        InsertPhantom(phantom_nodes_array[0], SOURCE_SIGN, with_lengths, source_heap);
+        SettleSourceSearchSpace(source_heap, min_target_offset, with_lengths, max_weight);
+    }
+
+    // Same as operator() without number_of_nearest, but sweeps the targets from the search
+    // space of SearchSourceSearchSpace. The source heap is only read, so threads can share it
+    // as long as their targets were part of its search.
+    std::shared_ptr<std::vector<std::pair<double, double>>>
+    operator()(const std::vector<PhantomNode> &phantom_nodes_array,
+               const QueryHeap &source_heap,
+               const bool calculate_distance = true,
+               const EdgeWeight max_weight = INVALID_EDGE_WEIGHT) const
+    {
+        BOOST_ASSERT(CanShareSourceSearchSpace());
+        BOOST_ASSERT(phantom_nodes_array.size() >= 2);
+
+        auto results = std::make_shared<std::vector<std::pair<double, double>>>();
+        results->reserve(phantom_nodes_array.size() - 1);
+
+        const auto &source = phantom_nodes_array[0];
+        std::vector<std::reference_wrapper<const PhantomNode>> targets(
+            std::next(begin(phantom_nodes_array)), end(phantom_nodes_array));
+        const bool with_lengths = calculate_distance && super::facade->HasLengths();
+
+        engine_working_data.InitializeOrClearFirstThreadLocalStorage(
+            super::facade->GetNumberOfNodes());
+        QueryHeap &label_heap = *(engine_working_data.reverse_heap_1);
+
+        SweepTargets(source, targets, source_heap, label_heap, calculate_distance, with_lengths,
+                     max_weight, *results);
+
+        label_heap.Clear();
+
+        return results;
+    }
+
+  private:
+    // Signs of the phantom offsets the searches from the source and the targets start with
+    static const constexpr int SOURCE_SIGN = forward ? -1 : 1;
+    static const constexpr int TARGET_SIGN = forward ? 1 : -1;
+
+    // Best path found so far for a target: the node the source and the target search spaces
+    // meet at and the node the path enters it from. They only differ for the target sweep.
+    struct Meeting
+    {
+        NodeID node;
+        NodeID via_node;
+        EdgeWeight weight;
+        std::int32_t length;
+    };
+
+    // Direction in which the searches from the targets relax the edges.
+    static bool IsTargetDirection(const typename DataFacadeT::EdgeData &data)
+    {
+        return forward ? data.backward : data.forward;
+    }
+
+    // Smallest offset a search from the phantom node starts with, but at most zero
+    static EdgeWeight GetMinOffset(const PhantomNode &phantom, const int sign)
+    {
+        EdgeWeight min_offset = 0;
+        if (phantom.forward_segment_id.enabled)
+        {
+            min_offset = std::min(min_offset, sign * phantom.GetForwardWeightPlusOffset());
+        }
+        if (phantom.reverse_segment_id.enabled)
+        {
+            min_offset = std::min(min_offset, sign * phantom.GetReverseWeightPlusOffset());
+        }
+        return min_offset;
+    }
+
+    // Inserts the segments of the phantom node, returns GetMinOffset.
+    EdgeWeight InsertPhantom(const PhantomNode &phantom,
+                             const int sign,
+                             const bool with_lengths,
+                             QueryHeap &heap) const
+    {
+        if (phantom.forward_segment_id.enabled)
+        {
+            const NodeID node = phantom.forward_segment_id.id;
+            heap.Insert(node,
+                        sign * phantom.GetForwardWeightPlusOffset(),
+                        {node, with_lengths ? GetPhantomLength(phantom, node, sign) : 0});
+        }
+        if (phantom.reverse_segment_id.enabled)
+        {
+            const NodeID node = phantom.reverse_segment_id.id;
+            heap.Insert(node,
+                        sign * phantom.GetReverseWeightPlusOffset(),
+                        {node, with_lengths ? GetPhantomLength(phantom, node, sign) : 0});
+        }
+        return GetMinOffset(phantom, sign);
+    }
+
+    // Initial upper bound of a search that ignores paths longer than max_weight
+    static EdgeWeight GetUpperBound(const EdgeWeight max_weight)
+    {
+        return INVALID_EDGE_WEIGHT == max_weight ? INVALID_EDGE_WEIGHT : max_weight + 1;
+    }
+
+    // The searches carry the lengths of their paths in HeapData::length, in twentieths of a
+    // meter. An edge has the full lengths of both of its nodes in decimeters, so the sum along
+    // a path counts the first and the last node once and all nodes in between twice. The
+    // lengths the searches start with make up for the ends: the path starts at the phantom
+    // location of its first node and ends at the one of its last node.
+    //
+    // Length a search starts with at a segment of the phantom node. Phantom nodes at the
+    // start of the paths are inserted with a negative sign, see SOURCE_SIGN.
+    std::int32_t
+    GetPhantomLength(const PhantomNode &phantom, const NodeID node, const int sign) const
+    {
+        const auto node_length = static_cast<std::int32_t>(super::facade->GetNodeLength(node));
+        const auto remaining_length =
+            static_cast<std::int32_t>(std::round(GetRemainingLength(phantom, node) * 20.));
+        return sign < 0 ? remaining_length - node_length : node_length - remaining_length;
+    }
+
+    std::int32_t GetEdgeLength(const EdgeID edge) const
+    {
+        return static_cast<std::int32_t>(super::facade->GetEdgeLength(edge));
+    }
+
+    // Length in meters from the phantom location to the end of the node.
+    double GetRemainingLength(const PhantomNode &phantom, const NodeID node) const
+    {
+        const bool traversed_in_reverse = node != phantom.forward_segment_id.id;
+
+        auto &id_vector = SearchEngineData::GetUnpackingBuffer().geometry;
+        super::facade->GetUncompressedGeometry(traversed_in_reverse
+                                                   ? phantom.reverse_packed_geometry_id
+                                                   : phantom.forward_packed_geometry_id,
+                                               id_vector);
+
+        const std::size_t start_index =
+            traversed_in_reverse ? id_vector.size() - phantom.fwd_segment_position - 1
+                                 : phantom.fwd_segment_position;
+        BOOST_ASSERT(start_index < id_vector.size());
+
+        double length = 0.0;
+        Coordinate previous = phantom.location;
+        for (std::size_t i = start_index; i < id_vector.size(); ++i)
+        {
+            const Coordinate current = super::facade->GetCoordinateOfNode(id_vector[i]);
+            length += util::coordinate_calculation::greatCircleDistance(previous, current);
+            previous = current;
+        }
+        return length;
+    }
+
+    // Relaxes the edges of a node in the search direction, without stalling. The lengths are
+    // only carried along if with_lengths is set.
+    void RelaxEdges(const NodeID node,
+                    QueryHeap &heap,
+                    const bool search_direction,
+                    const bool with_lengths) const
+    {
+        const EdgeWeight distance = heap.GetKey(node);
+        const std::int32_t length = heap.GetData(node).length;
+
+        const auto edges = super::facade->GetDirectedEdgeRanges(node);
+        for (const auto edge : search_direction ? edges.Forward() : edges.Backward())
+        {
+            const EdgeWeight edge_weight = super::facade->GetEdgeData(edge).distance;
+            BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
+
+            const NodeID to = super::facade->GetTarget(edge);
+            const EdgeWeight to_distance = distance + edge_weight;
+            const std::int32_t to_length = with_lengths ? length + GetEdgeLength(edge) : 0;
+
+            if (!heap.WasInserted(to))
+            {
+                heap.Insert(to, to_distance, {node, to_length});
+            }
+            else if (IsShorter(to_distance, to_length, heap.GetKey(to), heap.GetData(to).length))
+            {
+                heap.GetData(to) = {node, to_length};
+                if (to_distance < heap.GetKey(to))
+                {
+                    heap.DecreaseKey(to, to_distance);
+                }
+            }
+        }
+    }
+
+    // All searches order paths by weight and break ties by length, so the target sweep and
+    // the searches per target pick the same path and report the same distance.
+    static bool IsShorter(const EdgeWeight weight,
+                          const std::int32_t length,
+                          const EdgeWeight other_weight,
+                          const std::int32_t other_length)
+    {
+        return std::tie(weight, length) < std::tie(other_weight, other_length);
+    }
+
+    // Takes the path if it is shorter than the best one found so far.
+    static void UpdateMeeting(const NodeID node,
+                              const NodeID via_node,
+                              const EdgeWeight weight,
+                              const std::int32_t length,
+                              Meeting &meeting)
+    {
+        if (IsShorter(weight, length, meeting.weight, meeting.length))
+        {
+            meeting = {node, via_node, weight, length};
+        }
+    }
+
+    // Takes the path meeting at the node itself. A negative weight means that source and
+    // target phantom are on the same edge based node, so the path has to use a loop at it.
+    void UpdateMeetingAtNode(const NodeID node,
+                             const EdgeWeight weight,
+                             const std::int32_t length,
+                             const bool with_lengths,
+                             Meeting &meeting) const
+    {
+        if (weight >= 0)
+        {
+            UpdateMeeting(node, node, weight, length, meeting);
+            return;
+        }
+
+        for (const auto edge : super::facade->GetAdjacentEdgeRange(node))
+        {
+            const auto &data = super::facade->GetEdgeData(edge);
+            if (IsTargetDirection(data) && super::facade->GetTarget(edge) == node &&
+                weight + data.distance >= 0)
+            {
+                UpdateMeeting(node,
+                              node,
+                              weight + data.distance,
+                              with_lengths ? length + GetEdgeLength(edge) : 0,
+                              meeting);
+            }
+        }
+    }
+
+    // Runs the upward search from the source until its search space is exhausted, or until
+    // no path within max_weight can pass the remaining nodes. Afterwards the forward heap
+    // holds the exact upward distances of all nodes that can be part of such a path.
+    void SettleSourceSearchSpace(QueryHeap &forward_heap,
+                                 const EdgeWeight min_target_offset,
+                                 const bool with_lengths,
+                                 const EdgeWeight max_weight) const
+    {
+        while (0 < forward_heap.Size() &&
+               forward_heap.MinKey() + min_target_offset <= max_weight)
+        {
+            RelaxEdges(forward_heap.DeleteMin(), forward_heap, forward, with_lengths);
+        }
+    }
+
+    // Collects the union of the upward search spaces of all targets.
+    //
+    // The reverse heap is used as label storage for the sweep: every selected node is
+    // inserted with an infinite distance. The nodes are emitted in DFS post-order, which
+    // places each node after all nodes it can reach upwards, i.e. top-down.
+    void SelectTargetSearchSpace(
+        const std::vector<std::reference_wrapper<const PhantomNode>> &targets,
+        QueryHeap &label_heap,
+        std::vector<NodeID> &sweep_order) const
+    {
+        struct StackEntry
+        {
+            NodeID node;
+            EdgeID current_edge;
+            EdgeID end_edge;
+        };
+        std::vector<StackEntry> dfs_stack;
+
+        const auto visit = [&](const NodeID node) {
+            if (!label_heap.WasInserted(node))
+            {
+                label_heap.Insert(node, INVALID_EDGE_WEIGHT, node);
+                dfs_stack.push_back(
+                    {node, super::facade->BeginEdges(node), super::facade->EndEdges(node)});
+            }
+        };
+
+        const auto traverse = [&](const NodeID start) {
+            visit(start);
+            while (!dfs_stack.empty())
+            {
+                if (dfs_stack.back().current_edge == dfs_stack.back().end_edge)
+                {
+                    sweep_order.push_back(dfs_stack.back().node);
+                    dfs_stack.pop_back();
+                    continue;
+                }
+
+                const EdgeID edge = dfs_stack.back().current_edge++;
+                if (IsTargetDirection(super::facade->GetEdgeData(edge)))
+                {
+                    visit(super::facade->GetTarget(edge));
+                }
+            }
+        };
+
+        for (const PhantomNode &target : targets)
+        {
+            if (target.forward_segment_id.enabled)
+            {
+                traverse(target.forward_segment_id.id);
+            }
+            if (target.reverse_segment_id.enabled)
+            {
+                traverse(target.reverse_segment_id.id);
+            }
+        }
+
+        // the labels are only accessed by node from here on
+        label_heap.DeleteAll();
+    }
+
+    // Weight of the shortest loop at a node in the direction of the target searches
+    EdgeWeight GetTargetLoopWeight(const NodeID node) const
+    {
+        EdgeWeight loop_weight = INVALID_EDGE_WEIGHT;
+        for (const auto edge : super::facade->GetAdjacentEdgeRange(node))
+        {
+            const auto &data = super::facade->GetEdgeData(edge);
+            if (IsTargetDirection(data) && super::facade->GetTarget(edge) == node)
+            {
+                loop_weight = std::min(loop_weight, data.distance);
+            }
+        }
+        return loop_weight;
+    }
+
+    // Finds the weights of the number_of_nearest closest targets within max_weight, all other
+    // targets get INVALID_EDGE_WEIGHT.
+    //
+    // The target search spaces are stored in buckets as in the many-to-many routing. The
+    // search from the source then scans the buckets in order of increasing distance and
+    // stops as soon as enough targets are settled, which keeps it local.
+    std::vector<EdgeWeight>
+    FindNearestTargets(const std::vector<std::reference_wrapper<const PhantomNode>> &targets,
+                       QueryHeap &forward_heap,
+                       QueryHeap &reverse_heap,
+                       const EdgeWeight min_edge_offset,
+                       const EdgeWeight min_target_offset,
+                       const EdgeWeight max_weight,
+                       const std::size_t number_of_nearest) const
+    {
+        std::unordered_map<NodeID, std::vector<std::pair<unsigned, EdgeWeight>>> buckets;
+        for (unsigned index = 0; index < targets.size(); ++index)
+        {
+            reverse_heap.Clear();
+            InsertPhantom(targets[index], TARGET_SIGN, false, reverse_heap);
+            while (!reverse_heap.Empty() && reverse_heap.MinKey() + min_edge_offset <= max_weight)
+            {
+                const NodeID node = reverse_heap.DeleteMin();
+                const EdgeWeight distance = reverse_heap.GetKey(node);
+                buckets[node].emplace_back(index, distance);
+                super::RelaxOrStall(node, distance, reverse_heap, !forward);
+            }
+        }
+
+        std::vector<EdgeWeight> weights(targets.size(), INVALID_EDGE_WEIGHT);
+        NearestQueue nearest_queue;
+        std::size_t number_of_final_targets = 0;
+        while (!forward_heap.Empty())
+        {
+            // every path that is still to be found is at least this long
+            const EdgeWeight min_weight = forward_heap.MinKey() + min_target_offset;
+            if (min_weight > max_weight)
+            {
+                break;
+            }
+
+            // targets below that weight are final, see ManyToManyRouting
+            while (!nearest_queue.empty() && nearest_queue.top().first < min_weight)
+            {
+                if (nearest_queue.top().first == weights[nearest_queue.top().second])
+                {
+                    ++number_of_final_targets;
+                }
+                nearest_queue.pop();
+            }
+            if (number_of_final_targets >= number_of_nearest)
+            {
+                break;
+            }
+
+            const NodeID node = forward_heap.DeleteMin();
+            const EdgeWeight distance = forward_heap.GetKey(node);
+
+            const auto bucket = buckets.find(node);
+            if (bucket != buckets.end())
+            {
+                for (const auto &entry : bucket->second)
+                {
+                    EdgeWeight new_weight = distance + entry.second;
+                    if (new_weight < 0)
+                    {
+                        // source and target phantom are on the same edge based node
+                        const EdgeWeight loop_weight = GetTargetLoopWeight(node);
+                        if (INVALID_EDGE_WEIGHT == loop_weight || new_weight + loop_weight < 0)
+                        {
+                            continue;
+                        }
+                        new_weight += loop_weight;
+                    }
+                    if (new_weight < weights[entry.first])
+                    {
+                        weights[entry.first] = new_weight;
+                        nearest_queue.emplace(new_weight, entry.first);
+                    }
+                }
+            }
+
+            super::RelaxOrStall(node, distance, forward_heap, forward);
+        }
+
+        forward_heap.Clear();
+        reverse_heap.Clear();
+
+        std::replace_if(weights.begin(),
+                        weights.end(),
+                        [max_weight](const EdgeWeight weight) { return weight > max_weight; },
+                        INVALID_EDGE_WEIGHT);
+        super::SelectNearest(weights.begin(), weights.size(), number_of_nearest);
+
+        return weights;
+    }
+
+    // Sweeps the target search spaces and reads the results of all targets off the labels.
+    // The source heap has to hold the settled upward search space of the source.
+    void SweepTargets(const PhantomNode &source,
+                      const std::vector<std::reference_wrapper<const PhantomNode>> &targets,
+                      const QueryHeap &source_heap,
+                      QueryHeap &label_heap,
+                      const bool calculate_distance,
+                      const bool with_lengths,
+                      const EdgeWeight max_weight,
+                      std::vector<std::pair<double, double>> &results) const
+    {
+        std::vector<NodeID> sweep_order;
+        SelectTargetSearchSpace(targets, label_heap, sweep_order);
+        SweepTargetSearchSpace(sweep_order, source_heap, label_heap, with_lengths);
+
+        for (auto const &target : targets)
+        {
+            results.emplace_back(FindSweptShortestPath(source, target, source_heap, label_heap,
+                                                       calculate_distance, with_lengths,
+                                                       max_weight));
+        }
+    }
+
+    // Propagates the distances of the source search space downwards in a single pass.
+    // A node keeps itself as parent if its label stems from the source search space,
+    // otherwise the parent is the upward neighbour the label was pulled from.
+    void SweepTargetSearchSpace(const std::vector<NodeID> &sweep_order,
+                                const QueryHeap &forward_heap,
+                                QueryHeap &label_heap,
+                                const bool with_lengths) const
+    {
+        for (const NodeID node : sweep_order)
+        {
+            EdgeWeight &distance = label_heap.GetKey(node);
+            HeapData &label = label_heap.GetData(node);
+
+            if (forward_heap.WasInserted(node))
+            {
+                distance = forward_heap.GetKey(node);
+                label = {node, forward_heap.GetData(node).length};
+            }
+
+            for (const auto edge : super::facade->GetAdjacentEdgeRange(node))
+            {
+                const auto &data = super::facade->GetEdgeData(edge);
+                if (!IsTargetDirection(data))
+                {
+                    continue;
+                }
+
+                const NodeID to = super::facade->GetTarget(edge);
+                const EdgeWeight to_distance = label_heap.GetKey(to);
+                if (to == node || INVALID_EDGE_WEIGHT == to_distance)
+                {
+                    continue;
+                }
+
+                BOOST_ASSERT_MSG(data.distance > 0, "edge_weight invalid");
+                const std::int32_t to_length =
+                    with_lengths ? label_heap.GetData(to).length + GetEdgeLength(edge) : 0;
+                if (IsShorter(to_distance + data.distance, to_length, distance, label.length))
+                {
+                    distance = to_distance + data.distance;
+                    label = {to, to_length};
+                }
+            }
+        }
+    }
+
+    // Reads the result for a single target off the swept labels.
+    std::pair<double, double> FindSweptShortestPath(const PhantomNode &source,
+                                                    const PhantomNode &target,
+                                                    const QueryHeap &forward_heap,
+                                                    QueryHeap &label_heap,
+                                                    const bool calculate_distance,
+                                                    const bool with_lengths,
+                                                    const EdgeWeight max_weight) const
+    {
+        // target segment the path ends at and the node the path enters it from
+        Meeting meeting{SPECIAL_NODEID, SPECIAL_NODEID, GetUpperBound(max_weight), 0};
+
+        const auto relax_target_segment = [&](const NodeID node, const EdgeWeight offset) {
+            const std::int32_t target_length =
+                with_lengths ? GetPhantomLength(target, node, TARGET_SIGN) : 0;
+
+            // source and target search spaces meet at the target segment itself
+            if (forward_heap.WasInserted(node))
+            {
+                UpdateMeetingAtNode(node,
+                                    forward_heap.GetKey(node) + offset,
+                                    forward_heap.GetData(node).length + target_length,
+                                    with_lengths,
+                                    meeting);
+            }
+
+            for (const auto edge : super::facade->GetAdjacentEdgeRange(node))
+            {
+                const auto &data = super::facade->GetEdgeData(edge);
+                if (!IsTargetDirection(data))
+                {
+                    continue;
+                }
+
+                const NodeID to = super::facade->GetTarget(edge);
+                const EdgeWeight to_distance = label_heap.GetKey(to);
+                if (to == node || INVALID_EDGE_WEIGHT == to_distance)
+                {
+                    continue;
+                }
+
+                const EdgeWeight new_distance = to_distance + data.distance + offset;
+                if (new_distance >= 0)
+                {
+                    const std::int32_t new_length =
+                        with_lengths
+                            ? label_heap.GetData(to).length + GetEdgeLength(edge) + target_length
+                            : 0;
+                    UpdateMeeting(node, to, new_distance, new_length, meeting);
+                }
+            }
+        };
+
+        if (target.forward_segment_id.enabled)
+        {
+            relax_target_segment(target.forward_segment_id.id,
+                                 TARGET_SIGN * target.GetForwardWeightPlusOffset());
+        }
+        if (target.reverse_segment_id.enabled)
+        {
+            relax_target_segment(target.reverse_segment_id.id,
+                                 TARGET_SIGN * target.GetReverseWeightPlusOffset());
+        }
+
+        // Check if no path could be found (-> early exit).
+        if (SPECIAL_NODEID == meeting.node)
+        {
+            return std::make_pair(INVALID_EDGE_WEIGHT, 0);
+        }
+
+        if (!calculate_distance || with_lengths)
+        {
+            return MakeResult(meeting);
+        }
+
+        // Walk up the sweep labels until the path leaves the source search space.
+        std::vector<NodeID> downward_path;
+        NodeID middle = meeting.via_node;
+        if (meeting.via_node != meeting.node)
+        {
+            downward_path.push_back(meeting.node);
+            while (label_heap.GetData(middle).parent != middle)
+            {
+                downward_path.push_back(middle);
+                middle = label_heap.GetData(middle).parent;
+            }
+        }
+
+        std::vector<NodeID> packed_path;
+        super::RetrievePackedPathFromSingleHeap(forward_heap, middle, packed_path);
+        std::reverse(begin(packed_path), end(packed_path));
+        packed_path.emplace_back(middle);
+        packed_path.insert(end(packed_path), downward_path.rbegin(), downward_path.rend());
+
+        return std::make_pair(static_cast<double>(meeting.weight) / 10.,
+                              ComputeDistance(source, target, packed_path));
+    }
+
     std::pair<double, double> FindShortestPath(const PhantomNode &source,
                                                const PhantomNode &target,
                                                QueryHeap &forward_heap,
                                                QueryHeap &backward_heap,
-                                               EdgeWeight min_edge_offset) const
+                                               const EdgeWeight min_edge_offset,
+                                               const bool calculate_distance,
+                                               const bool with_lengths,
+                                               const EdgeWeight max_weight) const
     {
-        NodeID middle = UINT_MAX;
-        int local_upper_bound = INT_MAX;
+        const Meeting meeting = FindMeeting(
+            target, forward_heap, backward_heap, min_edge_offset, with_lengths, max_weight);
+        return MakePathResult(source, target, meeting, forward_heap, backward_heap,
+                              calculate_distance, with_lengths);
+    }
+
+    // Runs the bidirectional search to a single target, the backward heap holds its search
+    // space afterwards. The meeting node is SPECIAL_NODEID if no path within max_weight exists.
+    Meeting FindMeeting(const PhantomNode &target,
+                        QueryHeap &forward_heap,
+                        QueryHeap &backward_heap,
+                        EdgeWeight min_edge_offset,
+                        const bool with_lengths,
+                        const EdgeWeight max_weight) const
+    {
+        Meeting meeting{SPECIAL_NODEID, SPECIAL_NODEID, GetUpperBound(max_weight), 0};
 
         // Clear backward heap from the entries produced by the search to the last target
         // and initialize heap for this target.
         backward_heap.Clear();
-        if (target.forward_segment_id.enabled)
-        {
-            EdgeWeight offset = (forward ? 1 : -1) * target.GetForwardWeightPlusOffset();
-            backward_heap.Insert(target.forward_segment_id.id, offset,
-                                 target.forward_segment_id.id);
-            min_edge_offset = std::min(min_edge_offset, offset);
-        }
+        min_edge_offset = std::min(min_edge_offset,
+                                   InsertPhantom(target, TARGET_SIGN, with_lengths, backward_heap));
 
-        if (target.reverse_segment_id.enabled)
-        {
-            EdgeWeight offset = (forward ? 1 : -1) * target.GetReverseWeightPlusOffset();
-            backward_heap.Insert(target.reverse_segment_id.id, offset,
-                                 target.reverse_segment_id.id);
-            min_edge_offset = std::min(min_edge_offset, offset);
-        }
+        // The forward heap is shared by all targets, so it is only pruned by max_weight and
+        // not by the upper bound of this target.
+        const auto forward_in_bound = [&] {
+            return 0 < forward_heap.Size() &&
+                   forward_heap.MinKey() + min_edge_offset <= max_weight;
+        };
+
+        // Settles the next node of a heap and checks whether the searches meet at it
+        const auto step = [&](QueryHeap &heap, QueryHeap &opposite_heap) {
+            const NodeID node = heap.DeleteMin();
+            const EdgeWeight distance = heap.GetKey(node);
+            if (opposite_heap.WasInserted(node))
+            {
+                UpdateMeetingAtNode(node,
+                                    distance + opposite_heap.GetKey(node),
+                                    heap.GetData(node).length + opposite_heap.GetData(node).length,
+                                    with_lengths,
+                                    meeting);
+            }
+            return std::make_pair(node, distance);
+        };
 
         // Execute bidirectional Dijkstra shortest path search.
-        while (0 < backward_heap.Size() || 0 < forward_heap.Size())
+        while (0 < backward_heap.Size() || forward_in_bound())
         {
-            if (0 < forward_heap.Size())
+            if (forward_in_bound())
             {
-                super::RoutingStep(forward_heap, backward_heap, middle, local_upper_bound,
-                                   min_edge_offset, forward, false, false, false, false);
+                const auto settled = step(forward_heap, backward_heap);
+                RelaxEdges(settled.first, forward_heap, forward, with_lengths);
             }
             if (0 < backward_heap.Size())
             {
-                super::RoutingStep(backward_heap, forward_heap, middle, local_upper_bound,
-                                   min_edge_offset, !forward, false, false, false);
+                const auto settled = step(backward_heap, forward_heap);
+                // make sure we don't terminate too early if we initialize the distance
+                // for the nodes in the heaps with the forward/reverse offset
+                if (settled.second + min_edge_offset > meeting.weight)
+                {
+                    backward_heap.DeleteAll();
+                }
+                else
+                {
+                    RelaxEdges(settled.first, backward_heap, !forward, with_lengths);
+                }
             }
         }
 
+        return meeting;
+    }
+
+    // Duration and distance of the path found by FindMeeting
+    std::pair<double, double> MakePathResult(const PhantomNode &source,
+                                             const PhantomNode &target,
+                                             const Meeting &meeting,
+                                             QueryHeap &forward_heap,
+                                             QueryHeap &backward_heap,
+                                             const bool calculate_distance,
+                                             const bool with_lengths) const
+    {
         // Check if no path could be found (-> early exit).
-        if (INVALID_EDGE_WEIGHT == local_upper_bound)
+        if (SPECIAL_NODEID == meeting.node)
         {
             return std::make_pair(INVALID_EDGE_WEIGHT, 0);
         }
 
-        // Calculate exact distance in km.
+        if (!calculate_distance || with_lengths)
+        {
+            return MakeResult(meeting);
+        }
+
         std::vector<NodeID> packed_path;
-        super::RetrievePackedPathFromHeap(forward_heap, backward_heap, middle, packed_path);
+        super::RetrievePackedPathFromHeap(forward_heap, backward_heap, meeting.node, packed_path);
+
+        return std::make_pair(static_cast<double>(meeting.weight) / 10.,
+                              ComputeDistance(source, target, packed_path));
+    }
+
+    // Duration in seconds and distance in meters of the path, the distance is zero if the
+    // lengths were not carried.
+    static std::pair<double, double> MakeResult(const Meeting &meeting)
+    {
+        // rounding the node lengths can make a path within a single node slightly negative
+        return std::make_pair(static_cast<double>(meeting.weight) / 10.,
+                              static_cast<double>(std::max(meeting.length, 0)) / 20.);
+    }
 
+    // Calculate the distance in meters by unpacking the path.
+    double ComputeDistance(const PhantomNode &source,
+                           const PhantomNode &target,
+                           std::vector<NodeID> &packed_path) const
+    {
         if (!forward)
         {
             std::reverse(begin(packed_path), end(packed_path));
         }
 
-        std::vector<PathData> unpacked_path;
-        if (forward)
-        {
-            super::UnpackPath(begin(packed_path), end(packed_path), 
-                              {source, target}, unpacked_path);
-        }
-        else
-        {
-            super::UnpackPath(begin(packed_path), end(packed_path), 
-                              {target, source}, unpacked_path);
-        }
+        const PhantomNode &path_source = forward ? source : target;
+        const PhantomNode &path_target = forward ? target : source;
+
+        return SumUnpackedPathLength(path_source, path_target, packed_path);
+    }
+
+    // Unpacks the path and sums up the distances between its coordinates.
+    double SumUnpackedPathLength(const PhantomNode &source,
+                                 const PhantomNode &target,
+                                 const std::vector<NodeID> &packed_path) const
+    {
+        PathDataList unpacked_path;
+        super::UnpackPath(begin(packed_path), end(packed_path), {source, target}, unpacked_path);
 
         std::vector<Coordinate> coordinates;
         coordinates.reserve(unpacked_path.size() + 2);
 
-        coordinates.emplace_back(forward ? source.location
-                                         : target.location);
+        coordinates.emplace_back(source.location);
         for (const auto &path_data : unpacked_path)
         {
             coordinates.emplace_back(super::facade->GetCoordinateOfNode(path_data.turn_via_node));
         }
-        coordinates.emplace_back(forward ? target.location
-                                         : source.location);
+        coordinates.emplace_back(target.location);
 
         double distance = 0.0;
         for (unsigned i = 1; i < coordinates.size(); ++i)
@@ -209,7 +1014,7 @@ class MultiTargetRouting final
                 util::coordinate_calculation::greatCircleDistance(coordinates[i - 1], coordinates[i]);
         }
 
-        return std::make_pair(static_cast<double>(local_upper_bound) / 10., distance);
+        return distance;
     }
 };
 }
@@ -5,6 +5,8 @@
 #include "engine/internal_route_result.hpp"
 #include "engine/search_engine_data.hpp"
 #include "util/coordinate_calculation.hpp"
+#include "util/landmark_potential.hpp"
+#include "util/shortcut_children.hpp"
 #include "util/typedefs.hpp"
 
 #include <boost/assert.hpp>
@@ -13,8 +15,10 @@
 #include <cstdint>
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
 #include <numeric>
+#include <queue>
 #include <stack>
 #include <utility>
 #include <vector>
@@ -42,6 +46,36 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
     BasicRoutingInterface(const BasicRoutingInterface &) = delete;
     BasicRoutingInterface &operator=(const BasicRoutingInterface &) = delete;
 
+    // Tentative distances of targets by increasing distance, used to find out when the
+    // nearest targets are settled. May contain outdated entries.
+    using NearestQueue = std::priority_queue<std::pair<EdgeWeight, unsigned>,
+                                             std::vector<std::pair<EdgeWeight, unsigned>>,
+                                             std::greater<std::pair<EdgeWeight, unsigned>>>;
+
+    // Keeps the number_of_nearest smallest of the weights, ties go to the smaller index.
+    // All other weights are set to INVALID_EDGE_WEIGHT.
+    static void SelectNearest(const std::vector<EdgeWeight>::iterator weights_begin,
+                              const std::size_t number_of_weights,
+                              const std::size_t number_of_nearest)
+    {
+        if (number_of_nearest >= number_of_weights)
+        {
+            return;
+        }
+
+        std::vector<unsigned> order(number_of_weights);
+        std::iota(order.begin(), order.end(), 0);
+        const auto closer = [weights_begin](const unsigned lhs, const unsigned rhs) {
+            return std::make_pair(weights_begin[lhs], lhs) <
+                   std::make_pair(weights_begin[rhs], rhs);
+        };
+        std::nth_element(order.begin(), order.begin() + number_of_nearest, order.end(), closer);
+        for (auto iter = order.begin() + number_of_nearest; iter != order.end(); ++iter)
+        {
+            weights_begin[*iter] = INVALID_EDGE_WEIGHT;
+        }
+    }
+
     /*
     min_edge_offset is needed in case we use multiple
     nodes as start/target nodes with different (even negative) offsets.
@@ -87,46 +121,16 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
 
         if (reverse_heap.WasInserted(node))
         {
-            const std::int32_t new_distance = reverse_heap.GetKey(node) + distance;
-            if (new_distance < upper_bound)
-            {
-                // if loops are forced, they are so at the source
-                if ((force_loop_forward && forward_heap.GetData(node).parent == node) ||
-                    (force_loop_reverse && reverse_heap.GetData(node).parent == node) ||
-                    // in this case we are looking at a bi-directional way where the source
-                    // and target phantom are on the same edge based node
-                    new_distance < 0)
-                {
-                    // check whether there is a loop present at the node
-                    for (const auto edge : facade->GetAdjacentEdgeRange(node))
-                    {
-                        const EdgeData &data = facade->GetEdgeData(edge);
-                        bool forward_directionFlag =
-                            (forward_direction ? data.forward : data.backward);
-                        if (forward_directionFlag)
-                        {
-                            const NodeID to = facade->GetTarget(edge);
-                            if (to == node)
-                            {
-                                const EdgeWeight edge_weight = data.distance;
-                                const std::int32_t loop_distance = new_distance + edge_weight;
-                                if (loop_distance >= 0 && loop_distance < upper_bound)
-                                {
-                                    middle_node_id = node;
-                                    upper_bound = loop_distance;
-                                }
-                            }
-                        }
-                    }
-                }
-                else
-                {
-                    BOOST_ASSERT(new_distance >= 0);
-
-                    middle_node_id = node;
-                    upper_bound = new_distance;
-                }
-            }
+            UpdateMeetingNode(node,
+                              reverse_heap.GetKey(node) + distance,
+                              IsLoopForced(node,
+                                           forward_heap,
+                                           reverse_heap,
+                                           force_loop_forward,
+                                           force_loop_reverse),
+                              forward_direction,
+                              middle_node_id,
+                              upper_bound);
         }
 
         // make sure we don't terminate too early if we initialize the distance
@@ -138,75 +142,154 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
             return true;
         }
 
-        // Stalling
-        if (stalling)
+        RelaxOrStall(node, distance, forward_heap, forward_direction, stalling);
+        return false;
+    }
+
+    // if loops are forced, they are so at the source
+    static bool IsLoopForced(const NodeID node,
+                             const SearchEngineData::QueryHeap &forward_heap,
+                             const SearchEngineData::QueryHeap &reverse_heap,
+                             const bool force_loop_forward,
+                             const bool force_loop_reverse)
+    {
+        return (force_loop_forward && forward_heap.GetData(node).parent == node) ||
+               (force_loop_reverse && reverse_heap.GetData(node).parent == node);
+    }
+
+    // Takes the path of length new_distance meeting at node if it is shorter than the best one
+    // found so far.
+    void UpdateMeetingNode(const NodeID node,
+                           const std::int32_t new_distance,
+                           const bool loop_forced,
+                           const bool forward_direction,
+                           NodeID &middle_node_id,
+                           std::int32_t &upper_bound) const
+    {
+        if (new_distance >= upper_bound)
+        {
+            return;
+        }
+
+        // in case of a negative distance we are looking at a bi-directional way where the
+        // source and target phantom are on the same edge based node
+        if (loop_forced || new_distance < 0)
         {
-            for (const auto edge : facade->GetAdjacentEdgeRange(node))
+            // check whether there is a loop present at the node
+            const auto edges = facade->GetDirectedEdgeRanges(node);
+            for (const auto edge : forward_direction ? edges.Forward() : edges.Backward())
             {
-                const EdgeData &data = facade->GetEdgeData(edge);
-                const bool reverse_flag = ((!forward_direction) ? data.forward : data.backward);
-                if (reverse_flag)
+                const NodeID to = facade->GetTarget(edge);
+                if (to == node)
                 {
-                    const NodeID to = facade->GetTarget(edge);
-                    const EdgeWeight edge_weight = data.distance;
-
-                    BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
-
-                    if (forward_heap.WasInserted(to))
+                    const EdgeWeight edge_weight = facade->GetEdgeData(edge).distance;
+                    const std::int32_t loop_distance = new_distance + edge_weight;
+                    if (loop_distance >= 0 && loop_distance < upper_bound)
                     {
-                        if (forward_heap.GetKey(to) + edge_weight < distance)
-                        {
-                            return false;
-                        }
+                        middle_node_id = node;
+                        upper_bound = loop_distance;
                     }
                 }
             }
         }
-
-        for (const auto edge : facade->GetAdjacentEdgeRange(node))
+        else
         {
+            BOOST_ASSERT(new_distance >= 0);
+
+            middle_node_id = node;
+            upper_bound = new_distance;
+        }
+    }
+
+    // Relaxes the edges of a node in the search direction unless the node can be stalled,
+    // returns true if it was stalled.
+    //
+    // Stalling and relaxing share a single pass over the edges. The edges of the opposite
+    // direction stall the node, they overlap with the edges of the search direction in the
+    // bidirectional ones. The pass starts with the edges that can only stall, so a stalled
+    // node is mostly left before anything was relaxed. Edges relaxed before a stall are
+    // harmless, their distances are lengths of actual paths.
+    bool RelaxOrStall(const NodeID node,
+                      const EdgeWeight distance,
+                      SearchEngineData::QueryHeap &heap,
+                      const bool forward_direction,
+                      const bool stalling = true) const
+    {
+        const auto stall_or_relax = [&](const EdgeID edge, const bool stall, const bool relax) {
             const EdgeData &data = facade->GetEdgeData(edge);
-            bool forward_directionFlag = (forward_direction ? data.forward : data.backward);
-            if (forward_directionFlag)
-            {
+            const NodeID to = facade->GetTarget(edge);
+            const EdgeWeight edge_weight = data.distance;
 
-                const NodeID to = facade->GetTarget(edge);
-                const EdgeWeight edge_weight = data.distance;
+            BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
 
-                BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
-                const int to_distance = distance + edge_weight;
+            if (stall && heap.WasInserted(to) && heap.GetKey(to) + edge_weight < distance)
+            {
+                return true;
+            }
+
+            if (relax)
+            {
+                const EdgeWeight to_distance = distance + edge_weight;
 
                 // New Node discovered -> Add to Heap + Node Info Storage
-                if (!forward_heap.WasInserted(to))
+                if (!heap.WasInserted(to))
                 {
-                    forward_heap.Insert(to, to_distance, node);
+                    heap.Insert(to, to_distance, node);
                 }
                 // Found a shorter Path -> Update distance
-                else if (to_distance < forward_heap.GetKey(to))
+                else if (to_distance < heap.GetKey(to))
                 {
                     // new parent
-                    forward_heap.GetData(to).parent = node;
-                    forward_heap.DecreaseKey(to, to_distance);
+                    heap.GetData(to).parent = node;
+                    heap.DecreaseKey(to, to_distance);
                 }
             }
-        }
+            return false;
+        };
 
+        const auto edges = facade->GetDirectedEdgeRanges(node);
+        if (forward_direction)
+        {
+            // stalled by [first_bidirectional, end), relaxes [begin, first_backward_only)
+            for (auto edge = stalling ? edges.end : edges.first_backward_only;
+                 edge != edges.begin;)
+            {
+                --edge;
+                if (stall_or_relax(edge,
+                                   stalling && edge >= edges.first_bidirectional,
+                                   edge < edges.first_backward_only))
+                {
+                    return true;
+                }
+            }
+        }
+        else
+        {
+            // stalled by [begin, first_backward_only), relaxes [first_bidirectional, end)
+            for (auto edge = stalling ? edges.begin : edges.first_bidirectional;
+                 edge != edges.end;
+                 ++edge)
+            {
+                if (stall_or_relax(edge,
+                                   stalling && edge < edges.first_backward_only,
+                                   edge >= edges.first_bidirectional))
+                {
+                    return true;
+                }
+            }
+        }
         return false;
     }
 
     inline EdgeWeight GetLoopWeight(NodeID node) const
     {
         EdgeWeight loop_weight = INVALID_EDGE_WEIGHT;
-        for (auto edge : facade->GetAdjacentEdgeRange(node))
+        for (auto edge : facade->GetDirectedEdgeRanges(node).Forward())
         {
-            const auto &data = facade->GetEdgeData(edge);
-            if (data.forward)
+            const NodeID to = facade->GetTarget(edge);
+            if (to == node)
             {
-                const NodeID to = facade->GetTarget(edge);
-                if (to == node)
-                {
-                    loop_weight = std::min(loop_weight, data.distance);
-                }
+                loop_weight = std::min(loop_weight, facade->GetEdgeData(edge).distance);
             }
         }
         return loop_weight;
@@ -216,7 +299,7 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
     void UnpackPath(RandomIter packed_path_begin,
                     RandomIter packed_path_end,
                     const PhantomNodes &phantom_node_pair,
-                    std::vector<PathData> &unpacked_path) const
+                    PathDataList &unpacked_path) const
     {
         const bool start_traversed_in_reverse =
             (*packed_path_begin != phantom_node_pair.source_phantom.forward_segment_id.id);
@@ -224,14 +307,9 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
             (*std::prev(packed_path_end) != phantom_node_pair.target_phantom.forward_segment_id.id);
 
         BOOST_ASSERT(std::distance(packed_path_begin, packed_path_end) > 0);
-        std::stack<std::pair<NodeID, NodeID>> recursion_stack;
-
-        // We have to push the path in reverse order onto the stack because it's LIFO.
-        for (auto current = std::prev(packed_path_end); current != packed_path_begin;
-             current = std::prev(current))
-        {
-            recursion_stack.emplace(*std::prev(current), *current);
-        }
+        auto &buffer = SearchEngineData::GetUnpackingBuffer();
+        auto &id_vector = buffer.geometry;
+        auto &weight_vector = buffer.weights;
 
         BOOST_ASSERT(*packed_path_begin == phantom_node_pair.source_phantom.forward_segment_id.id ||
                      *packed_path_begin == phantom_node_pair.source_phantom.reverse_segment_id.id);
@@ -239,61 +317,19 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
             *std::prev(packed_path_end) == phantom_node_pair.target_phantom.forward_segment_id.id ||
             *std::prev(packed_path_end) == phantom_node_pair.target_phantom.reverse_segment_id.id);
 
-        std::pair<NodeID, NodeID> edge;
-        while (!recursion_stack.empty())
+        PushPackedPath(packed_path_begin, packed_path_end, buffer.stack);
+        while (!buffer.stack.empty())
         {
-            // edge.first         edge.second
-            //     *------------------>*
-            //            edge_id
-            edge = recursion_stack.top();
-            recursion_stack.pop();
+            const PackedPathEdge edge = buffer.stack.back();
+            buffer.stack.pop_back();
 
-            // Contraction might introduce double edges by inserting shortcuts
-            // this searching for the smallest upwards edge found by the forward search
-            EdgeID smaller_edge_id = SPECIAL_EDGEID;
-            EdgeWeight edge_weight = std::numeric_limits<EdgeWeight>::max();
-            for (const auto edge_id : facade->GetAdjacentEdgeRange(edge.first))
-            {
-                const EdgeWeight weight = facade->GetEdgeData(edge_id).distance;
-                if ((facade->GetTarget(edge_id) == edge.second) && (weight < edge_weight) &&
-                    facade->GetEdgeData(edge_id).forward)
-                {
-                    smaller_edge_id = edge_id;
-                    edge_weight = weight;
-                }
-            }
-
-            // edge.first         edge.second
-            //     *<------------------*
-            //            edge_id
-            // if we don't find a forward edge, this edge must have been an downwards edge
-            // found by the reverse search.
-            if (SPECIAL_EDGEID == smaller_edge_id)
-            {
-                for (const auto edge_id : facade->GetAdjacentEdgeRange(edge.second))
-                {
-                    const EdgeWeight weight = facade->GetEdgeData(edge_id).distance;
-                    if ((facade->GetTarget(edge_id) == edge.first) && (weight < edge_weight) &&
-                        facade->GetEdgeData(edge_id).backward)
-                    {
-                        smaller_edge_id = edge_id;
-                        edge_weight = weight;
-                    }
-                }
-            }
-            BOOST_ASSERT_MSG(edge_weight != INVALID_EDGE_WEIGHT, "edge id invalid");
-
-            const EdgeData &ed = facade->GetEdgeData(smaller_edge_id);
+            const EdgeData &ed = facade->GetEdgeData(edge.edge);
             if (ed.shortcut)
-            { // unpack
-                const NodeID middle_node_id = ed.id;
-                // again, we need to this in reversed order
-                recursion_stack.emplace(middle_node_id, edge.second);
-                recursion_stack.emplace(edge.first, middle_node_id);
+            {
+                PushShortcutChildren(edge, ed.id, buffer.stack);
             }
             else
             {
-                BOOST_ASSERT_MSG(!ed.shortcut, "original edge flagged as shortcut");
                 unsigned name_index = facade->GetNameIndexFromEdgeID(ed.id);
                 const auto turn_instruction = facade->GetTurnInstructionForEdgeID(ed.id);
                 const extractor::TravelMode travel_mode =
@@ -301,12 +337,10 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
                         ? phantom_node_pair.source_phantom.backward_travel_mode
                         : facade->GetTravelModeForEdgeID(ed.id);
 
-                std::vector<NodeID> id_vector;
                 facade->GetUncompressedGeometry(facade->GetGeometryIndexForEdgeID(ed.id),
                                                 id_vector);
                 BOOST_ASSERT(id_vector.size() > 0);
 
-                std::vector<EdgeWeight> weight_vector;
                 facade->GetUncompressedWeights(facade->GetGeometryIndexForEdgeID(ed.id),
                                                weight_vector);
                 BOOST_ASSERT(weight_vector.size() > 0);
@@ -348,8 +382,6 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
             }
         }
         std::size_t start_index = 0, end_index = 0;
-        std::vector<unsigned> id_vector;
-        std::vector<EdgeWeight> weight_vector;
         const bool is_local_path = (phantom_node_pair.source_phantom.forward_packed_geometry_id ==
                                     phantom_node_pair.target_phantom.forward_packed_geometry_id) &&
                                    unpacked_path.empty();
@@ -449,61 +481,63 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
 
     void UnpackEdge(const NodeID s, const NodeID t, std::vector<NodeID> &unpacked_path) const
     {
-        std::stack<std::pair<NodeID, NodeID>> recursion_stack;
-        recursion_stack.emplace(s, t);
+        auto &stack = SearchEngineData::GetUnpackingBuffer().stack;
+        const NodeID packed_path[] = {s, t};
+        PushPackedPath(std::begin(packed_path), std::end(packed_path), stack);
 
-        std::pair<NodeID, NodeID> edge;
-        while (!recursion_stack.empty())
+        while (!stack.empty())
         {
-            edge = recursion_stack.top();
-            recursion_stack.pop();
+            const PackedPathEdge edge = stack.back();
+            stack.pop_back();
 
-            EdgeID smaller_edge_id = SPECIAL_EDGEID;
-            EdgeWeight edge_weight = std::numeric_limits<EdgeWeight>::max();
-            for (const auto edge_id : facade->GetAdjacentEdgeRange(edge.first))
-            {
-                const EdgeWeight weight = facade->GetEdgeData(edge_id).distance;
-                if ((facade->GetTarget(edge_id) == edge.second) && (weight < edge_weight) &&
-                    facade->GetEdgeData(edge_id).forward)
-                {
-                    smaller_edge_id = edge_id;
-                    edge_weight = weight;
-                }
-            }
-
-            if (SPECIAL_EDGEID == smaller_edge_id)
-            {
-                for (const auto edge_id : facade->GetAdjacentEdgeRange(edge.second))
-                {
-                    const EdgeWeight weight = facade->GetEdgeData(edge_id).distance;
-                    if ((facade->GetTarget(edge_id) == edge.first) && (weight < edge_weight) &&
-                        facade->GetEdgeData(edge_id).backward)
-                    {
-                        smaller_edge_id = edge_id;
-                        edge_weight = weight;
-                    }
-                }
-            }
-            BOOST_ASSERT_MSG(edge_weight != std::numeric_limits<EdgeWeight>::max(),
-                             "edge weight invalid");
-
-            const EdgeData &ed = facade->GetEdgeData(smaller_edge_id);
+            const EdgeData &ed = facade->GetEdgeData(edge.edge);
             if (ed.shortcut)
-            { // unpack
-                const NodeID middle_node_id = ed.id;
-                // again, we need to this in reversed order
-                recursion_stack.emplace(middle_node_id, edge.second);
-                recursion_stack.emplace(edge.first, middle_node_id);
+            {
+                PushShortcutChildren(edge, ed.id, stack);
             }
             else
             {
-                BOOST_ASSERT_MSG(!ed.shortcut, "edge must be shortcut");
-                unpacked_path.emplace_back(edge.first);
+                unpacked_path.emplace_back(edge.from);
             }
         }
         unpacked_path.emplace_back(t);
     }
 
+    // Resolves the edges between the nodes of a packed path and pushes them in reverse order, so
+    // the first one is on top of the stack
+    template <typename RandomIter>
+    void PushPackedPath(RandomIter packed_path_begin,
+                        RandomIter packed_path_end,
+                        std::vector<PackedPathEdge> &stack) const
+    {
+        stack.clear();
+        for (auto current = std::prev(packed_path_end); current != packed_path_begin;
+             current = std::prev(current))
+        {
+            const NodeID from = *std::prev(current);
+            const NodeID to = *current;
+            const EdgeID edge = util::FindPackedPathEdge(*facade, from, to);
+            BOOST_ASSERT_MSG(edge != SPECIAL_EDGEID, "edge id invalid");
+            stack.push_back(PackedPathEdge{from, to, edge});
+        }
+    }
+
+    // Replaces a shortcut by the edges it was made of. No adjacency has to be searched, the
+    // children were resolved when the graph was loaded.
+    void PushShortcutChildren(const PackedPathEdge &shortcut,
+                              const NodeID middle_node_id,
+                              std::vector<PackedPathEdge> &stack) const
+    {
+        // A shortcut is stored at its source, used backward it leads from its target to it
+        const bool forward = facade->GetTarget(shortcut.edge) == shortcut.to;
+        const auto children = facade->GetShortcutChildren(shortcut.edge, forward);
+        BOOST_ASSERT_MSG(children.first != SPECIAL_EDGEID && children.second != SPECIAL_EDGEID,
+                         "shortcut child invalid");
+        // again, we need to this in reversed order
+        stack.push_back(PackedPathEdge{middle_node_id, shortcut.to, children.second});
+        stack.push_back(PackedPathEdge{shortcut.from, middle_node_id, children.first});
+    }
+
     void RetrievePackedPathFromHeap(const SearchEngineData::QueryHeap &forward_heap,
                                     const SearchEngineData::QueryHeap &reverse_heap,
                                     const NodeID middle_node_id,
@@ -637,7 +671,6 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
         NodeID middle = SPECIAL_NODEID;
         distance = duration_upper_bound;
 
-        using CoreEntryPoint = std::tuple<NodeID, EdgeWeight, NodeID>;
         std::vector<CoreEntryPoint> forward_entry_points;
         std::vector<CoreEntryPoint> reverse_entry_points;
 
@@ -694,26 +727,124 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
             }
         }
 
-        const auto insertInCoreHeap =
-            [](const CoreEntryPoint &p, SearchEngineData::QueryHeap &core_heap) {
-                NodeID id;
-                EdgeWeight weight;
-                NodeID parent;
-                // TODO this should use std::apply when we get c++17 support
-                std::tie(id, weight, parent) = p;
-                core_heap.Insert(id, weight, parent);
-            };
+        // distance of the path over middle through the core, the core heap keys include the
+        // potentials if the core was searched goal directed
+        std::int32_t middle_core_distance = 0;
+        if (facade->GetNumberOfLandmarks() > 0)
+        {
+            LandmarkCoreSearch(forward_core_heap,
+                               reverse_core_heap,
+                               forward_entry_points,
+                               reverse_entry_points,
+                               middle,
+                               distance,
+                               middle_core_distance,
+                               force_loop_forward,
+                               force_loop_reverse);
+        }
+        else
+        {
+            CoreSearch(forward_core_heap,
+                       reverse_core_heap,
+                       forward_entry_points,
+                       reverse_entry_points,
+                       middle,
+                       distance,
+                       force_loop_forward,
+                       force_loop_reverse);
+            if (middle != SPECIAL_NODEID && facade->IsCoreNode(middle))
+            {
+                middle_core_distance =
+                    forward_core_heap.GetKey(middle) + reverse_core_heap.GetKey(middle);
+            }
+        }
+
+        // No path found for both target nodes?
+        if (duration_upper_bound <= distance || SPECIAL_NODEID == middle)
+        {
+            distance = INVALID_EDGE_WEIGHT;
+            return;
+        }
+
+        // Was a paths over one of the forward/reverse nodes not found?
+        BOOST_ASSERT_MSG((SPECIAL_NODEID != middle && INVALID_EDGE_WEIGHT != distance),
+                         "no path found");
+
+        // we need to unpack sub path from core heaps
+        if (facade->IsCoreNode(middle))
+        {
+            if (distance != middle_core_distance)
+            {
+                // self loop
+                BOOST_ASSERT(forward_core_heap.GetData(middle).parent == middle &&
+                             reverse_core_heap.GetData(middle).parent == middle);
+                packed_leg.push_back(middle);
+                packed_leg.push_back(middle);
+            }
+            else
+            {
+                std::vector<NodeID> packed_core_leg;
+                RetrievePackedPathFromHeap(
+                    forward_core_heap, reverse_core_heap, middle, packed_core_leg);
+                BOOST_ASSERT(packed_core_leg.size() > 0);
+                RetrievePackedPathFromSingleHeap(forward_heap, packed_core_leg.front(), packed_leg);
+                std::reverse(packed_leg.begin(), packed_leg.end());
+                packed_leg.insert(packed_leg.end(), packed_core_leg.begin(), packed_core_leg.end());
+                RetrievePackedPathFromSingleHeap(reverse_heap, packed_core_leg.back(), packed_leg);
+            }
+        }
+        else
+        {
+            if (distance != forward_heap.GetKey(middle) + reverse_heap.GetKey(middle))
+            {
+                // self loop
+                BOOST_ASSERT(forward_heap.GetData(middle).parent == middle &&
+                             reverse_heap.GetData(middle).parent == middle);
+                packed_leg.push_back(middle);
+                packed_leg.push_back(middle);
+            }
+            else
+            {
+                RetrievePackedPathFromHeap(forward_heap, reverse_heap, middle, packed_leg);
+            }
+        }
+    }
+
+    // Node the search entered the core at, its distance and its parent outside of the core
+    using CoreEntryPoint = std::tuple<NodeID, EdgeWeight, NodeID>;
+
+    static void InsertInCoreHeap(const CoreEntryPoint &p,
+                                 const EdgeWeight weight_offset,
+                                 SearchEngineData::QueryHeap &core_heap)
+    {
+        NodeID id;
+        EdgeWeight weight;
+        NodeID parent;
+        // TODO this should use std::apply when we get c++17 support
+        std::tie(id, weight, parent) = p;
+        core_heap.Insert(id, weight + weight_offset, parent);
+    }
 
+    // Plain bidirectional Dijkstra search on the core between the entry points
+    void CoreSearch(SearchEngineData::QueryHeap &forward_core_heap,
+                    SearchEngineData::QueryHeap &reverse_core_heap,
+                    const std::vector<CoreEntryPoint> &forward_entry_points,
+                    const std::vector<CoreEntryPoint> &reverse_entry_points,
+                    NodeID &middle,
+                    int &distance,
+                    const bool force_loop_forward,
+                    const bool force_loop_reverse) const
+    {
         forward_core_heap.Clear();
         for (const auto &p : forward_entry_points)
         {
-            insertInCoreHeap(p, forward_core_heap);
+            InsertInCoreHeap(p, 0, forward_core_heap);
         }
 
         reverse_core_heap.Clear();
         for (const auto &p : reverse_entry_points)
         {
-            insertInCoreHeap(p, reverse_core_heap);
+            InsertInCoreHeap(p, 0, reverse_core_heap);
         }
 
         // get offset to account for offsets on phantom nodes on compressed edges
@@ -753,56 +884,126 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
                         force_loop_reverse,
                         force_loop_forward);
         }
+    }
 
-        // No path found for both target nodes?
-        if (duration_upper_bound <= distance || SPECIAL_NODEID == middle)
+    // Bidirectional ALT search on the core between the entry points. Each direction adds a
+    // landmark lower bound of the distance to the entry points of the other one to its keys,
+    // which settles the nodes towards them first. Both bounds are consistent, a direction can
+    // stop once its smallest key reaches the best distance found.
+    void LandmarkCoreSearch(SearchEngineData::QueryHeap &forward_core_heap,
+                            SearchEngineData::QueryHeap &reverse_core_heap,
+                            const std::vector<CoreEntryPoint> &forward_entry_points,
+                            const std::vector<CoreEntryPoint> &reverse_entry_points,
+                            NodeID &middle,
+                            int &distance,
+                            std::int32_t &middle_distance,
+                            const bool force_loop_forward,
+                            const bool force_loop_reverse) const
+    {
+        const auto number_of_landmarks = facade->GetNumberOfLandmarks();
+        util::LandmarkPotential forward_potential(number_of_landmarks, true);
+        util::LandmarkPotential reverse_potential(number_of_landmarks, false);
+        for (const auto &p : reverse_entry_points)
         {
-            distance = INVALID_EDGE_WEIGHT;
-            return;
+            forward_potential.AddGoal(facade->GetLandmarkDistances(std::get<0>(p)),
+                                      std::get<1>(p));
         }
-
-        // Was a paths over one of the forward/reverse nodes not found?
-        BOOST_ASSERT_MSG((SPECIAL_NODEID != middle && INVALID_EDGE_WEIGHT != distance),
-                         "no path found");
-
-        // we need to unpack sub path from core heaps
-        if (facade->IsCoreNode(middle))
+        for (const auto &p : forward_entry_points)
         {
-            if (distance != forward_core_heap.GetKey(middle) + reverse_core_heap.GetKey(middle))
+            reverse_potential.AddGoal(facade->GetLandmarkDistances(std::get<0>(p)),
+                                      std::get<1>(p));
+        }
+
+        const auto initialize = [this](const std::vector<CoreEntryPoint> &entry_points,
+                                       const util::LandmarkPotential &potential,
+                                       SearchEngineData::QueryHeap &core_heap) {
+            core_heap.Clear();
+            for (const auto &p : entry_points)
             {
-                // self loop
-                BOOST_ASSERT(forward_core_heap.GetData(middle).parent == middle &&
-                             reverse_core_heap.GetData(middle).parent == middle);
-                packed_leg.push_back(middle);
-                packed_leg.push_back(middle);
+                const auto node_potential =
+                    potential(facade->GetLandmarkDistances(std::get<0>(p)));
+                if (node_potential != INVALID_EDGE_WEIGHT)
+                {
+                    InsertInCoreHeap(p, node_potential, core_heap);
+                }
             }
-            else
+        };
+        initialize(forward_entry_points, forward_potential, forward_core_heap);
+        initialize(reverse_entry_points, reverse_potential, reverse_core_heap);
+
+        // distance of a node from the entry points of a direction
+        const auto get_distance = [this](SearchEngineData::QueryHeap &core_heap,
+                                         const util::LandmarkPotential &potential,
+                                         const NodeID node) {
+            return core_heap.GetKey(node) - potential(facade->GetLandmarkDistances(node));
+        };
+
+        const auto step = [&](SearchEngineData::QueryHeap &heap,
+                              const util::LandmarkPotential &potential,
+                              SearchEngineData::QueryHeap &opposite_heap,
+                              const util::LandmarkPotential &opposite_potential,
+                              const bool forward_direction) {
+            const NodeID node = heap.DeleteMin();
+            const std::int32_t node_distance = get_distance(heap, potential, node);
+
+            if (opposite_heap.WasInserted(node))
             {
-                std::vector<NodeID> packed_core_leg;
-                RetrievePackedPathFromHeap(
-                    forward_core_heap, reverse_core_heap, middle, packed_core_leg);
-                BOOST_ASSERT(packed_core_leg.size() > 0);
-                RetrievePackedPathFromSingleHeap(forward_heap, packed_core_leg.front(), packed_leg);
-                std::reverse(packed_leg.begin(), packed_leg.end());
-                packed_leg.insert(packed_leg.end(), packed_core_leg.begin(), packed_core_leg.end());
-                RetrievePackedPathFromSingleHeap(reverse_heap, packed_core_leg.back(), packed_leg);
+                const auto &forward_heap = forward_direction ? heap : opposite_heap;
+                const auto &reverse_heap = forward_direction ? opposite_heap : heap;
+                UpdateMeetingNode(
+                    node,
+                    node_distance + get_distance(opposite_heap, opposite_potential, node),
+                    IsLoopForced(
+                        node, forward_heap, reverse_heap, force_loop_forward, force_loop_reverse),
+                    forward_direction,
+                    middle,
+                    distance);
             }
-        }
-        else
-        {
-            if (distance != forward_heap.GetKey(middle) + reverse_heap.GetKey(middle))
+
+            const auto edges = facade->GetDirectedEdgeRanges(node);
+            for (const auto edge : forward_direction ? edges.Forward() : edges.Backward())
             {
-                // self loop
-                BOOST_ASSERT(forward_heap.GetData(middle).parent == middle &&
-                             reverse_heap.GetData(middle).parent == middle);
-                packed_leg.push_back(middle);
-                packed_leg.push_back(middle);
+                const NodeID to = facade->GetTarget(edge);
+                const auto to_potential = potential(facade->GetLandmarkDistances(to));
+                if (to_potential == INVALID_EDGE_WEIGHT)
+                {
+                    continue;
+                }
+
+                const EdgeWeight edge_weight = facade->GetEdgeData(edge).distance;
+                BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
+                const EdgeWeight to_key = node_distance + edge_weight + to_potential;
+                if (!heap.WasInserted(to))
+                {
+                    heap.Insert(to, to_key, node);
+                }
+                else if (!heap.WasRemoved(to) && to_key < heap.GetKey(to))
+                {
+                    heap.GetData(to).parent = node;
+                    heap.DecreaseKey(to, to_key);
+                }
             }
-            else
+        };
+
+        while (!forward_core_heap.Empty() && !reverse_core_heap.Empty() &&
+               forward_core_heap.MinKey() < distance && reverse_core_heap.MinKey() < distance)
+        {
+            step(forward_core_heap, forward_potential, reverse_core_heap, reverse_potential, true);
+            if (!reverse_core_heap.Empty() && reverse_core_heap.MinKey() < distance)
             {
-                RetrievePackedPathFromHeap(forward_heap, reverse_heap, middle, packed_leg);
+                step(reverse_core_heap,
+                     reverse_potential,
+                     forward_core_heap,
+                     forward_potential,
+                     false);
             }
         }
+
+        if (middle != SPECIAL_NODEID && facade->IsCoreNode(middle))
+        {
+            middle_distance = get_distance(forward_core_heap, forward_potential, middle) +
+                              get_distance(reverse_core_heap, reverse_potential, middle);
+        }
     }
 
     bool NeedsLoopForward(const PhantomNode &source_phantom,
@@ -829,7 +1030,7 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
                            const PhantomNode &source_phantom,
                            const PhantomNode &target_phantom) const
     {
-        std::vector<PathData> unpacked_path;
+        PathDataList unpacked_path;
         PhantomNodes nodes;
         nodes.source_phantom = source_phantom;
         nodes.target_phantom = target_phantom;
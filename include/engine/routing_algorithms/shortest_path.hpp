@@ -248,7 +248,7 @@ class ShortestPathRouting final
                     const int shortest_path_length,
                     InternalRouteResult &raw_route_data) const
     {
-        raw_route_data.unpacked_path_segments.resize(packed_leg_begin.size() - 1);
+        raw_route_data.ResizeUnpackedPathSegments(packed_leg_begin.size() - 1);
 
         raw_route_data.shortest_path_length = shortest_path_length;
 
@@ -3,9 +3,16 @@
 
 #include <boost/thread/tss.hpp>
 
+#include "engine/heap_pool.hpp"
+#include "util/arena.hpp"
 #include "util/binary_heap.hpp"
+#include "util/d_ary_heap.hpp"
 #include "util/typedefs.hpp"
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 namespace osrm
 {
 namespace engine
@@ -14,14 +21,32 @@ namespace engine
 struct HeapData
 {
     NodeID parent;
-    /* explicit */ HeapData(NodeID p) : parent(p) {}
+    // Length of the path to the node, only carried by searches that need it. See
+    // routing_algorithms::MultiTargetRouting for the unit.
+    std::int32_t length;
+    /* explicit */ HeapData(NodeID p, std::int32_t length = 0) : parent(p), length(length) {}
+};
+
+// Edge between two nodes of a packed path that is still to be unpacked
+struct PackedPathEdge
+{
+    NodeID from;
+    NodeID to;
+    EdgeID edge;
 };
 
 struct SearchEngineData
 {
+    // util::BinaryHeap is a drop-in replacement, src/benchmarks/query_heap.cpp compares both.
+    // The generation storage clears in O(1) and only allocates the pages a search touched.
     using QueryHeap =
-        util::BinaryHeap<NodeID, NodeID, int, HeapData, util::UnorderedMapStorage<NodeID, int>>;
+        util::DAryHeap<NodeID, NodeID, int, HeapData, util::GenerationStorage<NodeID, NodeID>>;
     using SearchEngineHeapPtr = boost::thread_specific_ptr<QueryHeap>;
+    using QueryHeapPool = HeapPool<QueryHeap>;
+
+    // The thread local pointers only hold heaps checked out of heap_pool for the request that
+    // is running on the thread. Resetting them, or the thread exiting, returns the heaps.
+    static QueryHeapPool heap_pool;
 
     static SearchEngineHeapPtr forward_heap_1;
     static SearchEngineHeapPtr reverse_heap_1;
@@ -30,11 +55,73 @@ struct SearchEngineData
     static SearchEngineHeapPtr forward_heap_3;
     static SearchEngineHeapPtr reverse_heap_3;
 
-    void InitializeOrClearFirstThreadLocalStorage(const unsigned number_of_nodes);
+    // Scratch space of the path unpacking. Unlike the heaps it is small and stays with the thread.
+    struct UnpackingBuffer
+    {
+        std::vector<PackedPathEdge> stack;
+        std::vector<NodeID> geometry;
+        std::vector<EdgeWeight> weights;
+    };
+    using UnpackingBufferPtr = boost::thread_specific_ptr<UnpackingBuffer>;
+
+    static UnpackingBufferPtr unpacking_buffer;
+
+    // Buffer of the calling thread, created on first use
+    static UnpackingBuffer &GetUnpackingBuffer();
+
+    // Memory for the route results of the request running on the thread. Everything allocated
+    // from it is freed at once when the RequestArenaScope of the request ends.
+    using RequestArenaPtr = boost::thread_specific_ptr<util::Arena>;
+
+    static RequestArenaPtr request_arena;
+
+    // Arena of the calling thread, created on first use
+    static util::Arena &GetRequestArena();
+
+    struct RequestArenaScope
+    {
+        RequestArenaScope() = default;
+        RequestArenaScope(const RequestArenaScope &) = delete;
+        RequestArenaScope &operator=(const RequestArenaScope &) = delete;
+        ~RequestArenaScope() { GetRequestArena().Release(); }
+    };
+
+    // Searches that settle large parts of the graph ask for full-size heaps, see HeapPool
+    void InitializeOrClearFirstThreadLocalStorage(const unsigned number_of_nodes,
+                                                  const HeapSize expected_size = HeapSize::Sparse);
 
     void InitializeOrClearSecondThreadLocalStorage(const unsigned number_of_nodes);
 
     void InitializeOrClearThirdThreadLocalStorage(const unsigned number_of_nodes);
+
+    // Returns the heaps of the calling thread to heap_pool
+    static void ReleaseThreadLocalStorage();
+
+    // Releases the heaps of the calling thread when a request or a task of it ends
+    struct ThreadLocalStorageScope
+    {
+        ThreadLocalStorageScope() = default;
+        ThreadLocalStorageScope(const ThreadLocalStorageScope &) = delete;
+        ThreadLocalStorageScope &operator=(const ThreadLocalStorageScope &) = delete;
+        ~ThreadLocalStorageScope() { ReleaseThreadLocalStorage(); }
+    };
+
+    // Returns a heap checked out of heap_pool by hand, if it holds one, when the scope ends
+    struct PooledHeapScope
+    {
+        explicit PooledHeapScope(std::unique_ptr<QueryHeap> &heap_) : heap(heap_) {}
+        PooledHeapScope(const PooledHeapScope &) = delete;
+        PooledHeapScope &operator=(const PooledHeapScope &) = delete;
+        ~PooledHeapScope()
+        {
+            if (heap)
+            {
+                heap_pool.Release(std::move(heap));
+            }
+        }
+
+        std::unique_ptr<QueryHeap> &heap;
+    };
 };
 }
 }
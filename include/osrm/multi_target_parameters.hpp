@@ -33,6 +33,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace osrm
 {
 using engine::api::MultiTargetParameters;
+using engine::api::MultiTargetBatchHandler;
 }
 
 #endif
@@ -28,11 +28,13 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef OSRM_HPP
 #define OSRM_HPP
 
+#include "osrm/multi_target_parameters.hpp"
 #include "osrm/osrm_fwd.hpp"
 #include "osrm/status.hpp"
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -134,8 +136,43 @@ class OSRM final
 
     Status MultiTarget(const MultiTargetParameters &parameters, json::Object &result);
 
+    /**
+     * MultiTargetBatch: many independent multi target queries in one call
+     *
+     * Uses the same dataset for the whole batch and snaps every distinct coordinate only once.
+     * The handler receives each sub-query's result as soon as it is computed.
+     *
+     * \param queries multi target queries, answered in order
+     * \param handler called once per query with its index, status and result
+     * \return Status::Error if any of the queries failed
+     */
+    Status MultiTargetBatch(const std::vector<MultiTargetParameters> &queries,
+                            const MultiTargetBatchHandler &handler);
+
     Status SmoothVia(const SmoothViaParameters &parameters, json::Object &result);
 
+    /**
+     * SmoothViaCounters: totals of the SmoothVia metrics over all requests so far
+     *
+     * Lock-free, so it can be polled while queries are running.
+     */
+    void SmoothViaCounters(json::Object &result) const;
+
+    /**
+     * PhantomNodeCacheCounters: hits, misses, evictions, invalidations and size of the
+     * snapping cache, empty if EngineConfig::phantom_node_cache_size disabled it. Every dataset
+     * loaded from shared memory has a cache of its own, the size is the one of the current
+     * dataset and the other counters are totals over all of them.
+     */
+    void PhantomNodeCacheCounters(json::Object &result) const;
+
+    /**
+     * HeapPoolCounters: heaps created, reused and evicted by the process-wide search heap
+     * pool, the heaps checked out right now and their high-water mark, and the number and
+     * bytes of the idle heaps
+     */
+    void HeapPoolCounters(json::Object &result) const;
+
   private:
     std::unique_ptr<engine::Engine> engine_;
 };
@@ -128,8 +128,17 @@ struct BaseParametersGrammar : boost::spirit::qi::grammar<Iterator, Signature>
                                           },
                                           qi::_1)];
 
+        // Full precision polyline, keeps long coordinate lists short to transfer and cheap to parse
+        polyline6_rule = qi::as_string[qi::lit("polyline6(") > +polyline_chars > ')']
+                                      [qi::_val = ph::bind(
+                                           [](const std::string &polyline) {
+                                               return engine::decodePolyline(
+                                                   polyline, engine::detail::POLYLINE6_PRECISION);
+                                           },
+                                           qi::_1)];
+
         query_rule =
-            ((location_rule % ';') |
+            ((location_rule % ';') | polyline6_rule |
              polyline_rule)[ph::bind(&engine::api::BaseParameters::coordinates, qi::_r1) = qi::_1];
 
         radiuses_rule = qi::lit("radiuses=") >
@@ -152,14 +161,16 @@ struct BaseParametersGrammar : boost::spirit::qi::grammar<Iterator, Signature>
     qi::rule<Iterator, Signature> base_rule;
     qi::rule<Iterator, Signature> query_rule;
 
+    qi::rule<Iterator, osrm::util::Coordinate()> location_rule;
+    qi::rule<Iterator, std::vector<osrm::util::Coordinate>()> polyline_rule;
+    qi::rule<Iterator, std::vector<osrm::util::Coordinate>()> polyline6_rule;
+
   private:
     qi::rule<Iterator, Signature> bearings_rule;
     qi::rule<Iterator, Signature> radiuses_rule;
     qi::rule<Iterator, Signature> hints_rule;
 
     qi::rule<Iterator, osrm::engine::Bearing()> bearing_rule;
-    qi::rule<Iterator, osrm::util::Coordinate()> location_rule;
-    qi::rule<Iterator, std::vector<osrm::util::Coordinate>()> polyline_rule;
 
     qi::rule<Iterator, unsigned char()> base64_char;
     qi::rule<Iterator, std::string()> polyline_chars;
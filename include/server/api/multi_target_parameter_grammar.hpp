@@ -0,0 +1,60 @@
+#ifndef MULTI_TARGET_PARAMETERS_GRAMMAR_HPP
+#define MULTI_TARGET_PARAMETERS_GRAMMAR_HPP
+
+#include "server/api/base_parameters_grammar.hpp"
+#include "engine/api/multi_target_parameters.hpp"
+
+#include <boost/spirit/include/phoenix.hpp>
+#include <boost/spirit/include/qi.hpp>
+
+namespace osrm
+{
+namespace server
+{
+namespace api
+{
+
+namespace
+{
+namespace ph = boost::phoenix;
+namespace qi = boost::spirit::qi;
+}
+
+template <typename Iterator = std::string::iterator,
+          typename Signature = void(engine::api::MultiTargetParameters &)>
+struct MultiTargetParametersGrammar final : public BaseParametersGrammar<Iterator, Signature>
+{
+    using BaseGrammar = BaseParametersGrammar<Iterator, Signature>;
+
+    MultiTargetParametersGrammar() : BaseGrammar(root_rule)
+    {
+        direction_type.add("forward", true)("backward", false);
+
+        multi_target_rule =
+            (qi::lit("direction=") >
+             direction_type[ph::bind(&engine::api::MultiTargetParameters::forward, qi::_r1) =
+                                qi::_1]) |
+            (qi::lit("distance=") >
+             qi::bool_[ph::bind(&engine::api::MultiTargetParameters::calculate_distance, qi::_r1) =
+                           qi::_1]) |
+            (qi::lit("max_duration=") >
+             qi::double_[ph::bind(&engine::api::MultiTargetParameters::max_duration, qi::_r1) =
+                             qi::_1]) |
+            (qi::lit("k=") >
+             qi::uint_[ph::bind(&engine::api::MultiTargetParameters::k, qi::_r1) = qi::_1]);
+
+        root_rule = BaseGrammar::query_rule(qi::_r1) > -qi::lit(".json") >
+                    -('?' > (multi_target_rule(qi::_r1) | BaseGrammar::base_rule(qi::_r1)) % '&');
+    }
+
+  private:
+    qi::rule<Iterator, Signature> root_rule;
+    qi::rule<Iterator, Signature> multi_target_rule;
+
+    qi::symbols<char, bool> direction_type;
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef SMOOTH_VIA_PARAMETERS_GRAMMAR_HPP
+#define SMOOTH_VIA_PARAMETERS_GRAMMAR_HPP
+
+#include "server/api/base_parameters_grammar.hpp"
+#include "engine/api/smooth_via_parameters.hpp"
+
+#include <boost/spirit/include/phoenix.hpp>
+#include <boost/spirit/include/qi.hpp>
+
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+namespace api
+{
+
+namespace
+{
+namespace ph = boost::phoenix;
+namespace qi = boost::spirit::qi;
+}
+
+// Waypoints are separated by ';', the candidate coordinates of a waypoint either by '|' or
+// packed into a polyline, e.g. 1,2|1.1,2;polyline6(...);3,4
+template <typename Iterator = std::string::iterator,
+          typename Signature = void(engine::api::SmoothViaParameters &)>
+struct SmoothViaParametersGrammar final : public BaseParametersGrammar<Iterator, Signature>
+{
+    using BaseGrammar = BaseParametersGrammar<Iterator, Signature>;
+
+    SmoothViaParametersGrammar() : BaseGrammar(root_rule)
+    {
+        waypoint_rule = BaseGrammar::polyline6_rule | BaseGrammar::polyline_rule |
+                        (BaseGrammar::location_rule % '|');
+
+        waypoints_rule =
+            (waypoint_rule %
+             ';')[ph::bind(&engine::api::SmoothViaParameters::waypoints, qi::_r1) = qi::_1];
+
+        smooth_via_rule =
+            qi::lit("debug=") >
+            qi::bool_[ph::bind(&engine::api::SmoothViaParameters::debug, qi::_r1) = qi::_1];
+
+        root_rule = waypoints_rule(qi::_r1) > -qi::lit(".json") >
+                    -('?' > smooth_via_rule(qi::_r1) % '&');
+    }
+
+  private:
+    qi::rule<Iterator, Signature> root_rule;
+    qi::rule<Iterator, Signature> waypoints_rule;
+    qi::rule<Iterator, Signature> smooth_via_rule;
+    qi::rule<Iterator, std::vector<osrm::util::Coordinate>()> waypoint_rule;
+};
+}
+}
+}
+
+#endif
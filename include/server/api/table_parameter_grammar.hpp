@@ -48,7 +48,15 @@ struct TableParametersGrammar final : public BaseParametersGrammar<Iterator, Sig
             (qi::lit("all") |
              (size_t_ % ';')[ph::bind(&engine::api::TableParameters::sources, qi::_r1) = qi::_1]);
 
-        table_rule = destinations_rule(qi::_r1) | sources_rule(qi::_r1);
+        max_duration_rule =
+            qi::lit("max_duration=") >
+            qi::double_[ph::bind(&engine::api::TableParameters::max_duration, qi::_r1) = qi::_1];
+
+        k_rule = qi::lit("k=") >
+                 size_t_[ph::bind(&engine::api::TableParameters::k, qi::_r1) = qi::_1];
+
+        table_rule = destinations_rule(qi::_r1) | sources_rule(qi::_r1) |
+                     max_duration_rule(qi::_r1) | k_rule(qi::_r1);
 
         root_rule = BaseGrammar::query_rule(qi::_r1) > -qi::lit(".json") >
                     -('?' > (table_rule(qi::_r1) | BaseGrammar::base_rule(qi::_r1)) % '&');
@@ -59,6 +67,8 @@ struct TableParametersGrammar final : public BaseParametersGrammar<Iterator, Sig
     qi::rule<Iterator, Signature> table_rule;
     qi::rule<Iterator, Signature> sources_rule;
     qi::rule<Iterator, Signature> destinations_rule;
+    qi::rule<Iterator, Signature> max_duration_rule;
+    qi::rule<Iterator, Signature> k_rule;
     qi::rule<Iterator, std::size_t()> size_t_;
 };
 }
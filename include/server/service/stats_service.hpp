@@ -0,0 +1,33 @@
+#ifndef SERVER_SERVICE_STATS_SERVICE_HPP
+#define SERVER_SERVICE_STATS_SERVICE_HPP
+
+#include "server/service/base_service.hpp"
+
+#include "engine/status.hpp"
+#include "osrm/osrm.hpp"
+
+#include <string>
+
+namespace osrm
+{
+namespace server
+{
+namespace service
+{
+
+// Reports the counters of the engine, the query names the set of counters
+class StatsService final : public BaseService
+{
+  public:
+    StatsService(OSRM &routing_machine) : BaseService(routing_machine) {}
+
+    engine::Status
+    RunQuery(std::size_t prefix_length, std::string &query, ResultT &result) final override;
+
+    unsigned GetVersion() final override { return 1; }
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef DATASET_FILE_HPP
+#define DATASET_FILE_HPP
+
+#include "storage/shared_datatype.hpp"
+#include "util/fingerprint.hpp"
+#include "util/mapped_file.hpp"
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <array>
+#include <cstdint>
+
+namespace osrm
+{
+namespace storage
+{
+
+// A dataset file holds all blocks of a SharedDataLayout in one file, laid out exactly as in
+// shared memory. The header is the table of contents: the layout and the offset and CRC-32 of
+// every block. The data starts at a page boundary and its blocks are page aligned, so it can
+// be mapped and used in place.
+struct DatasetHeader
+{
+    static constexpr std::uint32_t CURRENT_VERSION = 1;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t number_of_blocks;
+    util::FingerPrint fingerprint;
+    SharedDataLayout layout;
+    std::array<std::uint64_t, SharedDataLayout::NUM_BLOCKS> block_offsets;
+    std::array<std::uint32_t, SharedDataLayout::NUM_BLOCKS> block_checksums;
+    // offset of the data from the start of the file
+    std::uint64_t data_offset;
+    std::uint64_t data_size;
+};
+
+// Writes a dataset file without holding its data in memory. The data is filled in place in a
+// mapping of the file, so the kernel writes the pages back while they are filled, and the
+// checksums are computed block by block once the data is complete. The file is written next to
+// the path and renamed by Commit, so readers either see the previous dataset or the new one.
+class DatasetFileWriter
+{
+  public:
+    explicit DatasetFileWriter(const boost::filesystem::path &path);
+    DatasetFileWriter(const DatasetFileWriter &) = delete;
+    DatasetFileWriter &operator=(const DatasetFileWriter &) = delete;
+    // removes the file of a dataset that was not committed
+    ~DatasetFileWriter();
+
+    // Creates the file for the layout. Returns its zero-initialized data to be filled in.
+    char *Allocate(const SharedDataLayout &layout);
+    // Writes the table of contents and moves the file to the path
+    void Commit();
+
+  private:
+    boost::filesystem::path path;
+    boost::filesystem::path temporary_path;
+    boost::iostreams::mapped_file_sink region;
+    DatasetHeader header{};
+};
+
+// Checks the table of contents read from a dataset file against this build and the file size,
+// throws if they do not match
+void CheckDatasetHeader(const boost::filesystem::path &path,
+                        const DatasetHeader &header,
+                        const std::uint64_t file_size);
+
+// Compares a block of the dataset data to its checksum
+bool CheckDatasetBlock(const DatasetHeader &header,
+                       const char *data,
+                       const SharedDataLayout::BlockID bid);
+
+// Read-only dataset file, mapped or read at once (see util::MappedFile). Opening it checks
+// the table of contents, and with verify the checksums of all blocks. Verifying touches every
+// page of the data, so a mapped file is read entirely before the first query.
+class DatasetFile
+{
+  public:
+    DatasetFile(const boost::filesystem::path &path, const bool map, const bool verify);
+
+    const SharedDataLayout &GetLayout() const { return header.layout; }
+    // data of the layout, it must not be written to
+    const char *GetData() const { return data; }
+    std::uint64_t GetDataSize() const { return header.data_size; }
+
+  private:
+    util::MappedFile file;
+    DatasetHeader header{};
+    const char *data;
+};
+}
+}
+
+#endif // DATASET_FILE_HPP
@@ -7,6 +7,7 @@
 #include <cstdint>
 
 #include <array>
+#include <atomic>
 
 namespace osrm
 {
@@ -23,6 +24,11 @@ const constexpr char *block_id_to_name[] = {"NAME_OFFSETS",
                                             "VIA_NODE_LIST",
                                             "GRAPH_NODE_LIST",
                                             "GRAPH_EDGE_LIST",
+                                            "GRAPH_EDGE_DIRECTION_SPLITS",
+                                            "SHORTCUT_CHILDREN_OFFSETS",
+                                            "SHORTCUT_CHILDREN",
+                                            "GRAPH_NODE_LENGTHS",
+                                            "GRAPH_EDGE_LENGTHS",
                                             "COORDINATE_LIST",
                                             "OSM_NODE_ID_LIST",
                                             "TURN_INSTRUCTION",
@@ -35,6 +41,9 @@ const constexpr char *block_id_to_name[] = {"NAME_OFFSETS",
                                             "TIMESTAMP",
                                             "FILE_INDEX_PATH",
                                             "CORE_MARKER",
+                                            "CORE_LANDMARKS",
+                                            "CORE_LANDMARK_INDEX",
+                                            "CORE_LANDMARK_DISTANCES",
                                             "DATASOURCES_LIST",
                                             "DATASOURCE_NAME_DATA",
                                             "DATASOURCE_NAME_OFFSETS",
@@ -61,6 +70,11 @@ struct SharedDataLayout
         VIA_NODE_LIST,
         GRAPH_NODE_LIST,
         GRAPH_EDGE_LIST,
+        GRAPH_EDGE_DIRECTION_SPLITS,
+        SHORTCUT_CHILDREN_OFFSETS,
+        SHORTCUT_CHILDREN,
+        GRAPH_NODE_LENGTHS,
+        GRAPH_EDGE_LENGTHS,
         COORDINATE_LIST,
         OSM_NODE_ID_LIST,
         TURN_INSTRUCTION,
@@ -73,6 +87,9 @@ struct SharedDataLayout
         TIMESTAMP,
         FILE_INDEX_PATH,
         CORE_MARKER,
+        CORE_LANDMARKS,
+        CORE_LANDMARK_INDEX,
+        CORE_LANDMARK_DISTANCES,
         DATASOURCES_LIST,
         DATASOURCE_NAME_DATA,
         DATASOURCE_NAME_OFFSETS,
@@ -117,19 +134,26 @@ struct SharedDataLayout
         return AlignBlockSize(num_entries[bid] * entry_size[bid]);
     }
 
-    inline uint64_t GetSizeOfLayout() const
+    // Blocks start at page boundaries, so the data can be mapped from a dataset file and used
+    // in place. The start canary of a block sits right before it, the end canary right after.
+    static constexpr uint64_t BLOCK_ALIGNMENT = 4096;
+
+    static inline uint64_t AlignBlockOffset(uint64_t offset)
     {
-        return GetBlockOffset(NUM_BLOCKS) + NUM_BLOCKS * 2 * sizeof(CANARY);
+        return (offset + (BLOCK_ALIGNMENT - 1)) & ~(BLOCK_ALIGNMENT - 1);
     }
 
+    inline uint64_t GetSizeOfLayout() const { return GetBlockOffset(NUM_BLOCKS); }
+
     inline uint64_t GetBlockOffset(BlockID bid) const
     {
-        uint64_t result = sizeof(CANARY);
+        uint64_t result = 0;
         for (auto i = 0; i < bid; i++)
         {
-            result += GetBlockSize((BlockID)i) + 2 * sizeof(CANARY);
+            result = AlignBlockOffset(result + sizeof(CANARY)) + GetBlockSize((BlockID)i) +
+                     sizeof(CANARY);
         }
-        return result;
+        return AlignBlockOffset(result + sizeof(CANARY));
     }
 
     template <typename T, bool WRITE_CANARY = false>
@@ -183,6 +207,46 @@ struct SharedDataTimestamp
     unsigned timestamp;
 };
 
+inline bool operator==(const SharedDataTimestamp &lhs, const SharedDataTimestamp &rhs)
+{
+    return lhs.layout == rhs.layout && lhs.data == rhs.data && lhs.timestamp == rhs.timestamp;
+}
+
+inline bool operator!=(const SharedDataTimestamp &lhs, const SharedDataTimestamp &rhs)
+{
+    return !(lhs == rhs);
+}
+
+// Contents of the CURRENT_REGIONS region. osrm-datastore publishes a new dataset with a single
+// atomic store, so readers need no lock and never combine the layout of one dataset with the
+// data of another.
+class SharedCurrentRegions
+{
+    // shared between processes, which only works without a lock
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "64 bit atomics have to be lock-free");
+
+  public:
+    SharedDataTimestamp Load() const
+    {
+        const std::uint64_t value = packed.load(std::memory_order_acquire);
+        return {static_cast<SharedDataType>(value & 0xff),
+                static_cast<SharedDataType>((value >> 8) & 0xff),
+                static_cast<unsigned>(value >> 32)};
+    }
+
+    void Store(const SharedDataTimestamp &regions)
+    {
+        packed.store(static_cast<std::uint64_t>(regions.layout) |
+                         static_cast<std::uint64_t>(regions.data) << 8 |
+                         static_cast<std::uint64_t>(regions.timestamp) << 32,
+                     std::memory_order_release);
+    }
+
+  private:
+    // layout in the lowest byte, data in the next one, the timestamp in the upper half
+    std::atomic<std::uint64_t> packed;
+};
+
 static_assert(sizeof(block_id_to_name) / sizeof(*block_id_to_name) == SharedDataLayout::NUM_BLOCKS,
               "Number of blocks needs to match the number of Block names.");
 }
@@ -19,10 +19,17 @@
 #endif
 
 // #include <cstring>
+#include <cerrno>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 
 #include <algorithm>
 #include <exception>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
 
 namespace osrm
 {
@@ -81,12 +88,15 @@ class SharedMemory
     SharedMemory(const SharedMemory &) = delete;
     SharedMemory &operator=(const SharedMemory &) = delete;
 
+    // With huge_pages a new region is backed by huge pages (SHM_HUGETLB) if enough of them are
+    // reserved (vm.nr_hugepages), otherwise by normal pages
     template <typename IdentifierT>
     SharedMemory(const boost::filesystem::path &lock_file,
                  const IdentifierT id,
                  const uint64_t size = 0,
                  bool read_write = false,
-                 bool remove_prev = true)
+                 bool remove_prev = true,
+                 bool huge_pages = false)
         : key(lock_file.string().c_str(), id)
     {
         if (0 == size)
@@ -104,8 +114,32 @@ class SharedMemory
             {
                 Remove(key);
             }
-            shm = boost::interprocess::xsi_shared_memory(
-                boost::interprocess::open_or_create, key, size);
+#if defined(__linux__) && defined(SHM_HUGETLB)
+            if (huge_pages)
+            {
+                // huge page segments are multiples of the huge page size
+                const uint64_t page_size = GetHugePageSize();
+                const uint64_t huge_size = (size + page_size - 1) / page_size * page_size;
+                if (-1 != shmget(key.get_key(), huge_size, IPC_CREAT | SHM_HUGETLB | 0644))
+                {
+                    shm = boost::interprocess::xsi_shared_memory(boost::interprocess::open_only,
+                                                                 key);
+                }
+                else
+                {
+                    util::SimpleLogger().Write(logWARNING)
+                        << "could not allocate " << huge_size << " bytes of huge pages ("
+                        << std::strerror(errno) << "), check vm.nr_hugepages";
+                }
+            }
+#else
+            (void)huge_pages;
+#endif
+            if (-1 == shm.get_shmid())
+            {
+                shm = boost::interprocess::xsi_shared_memory(
+                    boost::interprocess::open_or_create, key, size);
+            }
 #ifdef __linux__
             if (-1 == shmctl(shm.get_shmid(), SHM_LOCK, nullptr))
             {
@@ -146,7 +180,95 @@ class SharedMemory
         return Remove(key);
     }
 
+#ifdef __linux__
+    // Logs the page size of the region as mapped into this process, read from its smaps
+    void LogPageSizes() const
+    {
+        const auto address = reinterpret_cast<uintptr_t>(region.get_address());
+        std::ifstream smaps("/proc/self/smaps");
+        std::string line;
+        bool in_region = false;
+        uint64_t size_kb = 0;
+        uint64_t page_size_kb = 0;
+        uint64_t transparent_huge_pages_kb = 0;
+        while (std::getline(smaps, line))
+        {
+            std::istringstream fields(line);
+            std::string name;
+            fields >> name;
+            if (name.empty())
+            {
+                continue;
+            }
+            // every mapping starts with its address range, its fields follow
+            if (name.back() != ':')
+            {
+                if (in_region)
+                {
+                    break;
+                }
+                in_region =
+                    std::strtoull(name.substr(0, name.find('-')).c_str(), nullptr, 16) == address;
+                continue;
+            }
+            if (!in_region)
+            {
+                continue;
+            }
+            uint64_t value = 0;
+            fields >> value;
+            if (name == "Size:")
+            {
+                size_kb = value;
+            }
+            else if (name == "KernelPageSize:")
+            {
+                page_size_kb = value;
+            }
+            else if (name == "ShmemPmdMapped:")
+            {
+                transparent_huge_pages_kb = value;
+            }
+        }
+
+        if (0 == size_kb)
+        {
+            util::SimpleLogger().Write(logDEBUG) << "could not find shared memory in smaps";
+        }
+        else if (page_size_kb > 4)
+        {
+            util::SimpleLogger().Write() << "shared memory of " << size_kb / 1024
+                                         << " MB uses huge pages of " << page_size_kb << " kB";
+        }
+        else
+        {
+            util::SimpleLogger().Write() << "shared memory of " << size_kb / 1024 << " MB has "
+                                         << transparent_huge_pages_kb / 1024
+                                         << " MB in transparent huge pages";
+        }
+    }
+#endif
+
   private:
+#ifdef __linux__
+    // size of the default huge pages, from /proc/meminfo
+    static uint64_t GetHugePageSize()
+    {
+        std::ifstream meminfo("/proc/meminfo");
+        std::string name;
+        uint64_t value = 0;
+        while (meminfo >> name >> value)
+        {
+            if (name == "Hugepagesize:")
+            {
+                return value * 1024;
+            }
+            meminfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+        return 2 * 1024 * 1024;
+    }
+#endif
+
     static bool RegionExists(const boost::interprocess::xsi_key &key)
     {
         bool result = true;
@@ -230,7 +352,8 @@ class SharedMemory
                  const int id,
                  const uint64_t size = 0,
                  bool read_write = false,
-                 bool remove_prev = true)
+                 bool remove_prev = true,
+                 bool /*huge_pages*/ = false)
     {
         sprintf(key, "%s.%d", "osrm.lock", id);
         if (0 == size)
@@ -330,7 +453,8 @@ template <typename IdentifierT, typename LockFileT = OSRMLockFile>
 SharedMemory *makeSharedMemory(const IdentifierT &id,
                                const uint64_t size = 0,
                                bool read_write = false,
-                               bool remove_prev = true)
+                               bool remove_prev = true,
+                               bool huge_pages = false)
 {
     try
     {
@@ -346,7 +470,7 @@ SharedMemory *makeSharedMemory(const IdentifierT &id,
                 boost::filesystem::ofstream ofs(lock_file());
             }
         }
-        return new SharedMemory(lock_file(), id, size, read_write, remove_prev);
+        return new SharedMemory(lock_file(), id, size, read_write, remove_prev, huge_pages);
     }
     catch (const boost::interprocess::interprocess_exception &e)
     {
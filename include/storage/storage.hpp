@@ -32,19 +32,30 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <boost/filesystem/path.hpp>
 
+#include <functional>
 #include <string>
 
 namespace osrm
 {
 namespace storage
 {
+struct SharedDataLayout;
+
 class Storage
 {
   public:
     Storage(StorageConfig config);
+    // Loads the dataset into shared memory, from the dataset file if there is one
     int Run();
+    // Writes all files of the dataset into a single dataset file
+    void WriteDataset(const boost::filesystem::path &dataset_path);
 
   private:
+    using AllocateData = std::function<char *(const SharedDataLayout &)>;
+
+    void LoadDataset(SharedDataLayout &layout, const AllocateData &allocate);
+    void PopulateData(SharedDataLayout &layout, const AllocateData &allocate);
+
     StorageConfig config;
 };
 }
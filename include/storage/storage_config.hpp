@@ -36,7 +36,7 @@ namespace storage
 {
 
 /**
- * Configures OSRM's file storage paths.
+ * Configures OSRM's file storage paths and how osrm-datastore loads them.
  *
  * \see OSRM, EngineConfig
  */
@@ -55,9 +55,11 @@ struct StorageConfig final
     boost::filesystem::path ram_index_path;
     boost::filesystem::path file_index_path;
     boost::filesystem::path hsgr_data_path;
+    boost::filesystem::path lengths_path;
     boost::filesystem::path nodes_data_path;
     boost::filesystem::path edges_data_path;
     boost::filesystem::path core_data_path;
+    boost::filesystem::path landmarks_path;
     boost::filesystem::path geometries_path;
     boost::filesystem::path timestamp_path;
     boost::filesystem::path datasource_names_path;
@@ -67,6 +69,17 @@ struct StorageConfig final
     boost::filesystem::path intersection_class_path;
     boost::filesystem::path turn_lane_data_path;
     boost::filesystem::path turn_lane_description_path;
+    // the blocks read from the files above in a single file, written by osrm-contract. The
+    // leaves of the search tree stay in the file index.
+    boost::filesystem::path dataset_path;
+
+    // Threads osrm-datastore loads the blocks with, 0 for one per core
+    unsigned requested_num_threads = 0;
+    // Reads the dataset file without the page cache (O_DIRECT), it is only read once
+    bool use_direct_io = false;
+    // Backs the data region with huge pages reserved through vm.nr_hugepages, with transparent
+    // huge pages where they are not available
+    bool use_huge_pages = false;
 };
 }
 }
@@ -0,0 +1,178 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+// Monotonic memory for the objects of a single request. Allocating bumps a pointer inside the
+// current block, deallocating does nothing and Release frees everything at once.
+//
+// Release keeps the memory of the request as a single block of at most max_retained_bytes, so
+// a thread that serves requests of similar size stops allocating from the heap after the first
+// of them.
+class Arena
+{
+  public:
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+    static constexpr std::size_t DEFAULT_MAX_RETAINED_BYTES = 16 * 1024 * 1024;
+
+    struct Statistics
+    {
+        // allocations served from the blocks and the bytes handed out by them
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+        // blocks allocated from the heap
+        std::uint64_t block_allocations = 0;
+        std::uint64_t releases = 0;
+        // bytes of the blocks currently held
+        std::size_t capacity = 0;
+    };
+
+    explicit Arena(const std::size_t block_size_ = DEFAULT_BLOCK_SIZE,
+                   const std::size_t max_retained_bytes_ = DEFAULT_MAX_RETAINED_BYTES)
+        : block_size(block_size_), max_retained_bytes(max_retained_bytes_)
+    {
+    }
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *Allocate(const std::size_t bytes, const std::size_t alignment)
+    {
+        // the blocks come from operator new[] and are aligned for every fundamental type
+        BOOST_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+        BOOST_ASSERT(alignment <= alignof(std::max_align_t));
+
+        std::size_t offset = AlignUp(current_offset, alignment);
+        if (blocks.empty() || offset + bytes > blocks.back().size)
+        {
+            // every new block is as large as all previous ones together
+            AddBlock(std::max(bytes, std::max(block_size, statistics.capacity)));
+            offset = 0;
+        }
+
+        ++statistics.allocations;
+        statistics.bytes += bytes;
+        current_offset = offset + bytes;
+        return blocks.back().data.get() + offset;
+    }
+
+    // Frees everything allocated since the last release. The memory is kept for the next
+    // request, merged into one block if it was spread over several.
+    void Release()
+    {
+        ++statistics.releases;
+        current_offset = 0;
+        if (blocks.size() == 1 && statistics.capacity <= max_retained_bytes)
+        {
+            return;
+        }
+
+        const auto retained_bytes = std::min(statistics.capacity, max_retained_bytes);
+        blocks.clear();
+        statistics.capacity = 0;
+        if (retained_bytes > 0)
+        {
+            AddBlock(std::max(retained_bytes, block_size));
+        }
+    }
+
+    const Statistics &GetStatistics() const { return statistics; }
+
+  private:
+    struct Block
+    {
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+    };
+
+    static std::size_t AlignUp(const std::size_t offset, const std::size_t alignment)
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    void AddBlock(const std::size_t size)
+    {
+        blocks.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+        ++statistics.block_allocations;
+        statistics.capacity += size;
+        current_offset = 0;
+    }
+
+    const std::size_t block_size;
+    const std::size_t max_retained_bytes;
+    std::vector<Block> blocks;
+    // first free byte of the last block
+    std::size_t current_offset = 0;
+    Statistics statistics;
+};
+
+// Standard allocator on top of an Arena. Without an arena it allocates from the heap, so
+// containers using it can be used outside of a request as well.
+template <typename T> class ArenaAllocator
+{
+  public:
+    using value_type = T;
+    // containers keep the arena of the container they were moved from
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() noexcept = default;
+    explicit ArenaAllocator(Arena &arena_) noexcept : arena(&arena_) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena(other.GetArena())
+    {
+    }
+
+    T *allocate(const std::size_t n)
+    {
+        if (arena == nullptr)
+        {
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T *>(arena->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *pointer, const std::size_t) noexcept
+    {
+        if (arena == nullptr)
+        {
+            ::operator delete(pointer);
+        }
+    }
+
+    Arena *GetArena() const noexcept { return arena; }
+
+  private:
+    Arena *arena = nullptr;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) noexcept
+{
+    return lhs.GetArena() == rhs.GetArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+template <typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+}
+}
+
+#endif // ARENA_HPP
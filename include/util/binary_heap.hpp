@@ -4,8 +4,10 @@
 #include <boost/assert.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <map>
+#include <memory>
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
@@ -15,6 +17,16 @@ namespace osrm
 namespace util
 {
 
+// Gives back the capacity of a vector that is mostly unused. Vectors that are at least a quarter
+// full keep it, so heaps of searches of similar size do not reallocate over and over.
+template <typename T> void ShrinkVector(std::vector<T> &vector)
+{
+    if (vector.size() < vector.capacity() / 4)
+    {
+        vector.shrink_to_fit();
+    }
+}
+
 template <typename NodeID, typename Key> class ArrayStorage
 {
   public:
@@ -28,6 +40,11 @@ template <typename NodeID, typename Key> class ArrayStorage
 
     void Clear() {}
 
+    std::size_t MemoryUsage() const { return positions.capacity() * sizeof(Key); }
+
+    // every node has its slot
+    void ReleaseUnusedPages() {}
+
   private:
     std::vector<Key> positions;
 };
@@ -51,6 +68,15 @@ template <typename NodeID, typename Key> class MapStorage
         return std::numeric_limits<Key>::max();
     }
 
+    // approximation, a tree node also holds three pointers and its color
+    std::size_t MemoryUsage() const
+    {
+        return nodes.size() * (sizeof(typename decltype(nodes)::value_type) + 4 * sizeof(void *));
+    }
+
+    // only holds the nodes of the last search
+    void ReleaseUnusedPages() {}
+
   private:
     std::map<NodeID, Key> nodes;
 };
@@ -80,10 +106,129 @@ template <typename NodeID, typename Key> class UnorderedMapStorage
 
     void Clear() { nodes.clear(); }
 
+    // approximation, every element also holds a next pointer
+    std::size_t MemoryUsage() const
+    {
+        return nodes.bucket_count() * sizeof(void *) +
+               nodes.size() * (sizeof(typename decltype(nodes)::value_type) + sizeof(void *));
+    }
+
+    // only holds the nodes of the last search
+    void ReleaseUnusedPages() {}
+
   private:
     std::unordered_map<NodeID, Key> nodes;
 };
 
+// Index storage with an O(1) Clear. Every slot remembers the generation it was written in and
+// slots of older generations read as absent, so Clear only starts a new generation. Slots are
+// allocated in pages of 2^PageBits on their first write, which keeps the footprint of a heap
+// proportional to the part of the graph it searched instead of to the number of nodes.
+template <typename NodeID, typename Key, unsigned PageBits = 12> class GenerationStorage
+{
+  public:
+    explicit GenerationStorage(std::size_t size)
+        : pages((size >> PageBits) + 1), page_generations(pages.size(), 0)
+    {
+    }
+
+    Key &operator[](const NodeID node)
+    {
+        const auto page_index = node >> PageBits;
+        auto &page = pages[page_index];
+        if (!page)
+        {
+            page.reset(new Slot[PAGE_SIZE]());
+        }
+
+        auto &slot = page[node & PAGE_MASK];
+        if (slot.generation != generation)
+        {
+            slot.generation = generation;
+            slot.key = std::numeric_limits<Key>::max();
+            page_generations[page_index] = generation;
+        }
+        return slot.key;
+    }
+
+    Key peek_index(const NodeID node) const
+    {
+        BOOST_ASSERT((node >> PageBits) < pages.size());
+        const auto &page = pages[node >> PageBits];
+        if (!page || page[node & PAGE_MASK].generation != generation)
+        {
+            return std::numeric_limits<Key>::max();
+        }
+        return page[node & PAGE_MASK].key;
+    }
+
+    void Clear()
+    {
+        ++generation;
+        // the generation wrapped around, old slots could look current again
+        if (generation == 0)
+        {
+            for (auto &page : pages)
+            {
+                if (page)
+                {
+                    std::fill(page.get(), page.get() + PAGE_SIZE, Slot());
+                }
+            }
+            std::fill(page_generations.begin(), page_generations.end(), 0);
+            generation = 1;
+        }
+    }
+
+    // Number of pages that were written to so far
+    std::size_t NumberOfAllocatedPages() const
+    {
+        return std::count_if(pages.begin(), pages.end(), [](const std::unique_ptr<Slot[]> &page) {
+            return static_cast<bool>(page);
+        });
+    }
+
+    std::size_t MemoryUsage() const
+    {
+        return pages.capacity() * sizeof(std::unique_ptr<Slot[]>) +
+               page_generations.capacity() * sizeof(std::uint32_t) +
+               NumberOfAllocatedPages() * PAGE_SIZE * sizeof(Slot);
+    }
+
+    // Frees the pages the search since the last Clear did not write to
+    void ReleaseUnusedPages()
+    {
+        for (std::size_t page_index = 0; page_index < pages.size(); ++page_index)
+        {
+            if (page_generations[page_index] != generation)
+            {
+                pages[page_index].reset();
+            }
+        }
+    }
+
+  private:
+    static constexpr std::size_t PAGE_SIZE = std::size_t{1} << PageBits;
+    static constexpr std::size_t PAGE_MASK = PAGE_SIZE - 1;
+
+    struct Slot
+    {
+        Key key = Key();
+        std::uint32_t generation = 0;
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> pages;
+    // generation that last wrote to a page, a page is only freed if it is not the current one
+    std::vector<std::uint32_t> page_generations;
+    // starts at one, so freshly allocated slots are absent
+    std::uint32_t generation = 1;
+};
+
+template <typename NodeID, typename Key, unsigned PageBits>
+constexpr std::size_t GenerationStorage<NodeID, Key, PageBits>::PAGE_SIZE;
+template <typename NodeID, typename Key, unsigned PageBits>
+constexpr std::size_t GenerationStorage<NodeID, Key, PageBits>::PAGE_MASK;
+
 template <typename NodeID,
           typename Key,
           typename Weight,
@@ -144,6 +289,12 @@ class BinaryHeap
         return inserted_nodes[index].weight;
     }
 
+    Weight GetKey(NodeID node) const
+    {
+        const Key index = node_index.peek_index(node);
+        return inserted_nodes[index].weight;
+    }
+
     bool WasRemoved(const NodeID node) const
     {
         BOOST_ASSERT(WasInserted(node));
@@ -212,6 +363,21 @@ class BinaryHeap
         CheckHeap();
     }
 
+    // Bytes held by the heap, including capacity that a Clear keeps around
+    std::size_t MemoryUsage() const
+    {
+        return inserted_nodes.capacity() * sizeof(HeapNode) +
+               heap.capacity() * sizeof(HeapElement) + node_index.MemoryUsage();
+    }
+
+    // Frees what the search since the last Clear did not use, see GenerationStorage
+    void ShrinkToFit()
+    {
+        ShrinkVector(inserted_nodes);
+        ShrinkVector(heap);
+        node_index.ReleaseUnusedPages();
+    }
+
   private:
     class HeapNode
     {
@@ -0,0 +1,272 @@
+#ifndef D_ARY_HEAP_HPP
+#define D_ARY_HEAP_HPP
+
+#include "util/binary_heap.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+// Drop-in replacement for BinaryHeap with Arity children per heap node.
+//
+// The heap array holds the weights inline next to the insertion index, and the heap position
+// of every inserted node lives in a compact array of its own. Sifting an element therefore
+// only touches the heap array and that position array instead of the much larger array of
+// inserted nodes. The wider nodes make the heap shallower, which saves writes on DecreaseKey
+// and Insert, the common operations in a CH search, at the price of more comparisons per
+// level in DeleteMin.
+template <typename NodeID,
+          typename Key,
+          typename Weight,
+          typename Data,
+          typename IndexStorage = ArrayStorage<NodeID, NodeID>,
+          unsigned Arity = 4>
+class DAryHeap
+{
+    static_assert(Arity >= 2, "a heap node needs at least two children");
+
+  public:
+    using WeightType = Weight;
+    using DataType = Data;
+
+    explicit DAryHeap(std::size_t maxID) : node_index(maxID) { Clear(); }
+
+    DAryHeap(const DAryHeap &) = delete;
+    DAryHeap &operator=(const DAryHeap &) = delete;
+
+    void Clear()
+    {
+        heap.clear();
+        inserted_nodes.clear();
+        positions.clear();
+        node_index.Clear();
+    }
+
+    std::size_t Size() const { return heap.size(); }
+
+    bool Empty() const { return heap.empty(); }
+
+    void Insert(NodeID node, Weight weight, const Data &data)
+    {
+        const Key index = static_cast<Key>(inserted_nodes.size());
+        inserted_nodes.push_back({node, weight, data});
+        positions.push_back(static_cast<Key>(heap.size()));
+        heap.push_back({weight, index});
+        node_index[node] = index;
+        Upheap(heap.size() - 1);
+        CheckHeap();
+    }
+
+    Data &GetData(NodeID node)
+    {
+        const Key index = node_index.peek_index(node);
+        return inserted_nodes[index].data;
+    }
+
+    Data const &GetData(NodeID node) const
+    {
+        const Key index = node_index.peek_index(node);
+        return inserted_nodes[index].data;
+    }
+
+    Weight &GetKey(NodeID node)
+    {
+        const Key index = node_index[node];
+        return inserted_nodes[index].weight;
+    }
+
+    Weight GetKey(NodeID node) const
+    {
+        const Key index = node_index.peek_index(node);
+        return inserted_nodes[index].weight;
+    }
+
+    bool WasRemoved(const NodeID node) const
+    {
+        BOOST_ASSERT(WasInserted(node));
+        const Key index = node_index.peek_index(node);
+        return positions[index] == REMOVED;
+    }
+
+    bool WasInserted(const NodeID node) const
+    {
+        const auto index = node_index.peek_index(node);
+        if (index >= static_cast<decltype(index)>(inserted_nodes.size()))
+        {
+            return false;
+        }
+        return inserted_nodes[index].node == node;
+    }
+
+    NodeID Min() const
+    {
+        BOOST_ASSERT(!heap.empty());
+        return inserted_nodes[heap.front().index].node;
+    }
+
+    Weight MinKey() const
+    {
+        BOOST_ASSERT(!heap.empty());
+        return heap.front().weight;
+    }
+
+    NodeID DeleteMin()
+    {
+        BOOST_ASSERT(!heap.empty());
+        const Key removed_index = heap.front().index;
+        positions[removed_index] = REMOVED;
+
+        heap.front() = heap.back();
+        heap.pop_back();
+        if (!heap.empty())
+        {
+            Downheap(0);
+        }
+        CheckHeap();
+        return inserted_nodes[removed_index].node;
+    }
+
+    void DeleteAll()
+    {
+        for (const auto &element : heap)
+        {
+            positions[element.index] = REMOVED;
+        }
+        heap.clear();
+    }
+
+    void DecreaseKey(NodeID node, Weight weight)
+    {
+        BOOST_ASSERT(std::numeric_limits<NodeID>::max() != node);
+        const Key index = node_index.peek_index(node);
+        const Key position = positions[index];
+        BOOST_ASSERT(position != REMOVED);
+
+        inserted_nodes[index].weight = weight;
+        heap[position].weight = weight;
+        Upheap(position);
+        CheckHeap();
+    }
+
+    // Bytes held by the heap, including capacity that a Clear keeps around
+    std::size_t MemoryUsage() const
+    {
+        return inserted_nodes.capacity() * sizeof(HeapNode) + positions.capacity() * sizeof(Key) +
+               heap.capacity() * sizeof(HeapElement) + node_index.MemoryUsage();
+    }
+
+    // Frees what the search since the last Clear did not use, see GenerationStorage
+    void ShrinkToFit()
+    {
+        ShrinkVector(inserted_nodes);
+        ShrinkVector(positions);
+        ShrinkVector(heap);
+        node_index.ReleaseUnusedPages();
+    }
+
+  private:
+    static constexpr Key REMOVED = std::numeric_limits<Key>::max();
+
+    struct HeapNode
+    {
+        NodeID node;
+        Weight weight;
+        Data data;
+    };
+
+    struct HeapElement
+    {
+        Weight weight;
+        Key index;
+    };
+
+    std::vector<HeapNode> inserted_nodes;
+    // heap position of every inserted node by insertion index, REMOVED once deleted
+    std::vector<Key> positions;
+    std::vector<HeapElement> heap;
+    IndexStorage node_index;
+
+    void Downheap(std::size_t position)
+    {
+        const HeapElement dropping = heap[position];
+        const std::size_t heap_size = heap.size();
+        while (true)
+        {
+            const std::size_t first_child = Arity * position + 1;
+            if (first_child >= heap_size)
+            {
+                break;
+            }
+
+            const std::size_t last_child = std::min<std::size_t>(first_child + Arity, heap_size);
+            std::size_t smallest_child = first_child;
+            for (std::size_t child = first_child + 1; child < last_child; ++child)
+            {
+                if (heap[child].weight < heap[smallest_child].weight)
+                {
+                    smallest_child = child;
+                }
+            }
+
+            if (dropping.weight <= heap[smallest_child].weight)
+            {
+                break;
+            }
+
+            heap[position] = heap[smallest_child];
+            positions[heap[position].index] = static_cast<Key>(position);
+            position = smallest_child;
+        }
+        heap[position] = dropping;
+        positions[dropping.index] = static_cast<Key>(position);
+    }
+
+    void Upheap(std::size_t position)
+    {
+        const HeapElement rising = heap[position];
+        while (position > 0)
+        {
+            const std::size_t parent = (position - 1) / Arity;
+            if (heap[parent].weight <= rising.weight)
+            {
+                break;
+            }
+
+            heap[position] = heap[parent];
+            positions[heap[position].index] = static_cast<Key>(position);
+            position = parent;
+        }
+        heap[position] = rising;
+        positions[rising.index] = static_cast<Key>(position);
+    }
+
+    void CheckHeap()
+    {
+#ifndef NDEBUG
+        for (std::size_t i = 1; i < heap.size(); ++i)
+        {
+            BOOST_ASSERT(heap[i].weight >= heap[(i - 1) / Arity].weight);
+        }
+#endif
+    }
+};
+
+template <typename NodeID,
+          typename Key,
+          typename Weight,
+          typename Data,
+          typename IndexStorage,
+          unsigned Arity>
+constexpr Key DAryHeap<NodeID, Key, Weight, Data, IndexStorage, Arity>::REMOVED;
+}
+}
+
+#endif // D_ARY_HEAP_HPP
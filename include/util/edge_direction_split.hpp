@@ -0,0 +1,99 @@
+#ifndef EDGE_DIRECTION_SPLIT_HPP
+#define EDGE_DIRECTION_SPLIT_HPP
+
+#include "util/exception.hpp"
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace osrm
+{
+namespace util
+{
+
+// The search graph stores the edges of every node grouped by direction: the forward-only edges
+// first, then the edges usable in both directions and the backward-only edges last, see
+// contractor::QueryEdge. The forward edges of a node are then [begin, first_backward_only) and
+// the backward edges [first_bidirectional, end), both contiguous.
+struct EdgeDirectionSplit
+{
+    EdgeID first_bidirectional;
+    EdgeID first_backward_only;
+};
+
+// Adjacency of a single node with its direction split
+struct DirectedEdgeRanges
+{
+    EdgeID begin;
+    EdgeID first_bidirectional;
+    EdgeID first_backward_only;
+    EdgeID end;
+
+    range<EdgeID> Forward() const { return irange(begin, first_backward_only); }
+    range<EdgeID> Backward() const { return irange(first_bidirectional, end); }
+};
+
+// Version of the edge order of a .hsgr, written right after its fingerprint. Bump it whenever
+// contractor::QueryEdge sorts the edges differently. Files from before the edges were grouped
+// by direction have no version, their checksum is read in its place.
+constexpr std::uint32_t HSGR_EDGE_ORDER_VERSION = 1;
+
+// Throws if a .hsgr was written with another edge order than this build expects
+inline void CheckEdgeOrderVersion(const std::string &hsgr_path, const std::uint32_t version)
+{
+    if (version != HSGR_EDGE_ORDER_VERSION)
+    {
+        throw exception(hsgr_path + " has an outdated edge order (expected version " +
+                        std::to_string(HSGR_EDGE_ORDER_VERSION) + "), re-run osrm-contract");
+    }
+}
+
+// Group of an edge in the adjacency of its node
+template <typename EdgeDataT> inline unsigned GetEdgeDirectionGroup(const EdgeDataT &data)
+{
+    return data.forward ? (data.backward ? 1 : 0) : 2;
+}
+
+// Computes the split of every node of a graph whose edges are grouped by direction. Throws if
+// the edges are not grouped, which CheckEdgeOrderVersion should have caught before.
+template <typename GraphT, typename OutputIter>
+void BuildEdgeDirectionSplits(const GraphT &graph, OutputIter output)
+{
+    for (const auto node : irange(0u, graph.GetNumberOfNodes()))
+    {
+        const EdgeID end = graph.EndEdges(node);
+        EdgeDirectionSplit split{end, end};
+        unsigned group = 0;
+        for (const auto edge : irange(graph.BeginEdges(node), end))
+        {
+            const auto &data = graph.GetEdgeData(edge);
+            if (!data.forward && !data.backward)
+            {
+                throw exception("Edge " + std::to_string(edge) + " has no direction");
+            }
+
+            const auto edge_group = GetEdgeDirectionGroup(data);
+            if (edge_group < group)
+            {
+                throw exception("Edges of node " + std::to_string(node) +
+                                " are not grouped by direction, re-run osrm-contract");
+            }
+            if (group < 1 && edge_group >= 1)
+            {
+                split.first_bidirectional = edge;
+            }
+            if (group < 2 && edge_group >= 2)
+            {
+                split.first_backward_only = edge;
+            }
+            group = edge_group;
+        }
+        *output++ = split;
+    }
+}
+}
+}
+
+#endif // EDGE_DIRECTION_SPLIT_HPP
@@ -0,0 +1,213 @@
+#ifndef EPOCH_RECLAIMER_HPP
+#define EPOCH_RECLAIMER_HPP
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+// Epoch based reclamation of objects that readers use without taking a lock, the same idea as
+// RCU. A reader pins the current epoch in a slot of its thread for as long as it uses an object.
+// A writer replaces the object, retires the old one and advances the epoch. The old object is
+// deleted once every thread that pinned an epoch up to the one it was retired in is done.
+//
+// Pinning is a store to the slot of the thread, readers never write to shared cache lines. The
+// slots stay with the reclaimer until it is destroyed, even if their threads exit before.
+class EpochReclaimer
+{
+    // padded so that the slots of different threads do not share a cache line
+    struct Slot
+    {
+        // 0 while the thread is not reading
+        std::atomic<std::uint64_t> epoch{0};
+        // pins of the thread that are still alive, only used by the thread itself
+        unsigned depth = 0;
+        char padding[64 - sizeof(std::atomic<std::uint64_t>) - sizeof(unsigned)];
+    };
+
+    struct Retired
+    {
+        std::uint64_t epoch;
+        std::shared_ptr<void> object;
+    };
+
+  public:
+    // Marks the thread as reading from construction to destruction. Pins nest, only the
+    // outermost one of a thread counts.
+    class Pin
+    {
+      public:
+        Pin(Pin &&other) noexcept : reclaimer(other.reclaimer), slot(other.slot)
+        {
+            other.slot = nullptr;
+        }
+        Pin(const Pin &) = delete;
+        Pin &operator=(const Pin &) = delete;
+        ~Pin()
+        {
+            if (slot)
+            {
+                reclaimer->Unpin(*slot);
+            }
+        }
+
+      private:
+        friend class EpochReclaimer;
+        Pin(EpochReclaimer &reclaimer_, Slot &slot_) : reclaimer(&reclaimer_), slot(&slot_) {}
+
+        EpochReclaimer *reclaimer;
+        Slot *slot;
+    };
+
+    EpochReclaimer() : id(next_id()++) {}
+
+    EpochReclaimer(const EpochReclaimer &) = delete;
+    EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+
+    // Has to be called before loading the pointer to a shared object
+    Pin Enter()
+    {
+        Slot *slot = FindThreadSlot();
+        if (!slot)
+        {
+            slot = &RegisterThread();
+        }
+        if (slot->depth++ == 0)
+        {
+            // sequentially consistent, a writer that retires an object after this store sees
+            // the slot, one that retired it before has already published the replacement
+            slot->epoch.store(epoch.load());
+        }
+        return Pin(*this, *slot);
+    }
+
+    // Deletes object as soon as no reader can use it anymore. The replacement has to be
+    // published before.
+    template <typename T> void Retire(std::unique_ptr<T> object)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            retired.push_back({epoch.fetch_add(1), std::shared_ptr<void>(std::move(object))});
+            has_retired.store(true, std::memory_order_relaxed);
+        }
+        TryReclaim();
+    }
+
+    // Deletes the retired objects that no reader can use anymore, if no other thread does
+    void TryReclaim()
+    {
+        std::vector<Retired> reclaimed;
+        {
+            std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+            if (!lock.owns_lock())
+            {
+                return;
+            }
+
+            const auto oldest_epoch = GetOldestPinnedEpoch();
+            const auto still_used =
+                std::partition(retired.begin(), retired.end(), [oldest_epoch](const Retired &r) {
+                    return r.epoch < oldest_epoch;
+                });
+            std::move(retired.begin(), still_used, std::back_inserter(reclaimed));
+            retired.erase(retired.begin(), still_used);
+            has_retired.store(!retired.empty(), std::memory_order_relaxed);
+        }
+        // objects are deleted outside of the lock, their destructors can be slow
+    }
+
+    std::size_t GetNumberOfRetired() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return retired.size();
+    }
+
+  private:
+    void Unpin(Slot &slot)
+    {
+        BOOST_ASSERT(slot.depth > 0);
+        if (--slot.depth == 0)
+        {
+            slot.epoch.store(0, std::memory_order_release);
+            // the last reader of a retired object deletes it
+            if (has_retired.load(std::memory_order_relaxed))
+            {
+                TryReclaim();
+            }
+        }
+    }
+
+    // Slots of the calling thread by the id of their reclaimer. Ids are never reused, so
+    // entries of destroyed reclaimers are never found again.
+    static std::vector<std::pair<std::uint64_t, Slot *>> &thread_slots()
+    {
+        static thread_local std::vector<std::pair<std::uint64_t, Slot *>> slots;
+        return slots;
+    }
+
+    static std::atomic<std::uint64_t> &next_id()
+    {
+        static std::atomic<std::uint64_t> id{0};
+        return id;
+    }
+
+    Slot *FindThreadSlot() const
+    {
+        const auto &entries = thread_slots();
+        const auto entry = std::find_if(entries.rbegin(),
+                                        entries.rend(),
+                                        [this](const std::pair<std::uint64_t, Slot *> &entry) {
+                                            return entry.first == id;
+                                        });
+        return entry == entries.rend() ? nullptr : entry->second;
+    }
+
+    Slot &RegisterThread()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots.emplace_back(new Slot);
+        thread_slots().emplace_back(id, slots.back().get());
+        return *slots.back();
+    }
+
+    // Smallest epoch a thread is reading in, objects retired before it are unused.
+    // Called while holding the mutex.
+    std::uint64_t GetOldestPinnedEpoch() const
+    {
+        auto oldest_epoch = std::numeric_limits<std::uint64_t>::max();
+        for (const auto &slot : slots)
+        {
+            const auto slot_epoch = slot->epoch.load();
+            if (slot_epoch != 0)
+            {
+                oldest_epoch = std::min(oldest_epoch, slot_epoch);
+            }
+        }
+        return oldest_epoch;
+    }
+
+    const std::uint64_t id;
+    // starts at 1, 0 marks slots that are not reading
+    std::atomic<std::uint64_t> epoch{1};
+    std::atomic<bool> has_retired{false};
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::vector<Retired> retired;
+};
+}
+}
+
+#endif // EPOCH_RECLAIMER_HPP
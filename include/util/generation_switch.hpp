@@ -0,0 +1,131 @@
+#ifndef GENERATION_SWITCH_HPP
+#define GENERATION_SWITCH_HPP
+
+#include "util/epoch_reclaimer.hpp"
+#include "util/simple_logger.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace osrm
+{
+namespace util
+{
+
+// The current generation of an object that is rebuilt whenever its key changes, e.g. the
+// plugins of the dataset osrm-datastore published last. Readers switch to a new generation
+// without a lock: every Run pins an epoch, loads the current generation and compares its key
+// with the latest one. The first reader that notices a new key builds the next generation while
+// the others keep using the current one. A generation is deleted once all readers that could
+// still use it are done.
+//
+// If building a generation fails, e.g. because the key was replaced again in the meantime,
+// readers keep the current generation and retry the same key after retry_delay.
+template <typename Key, typename Generation> class GenerationSwitch
+{
+    struct Entry
+    {
+        Key key;
+        std::unique_ptr<Generation> generation;
+    };
+
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // Builds the first generation with make(key), see Run
+    template <typename Make>
+    GenerationSwitch(const Key &key,
+                     Make &&make,
+                     const Clock::duration retry_delay_ = std::chrono::seconds(1))
+        : current(new Entry{key, make(key)}), retry_delay(retry_delay_)
+    {
+    }
+
+    GenerationSwitch(const GenerationSwitch &) = delete;
+    GenerationSwitch &operator=(const GenerationSwitch &) = delete;
+
+    ~GenerationSwitch() { delete current.load(); }
+
+    // Runs query on the generation of latest_key(). make(key) builds a new generation, it is
+    // called by at most one reader at a time.
+    template <typename LatestKey, typename Make, typename Query>
+    auto Run(LatestKey &&latest_key, Make &&make, Query &&query)
+        -> decltype(query(std::declval<Generation &>()))
+    {
+        const auto pin = reclaimer.Enter();
+        Entry *entry = current.load();
+        if (latest_key() != entry->key)
+        {
+            entry = Update(latest_key, make);
+        }
+        return query(*entry->generation);
+    }
+
+    // Number of generations that were built after the first one
+    std::size_t GetNumberOfUpdates() const { return number_of_updates.load(); }
+
+  private:
+    // Builds and publishes the generation of the latest key, called by a pinned reader
+    template <typename LatestKey, typename Make> Entry *Update(LatestKey &latest_key, Make &make)
+    {
+        // the other readers do not wait for the new generation
+        std::unique_lock<std::mutex> lock(update_mutex, std::try_to_lock);
+        Entry *entry = current.load();
+        if (!lock.owns_lock())
+        {
+            return entry;
+        }
+        // read again under the lock so a reader with a stale key never replaces a newer generation
+        const Key key = latest_key();
+        if (entry->key == key)
+        {
+            return entry;
+        }
+        if (has_failed && failed_key == key && Clock::now() - failed_at < retry_delay)
+        {
+            return entry;
+        }
+
+        std::unique_ptr<Entry> next;
+        try
+        {
+            next.reset(new Entry{key, make(key)});
+        }
+        catch (const std::exception &exception)
+        {
+            util::SimpleLogger().Write(logWARNING)
+                << "keeping the current generation, building the new one failed: "
+                << exception.what();
+            has_failed = true;
+            failed_key = key;
+            failed_at = Clock::now();
+            return entry;
+        }
+        has_failed = false;
+
+        current.store(next.get());
+        ++number_of_updates;
+        reclaimer.Retire(std::unique_ptr<Entry>(entry));
+        return next.release();
+    }
+
+    std::atomic<Entry *> current;
+    std::atomic<std::size_t> number_of_updates{0};
+
+    // guard the failed key
+    std::mutex update_mutex;
+    const Clock::duration retry_delay;
+    bool has_failed = false;
+    Key failed_key{};
+    Clock::time_point failed_at;
+
+    util::EpochReclaimer reclaimer;
+};
+}
+}
+
+#endif // GENERATION_SWITCH_HPP
@@ -5,6 +5,7 @@
 #include "extractor/node_based_edge.hpp"
 #include "extractor/query_node.hpp"
 #include "extractor/restriction.hpp"
+#include "util/edge_direction_split.hpp"
 #include "util/exception.hpp"
 #include "util/fingerprint.hpp"
 #include "util/simple_logger.hpp"
@@ -19,6 +20,7 @@
 #endif  // OSRM_WITH_TBB
 
 #include <cmath>
+#include <cstdint>
 
 #include <fstream>
 #include <ios>
@@ -187,6 +189,10 @@ unsigned readHSGRFromStream(const boost::filesystem::path &hsgr_file,
                                             "Reprocess to get rid of this warning.";
     }
 
+    std::uint32_t edge_order_version = 0;
+    hsgr_input_stream.read(reinterpret_cast<char *>(&edge_order_version), sizeof(std::uint32_t));
+    CheckEdgeOrderVersion(hsgr_file.string(), edge_order_version);
+
     unsigned number_of_nodes = 0;
     unsigned number_of_edges = 0;
     hsgr_input_stream.read(reinterpret_cast<char *>(check_sum), sizeof(unsigned));
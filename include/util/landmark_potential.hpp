@@ -0,0 +1,165 @@
+#ifndef LANDMARK_POTENTIAL_HPP
+#define LANDMARK_POTENTIAL_HPP
+
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+// Shortest path distances between a core node and a landmark, INVALID_EDGE_WEIGHT if there is
+// no path. The distances of a core node are stored consecutively, one entry per landmark.
+struct LandmarkDistance
+{
+    EdgeWeight to_landmark;
+    EdgeWeight from_landmark;
+};
+
+// Lower bound of the distance between a node and the closest of a set of goal nodes, the
+// potential of a goal directed (ALT) search. Every goal has an offset that is added to its
+// distance, e.g. the distance of a core entry node to the phantom node the search ends at.
+//
+// By the triangle inequality d(v, t) >= d(v, L) - d(t, L) and d(v, t) >= d(L, t) - d(L, v)
+// for every landmark L. Taking the extreme values over all goals once per landmark keeps the
+// bound cheap for many goals. It is consistent, so a search that adds it to its keys settles
+// every node with its exact distance.
+//
+// A search towards the goals uses the bound as it is, a search from the goals backwards swaps
+// the roles of to_landmark and from_landmark. Offsets may be negative, the bound never exceeds
+// the smallest of them plus the distance, so it can be negative as well.
+class LandmarkPotential
+{
+  public:
+    LandmarkPotential(const unsigned number_of_landmarks_, const bool towards_goals_)
+        : number_of_landmarks(number_of_landmarks_), towards_goals(towards_goals_),
+          bounds(number_of_landmarks_)
+    {
+    }
+
+    // distances are the landmark distances of the goal, nullptr if it has none. A goal without
+    // distances turns the bound off.
+    void AddGoal(const LandmarkDistance *distances, const EdgeWeight offset)
+    {
+        ++number_of_goals;
+        min_goal_offset = std::min<std::int64_t>(min_goal_offset, offset);
+        if (distances == nullptr)
+        {
+            enabled = false;
+            return;
+        }
+
+        for (unsigned landmark = 0; landmark < number_of_landmarks; ++landmark)
+        {
+            auto &bound = bounds[landmark];
+            const auto leaving = Leaving(distances[landmark]);
+            const auto entering = Entering(distances[landmark]);
+
+            // a goal without a path to the landmark makes the leaving bound useless
+            if (leaving == INVALID_EDGE_WEIGHT)
+            {
+                bound.max_goal_leaving = INFINITE;
+            }
+            else if (bound.max_goal_leaving != INFINITE)
+            {
+                bound.max_goal_leaving =
+                    std::max<std::int64_t>(bound.max_goal_leaving, leaving - offset);
+            }
+
+            // a goal the landmark has no path to can not be reached from nodes it reaches
+            if (entering != INVALID_EDGE_WEIGHT)
+            {
+                bound.min_goal_entering =
+                    std::min<std::int64_t>(bound.min_goal_entering, entering + offset);
+            }
+        }
+    }
+
+    // Lower bound of the distance to the closest goal including its offset. INVALID_EDGE_WEIGHT
+    // if no goal can be reached from the node, the smallest offset if the node has no landmark
+    // distances.
+    EdgeWeight operator()(const LandmarkDistance *distances) const
+    {
+        if (number_of_goals == 0)
+        {
+            return INVALID_EDGE_WEIGHT;
+        }
+        if (distances == nullptr || !enabled)
+        {
+            return static_cast<EdgeWeight>(min_goal_offset);
+        }
+
+        std::int64_t potential = min_goal_offset;
+        for (unsigned landmark = 0; landmark < number_of_landmarks; ++landmark)
+        {
+            const auto &bound = bounds[landmark];
+            const auto leaving = Leaving(distances[landmark]);
+            const auto entering = Entering(distances[landmark]);
+
+            if (bound.max_goal_leaving != INFINITE)
+            {
+                // every goal has a path to the landmark, the node has none
+                if (leaving == INVALID_EDGE_WEIGHT)
+                {
+                    return INVALID_EDGE_WEIGHT;
+                }
+                potential = std::max(potential, leaving - bound.max_goal_leaving);
+            }
+
+            if (entering != INVALID_EDGE_WEIGHT)
+            {
+                // the landmark reaches the node but none of the goals
+                if (bound.min_goal_entering == INFINITE)
+                {
+                    return INVALID_EDGE_WEIGHT;
+                }
+                potential = std::max(potential, bound.min_goal_entering - entering);
+            }
+        }
+
+        BOOST_ASSERT(potential >= min_goal_offset);
+        return static_cast<EdgeWeight>(
+            std::min<std::int64_t>(potential, std::numeric_limits<EdgeWeight>::max() - 1));
+    }
+
+  private:
+    static constexpr std::int64_t INFINITE = std::numeric_limits<std::int64_t>::max();
+
+    struct Bound
+    {
+        // largest distance from a goal to the landmark minus its offset
+        std::int64_t max_goal_leaving = std::numeric_limits<std::int64_t>::min();
+        // smallest distance from the landmark to a goal plus its offset
+        std::int64_t min_goal_entering = INFINITE;
+    };
+
+    // distance from the node towards the landmark in search direction
+    EdgeWeight Leaving(const LandmarkDistance &distance) const
+    {
+        return towards_goals ? distance.to_landmark : distance.from_landmark;
+    }
+
+    EdgeWeight Entering(const LandmarkDistance &distance) const
+    {
+        return towards_goals ? distance.from_landmark : distance.to_landmark;
+    }
+
+    unsigned number_of_landmarks;
+    bool towards_goals;
+    std::vector<Bound> bounds;
+    std::size_t number_of_goals = 0;
+    std::int64_t min_goal_offset = INFINITE;
+    bool enabled = true;
+};
+}
+}
+
+#endif // LANDMARK_POTENTIAL_HPP
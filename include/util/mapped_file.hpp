@@ -0,0 +1,151 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include "util/exception.hpp"
+#include "util/fingerprint.hpp"
+#include "util/shared_memory_vector_wrapper.hpp"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+// Read-only contents of a file whose blocks are used in place through ShM<T, true>::vector
+// views, the same as the leaves of the StaticRTree.
+//
+// A mapped file is only paged in when it is accessed and shares the page cache with every
+// other process that maps it. Otherwise the file is read into memory at once, which avoids
+// page faults on the first queries. Either way a block is never copied again, the views stay
+// valid as long as the MappedFile lives. The views must not be written to.
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+
+    MappedFile(const boost::filesystem::path &path_, const bool map) : path(path_)
+    {
+        if (!boost::filesystem::exists(path))
+        {
+            throw exception(path.string() + " does not exist");
+        }
+
+        // empty files can not be mapped
+        const auto file_size = boost::filesystem::file_size(path);
+        if (map && file_size > 0)
+        {
+            try
+            {
+                region.open(path);
+            }
+            catch (const std::exception &exc)
+            {
+                throw exception("Mapping " + path.string() + " failed: " + exc.what());
+            }
+            begin = region.data();
+            size = region.size();
+        }
+        else
+        {
+            // std::uint64_t aligns the blocks the same as a mapping does
+            buffer.resize((file_size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+            boost::filesystem::ifstream stream(path, std::ios::binary);
+            if (!stream || !stream.read(reinterpret_cast<char *>(buffer.data()), file_size))
+            {
+                throw exception("Reading " + path.string() + " failed");
+            }
+            begin = reinterpret_cast<const char *>(buffer.data());
+            size = file_size;
+        }
+    }
+
+    MappedFile(MappedFile &&) = default;
+    MappedFile &operator=(MappedFile &&) = default;
+
+    // Contents of the whole file, the same as the views
+    const char *GetData() const { return begin; }
+    std::size_t GetSize() const { return size; }
+    std::size_t GetPosition() const { return position; }
+    bool AtEnd() const { return position == size; }
+
+    // Reads a value at the current position and moves past it
+    template <typename T> T ReadValue()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "values are copied bytewise");
+        T value;
+        std::memcpy(&value, Advance(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    // Compares the fingerprint at the current position the same as readAndCheckFingerprint
+    bool ReadAndCheckFingerprint()
+    {
+        if (size - position < sizeof(FingerPrint))
+        {
+            return false;
+        }
+        const auto fingerprint = ReadValue<FingerPrint>();
+        const auto valid = FingerPrint::GetValid();
+        return valid.IsMagicNumberOK(fingerprint) && valid.TestContractor(fingerprint) &&
+               valid.TestGraphUtil(fingerprint) && valid.TestRTree(fingerprint) &&
+               valid.TestQueryObjects(fingerprint);
+    }
+
+    // View of count elements at the current position, which moves past them
+    template <typename T> typename ShM<T, true>::vector ReadBlock(const std::size_t count)
+    {
+        if (count > (size - position) / sizeof(T))
+        {
+            throw exception(path.string() + " is truncated");
+        }
+        const char *data = Advance(count * sizeof(T));
+        if (reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0)
+        {
+            throw exception(path.string() + " has a misaligned block at " +
+                            std::to_string(data - begin));
+        }
+        return typename ShM<T, true>::vector(reinterpret_cast<T *>(const_cast<char *>(data)),
+                                             count);
+    }
+
+    // View of a block written by serializeVector
+    template <typename T> typename ShM<T, true>::vector ReadVector()
+    {
+        const auto count = ReadValue<std::uint64_t>();
+        return ReadBlock<T>(count);
+    }
+
+  private:
+    const char *Advance(const std::size_t bytes)
+    {
+        if (bytes > size - position)
+        {
+            throw exception(path.string() + " is truncated");
+        }
+        const char *data = begin + position;
+        position += bytes;
+        return data;
+    }
+
+    boost::filesystem::path path;
+    boost::iostreams::mapped_file_source region;
+    std::vector<std::uint64_t> buffer;
+    const char *begin = nullptr;
+    std::size_t size = 0;
+    std::size_t position = 0;
+};
+}
+}
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,151 @@
+#ifndef SHARDED_CLOCK_CACHE_HPP
+#define SHARDED_CLOCK_CACHE_HPP
+
+#include <boost/assert.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+// Bounded key-value cache that approximates LRU with the CLOCK (second chance) policy.
+// Keys are distributed over independent shards. Lookups only take a shared lock on their
+// shard and mark the entry as referenced with an atomic flag, so concurrent readers never
+// block each other. Inserts take the shard exclusively and evict the first unreferenced
+// entry under the clock hand.
+template <typename Key, typename Value, typename Hash = std::hash<Key>> class ShardedClockCache
+{
+    struct Entry
+    {
+        Entry(const Key &key, Value value) : key(key), value(std::move(value)), referenced(true) {}
+
+        Key key;
+        Value value;
+        mutable std::atomic<bool> referenced;
+    };
+
+    struct Shard
+    {
+        mutable boost::shared_mutex mutex;
+        std::unordered_map<Key, std::size_t, Hash> index;
+        // deque, because entries hold an atomic and can not be moved
+        std::deque<Entry> entries;
+        std::size_t hand = 0;
+    };
+
+  public:
+    ShardedClockCache(const std::size_t capacity, const std::size_t number_of_shards = 16)
+        : shard_capacity((capacity + number_of_shards - 1) / number_of_shards),
+          shards(number_of_shards)
+    {
+        BOOST_ASSERT(number_of_shards > 0);
+        for (auto &shard : shards)
+        {
+            shard = std::unique_ptr<Shard>(new Shard);
+        }
+    }
+
+    // Copies the cached value into value and returns true if key is cached
+    bool Find(const Key &key, Value &value) const
+    {
+        const auto &shard = GetShard(key);
+        boost::shared_lock<boost::shared_mutex> lock(shard.mutex);
+
+        const auto iter = shard.index.find(key);
+        if (iter == shard.index.end())
+        {
+            return false;
+        }
+
+        const auto &entry = shard.entries[iter->second];
+        entry.referenced.store(true, std::memory_order_relaxed);
+        value = entry.value;
+        return true;
+    }
+
+    // Returns true if another entry had to be evicted
+    bool Insert(const Key &key, Value value)
+    {
+        if (shard_capacity == 0)
+        {
+            return false;
+        }
+
+        auto &shard = GetShard(key);
+        boost::unique_lock<boost::shared_mutex> lock(shard.mutex);
+
+        const auto iter = shard.index.find(key);
+        if (iter != shard.index.end())
+        {
+            auto &entry = shard.entries[iter->second];
+            entry.value = std::move(value);
+            entry.referenced.store(true, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (shard.entries.size() < shard_capacity)
+        {
+            shard.index.emplace(key, shard.entries.size());
+            shard.entries.emplace_back(key, std::move(value));
+            return false;
+        }
+
+        // Advance the clock hand, giving referenced entries a second chance
+        while (shard.entries[shard.hand].referenced.exchange(false, std::memory_order_relaxed))
+        {
+            shard.hand = (shard.hand + 1) % shard.entries.size();
+        }
+
+        auto &victim = shard.entries[shard.hand];
+        shard.index.erase(victim.key);
+        shard.index.emplace(key, shard.hand);
+        victim.key = key;
+        victim.value = std::move(value);
+        victim.referenced.store(true, std::memory_order_relaxed);
+        shard.hand = (shard.hand + 1) % shard.entries.size();
+
+        return true;
+    }
+
+    void Clear()
+    {
+        for (auto &shard : shards)
+        {
+            boost::unique_lock<boost::shared_mutex> lock(shard->mutex);
+            shard->index.clear();
+            shard->entries.clear();
+            shard->hand = 0;
+        }
+    }
+
+    std::size_t Size() const
+    {
+        std::size_t size = 0;
+        for (const auto &shard : shards)
+        {
+            boost::shared_lock<boost::shared_mutex> lock(shard->mutex);
+            size += shard->entries.size();
+        }
+        return size;
+    }
+
+  private:
+    Shard &GetShard(const Key &key) const { return *shards[Hash()(key) % shards.size()]; }
+
+    const std::size_t shard_capacity;
+    std::vector<std::unique_ptr<Shard>> shards;
+};
+}
+}
+
+#endif // SHARDED_CLOCK_CACHE_HPP
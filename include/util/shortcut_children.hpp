@@ -0,0 +1,103 @@
+#ifndef SHORTCUT_CHILDREN_HPP
+#define SHORTCUT_CHILDREN_HPP
+
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+
+#include <limits>
+
+namespace osrm
+{
+namespace util
+{
+
+// The two edges a shortcut was made of, in the order they are traversed. A shortcut from u to
+// v via its middle node w consists of the edges resolving (u, w) and (w, v), if it is used from
+// v to u of the ones resolving (v, w) and (w, u).
+//
+// The children of every edge are stored consecutively: the pair for using the edge forward
+// first, then the pair for using it backward. Original edges have none. With an offset per edge
+// the children of edge e are [offsets[e], offsets[e + 1]), see BuildShortcutChildren.
+struct ShortcutChildren
+{
+    EdgeID first;
+    EdgeID second;
+};
+
+// Number of child pairs stored for an edge, one per direction a shortcut can be used in
+template <typename EdgeDataT> inline unsigned GetNumberOfShortcutChildren(const EdgeDataT &data)
+{
+    return data.shortcut ? static_cast<unsigned>(data.forward) + data.backward : 0;
+}
+
+// Edge a search used to get from one node of a packed path to the next one: the smallest
+// forward edge of from, or else the smallest backward edge of to. SPECIAL_EDGEID if none exists.
+template <typename GraphT>
+EdgeID FindPackedPathEdge(const GraphT &graph, const NodeID from, const NodeID to)
+{
+    EdgeID smaller_edge_id = SPECIAL_EDGEID;
+    EdgeWeight edge_weight = std::numeric_limits<EdgeWeight>::max();
+    for (const auto edge_id : graph.GetAdjacentEdgeRange(from))
+    {
+        const auto &data = graph.GetEdgeData(edge_id);
+        if (graph.GetTarget(edge_id) == to && data.forward && data.distance < edge_weight)
+        {
+            smaller_edge_id = edge_id;
+            edge_weight = data.distance;
+        }
+    }
+
+    if (SPECIAL_EDGEID == smaller_edge_id)
+    {
+        for (const auto edge_id : graph.GetAdjacentEdgeRange(to))
+        {
+            const auto &data = graph.GetEdgeData(edge_id);
+            if (graph.GetTarget(edge_id) == from && data.backward && data.distance < edge_weight)
+            {
+                smaller_edge_id = edge_id;
+                edge_weight = data.distance;
+            }
+        }
+    }
+    return smaller_edge_id;
+}
+
+// Resolves the children of all shortcuts of a graph, writes one offset per edge plus a sentinel
+// and the child pairs. Children that do not exist in the graph are SPECIAL_EDGEID.
+template <typename GraphT, typename OffsetIter, typename ChildrenIter>
+void BuildShortcutChildren(const GraphT &graph, OffsetIter offsets, ChildrenIter children)
+{
+    EdgeID offset = 0;
+    for (const auto node : irange(0u, graph.GetNumberOfNodes()))
+    {
+        for (const auto edge : graph.GetAdjacentEdgeRange(node))
+        {
+            *offsets++ = offset;
+
+            const auto &data = graph.GetEdgeData(edge);
+            if (!data.shortcut)
+            {
+                continue;
+            }
+
+            const NodeID target = graph.GetTarget(edge);
+            const NodeID middle = data.id;
+            if (data.forward)
+            {
+                *children++ = ShortcutChildren{FindPackedPathEdge(graph, node, middle),
+                                               FindPackedPathEdge(graph, middle, target)};
+            }
+            if (data.backward)
+            {
+                *children++ = ShortcutChildren{FindPackedPathEdge(graph, target, middle),
+                                               FindPackedPathEdge(graph, middle, node)};
+            }
+            offset += GetNumberOfShortcutChildren(data);
+        }
+    }
+    *offsets++ = offset;
+}
+}
+}
+
+#endif // SHORTCUT_CHILDREN_HPP
@@ -60,6 +60,8 @@ using NodeID = std::uint32_t;
 using EdgeID = std::uint32_t;
 using NameID = std::uint32_t;
 using EdgeWeight = std::int32_t;
+// Length of a search graph edge in decimeters, see contractor::QueryEdge
+using EdgeLength = std::uint32_t;
 
 using LaneID = std::uint8_t;
 static const LaneID INVALID_LANEID = std::numeric_limits<LaneID>::max();
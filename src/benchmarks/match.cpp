@@ -22,16 +22,19 @@ int main(int argc, const char *argv[]) try
 {
     if (argc < 2)
     {
-        std::cerr << "Usage: " << argv[0] << " data.osrm\n";
+        std::cerr << "Usage: " << argv[0] << " data.osrm | --shared-memory\n";
         return EXIT_FAILURE;
     }
 
     using namespace osrm;
 
-    // Configure based on a .osrm base path, and no datasets in shared mem from osrm-datastore
+    // Configure based on a .osrm base path, or the datasets in shared mem from osrm-datastore
     EngineConfig config;
-    config.storage_config = {argv[1]};
-    config.use_shared_memory = false;
+    config.use_shared_memory = std::string(argv[1]) == "--shared-memory";
+    if (!config.use_shared_memory)
+    {
+        config.storage_config = {argv[1]};
+    }
 
     // Routing machine with several services (such as Route, Table, Nearest, Trip, Match)
     OSRM osrm{config};
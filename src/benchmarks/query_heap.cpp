@@ -0,0 +1,186 @@
+#include "engine/datafacade/internal_datafacade.hpp"
+#include "engine/search_engine_data.hpp"
+#include "storage/storage_config.hpp"
+#include "util/binary_heap.hpp"
+#include "util/d_ary_heap.hpp"
+#include "util/timing_util.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace benchmarks
+{
+
+using Facade = engine::datafacade::InternalDataFacade;
+
+// Choosen by a fair W20 dice roll (this value is completely arbitrary)
+constexpr unsigned RANDOM_SEED = 13;
+
+struct SearchStatistics
+{
+    std::uint64_t inserts = 0;
+    std::uint64_t decreases = 0;
+    std::uint64_t deletes = 0;
+    // sum of all settled distances, has to be the same for every heap
+    std::uint64_t checksum = 0;
+};
+
+// Runs the upward searches of a CH query from every start node until their search spaces are
+// exhausted, the heap workload of the many-to-many and multi-target searches. Both directions
+// are searched, so the trace covers the forward and the backward search space of every node.
+template <typename Heap>
+SearchStatistics runSearches(const Facade &facade,
+                             const std::vector<NodeID> &start_nodes,
+                             Heap &heap)
+{
+    SearchStatistics statistics;
+    for (const bool forward : {true, false})
+    {
+        for (const auto start_node : start_nodes)
+        {
+            heap.Clear();
+            heap.Insert(start_node, 0, start_node);
+            ++statistics.inserts;
+
+            while (!heap.Empty())
+            {
+                const NodeID node = heap.DeleteMin();
+                const int distance = heap.GetKey(node);
+                ++statistics.deletes;
+                statistics.checksum += distance;
+
+                for (const auto edge : facade.GetAdjacentEdgeRange(node))
+                {
+                    const auto &data = facade.GetEdgeData(edge);
+                    if (!(forward ? data.forward : data.backward))
+                    {
+                        continue;
+                    }
+
+                    const NodeID to = facade.GetTarget(edge);
+                    const int to_distance = distance + data.distance;
+                    if (!heap.WasInserted(to))
+                    {
+                        heap.Insert(to, to_distance, node);
+                        ++statistics.inserts;
+                    }
+                    else if (to_distance < heap.GetKey(to))
+                    {
+                        heap.GetData(to).parent = node;
+                        heap.DecreaseKey(to, to_distance);
+                        ++statistics.decreases;
+                    }
+                }
+            }
+        }
+    }
+    return statistics;
+}
+
+template <typename Heap>
+void benchmarkHeap(const Facade &facade,
+                   const std::vector<NodeID> &start_nodes,
+                   const std::string &name,
+                   SearchStatistics &reference)
+{
+    Heap heap(facade.GetNumberOfNodes());
+
+    // warm up, also allocates the heap storage. Every search starts with a Clear, so the
+    // timings include the cost of clearing the index storage.
+    runSearches(facade, start_nodes, heap);
+
+    TIMER_START(searches);
+    const auto statistics = runSearches(facade, start_nodes, heap);
+    TIMER_STOP(searches);
+
+    if (reference.deletes == 0)
+    {
+        reference = statistics;
+    }
+    if (statistics.checksum != reference.checksum)
+    {
+        std::cerr << name << " settled different distances" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    const auto number_of_searches = 2 * start_nodes.size();
+    std::cout << std::left << std::setw(28) << name << std::right << std::setw(10)
+              << std::fixed << std::setprecision(3) << TIMER_MSEC(searches) << "ms"
+              << std::setw(10) << TIMER_USEC(searches) / number_of_searches << "us/search"
+              << std::endl;
+}
+}
+}
+
+int main(int argc, char **argv) try
+{
+    using namespace osrm;
+    using namespace osrm::benchmarks;
+
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " data.osrm [number of searches]\n";
+        return EXIT_FAILURE;
+    }
+
+    const storage::StorageConfig config(argv[1]);
+    if (!config.IsValid())
+    {
+        std::cerr << "Invalid dataset " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    const Facade facade(config);
+
+    const unsigned number_of_searches = argc > 2 ? std::stoul(argv[2]) : 1000;
+    std::mt19937 generator(RANDOM_SEED);
+    std::uniform_int_distribution<NodeID> node_distribution(0, facade.GetNumberOfNodes() - 1);
+    std::vector<NodeID> start_nodes(number_of_searches);
+    for (auto &node : start_nodes)
+    {
+        node = node_distribution(generator);
+    }
+
+    using engine::HeapData;
+    using HashStorage = util::UnorderedMapStorage<NodeID, int>;
+    using ArrayStorage = util::ArrayStorage<NodeID, NodeID>;
+    using GenerationStorage = util::GenerationStorage<NodeID, NodeID>;
+
+    SearchStatistics reference;
+    benchmarkHeap<util::BinaryHeap<NodeID, NodeID, int, HeapData, HashStorage>>(
+        facade, start_nodes, "BinaryHeap hash storage", reference);
+    benchmarkHeap<util::BinaryHeap<NodeID, NodeID, int, HeapData, ArrayStorage>>(
+        facade, start_nodes, "BinaryHeap array storage", reference);
+    benchmarkHeap<util::DAryHeap<NodeID, NodeID, int, HeapData, HashStorage, 2>>(
+        facade, start_nodes, "2-ary heap hash storage", reference);
+    benchmarkHeap<util::DAryHeap<NodeID, NodeID, int, HeapData, HashStorage, 4>>(
+        facade, start_nodes, "4-ary heap hash storage", reference);
+    benchmarkHeap<util::DAryHeap<NodeID, NodeID, int, HeapData, HashStorage, 8>>(
+        facade, start_nodes, "8-ary heap hash storage", reference);
+    benchmarkHeap<util::DAryHeap<NodeID, NodeID, int, HeapData, ArrayStorage, 4>>(
+        facade, start_nodes, "4-ary heap array storage", reference);
+    benchmarkHeap<util::BinaryHeap<NodeID, NodeID, int, HeapData, GenerationStorage>>(
+        facade, start_nodes, "BinaryHeap generation", reference);
+    benchmarkHeap<util::DAryHeap<NodeID, NodeID, int, HeapData, GenerationStorage, 4>>(
+        facade, start_nodes, "4-ary heap generation", reference);
+
+    std::cout << reference.inserts << " inserts, " << reference.decreases << " decreases, "
+              << reference.deletes << " deletes per run" << std::endl;
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,150 @@
+#include "engine/datafacade/internal_datafacade.hpp"
+#include "engine/search_engine_data.hpp"
+#include "util/arena.hpp"
+#include "util/integer_range.hpp"
+#include "util/timing_util.hpp"
+
+#include "osrm/coordinate.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/json_container.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/route_parameters.hpp"
+#include "osrm/status.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+// Counts every heap allocation of the process
+std::atomic<std::uint64_t> number_of_allocations{0};
+}
+
+void *operator new(std::size_t size)
+{
+    ++number_of_allocations;
+    if (void *pointer = std::malloc(size == 0 ? 1 : size))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+
+namespace osrm
+{
+namespace benchmarks
+{
+
+// Choosen by a fair W20 dice roll (this value is completely arbitrary)
+constexpr unsigned RANDOM_SEED = 13;
+
+struct RunStatistics
+{
+    std::uint64_t allocations = 0;
+    unsigned successful_routes = 0;
+};
+
+RunStatistics runRoutes(OSRM &osrm, const std::vector<RouteParameters> &queries)
+{
+    RunStatistics statistics;
+    const auto allocations_before = number_of_allocations.load();
+    for (const auto &parameters : queries)
+    {
+        util::json::Object result;
+        if (osrm.Route(parameters, result) == Status::Ok)
+        {
+            ++statistics.successful_routes;
+        }
+    }
+    statistics.allocations = number_of_allocations.load() - allocations_before;
+    return statistics;
+}
+}
+}
+
+int main(int argc, char **argv) try
+{
+    using namespace osrm;
+    using namespace osrm::benchmarks;
+
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " data.osrm [number of routes]\n";
+        return EXIT_FAILURE;
+    }
+
+    EngineConfig config;
+    config.storage_config = {argv[1]};
+    config.use_shared_memory = false;
+    if (!config.IsValid())
+    {
+        std::cerr << "Invalid dataset " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // picks random coordinates of the road network
+    std::vector<util::Coordinate> coordinates;
+    {
+        const engine::datafacade::InternalDataFacade facade(config.storage_config);
+        std::mt19937 generator(RANDOM_SEED);
+        std::uniform_int_distribution<NodeID> node_distribution(
+            0, facade.GetNumberOfNodes() - 1);
+        const unsigned number_of_routes = argc > 2 ? std::stoul(argv[2]) : 1000;
+        for (unsigned index = 0; index < 2 * number_of_routes; ++index)
+        {
+            coordinates.push_back(facade.GetCoordinateOfNode(node_distribution(generator)));
+        }
+    }
+
+    std::vector<RouteParameters> queries(coordinates.size() / 2);
+    for (const auto index : util::irange<std::size_t>(0, queries.size()))
+    {
+        queries[index].steps = true;
+        queries[index].overview = RouteParameters::OverviewType::Full;
+        queries[index].coordinates = {coordinates[2 * index], coordinates[2 * index + 1]};
+    }
+
+    OSRM osrm{config};
+
+    // warm up, sizes the heaps and the arena of this thread
+    runRoutes(osrm, queries);
+
+    const auto &arena_statistics = engine::SearchEngineData::GetRequestArena().GetStatistics();
+    const auto arena_blocks_before = arena_statistics.block_allocations;
+    const auto arena_allocations_before = arena_statistics.allocations;
+
+    TIMER_START(routes);
+    const auto statistics = runRoutes(osrm, queries);
+    TIMER_STOP(routes);
+
+    const auto number_of_queries = static_cast<double>(queries.size());
+    std::cout << statistics.successful_routes << "/" << queries.size() << " routes found in "
+              << std::fixed << std::setprecision(3) << TIMER_MSEC(routes) << "ms ("
+              << TIMER_USEC(routes) / number_of_queries << "us/route)" << std::endl;
+    std::cout << "heap allocations:  " << std::setprecision(1)
+              << statistics.allocations / number_of_queries << " per route" << std::endl;
+    std::cout << "arena allocations: "
+              << (arena_statistics.allocations - arena_allocations_before) / number_of_queries
+              << " per route, " << arena_statistics.block_allocations - arena_blocks_before
+              << " blocks allocated, " << arena_statistics.capacity << " bytes retained"
+              << std::endl;
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,119 @@
+#include "engine/datafacade/internal_datafacade.hpp"
+#include "util/integer_range.hpp"
+#include "util/timing_util.hpp"
+
+#include "osrm/coordinate.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/json_container.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/status.hpp"
+#include "osrm/table_parameters.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace benchmarks
+{
+
+// Choosen by a fair W20 dice roll (this value is completely arbitrary)
+constexpr unsigned RANDOM_SEED = 13;
+constexpr unsigned TABLE_SIZE = 25;
+
+unsigned runTables(OSRM &osrm, const std::vector<TableParameters> &queries)
+{
+    unsigned successful_tables = 0;
+    for (const auto &parameters : queries)
+    {
+        util::json::Object result;
+        if (osrm.Table(parameters, result) == Status::Ok)
+        {
+            ++successful_tables;
+        }
+    }
+    return successful_tables;
+}
+}
+}
+
+// Compares the engine on the files with the engine on the data of osrm-datastore, which can be
+// loaded with and without --huge-pages
+int main(int argc, char **argv) try
+{
+    using namespace osrm;
+    using namespace osrm::benchmarks;
+
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+    const auto shared_memory = std::find(arguments.begin(), arguments.end(), "--shared-memory");
+    const bool use_shared_memory = shared_memory != arguments.end();
+    if (use_shared_memory)
+    {
+        arguments.erase(shared_memory);
+    }
+
+    if (arguments.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " data.osrm [number of tables] [--shared-memory]\n";
+        return EXIT_FAILURE;
+    }
+
+    EngineConfig config;
+    config.storage_config = {arguments[0]};
+    config.use_shared_memory = use_shared_memory;
+    if (!config.storage_config.IsValid())
+    {
+        std::cerr << "Invalid dataset " << arguments[0] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // picks random coordinates of the road network
+    const unsigned number_of_tables = arguments.size() > 1 ? std::stoul(arguments[1]) : 100;
+    std::vector<util::Coordinate> coordinates;
+    {
+        const engine::datafacade::InternalDataFacade facade(config.storage_config);
+        std::mt19937 generator(RANDOM_SEED);
+        std::uniform_int_distribution<NodeID> node_distribution(
+            0, facade.GetNumberOfNodes() - 1);
+        for (unsigned index = 0; index < TABLE_SIZE * number_of_tables; ++index)
+        {
+            coordinates.push_back(facade.GetCoordinateOfNode(node_distribution(generator)));
+        }
+    }
+
+    std::vector<TableParameters> queries(number_of_tables);
+    for (const auto index : util::irange<std::size_t>(0, queries.size()))
+    {
+        queries[index].coordinates.assign(coordinates.begin() + TABLE_SIZE * index,
+                                          coordinates.begin() + TABLE_SIZE * (index + 1));
+    }
+
+    OSRM osrm{config};
+
+    // warm up, pages the data in
+    runTables(osrm, queries);
+
+    TIMER_START(tables);
+    const auto successful_tables = runTables(osrm, queries);
+    TIMER_STOP(tables);
+
+    const auto number_of_queries = static_cast<double>(queries.size());
+    std::cout << successful_tables << "/" << queries.size() << " tables of " << TABLE_SIZE << "x"
+              << TABLE_SIZE << " found in " << std::fixed << std::setprecision(3)
+              << TIMER_MSEC(tables) << "ms (" << TIMER_MSEC(tables) / number_of_queries
+              << "ms/table, " << number_of_queries / TIMER_SEC(tables) << " tables/s)"
+              << std::endl;
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
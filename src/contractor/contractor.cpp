@@ -1,6 +1,8 @@
 #include "contractor/contractor.hpp"
+#include "contractor/core_landmarks.hpp"
 #include "contractor/crc32_processor.hpp"
 #include "contractor/graph_contractor.hpp"
+#include "contractor/graph_customizer.hpp"
 
 #include "extractor/compressed_edge_container.hpp"
 #include "extractor/edge_based_graph_factory.hpp"
@@ -35,6 +37,7 @@
 
 #include <algorithm>
 #include <bitset>
+#include <cmath>
 #include <cstdint>
 #include <fstream>
 #include <iterator>
@@ -115,6 +118,15 @@ int Contractor::Run()
                                                config.datasource_indexes_path,
                                                config.rtree_leaf_path);
 
+    if (config.use_cached_hierarchy)
+    {
+        CustomizeGraph(max_edge_id, edge_based_edge_list);
+        TIMER_STOP(preparing);
+        util::SimpleLogger().Write() << "Preprocessing : " << TIMER_SEC(preparing) << " seconds";
+        util::SimpleLogger().Write() << "finished preprocessing";
+        return 0;
+    }
+
     // Contracting the edge-expanded graph
 
     TIMER_START(contraction);
@@ -137,11 +149,16 @@ int Contractor::Run()
         throw util::exception("Failed reading node weights.");
     }
 
+    util::SimpleLogger().Write() << "Computing node lengths.";
+    std::vector<EdgeLength> node_lengths;
+    ComputeNodeLengths(max_edge_id, node_lengths);
+
     util::DeallocatingVector<QueryEdge> contracted_edge_list;
     ContractGraph(max_edge_id,
                   edge_based_edge_list,
                   contracted_edge_list,
                   std::move(node_weights),
+                  node_lengths,
                   is_core_node,
                   node_levels);
     TIMER_STOP(contraction);
@@ -149,6 +166,8 @@ int Contractor::Run()
     util::SimpleLogger().Write() << "Contraction took " << TIMER_SEC(contraction) << " sec";
 
     std::size_t number_of_used_edges = WriteContractedGraph(max_edge_id, contracted_edge_list);
+    WriteLengths(node_lengths, contracted_edge_list);
+    WriteCoreLandmarks(contracted_edge_list, is_core_node);
     WriteCoreNodeMarker(std::move(is_core_node));
     if (!config.use_cached_priority)
     {
@@ -867,6 +886,69 @@ void Contractor::WriteCoreNodeMarker(std::vector<bool> &&in_is_core_node) const
                                     sizeof(char) * unpacked_bool_flags.size());
 }
 
+void Contractor::ReadCoreNodeMarker(std::vector<bool> &is_core_node) const
+{
+    boost::filesystem::ifstream core_marker_input_stream(config.core_output_path,
+                                                         std::ios::binary);
+    unsigned size = 0;
+    core_marker_input_stream.read((char *)&size, sizeof(unsigned));
+    std::vector<char> unpacked_bool_flags(size);
+    core_marker_input_stream.read((char *)unpacked_bool_flags.data(),
+                                  sizeof(char) * unpacked_bool_flags.size());
+
+    is_core_node.resize(size);
+    for (auto i = 0u; i < size; ++i)
+    {
+        is_core_node[i] = unpacked_bool_flags[i] != 0;
+    }
+}
+
+// Replaces the weights of the contracted graph of the last run by the ones of the updated
+// edge-based graph. The hierarchy is kept, which makes this a matter of seconds rather than a
+// complete contraction. It has to be contracted with --customizable. Core markers stay valid,
+// the lengths of the shortcuts and the landmarks are computed again.
+void Contractor::CustomizeGraph(
+    const EdgeID max_edge_id,
+    const util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list)
+{
+    util::SimpleLogger().Write() << "Loading contracted graph " << config.graph_output_path;
+    std::vector<GraphCustomizer::QueryGraph::NodeArrayEntry> node_list;
+    std::vector<GraphCustomizer::QueryGraph::EdgeArrayEntry> edge_list;
+    unsigned checksum = 0;
+    util::readHSGRFromStream(config.graph_output_path, node_list, edge_list, &checksum);
+
+    std::vector<EdgeLength> node_lengths;
+    std::vector<EdgeLength> edge_lengths;
+    std::ifstream length_input_stream(config.length_output_path, std::ios::binary);
+    if (!length_input_stream || !util::readAndCheckFingerprint(length_input_stream) ||
+        !util::deserializeVector(length_input_stream, node_lengths) ||
+        !util::deserializeVector(length_input_stream, edge_lengths) ||
+        edge_lengths.size() != edge_list.size())
+    {
+        throw util::exception("Failed reading " + config.length_output_path +
+                              ", the graph needs to be contracted again");
+    }
+
+    const GraphCustomizer::QueryGraph graph(node_list, edge_list);
+
+    TIMER_START(customization);
+    const GraphCustomizer customizer(graph);
+    util::DeallocatingVector<QueryEdge> contracted_edge_list;
+    customizer.Run(edge_based_edge_list, node_lengths, contracted_edge_list);
+    TIMER_STOP(customization);
+
+    util::SimpleLogger().Write() << "Customized " << contracted_edge_list.size() << " edges on "
+                                 << customizer.GetNumberOfLevels() << " levels in "
+                                 << TIMER_SEC(customization) << " sec";
+
+    WriteContractedGraph(max_edge_id, contracted_edge_list);
+    WriteLengths(node_lengths, contracted_edge_list);
+
+    std::vector<bool> is_core_node;
+    ReadCoreNodeMarker(is_core_node);
+    WriteCoreLandmarks(contracted_edge_list, is_core_node);
+}
+
 std::size_t
 Contractor::WriteContractedGraph(unsigned max_node_id,
                                  const util::DeallocatingVector<QueryEdge> &contracted_edge_list)
@@ -880,6 +962,8 @@ Contractor::WriteContractedGraph(unsigned max_node_id,
     const util::FingerPrint fingerprint = util::FingerPrint::GetValid();
     boost::filesystem::ofstream hsgr_output_stream(config.graph_output_path, std::ios::binary);
     hsgr_output_stream.write((char *)&fingerprint, sizeof(util::FingerPrint));
+    const std::uint32_t edge_order_version = util::HSGR_EDGE_ORDER_VERSION;
+    hsgr_output_stream.write((char *)&edge_order_version, sizeof(std::uint32_t));
     const NodeID max_used_node_id = [&contracted_edge_list] {
         NodeID tmp_max = 0;
         for (const QueryEdge &edge : contracted_edge_list)
@@ -985,6 +1069,107 @@ Contractor::WriteContractedGraph(unsigned max_node_id,
     return number_of_used_edges;
 }
 
+// Writes the lengths of the edge-based nodes followed by the lengths of the contracted edges.
+// The edges have to be sorted in the same order as in the .hsgr already.
+void Contractor::WriteLengths(const std::vector<EdgeLength> &node_lengths,
+                              const util::DeallocatingVector<QueryEdge> &contracted_edge_list) const
+{
+    std::vector<EdgeLength> edge_lengths(contracted_edge_list.size());
+    std::transform(contracted_edge_list.begin(),
+                   contracted_edge_list.end(),
+                   edge_lengths.begin(),
+                   [](const QueryEdge &edge) { return edge.length; });
+
+    std::ofstream length_output_stream(config.length_output_path, std::ios::binary);
+    if (!util::writeFingerprint(length_output_stream) ||
+        !util::serializeVector(length_output_stream, node_lengths) ||
+        !util::serializeVector(length_output_stream, edge_lengths))
+    {
+        throw util::exception("Failed writing " + config.length_output_path);
+    }
+}
+
+// Selects the landmarks of the core and writes their distances. The edges have to be sorted in
+// the same order as in the .hsgr already, the file is tied to its checksum.
+void Contractor::WriteCoreLandmarks(const util::DeallocatingVector<QueryEdge> &contracted_edge_list,
+                                    const std::vector<bool> &is_core_node) const
+{
+    TIMER_START(landmarks);
+    const auto core_landmarks =
+        ComputeCoreLandmarks(contracted_edge_list, is_core_node, config.number_of_core_landmarks);
+    TIMER_STOP(landmarks);
+    if (!core_landmarks.landmarks.empty())
+    {
+        util::SimpleLogger().Write() << "Selected " << core_landmarks.landmarks.size()
+                                     << " core landmarks in " << TIMER_SEC(landmarks) << " sec";
+    }
+
+    RangebasedCRC32 crc32_calculator;
+    const unsigned checksum = crc32_calculator(contracted_edge_list);
+    if (!writeCoreLandmarks(config.landmarks_output_path, checksum, core_landmarks))
+    {
+        throw util::exception("Failed writing " + config.landmarks_output_path);
+    }
+}
+
+// Sums up the segment lengths of every edge-based node. The leaves of the r-tree hold every
+// segment of the edge-based graph exactly once, which makes them a convenient source for this.
+void Contractor::ComputeNodeLengths(const EdgeID max_edge_id,
+                                    std::vector<EdgeLength> &node_lengths) const
+{
+    boost::filesystem::ifstream nodes_input_stream(config.node_based_graph_path,
+                                                   std::ios::binary);
+    if (!nodes_input_stream)
+    {
+        throw util::exception("Failed to open " + config.node_based_graph_path);
+    }
+
+    unsigned number_of_nodes = 0;
+    nodes_input_stream.read((char *)&number_of_nodes, sizeof(unsigned));
+    std::vector<extractor::QueryNode> query_nodes(number_of_nodes);
+    nodes_input_stream.read(reinterpret_cast<char *>(query_nodes.data()),
+                            number_of_nodes * sizeof(extractor::QueryNode));
+
+    using LeafNode = util::StaticRTree<extractor::EdgeBasedNode>::LeafNode;
+    using boost::interprocess::file_mapping;
+    using boost::interprocess::mapped_region;
+    using boost::interprocess::read_only;
+
+    const file_mapping mapping{config.rtree_leaf_path.c_str(), read_only};
+    mapped_region region{mapping, read_only};
+    region.advise(mapped_region::advice_sequential);
+
+    const auto first = static_cast<const LeafNode *>(region.get_address());
+    const auto last = first + (region.get_size() / sizeof(LeafNode));
+
+    // accumulate in meters and round only once per node
+    std::vector<float> lengths(max_edge_id + 1, 0.f);
+    std::for_each(first, last, [&](const LeafNode &current_node) {
+        for (std::size_t i = 0; i < current_node.object_count; ++i)
+        {
+            const auto &leaf_object = current_node.objects[i];
+            const auto &u = query_nodes[leaf_object.u];
+            const auto &v = query_nodes[leaf_object.v];
+            const double segment_length = util::coordinate_calculation::greatCircleDistance(
+                util::Coordinate{u.lon, u.lat}, util::Coordinate{v.lon, v.lat});
+
+            if (leaf_object.forward_segment_id.enabled)
+            {
+                lengths[leaf_object.forward_segment_id.id] += segment_length;
+            }
+            if (leaf_object.reverse_segment_id.enabled)
+            {
+                lengths[leaf_object.reverse_segment_id.id] += segment_length;
+            }
+        }
+    });
+
+    node_lengths.resize(lengths.size());
+    std::transform(lengths.begin(), lengths.end(), node_lengths.begin(), [](const float length) {
+        return static_cast<EdgeLength>(std::round(length * 10.f));
+    });
+}
+
 /**
  \brief Build contracted graph.
  */
@@ -993,15 +1178,19 @@ void Contractor::ContractGraph(
     util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list,
     util::DeallocatingVector<QueryEdge> &contracted_edge_list,
     std::vector<EdgeWeight> &&node_weights,
+    const std::vector<EdgeLength> &node_lengths,
     std::vector<bool> &is_core_node,
     std::vector<float> &inout_node_levels) const
 {
     std::vector<float> node_levels;
     node_levels.swap(inout_node_levels);
 
-    GraphContractor graph_contractor(
-        max_edge_id + 1, edge_based_edge_list, std::move(node_levels), std::move(node_weights));
-    graph_contractor.Run(config.core_factor);
+    GraphContractor graph_contractor(max_edge_id + 1,
+                                     edge_based_edge_list,
+                                     std::move(node_levels),
+                                     std::move(node_weights),
+                                     node_lengths);
+    graph_contractor.Run(config.core_factor, config.customizable);
     graph_contractor.GetEdges(contracted_edge_list);
     graph_contractor.GetCoreMarker(is_core_node);
     graph_contractor.GetNodeLevels(inout_node_levels);
@@ -1,6 +1,8 @@
 #include "engine/engine.hpp"
 #include "engine/api/route_parameters.hpp"
 #include "engine/engine_config.hpp"
+#include "engine/phantom_node_cache.hpp"
+#include "engine/search_engine_data.hpp"
 #include "engine/status.hpp"
 
 #include "engine/plugins/match.hpp"
@@ -16,122 +18,307 @@
 #include "engine/datafacade/internal_datafacade.hpp"
 #include "engine/datafacade/shared_datafacade.hpp"
 
-#include "storage/shared_barriers.hpp"
+#include "storage/dataset_file.hpp"
+#include "storage/shared_datatype.hpp"
+#include "storage/shared_memory.hpp"
+#include "util/exception.hpp"
+#include "util/generation_switch.hpp"
 #include "util/make_unique.hpp"
 #include "util/simple_logger.hpp"
 
 #include <boost/assert.hpp>
-#include <boost/interprocess/sync/named_condition.hpp>
-#include <boost/interprocess/sync/scoped_lock.hpp>
-#include <boost/thread/lock_types.hpp>
+#include <boost/filesystem/operations.hpp>
 
 #include <algorithm>
 #include <fstream>
 #include <utility>
 #include <vector>
 
+namespace
+{
+// Runs a query of a plugin with the thread local memory it needs
+template <typename ParameterT, typename PluginT, typename ResultT>
+osrm::engine::Status RunQuery(const ParameterT &parameters, PluginT &plugin, ResultT &result)
+{
+    // frees the route results once the response was built
+    osrm::engine::SearchEngineData::RequestArenaScope arena_scope;
+    // hands the heaps of this thread back to the pool once the query is done
+    osrm::engine::SearchEngineData::ThreadLocalStorageScope heap_scope;
+
+    return plugin.HandleRequest(parameters, result);
+}
+
+osrm::util::json::Object MakeJSON(const osrm::engine::PhantomNodeCache::Counters &counters,
+                                  const std::size_t size)
+{
+    osrm::util::json::Object result;
+    result.values["hits"] = counters.hits.load(std::memory_order_relaxed);
+    result.values["misses"] = counters.misses.load(std::memory_order_relaxed);
+    result.values["evictions"] = counters.evictions.load(std::memory_order_relaxed);
+    result.values["invalidations"] = counters.invalidations.load(std::memory_order_relaxed);
+    result.values["size"] = size;
+    return result;
+}
+} // anon. ns
+
 namespace osrm
 {
 namespace engine
 {
-struct Engine::EngineLock
+
+// The plugins of an engine. This is the only virtual dispatch on the way of a query: below it the
+// plugins and routing algorithms are instantiated for the concrete facade, so the facade calls in
+// the search loops are direct calls the compiler can inline.
+struct Engine::PluginSet
 {
-    // will only be initialized if shared memory is used
-    storage::SharedBarriers barrier;
-    // decrease number of concurrent queries
-    void DecreaseQueryCount();
-    // increase number of concurrent queries
-    void IncreaseQueryCount();
+    virtual ~PluginSet() = default;
+
+    virtual Status Route(const api::RouteParameters &params, util::json::Object &result) = 0;
+    virtual Status Table(const api::TableParameters &params, util::json::Object &result) = 0;
+    virtual Status Nearest(const api::NearestParameters &params, util::json::Object &result) = 0;
+    virtual Status Trip(const api::TripParameters &params, util::json::Object &result) = 0;
+    virtual Status Match(const api::MatchParameters &params, util::json::Object &result) = 0;
+    virtual Status Tile(const api::TileParameters &params, std::string &result) = 0;
+    virtual Status MultiTarget(const api::MultiTargetParameters &params,
+                               util::json::Object &result) = 0;
+    virtual Status MultiTargetBatch(const std::vector<api::MultiTargetParameters> &queries,
+                                    const api::MultiTargetBatchHandler &handler) = 0;
+    virtual Status SmoothVia(const api::SmoothViaParameters &params,
+                             util::json::Object &result) = 0;
 };
 
-// decrease number of concurrent queries
-void Engine::EngineLock::DecreaseQueryCount()
+namespace
 {
-    // lock query
-    boost::interprocess::scoped_lock<boost::interprocess::named_mutex> query_lock(
-        barrier.query_mutex);
+template <typename FacadeT> class FacadePluginSet final : public Engine::PluginSet
+{
+  public:
+    FacadePluginSet(FacadeT &facade_,
+                    const EngineConfig &config,
+                    plugins::SmoothViaCounters &smooth_via_counters,
+                    PhantomNodeCache *phantom_node_cache)
+        : route_plugin(facade_, config.max_locations_viaroute),
+          table_plugin(facade_,
+                       config.max_locations_distance_table,
+                       config.table_parallel_threshold,
+                       config.max_table_threads),
+          nearest_plugin(facade_),
+          trip_plugin(facade_, config.max_locations_trip),
+          match_plugin(facade_, config.max_locations_map_matching), tile_plugin(facade_),
+          multi_target_plugin(facade_,
+                              config.multi_target_parallel_threshold,
+                              config.max_multi_target_threads,
+                              phantom_node_cache),
+          smooth_via_plugin(facade_, smooth_via_counters, phantom_node_cache)
+    {
+    }
 
-    // decrement query count
-    --(barrier.number_of_queries);
-    BOOST_ASSERT_MSG(0 <= barrier.number_of_queries, "invalid number of queries");
+    Status Route(const api::RouteParameters &params, util::json::Object &result) override
+    {
+        return RunQuery(params, route_plugin, result);
+    }
 
-    // notify all processes that were waiting for this condition
-    if (0 == barrier.number_of_queries)
+    Status Table(const api::TableParameters &params, util::json::Object &result) override
     {
-        barrier.no_running_queries_condition.notify_all();
+        return RunQuery(params, table_plugin, result);
     }
-}
 
-// increase number of concurrent queries
-void Engine::EngineLock::IncreaseQueryCount()
-{
-    // lock update pending
-    boost::interprocess::scoped_lock<boost::interprocess::named_mutex> pending_lock(
-        barrier.pending_update_mutex);
+    Status Nearest(const api::NearestParameters &params, util::json::Object &result) override
+    {
+        return RunQuery(params, nearest_plugin, result);
+    }
 
-    // lock query
-    boost::interprocess::scoped_lock<boost::interprocess::named_mutex> query_lock(
-        barrier.query_mutex);
+    Status Trip(const api::TripParameters &params, util::json::Object &result) override
+    {
+        return RunQuery(params, trip_plugin, result);
+    }
 
-    // unlock update pending
-    pending_lock.unlock();
+    Status Match(const api::MatchParameters &params, util::json::Object &result) override
+    {
+        return RunQuery(params, match_plugin, result);
+    }
 
-    // increment query count
-    ++(barrier.number_of_queries);
-}
-} // ns engine
-} // ns osrm
+    Status Tile(const api::TileParameters &params, std::string &result) override
+    {
+        return RunQuery(params, tile_plugin, result);
+    }
 
-namespace
-{
-// Abstracted away the query locking into a template function
-// Works the same for every plugin.
-template <typename ParameterT, typename PluginT, typename ResultT>
-osrm::engine::Status RunQuery(const std::unique_ptr<osrm::engine::Engine::EngineLock> &lock,
-                              osrm::engine::datafacade::BaseDataFacade &facade,
-                              const ParameterT &parameters,
-                              PluginT &plugin,
-                              ResultT &result)
+    Status MultiTarget(const api::MultiTargetParameters &params,
+                       util::json::Object &result) override
+    {
+        return RunQuery(params, multi_target_plugin, result);
+    }
+
+    Status MultiTargetBatch(const std::vector<api::MultiTargetParameters> &queries,
+                            const api::MultiTargetBatchHandler &handler) override
+    {
+        return RunQuery(queries, multi_target_plugin, handler);
+    }
+
+    Status SmoothVia(const api::SmoothViaParameters &params, util::json::Object &result) override
+    {
+        return RunQuery(params, smooth_via_plugin, result);
+    }
+
+  private:
+    plugins::ViaRoutePlugin<FacadeT> route_plugin;
+    plugins::TablePlugin<FacadeT> table_plugin;
+    plugins::NearestPlugin nearest_plugin;
+    plugins::TripPlugin<FacadeT> trip_plugin;
+    plugins::MatchPlugin<FacadeT> match_plugin;
+    plugins::TilePlugin tile_plugin;
+    plugins::MultiTargetPlugin<FacadeT> multi_target_plugin;
+    plugins::SmoothViaPlugin<FacadeT> smooth_via_plugin;
+};
+} // anon. ns
+
+// The dataset osrm-datastore published last, with the plugins that use it. Queries switch to a
+// new dataset without a lock, see util::GenerationSwitch. The first query that notices new
+// regions in shared memory loads them while the others keep using the previous dataset. Deleting
+// a generation detaches its regions. osrm-datastore only marks them for removal, so the kernel
+// frees them after the last engine detached.
+struct Engine::SharedDataset
 {
-    if (!lock)
+    SharedDataset(const EngineConfig &config_, plugins::SmoothViaCounters &smooth_via_counters_)
+        : config(config_), smooth_via_counters(smooth_via_counters_),
+          phantom_node_cache_counters(config.phantom_node_cache_size > 0
+                                          ? std::make_shared<PhantomNodeCache::Counters>()
+                                          : nullptr),
+          regions_memory(OpenCurrentRegions()),
+          current_regions(
+              static_cast<const storage::SharedCurrentRegions *>(regions_memory->Ptr())),
+          generations(current_regions->Load(),
+                      [this](const storage::SharedDataTimestamp &regions) {
+                          return MakeGeneration(regions);
+                      })
     {
-        return plugin.HandleRequest(parameters, result);
     }
 
-    BOOST_ASSERT(lock);
-    lock->IncreaseQueryCount();
+    template <typename Query>
+    auto Run(Query &&query) -> decltype(query(std::declval<PluginSet &>()))
+    {
+        return RunOnGeneration(
+            [&query](Generation &generation) { return query(generation.plugins); });
+    }
 
-    auto &shared_facade = static_cast<osrm::engine::datafacade::SharedDataFacade &>(facade);
-    shared_facade.CheckAndReloadFacade();
-    // Get a shared data lock so that other threads won't update
-    // things while the query is running
-    boost::shared_lock<boost::shared_mutex> data_lock{shared_facade.data_mutex};
+    // Counters over all datasets, the size is the one of the cache of the current dataset
+    void PhantomNodeCacheCounters(util::json::Object &result)
+    {
+        if (!phantom_node_cache_counters)
+        {
+            result = util::json::Object();
+            return;
+        }
+        const auto size = RunOnGeneration([](Generation &generation) {
+            return generation.phantom_node_cache->Size();
+        });
+        result = MakeJSON(*phantom_node_cache_counters, size);
+    }
 
-    osrm::engine::Status status = plugin.HandleRequest(parameters, result);
+  private:
+    // Each dataset has a phantom node cache of its own: queries that still run on the previous
+    // dataset must not fill the cache of the new one with their phantom nodes
+    struct Generation
+    {
+        Generation(const storage::SharedDataTimestamp &regions,
+                   const EngineConfig &config,
+                   plugins::SmoothViaCounters &smooth_via_counters,
+                   std::shared_ptr<PhantomNodeCache::Counters> phantom_node_cache_counters)
+            : facade(regions),
+              phantom_node_cache(phantom_node_cache_counters
+                                     ? util::make_unique<PhantomNodeCache>(
+                                           config.phantom_node_cache_size,
+                                           std::move(phantom_node_cache_counters))
+                                     : nullptr),
+              plugins(facade, config, smooth_via_counters, phantom_node_cache.get())
+        {
+        }
 
-    lock->DecreaseQueryCount();
-    return status;
-}
+        datafacade::SharedDataFacade facade;
+        std::unique_ptr<PhantomNodeCache> phantom_node_cache;
+        FacadePluginSet<datafacade::SharedDataFacade> plugins;
+    };
 
-template <typename Plugin, typename Facade, typename... Args>
-std::unique_ptr<Plugin> create(Facade &facade, Args... args)
-{
-    return osrm::util::make_unique<Plugin>(facade, std::forward<Args>(args)...);
-}
+    template <typename Query>
+    auto RunOnGeneration(Query &&query) -> decltype(query(std::declval<Generation &>()))
+    {
+        return generations.Run(
+            [this] { return current_regions->Load(); },
+            [this](const storage::SharedDataTimestamp &regions) {
+                util::SimpleLogger().Write() << "loading dataset " << regions.timestamp;
+                if (phantom_node_cache_counters)
+                {
+                    // the new dataset starts with an empty cache
+                    phantom_node_cache_counters->invalidations.fetch_add(
+                        1, std::memory_order_relaxed);
+                }
+                return MakeGeneration(regions);
+            },
+            query);
+    }
 
-} // anon. ns
+    static std::unique_ptr<storage::SharedMemory> OpenCurrentRegions()
+    {
+        if (!storage::SharedMemory::RegionExists(storage::CURRENT_REGIONS))
+        {
+            throw util::exception(
+                "No shared memory blocks found, have you forgotten to run osrm-datastore?");
+        }
+        return std::unique_ptr<storage::SharedMemory>(
+            storage::makeSharedMemory(storage::CURRENT_REGIONS));
+    }
 
-namespace osrm
+    std::unique_ptr<Generation> MakeGeneration(const storage::SharedDataTimestamp &regions) const
+    {
+        return util::make_unique<Generation>(
+            regions, config, smooth_via_counters, phantom_node_cache_counters);
+    }
+
+    const EngineConfig config;
+    plugins::SmoothViaCounters &smooth_via_counters;
+    const std::shared_ptr<PhantomNodeCache::Counters> phantom_node_cache_counters;
+    std::unique_ptr<storage::SharedMemory> regions_memory;
+    const storage::SharedCurrentRegions *current_regions;
+    util::GenerationSwitch<storage::SharedDataTimestamp, Generation> generations;
+};
+
+namespace
 {
-namespace engine
+// Runs query on the plugins of the current dataset
+template <typename Query>
+auto RunOnPlugins(Engine::SharedDataset *shared_dataset, Engine::PluginSet *plugin_set, Query query)
+    -> decltype(query(*plugin_set))
 {
+    if (shared_dataset)
+    {
+        return shared_dataset->Run(query);
+    }
+    return query(*plugin_set);
+}
+} // anon. ns
+
 
 Engine::Engine(EngineConfig &config)
 {
+    smooth_via_counters = util::make_unique<plugins::SmoothViaCounters>();
+    // with shared memory every dataset has a cache of its own
+    if (config.phantom_node_cache_size > 0 && !config.use_shared_memory)
+    {
+        phantom_node_cache = util::make_unique<PhantomNodeCache>(config.phantom_node_cache_size);
+    }
+
     if (config.use_shared_memory)
     {
-        lock = util::make_unique<EngineLock>();
-        query_data_facade = util::make_unique<datafacade::SharedDataFacade>();
+        shared_dataset = util::make_unique<SharedDataset>(config, *smooth_via_counters);
+    }
+    else if (boost::filesystem::exists(config.storage_config.dataset_path))
+    {
+        auto facade = util::make_unique<datafacade::SharedDataFacade>(
+            util::make_unique<storage::DatasetFile>(config.storage_config.dataset_path,
+                                                    config.use_mmap,
+                                                    !config.use_mmap || config.verify_dataset));
+        plugin_set = util::make_unique<FacadePluginSet<datafacade::SharedDataFacade>>(
+            *facade, config, *smooth_via_counters, phantom_node_cache.get());
+        query_data_facade = std::move(facade);
     }
     else
     {
@@ -139,21 +326,18 @@ Engine::Engine(EngineConfig &config)
         {
             throw util::exception("Invalid file paths given!");
         }
-        query_data_facade =
-            util::make_unique<datafacade::InternalDataFacade>(config.storage_config);
+        auto facade = util::make_unique<datafacade::InternalDataFacade>(config.storage_config,
+                                                                        config.use_mmap);
+        plugin_set = util::make_unique<FacadePluginSet<datafacade::InternalDataFacade>>(
+            *facade, config, *smooth_via_counters, phantom_node_cache.get());
+        query_data_facade = std::move(facade);
     }
 
-    // Register plugins
-    using namespace plugins;
-
-    route_plugin = create<ViaRoutePlugin>(*query_data_facade, config.max_locations_viaroute);
-    table_plugin = create<TablePlugin>(*query_data_facade, config.max_locations_distance_table);
-    nearest_plugin = create<NearestPlugin>(*query_data_facade);
-    trip_plugin = create<TripPlugin>(*query_data_facade, config.max_locations_trip);
-    match_plugin = create<MatchPlugin>(*query_data_facade, config.max_locations_map_matching);
-    tile_plugin = create<TilePlugin>(*query_data_facade);
-    multi_target_plugin = create<MultiTargetPlugin>(*query_data_facade);
-    smooth_via_plugin = create<SmoothViaPlugin>(*query_data_facade);
+    // The heap pool is shared by all engines of the process
+    if (config.max_full_size_heaps >= 0)
+    {
+        SearchEngineData::heap_pool.SetMaxFullSizeHeaps(config.max_full_size_heaps);
+    }
 }
 
 // make sure we deallocate the unique ptr at a position where we know the size of the plugins
@@ -163,42 +347,104 @@ Engine &Engine::operator=(Engine &&) noexcept = default;
 
 Status Engine::Route(const api::RouteParameters &params, util::json::Object &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *route_plugin, result);
+    return RunOnPlugins(shared_dataset.get(), plugin_set.get(), [&](PluginSet &plugins) {
+        return plugins.Route(params, result);
+    });
 }
 
 Status Engine::Table(const api::TableParameters &params, util::json::Object &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *table_plugin, result);
+    return RunOnPlugins(shared_dataset.get(), plugin_set.get(), [&](PluginSet &plugins) {
+        return plugins.Table(params, result);
+    });
 }
 
 Status Engine::Nearest(const api::NearestParameters &params, util::json::Object &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *nearest_plugin, result);
+    return RunOnPlugins(shared_dataset.get(), plugin_set.get(), [&](PluginSet &plugins) {
+        return plugins.Nearest(params, result);
+    });
 }
 
 Status Engine::Trip(const api::TripParameters &params, util::json::Object &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *trip_plugin, result);
+    return RunOnPlugins(shared_dataset.get(), plugin_set.get(), [&](PluginSet &plugins) {
+        return plugins.Trip(params, result);
+    });
 }
 
 Status Engine::Match(const api::MatchParameters &params, util::json::Object &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *match_plugin, result);
+    return RunOnPlugins(shared_dataset.get(), plugin_set.get(), [&](PluginSet &plugins) {
+        return plugins.Match(params, result);
+    });
 }
 
 Status Engine::Tile(const api::TileParameters &params, std::string &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *tile_plugin, result);
+    return RunOnPlugins(shared_dataset.get(), plugin_set.get(), [&](PluginSet &plugins) {
+        return plugins.Tile(params, result);
+    });
 }
 
 Status Engine::MultiTarget(const api::MultiTargetParameters &params, util::json::Object &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *multi_target_plugin, result);
+    return RunOnPlugins(shared_dataset.get(), plugin_set.get(), [&](PluginSet &plugins) {
+        return plugins.MultiTarget(params, result);
+    });
+}
+
+Status Engine::MultiTargetBatch(const std::vector<api::MultiTargetParameters> &queries,
+                                const api::MultiTargetBatchHandler &handler)
+{
+    return RunOnPlugins(shared_dataset.get(), plugin_set.get(), [&](PluginSet &plugins) {
+        return plugins.MultiTargetBatch(queries, handler);
+    });
 }
 
 Status Engine::SmoothVia(const api::SmoothViaParameters &params, util::json::Object &result)
 {
-    return RunQuery(lock, *query_data_facade, params, *smooth_via_plugin, result);
+    return RunOnPlugins(shared_dataset.get(), plugin_set.get(), [&](PluginSet &plugins) {
+        return plugins.SmoothVia(params, result);
+    });
+}
+
+void Engine::SmoothViaCounters(util::json::Object &result) const
+{
+    // kept by the engine, so they count across datasets
+    result = plugins::MakeJSON(*smooth_via_counters);
+}
+
+void Engine::PhantomNodeCacheCounters(util::json::Object &result) const
+{
+    if (shared_dataset)
+    {
+        shared_dataset->PhantomNodeCacheCounters(result);
+        return;
+    }
+
+    result = util::json::Object();
+    if (!phantom_node_cache)
+    {
+        return;
+    }
+    result = MakeJSON(phantom_node_cache->GetCounters(), phantom_node_cache->Size());
+}
+
+void Engine::HeapPoolCounters(util::json::Object &result) const
+{
+    const auto counters = SearchEngineData::heap_pool.GetCounters();
+    result = util::json::Object();
+    result.values["created"] = counters.created;
+    result.values["reused"] = counters.reused;
+    result.values["evicted"] = counters.evicted;
+    result.values["shrunk"] = counters.shrunk;
+    result.values["checked_out"] = counters.checked_out;
+    result.values["high_water_mark"] = counters.high_water_mark;
+    result.values["full_size"] = counters.full_size;
+    result.values["idle"] = counters.idle;
+    result.values["idle_full_size"] = counters.idle_full_size;
+    result.values["idle_bytes"] = counters.idle_bytes;
 }
 
 } // engine ns
@@ -21,7 +21,18 @@ bool EngineConfig::IsValid() const
         (max_locations_trip == -1 || max_locations_trip > 2) &&
         (max_locations_viaroute == -1 || max_locations_viaroute > 2);
 
-    return ((use_shared_memory && all_path_are_empty) || storage_config.IsValid()) && limits_valid;
+    const bool multi_target_valid =
+        (multi_target_parallel_threshold == -1 || multi_target_parallel_threshold > 0) &&
+        max_multi_target_threads > 0 &&
+        (phantom_node_cache_size == -1 || phantom_node_cache_size > 0);
+
+    const bool table_valid =
+        (table_parallel_threshold == -1 || table_parallel_threshold > 0) && max_table_threads > 0;
+
+    const bool heap_pool_valid = max_full_size_heaps >= -1;
+
+    return ((use_shared_memory && all_path_are_empty) || storage_config.IsValid()) &&
+           limits_valid && multi_target_valid && table_valid && heap_pool_valid;
 }
 }
 }
@@ -20,8 +20,8 @@ namespace engine
 namespace guidance
 {
 
-std::vector<RouteStep> anticipateLaneChange(std::vector<RouteStep> steps,
-                                            const double min_duration_needed_for_lane_change)
+RouteStepList anticipateLaneChange(RouteStepList steps,
+                                   const double min_duration_needed_for_lane_change)
 {
     // Postprocessing does not strictly guarantee for only turns
     const auto is_turn = [](const RouteStep &step) {
@@ -74,7 +74,7 @@ bool collapsable(const RouteStep &step)
 
 bool compatible(const RouteStep &lhs, const RouteStep &rhs) { return lhs.mode == rhs.mode; }
 
-double nameSegmentLength(std::size_t at, const std::vector<RouteStep> &steps)
+double nameSegmentLength(std::size_t at, const RouteStepList &steps)
 {
     double result = steps[at].distance;
     while (at + 1 < steps.size() && steps[at + 1].name_id == steps[at].name_id)
@@ -145,7 +145,7 @@ RouteStep forwardInto(RouteStep destination, const RouteStep &source)
     return destination;
 }
 
-void fixFinalRoundabout(std::vector<RouteStep> &steps)
+void fixFinalRoundabout(RouteStepList &steps)
 {
     for (std::size_t propagation_index = steps.size() - 1; propagation_index > 0;
          --propagation_index)
@@ -220,7 +220,7 @@ bool setUpRoundabout(RouteStep &step)
 }
 
 void closeOffRoundabout(const bool on_roundabout,
-                        std::vector<RouteStep> &steps,
+                        RouteStepList &steps,
                         const std::size_t step_index)
 {
     auto &step = steps[step_index];
@@ -352,7 +352,7 @@ RouteStep elongate(RouteStep step, const RouteStep &by_step)
     return step;
 }
 
-void collapseTurnAt(std::vector<RouteStep> &steps,
+void collapseTurnAt(RouteStepList &steps,
                     const std::size_t two_back_index,
                     const std::size_t one_back_index,
                     const std::size_t step_index)
@@ -502,7 +502,7 @@ void collapseTurnAt(std::vector<RouteStep> &steps,
 
 // Works on steps including silent and invalid instructions in order to do lane anticipation for
 // roundabouts which later on get collapsed into a single multi-hop instruction.
-std::vector<RouteStep> anticipateLaneChangeForRoundabouts(std::vector<RouteStep> steps)
+RouteStepList anticipateLaneChangeForRoundabouts(RouteStepList steps)
 {
     using namespace util::guidance;
 
@@ -545,7 +545,7 @@ std::vector<RouteStep> anticipateLaneChangeForRoundabouts(std::vector<RouteStep>
 
 // Post processing can invalidate some instructions. For example StayOnRoundabout
 // is turned into exit counts. These instructions are removed by the following function
-std::vector<RouteStep> removeNoTurnInstructions(std::vector<RouteStep> steps)
+RouteStepList removeNoTurnInstructions(RouteStepList steps)
 {
     // finally clean up the post-processed instructions.
     // Remove all invalid instructions from the set of instructions.
@@ -582,7 +582,7 @@ std::vector<RouteStep> removeNoTurnInstructions(std::vector<RouteStep> steps)
 // They are required for maintenance purposes. We can calculate the number
 // of exits to pass in a roundabout and the number of intersections
 // that we come across.
-std::vector<RouteStep> postProcess(std::vector<RouteStep> steps)
+RouteStepList postProcess(RouteStepList steps)
 {
     // the steps should always include the first/last step in form of a location
     BOOST_ASSERT(steps.size() >= 2);
@@ -659,7 +659,7 @@ std::vector<RouteStep> postProcess(std::vector<RouteStep> steps)
 }
 
 // Post Processing to collapse unnecessary sets of combined instructions into a single one
-std::vector<RouteStep> collapseTurns(std::vector<RouteStep> steps)
+RouteStepList collapseTurns(RouteStepList steps)
 {
     if (steps.size() <= 2)
         return steps;
@@ -851,7 +851,7 @@ std::vector<RouteStep> collapseTurns(std::vector<RouteStep> steps)
 // As a direct implication, we have to keep the time of the initial/final turns (which adds a
 // few seconds of inaccuracy at both ends. This is acceptable, however, since the turn should
 // usually not be as relevant.
-void trimShortSegments(std::vector<RouteStep> &steps, LegGeometry &geometry)
+void trimShortSegments(RouteStepList &steps, LegGeometry &geometry)
 {
     if (steps.size() < 2 || geometry.locations.size() <= 2)
         return;
@@ -1056,10 +1056,10 @@ void trimShortSegments(std::vector<RouteStep> &steps, LegGeometry &geometry)
 }
 
 // assign relative locations to depart/arrive instructions
-std::vector<RouteStep> assignRelativeLocations(std::vector<RouteStep> steps,
-                                               const LegGeometry &leg_geometry,
-                                               const PhantomNode &source_node,
-                                               const PhantomNode &target_node)
+RouteStepList assignRelativeLocations(RouteStepList steps,
+                                      const LegGeometry &leg_geometry,
+                                      const PhantomNode &source_node,
+                                      const PhantomNode &target_node)
 {
     // We report the relative position of source/target to the road only within a range that is
     // sufficiently different but not full of the path
@@ -1102,7 +1102,7 @@ std::vector<RouteStep> assignRelativeLocations(std::vector<RouteStep> steps,
     return steps;
 }
 
-LegGeometry resyncGeometry(LegGeometry leg_geometry, const std::vector<RouteStep> &steps)
+LegGeometry resyncGeometry(LegGeometry leg_geometry, const RouteStepList &steps)
 {
     // The geometry uses an adjacency array-like structure for representation.
     // To sync it back up with the steps, we cann add a segment for every step.
@@ -1125,7 +1125,7 @@ LegGeometry resyncGeometry(LegGeometry leg_geometry, const std::vector<RouteStep
     return leg_geometry;
 }
 
-std::vector<RouteStep> buildIntersections(std::vector<RouteStep> steps)
+RouteStepList buildIntersections(RouteStepList steps)
 {
     std::size_t last_valid_instruction = 0;
     for (std::size_t step_index = 0; step_index < steps.size(); ++step_index)
@@ -1164,7 +1164,7 @@ std::vector<RouteStep> buildIntersections(std::vector<RouteStep> steps)
     return removeNoTurnInstructions(std::move(steps));
 }
 
-std::vector<RouteStep> collapseUseLane(std::vector<RouteStep> steps)
+RouteStepList collapseUseLane(RouteStepList steps)
 {
     const auto containsTag = [](const extractor::guidance::TurnLaneType::Mask mask,
                                 const extractor::guidance::TurnLaneType::Mask tag) {
@@ -1,6 +1,9 @@
 #include "engine/plugins/match.hpp"
 #include "engine/plugins/plugin_base.hpp"
 
+#include "engine/datafacade/internal_datafacade.hpp"
+#include "engine/datafacade/shared_datafacade.hpp"
+
 #include "engine/api/match_api.hpp"
 #include "engine/api/match_parameters.hpp"
 #include "engine/map_matching/bayes_classifier.hpp"
@@ -26,7 +29,7 @@ namespace plugins
 
 // Filters PhantomNodes to obtain a set of viable candiates
 void filterCandidates(const std::vector<util::Coordinate> &coordinates,
-                      MatchPlugin::CandidateLists &candidates_lists)
+                      routing_algorithms::CandidateLists &candidates_lists)
 {
     for (const auto current_coordinate : util::irange<std::size_t>(0, coordinates.size()))
     {
@@ -106,8 +109,9 @@ void filterCandidates(const std::vector<util::Coordinate> &coordinates,
     }
 }
 
-Status MatchPlugin::HandleRequest(const api::MatchParameters &parameters,
-                                  util::json::Object &json_result)
+template <typename DataFacadeT>
+Status MatchPlugin<DataFacadeT>::HandleRequest(const api::MatchParameters &parameters,
+                                               util::json::Object &json_result)
 {
     BOOST_ASSERT(parameters.IsValid());
 
@@ -174,7 +178,8 @@ Status MatchPlugin::HandleRequest(const api::MatchParameters &parameters,
         return Error("NoMatch", "Could not match the trace.", json_result);
     }
 
-    std::vector<InternalRouteResult> sub_routes(sub_matchings.size());
+    std::vector<InternalRouteResult> sub_routes(
+        sub_matchings.size(), InternalRouteResult(SearchEngineData::GetRequestArena()));
     for (auto index : util::irange<std::size_t>(0UL, sub_matchings.size()))
     {
         BOOST_ASSERT(sub_matchings[index].nodes.size() > 1);
@@ -202,6 +207,9 @@ Status MatchPlugin::HandleRequest(const api::MatchParameters &parameters,
 
     return Status::Ok;
 }
+
+template class MatchPlugin<datafacade::InternalDataFacade>;
+template class MatchPlugin<datafacade::SharedDataFacade>;
 }
 }
 }
@@ -1,5 +1,17 @@
 #include "engine/plugins/multi_target.hpp"
 
+#include "engine/datafacade/internal_datafacade.hpp"
+#include "engine/datafacade/shared_datafacade.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <iterator>
+
 namespace osrm
 {
 namespace engine
@@ -7,32 +19,239 @@ namespace engine
 namespace plugins
 {
 
-MultiTargetPlugin::MultiTargetPlugin(datafacade::BaseDataFacade &facade_)
+template <typename DataFacadeT>
+MultiTargetPlugin<DataFacadeT>::MultiTargetPlugin(DataFacadeT &facade_,
+                                                  const int parallel_threshold_,
+                                                  const int max_threads_,
+                                                  PhantomNodeCache *phantom_node_cache_)
     : BasePlugin(facade_), multi_target_forward(&facade_, heaps),
-      multi_target_backward(&facade_, heaps)
+      multi_target_backward(&facade_, heaps), parallel_threshold(parallel_threshold_),
+      max_threads(max_threads_), phantom_node_cache(phantom_node_cache_)
+{
+}
+
+template <typename DataFacadeT>
+std::shared_ptr<typename MultiTargetPlugin<DataFacadeT>::ResultTable>
+MultiTargetPlugin<DataFacadeT>::Route(const std::vector<PhantomNode> &phantom_nodes,
+                                      const api::MultiTargetParameters &parameters) const
+{
+    const auto max_weight = GetMaxWeight(parameters.max_duration);
+    const auto number_of_nearest = parameters.k ? *parameters.k : 0;
+    if (parameters.forward)
+    {
+        return multi_target_forward(
+            phantom_nodes, parameters.calculate_distance, max_weight, number_of_nearest);
+    }
+    return multi_target_backward(
+        phantom_nodes, parameters.calculate_distance, max_weight, number_of_nearest);
+}
+
+template <typename DataFacadeT>
+std::shared_ptr<typename MultiTargetPlugin<DataFacadeT>::ResultTable>
+MultiTargetPlugin<DataFacadeT>::RouteInParallel(const std::vector<PhantomNode> &phantom_nodes,
+                                                const api::MultiTargetParameters &parameters)
+{
+    if (parameters.forward)
+    {
+        return RouteInParallel(multi_target_forward, phantom_nodes, parameters);
+    }
+    return RouteInParallel(multi_target_backward, phantom_nodes, parameters);
+}
+
+// Splits the targets into one chunk per thread and routes the chunks concurrently. Every
+// request gets an arena of its own, so max_threads bounds each request and not all of them
+// together.
+//
+// The upward search from the source is the same for all chunks. It runs once up front into a
+// heap of the request that the chunks only read. The routing algorithms only touch the heaps of
+// the thread they run on otherwise, so every worker checks out heaps of its own and returns them
+// once its chunks are done.
+template <typename DataFacadeT>
+template <typename RoutingT>
+std::shared_ptr<typename MultiTargetPlugin<DataFacadeT>::ResultTable>
+MultiTargetPlugin<DataFacadeT>::RouteInParallel(const RoutingT &routing,
+                                                const std::vector<PhantomNode> &phantom_nodes,
+                                                const api::MultiTargetParameters &parameters)
+{
+    BOOST_ASSERT(phantom_nodes.size() > 1);
+    const std::size_t number_of_targets = phantom_nodes.size() - 1;
+    const std::size_t number_of_chunks =
+        std::min<std::size_t>(max_threads, number_of_targets);
+    const std::size_t chunk_size = (number_of_targets + number_of_chunks - 1) / number_of_chunks;
+    const auto max_weight = GetMaxWeight(parameters.max_duration);
+
+    std::unique_ptr<SearchEngineData::QueryHeap> source_heap;
+    SearchEngineData::PooledHeapScope source_heap_scope(source_heap);
+    if (routing.CanShareSourceSearchSpace())
+    {
+        source_heap =
+            SearchEngineData::heap_pool.Acquire(facade.GetNumberOfNodes(), HeapSize::FullSize);
+        routing.SearchSourceSearchSpace(
+            phantom_nodes, parameters.calculate_distance, max_weight, *source_heap);
+    }
+
+    auto result_table = std::make_shared<ResultTable>(number_of_targets);
+
+    tbb::task_arena arena(max_threads);
+    arena.execute([&] {
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, number_of_chunks, 1),
+            [&](const tbb::blocked_range<std::size_t> &range) {
+                SearchEngineData::ThreadLocalStorageScope heap_scope;
+                for (auto chunk = range.begin(); chunk != range.end(); ++chunk)
+                {
+                    const auto first_target = std::next(
+                        phantom_nodes.begin(), 1 + std::min(chunk * chunk_size, number_of_targets));
+                    const auto last_target = std::next(
+                        phantom_nodes.begin(),
+                        1 + std::min((chunk + 1) * chunk_size, number_of_targets));
+                    if (first_target == last_target)
+                    {
+                        continue;
+                    }
+
+                    std::vector<PhantomNode> chunk_phantom_nodes;
+                    chunk_phantom_nodes.reserve(std::distance(first_target, last_target) + 1);
+                    chunk_phantom_nodes.push_back(phantom_nodes.front());
+                    chunk_phantom_nodes.insert(
+                        chunk_phantom_nodes.end(), first_target, last_target);
+
+                    const auto chunk_result =
+                        source_heap ? routing(chunk_phantom_nodes, *source_heap,
+                                              parameters.calculate_distance, max_weight)
+                                    : routing(chunk_phantom_nodes, parameters.calculate_distance,
+                                              max_weight);
+                    std::copy(chunk_result->begin(),
+                              chunk_result->end(),
+                              std::next(result_table->begin(),
+                                        std::distance(phantom_nodes.begin(), first_target) - 1));
+                }
+            },
+            tbb::simple_partitioner());
+    });
+
+    return result_table;
+}
+
+namespace
 {
+bool IsValidRequest(const api::MultiTargetParameters &parameters)
+{
+    return parameters.IsValid() && std::all_of(begin(parameters.coordinates),
+                                               end(parameters.coordinates),
+                                               [](Coordinate c) { return c.IsValid(); });
+}
 }
 
-Status MultiTargetPlugin::HandleRequest(const api::MultiTargetParameters &parameters,
-                                        util::json::Object &json_object)
+template <typename DataFacadeT>
+PhantomNodePair MultiTargetPlugin<DataFacadeT>::SnapCoordinate(const util::Coordinate coordinate,
+                                                               const PhantomNodeCacheKey &key) const
 {
-    if (!parameters.IsValid() || std::any_of(begin(parameters.coordinates),
-                                             end(parameters.coordinates),
-                                             [](Coordinate c) { return !c.IsValid(); }))
+    const boost::optional<double> radius =
+        key.radius < 0 ? boost::none : boost::optional<double>(key.radius);
+
+    if (key.bearing >= 0)
+    {
+        if (radius)
+        {
+            return facade.NearestPhantomNodeWithAlternativeFromBigComponent(
+                coordinate, *radius, key.bearing, key.range);
+        }
+        return facade.NearestPhantomNodeWithAlternativeFromBigComponent(
+            coordinate, key.bearing, key.range);
+    }
+
+    if (radius)
+    {
+        return facade.NearestPhantomNodeWithAlternativeFromBigComponent(coordinate, *radius);
+    }
+    return facade.NearestPhantomNodeWithAlternativeFromBigComponent(coordinate);
+}
+
+template <typename DataFacadeT>
+std::vector<PhantomNodePair>
+MultiTargetPlugin<DataFacadeT>::GetPhantomNodes(const api::MultiTargetParameters &parameters,
+                                                SnappingCache *batch_cache)
+{
+    // Hints skip snapping altogether
+    if ((!batch_cache && !phantom_node_cache) || !parameters.hints.empty())
+    {
+        return BasePlugin::GetPhantomNodes(parameters);
+    }
+
+    const bool use_bearings = !parameters.bearings.empty();
+    const bool use_radiuses = !parameters.radiuses.empty();
+
+    std::vector<PhantomNodePair> phantom_node_pairs;
+    phantom_node_pairs.reserve(parameters.coordinates.size());
+    for (const auto i : util::irange<std::size_t>(0UL, parameters.coordinates.size()))
+    {
+        const auto coordinate = parameters.coordinates[i];
+        const auto radius = use_radiuses ? parameters.radiuses[i] : boost::none;
+        const auto bearing = use_bearings ? parameters.bearings[i] : boost::none;
+        const PhantomNodeCacheKey key{coordinate,
+                                      radius,
+                                      bearing ? bearing->bearing : -1,
+                                      bearing ? bearing->range : -1};
+
+        const auto snap = [&] {
+            if (phantom_node_cache)
+            {
+                return phantom_node_cache->GetNearestWithAlternative(
+                    key, [&] { return SnapCoordinate(coordinate, key); });
+            }
+            return SnapCoordinate(coordinate, key);
+        };
+
+        PhantomNodePair phantom_node_pair;
+        if (batch_cache)
+        {
+            auto cached = batch_cache->find(key);
+            if (cached == batch_cache->end())
+            {
+                cached = batch_cache->emplace(key, snap()).first;
+            }
+            phantom_node_pair = cached->second;
+        }
+        else
+        {
+            phantom_node_pair = snap();
+        }
+
+        // we didn't find a fitting node, same as BasePlugin::GetPhantomNodes
+        if (!phantom_node_pair.first.IsValid(facade.GetNumberOfNodes()))
+        {
+            break;
+        }
+        phantom_node_pairs.push_back(std::move(phantom_node_pair));
+    }
+    return phantom_node_pairs;
+}
+
+template <typename DataFacadeT>
+Status MultiTargetPlugin<DataFacadeT>::HandleSnappedRequest(
+    const api::MultiTargetParameters &parameters,
+    std::vector<PhantomNodePair> phantom_node_pairs,
+    util::json::Object &json_object)
+{
+    if (phantom_node_pairs.size() != parameters.coordinates.size())
     {
         return Status::Error;
     }
 
-    auto snapped_phantoms = SnapPhantomNodes(GetPhantomNodes(parameters));
+    auto snapped_phantoms = SnapPhantomNodes(phantom_node_pairs);
 
-    std::shared_ptr<std::vector<std::pair<double, double>>> result_table;
-    if (parameters.forward)
+    // The nearest targets have to be selected among all targets, so those
+    // searches are not split. They are local anyway.
+    std::shared_ptr<ResultTable> result_table;
+    if (parallel_threshold > 0 && !parameters.k &&
+        snapped_phantoms.size() - 1 >= static_cast<std::size_t>(parallel_threshold))
     {
-        result_table = multi_target_forward(snapped_phantoms);
+        result_table = RouteInParallel(snapped_phantoms, parameters);
     }
     else
     {
-        result_table = multi_target_backward(snapped_phantoms);
+        result_table = Route(snapped_phantoms, parameters);
     }
 
     if (!result_table)
@@ -46,14 +265,74 @@ Status MultiTargetPlugin::HandleRequest(const api::MultiTargetParameters &parame
         auto routing_result = result_table->operator[](column);
 
         util::json::Object result;
-        result.values["duration"] = routing_result.first;
-        result.values["distance"] = routing_result.second;
+        if (routing_result.first == INVALID_EDGE_WEIGHT)
+        {
+            // unreachable or outside of the requested bounds
+            result.values["duration"] = util::json::Null();
+            if (parameters.calculate_distance)
+            {
+                result.values["distance"] = util::json::Null();
+            }
+        }
+        else
+        {
+            result.values["duration"] = routing_result.first;
+            if (parameters.calculate_distance)
+            {
+                result.values["distance"] = routing_result.second;
+            }
+        }
         json_array.values.emplace_back(result);
     }
     json_object.values["costs"] = json_array;
 
     return Status::Ok;
 }
+
+template <typename DataFacadeT>
+Status MultiTargetPlugin<DataFacadeT>::HandleRequest(const api::MultiTargetParameters &parameters,
+                                                     util::json::Object &json_object)
+{
+    if (!IsValidRequest(parameters))
+    {
+        return Status::Error;
+    }
+
+    return HandleSnappedRequest(parameters, GetPhantomNodes(parameters, nullptr), json_object);
+}
+
+template <typename DataFacadeT>
+Status MultiTargetPlugin<DataFacadeT>::HandleRequest(
+    const std::vector<api::MultiTargetParameters> &queries,
+    const api::MultiTargetBatchHandler &handler)
+{
+    SnappingCache cache;
+    Status batch_status = Status::Ok;
+
+    for (std::size_t index = 0; index < queries.size(); ++index)
+    {
+        const auto &parameters = queries[index];
+
+        util::json::Object json_object;
+        Status status = Status::Error;
+        if (IsValidRequest(parameters))
+        {
+            status =
+                HandleSnappedRequest(parameters, GetPhantomNodes(parameters, &cache), json_object);
+        }
+
+        if (status != Status::Ok)
+        {
+            batch_status = Status::Error;
+        }
+        handler(index, status, json_object);
+    }
+
+    return batch_status;
+}
+
+template class MultiTargetPlugin<datafacade::InternalDataFacade>;
+template class MultiTargetPlugin<datafacade::SharedDataFacade>;
 }
 }
 }
@@ -1,6 +1,16 @@
 #include "engine/plugins/smooth_via.hpp"
 
+#include "engine/datafacade/internal_datafacade.hpp"
+#include "engine/datafacade/shared_datafacade.hpp"
+
 #include "engine/api/json_factory.hpp"
+#include "util/timing_util.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <numeric>
 
 namespace osrm
 {
@@ -15,103 +25,198 @@ struct via_result
     double distance;
     std::vector<std::vector<Coordinate>> polylines;
 };
-using leg_results_t = std::vector<std::vector<std::vector<LegResult>>>;
 
-struct ResultFinder
+// Viterbi over the candidate layers: keeps the cheapest chain ending in every candidate of a
+// layer and returns the candidate index per waypoint of the overall cheapest chain.
+ViaChain FindBestChain(const std::vector<std::vector<PhantomNode>> &resolved_nodes,
+                       const std::vector<std::vector<EdgeWeight>> &leg_tables)
 {
-
-    ResultFinder(leg_results_t leg_results) : leg_results(std::move(leg_results)) {}
-
-    via_result find_best_cached(size_t depth, size_t node_idx)
+    if (resolved_nodes.size() < 2)
     {
-        auto it = result_cache.find({depth, node_idx});
-        if (it != end(result_cache))
-        {
-            return it->second;
-        }
-
-        auto result = find_best(depth, node_idx);
-        result_cache[{depth, node_idx}] = result;
-        std::cout << result.duration << std::endl;
-        return result;
+        return {};
     }
+    BOOST_ASSERT(leg_tables.size() + 1 == resolved_nodes.size());
+
+    using ChainWeight = std::int64_t;
+    const constexpr auto INVALID_CHAIN_WEIGHT = std::numeric_limits<ChainWeight>::max();
 
-    via_result find_best(size_t depth, size_t node_idx)
+    std::vector<ChainWeight> chain_weights(resolved_nodes.front().size(), 0);
+    std::vector<std::vector<std::size_t>> predecessors(resolved_nodes.size());
+
+    for (std::size_t leg = 0; leg < leg_tables.size(); ++leg)
     {
-        if (depth == leg_results.size() - 1)
-        {
-            auto min = std::min_element(begin(leg_results[depth][node_idx]),
-                                        end(leg_results[depth][node_idx]),
-                                        [](LegResult const &lhs, LegResult const &rhs) {
-                                            return lhs.duration < rhs.duration;
-                                        });
-            return {min->duration, min->distance, {min->polyline}};
-        }
+        const auto number_of_sources = resolved_nodes[leg].size();
+        const auto number_of_targets = resolved_nodes[leg + 1].size();
+        BOOST_ASSERT(leg_tables[leg].size() == number_of_sources * number_of_targets);
 
-        std::vector<via_result> tails;
-        for (auto i = 0u; i < leg_results[depth + 1].size(); ++i)
-        {
-            auto tail = find_best_cached(depth + 1, i);
+        std::vector<ChainWeight> next_chain_weights(number_of_targets, INVALID_CHAIN_WEIGHT);
+        auto &next_predecessors = predecessors[leg + 1];
+        next_predecessors.resize(number_of_targets, 0);
 
-            if (tail.duration == std::numeric_limits<int>::max())
+        for (std::size_t source = 0; source < number_of_sources; ++source)
+        {
+            if (chain_weights[source] == INVALID_CHAIN_WEIGHT)
             {
                 continue;
             }
 
-            if (depth != std::numeric_limits<size_t>::max())
+            for (std::size_t target = 0; target < number_of_targets; ++target)
             {
-                auto self = leg_results[depth][node_idx][i];
-
-                if (self.duration == std::numeric_limits<int>::max())
+                const auto leg_weight = leg_tables[leg][source * number_of_targets + target];
+                if (leg_weight == INVALID_EDGE_WEIGHT)
                 {
                     continue;
                 }
 
-                tail.duration += self.duration;
-                tail.distance += self.distance;
-                tail.polylines.insert(begin(tail.polylines), self.polyline);
+                const auto weight = chain_weights[source] + leg_weight;
+                if (weight < next_chain_weights[target])
+                {
+                    next_chain_weights[target] = weight;
+                    next_predecessors[target] = source;
+                }
             }
-
-            tails.push_back(tail);
         }
 
-        if (tails.empty())
-        {
-            return {
-              static_cast<double>(std::numeric_limits<int>::max()),
-              static_cast<double>(std::numeric_limits<double>::max()),
-              {}
-            };
-        }
+        chain_weights = std::move(next_chain_weights);
+    }
+
+    const auto best = std::min_element(chain_weights.begin(), chain_weights.end());
+    if (best == chain_weights.end() || *best == INVALID_CHAIN_WEIGHT)
+    {
+        return {};
+    }
 
-        return *std::min_element(
-            begin(tails), end(tails), [](via_result const &lhs, via_result const &rhs) {
-                return lhs.duration < rhs.duration;
-            });
+    ViaChain chain;
+    chain.weight = *best;
+    chain.candidates.resize(resolved_nodes.size());
+    chain.candidates.back() = std::distance(chain_weights.begin(), best);
+    for (std::size_t layer = resolved_nodes.size() - 1; layer > 0; --layer)
+    {
+        chain.candidates[layer - 1] = predecessors[layer][chain.candidates[layer]];
     }
 
-    leg_results_t leg_results;
-    std::map<std::pair<size_t, size_t>, via_result> result_cache;
-};
+    return chain;
+}
 
-via_result ExtractResult(leg_results_t leg_results)
+void SmoothViaCounters::Add(const SmoothViaMetrics &metrics)
 {
-    ResultFinder finder{std::move(leg_results)};
-    return finder.find_best(-1, -1);
+    requests.fetch_add(1, std::memory_order_relaxed);
+    if (!metrics.found_route)
+    {
+        requests_without_route.fetch_add(1, std::memory_order_relaxed);
+    }
+    waypoints.fetch_add(metrics.waypoints, std::memory_order_relaxed);
+    candidates.fetch_add(metrics.candidates, std::memory_order_relaxed);
+    tiny_component_fallbacks.fetch_add(metrics.tiny_component_fallbacks,
+                                       std::memory_order_relaxed);
+    all_tiny_waypoints.fetch_add(metrics.all_tiny_waypoints, std::memory_order_relaxed);
+    failed_legs.fetch_add(metrics.failed_legs, std::memory_order_relaxed);
+    snapping_us.fetch_add(metrics.snapping_us, std::memory_order_relaxed);
+    table_us.fetch_add(metrics.table_us, std::memory_order_relaxed);
+    unpacking_us.fetch_add(metrics.unpacking_us, std::memory_order_relaxed);
+}
+
+util::json::Object MakeJSON(const SmoothViaMetrics &metrics)
+{
+    util::json::Object json;
+    json.values["waypoints"] = metrics.waypoints;
+    json.values["candidates"] = metrics.candidates;
+    json.values["tiny_component_fallbacks"] = metrics.tiny_component_fallbacks;
+    json.values["all_tiny_waypoints"] = metrics.all_tiny_waypoints;
+    json.values["failed_legs"] = metrics.failed_legs;
+    json.values["found_route"] = metrics.found_route ? util::json::Value{util::json::True()}
+                                                     : util::json::Value{util::json::False()};
+    json.values["snapping_us"] = metrics.snapping_us;
+    json.values["table_us"] = metrics.table_us;
+    json.values["unpacking_us"] = metrics.unpacking_us;
+    return json;
 }
 
-SmoothViaPlugin::SmoothViaPlugin(datafacade::BaseDataFacade &facade_)
-    : BasePlugin(facade_), direct_shortest_path(&facade_, heaps), shortest_path(&facade_, heaps)
+util::json::Object MakeJSON(const SmoothViaCounters &counters)
 {
+    util::json::Object json;
+    json.values["requests"] = counters.requests.load(std::memory_order_relaxed);
+    json.values["requests_without_route"] =
+        counters.requests_without_route.load(std::memory_order_relaxed);
+    json.values["waypoints"] = counters.waypoints.load(std::memory_order_relaxed);
+    json.values["candidates"] = counters.candidates.load(std::memory_order_relaxed);
+    json.values["tiny_component_fallbacks"] =
+        counters.tiny_component_fallbacks.load(std::memory_order_relaxed);
+    json.values["all_tiny_waypoints"] = counters.all_tiny_waypoints.load(std::memory_order_relaxed);
+    json.values["failed_legs"] = counters.failed_legs.load(std::memory_order_relaxed);
+    json.values["snapping_us"] = counters.snapping_us.load(std::memory_order_relaxed);
+    json.values["table_us"] = counters.table_us.load(std::memory_order_relaxed);
+    json.values["unpacking_us"] = counters.unpacking_us.load(std::memory_order_relaxed);
+    return json;
 }
 
-Status SmoothViaPlugin::HandleRequest(const api::SmoothViaParameters &params,
-                                      util::json::Object &result)
+template <typename DataFacadeT>
+SmoothViaPlugin<DataFacadeT>::SmoothViaPlugin(DataFacadeT &facade_,
+                                              SmoothViaCounters &counters_,
+                                              PhantomNodeCache *phantom_node_cache_)
+    : BasePlugin(facade_), counters(counters_), phantom_node_cache(phantom_node_cache_),
+      direct_shortest_path(&facade_, heaps), shortest_path(&facade_, heaps),
+      distance_table(&facade_, heaps)
 {
-    auto resolved_nodes = ResolveNodes(params);
-    auto leg_results = RouteAllLegs(resolved_nodes);
+}
+
+template <typename DataFacadeT>
+Status SmoothViaPlugin<DataFacadeT>::HandleRequest(const api::SmoothViaParameters &params,
+                                                   util::json::Object &result)
+{
+    SmoothViaMetrics metrics;
+
+    TIMER_START(snapping);
+    auto resolved_nodes = ResolveNodes(params, metrics);
+    TIMER_STOP(snapping);
+    metrics.snapping_us = TIMER_USEC(snapping);
 
-    auto best_result = ExtractResult(std::move(leg_results));
+    if (resolved_nodes.size() < 2)
+    {
+        return Error("InvalidOptions", "At least two waypoints are required", result);
+    }
+
+    TIMER_START(table);
+    auto leg_tables = ComputeLegTables(resolved_nodes);
+    TIMER_STOP(table);
+    metrics.table_us = TIMER_USEC(table);
+
+    via_result best_result{static_cast<double>(std::numeric_limits<int>::max()),
+                           static_cast<double>(std::numeric_limits<double>::max()),
+                           {}};
+
+    // Only the legs of the winning chain are unpacked into geometry. The duration is the weight
+    // the chain was chosen by, the unpacked legs only add the distance and the geometry.
+    TIMER_START(unpacking);
+    std::vector<LegResult> legs;
+    const auto chain = RouteBestChain(
+        resolved_nodes,
+        leg_tables,
+        MAX_ROUTED_CHAINS,
+        [&](const std::size_t layer, const std::size_t source, const std::size_t target) {
+            return RouteDirect(resolved_nodes[layer - 1][source], resolved_nodes[layer][target]);
+        },
+        legs,
+        metrics.failed_legs);
+    TIMER_STOP(unpacking);
+    metrics.unpacking_us = TIMER_USEC(unpacking);
+
+    if (chain.candidates.empty() && metrics.failed_legs > 0)
+    {
+        counters.Add(metrics);
+        return Error("NoRoute", "No route found between the waypoints", result);
+    }
+    if (!chain.candidates.empty())
+    {
+        metrics.found_route = true;
+        best_result.duration = static_cast<double>(chain.weight) / 10.;
+        best_result.distance = 0;
+        for (auto &leg : legs)
+        {
+            best_result.distance += leg.distance;
+            best_result.polylines.push_back(std::move(leg.polyline));
+        }
+    }
 
     result.values["duration"] = best_result.duration;
     result.values["distance"] = best_result.distance;
@@ -124,12 +229,22 @@ Status SmoothViaPlugin::HandleRequest(const api::SmoothViaParameters &params,
     }
     result.values["geometry"] = geometry;
 
+    counters.Add(metrics);
+    if (params.debug)
+    {
+        result.values["debug"] = MakeJSON(metrics);
+    }
+
     return Status::Ok;
 }
 
+template <typename DataFacadeT>
 std::vector<std::vector<PhantomNode>>
-SmoothViaPlugin::ResolveNodes(const api::SmoothViaParameters &params)
+SmoothViaPlugin<DataFacadeT>::ResolveNodes(const api::SmoothViaParameters &params,
+                                           SmoothViaMetrics &metrics)
 {
+    metrics.waypoints = params.waypoints.size();
+
     std::vector<std::vector<PhantomNode>> resolved_nodes;
     for (auto const &waypoint : params.waypoints)
     {
@@ -138,15 +253,28 @@ SmoothViaPlugin::ResolveNodes(const api::SmoothViaParameters &params)
         std::vector<PhantomNode> nodes;
         for (auto const &coord : waypoint)
         {
-            std::vector<PhantomNodeWithDistance> close_nodes;
-            close_nodes = facade.NearestPhantomNodesInRange(coord, 50.);
+            const auto snap_in_range = [&] {
+                return facade.NearestPhantomNodesInRange(coord, 50.);
+            };
+            const auto close_nodes =
+                phantom_node_cache
+                    ? phantom_node_cache->GetInRange(PhantomNodeCacheKey{coord, 50.}, snap_in_range)
+                    : snap_in_range();
             if (close_nodes.empty() || std::all_of(begin(close_nodes),
                                                    end(close_nodes),
                                                    [](PhantomNodeWithDistance const &node) {
                                                        return node.phantom_node.component.is_tiny;
                                                    }))
             {
-                auto pair = facade.NearestPhantomNodeWithAlternativeFromBigComponent(coord);
+                ++metrics.tiny_component_fallbacks;
+                const auto snap = [&] {
+                    return facade.NearestPhantomNodeWithAlternativeFromBigComponent(coord);
+                };
+                const auto pair =
+                    phantom_node_cache
+                        ? phantom_node_cache->GetNearestWithAlternative(PhantomNodeCacheKey{coord},
+                                                                        snap)
+                        : snap();
                 if (!pair.first.component.is_tiny)
                 {
                     nodes.push_back(pair.first);
@@ -174,60 +302,52 @@ SmoothViaPlugin::ResolveNodes(const api::SmoothViaParameters &params)
                 return node.component.is_tiny;
             }))
         {
-            std::cout << "\nALL_TINY:";
-
-            for (auto const &coord : waypoint)
-            {
-                std::cout << coord << " -- ";
-            }
-            std::cout << std::endl;
+            ++metrics.all_tiny_waypoints;
         }
 
-        std::cout << nodes.size() << ", ";
-
+        metrics.candidates += nodes.size();
         resolved_nodes.emplace_back(std::move(nodes));
     }
-    std::cout << std::endl;
-
-    if (resolved_nodes.size() < 2)
-    {
-        // TODO throw
-        // throw std::system_error(error::invalid_request);
-    }
 
     return resolved_nodes;
 }
 
-leg_results_t
-SmoothViaPlugin::RouteAllLegs(const std::vector<std::vector<PhantomNode>> &resolved_nodes)
+template <typename DataFacadeT>
+std::vector<std::vector<EdgeWeight>>
+SmoothViaPlugin<DataFacadeT>::ComputeLegTables(
+    const std::vector<std::vector<PhantomNode>> &resolved_nodes)
 {
-    leg_results_t leg_results;
+    std::vector<std::vector<EdgeWeight>> leg_tables;
     for (auto i = 1ul; i < resolved_nodes.size(); ++i)
     {
-        std::vector<std::vector<LegResult>> many_to_many_results;
-        for (auto const &start_node : resolved_nodes[i - 1])
+        const auto &start_nodes = resolved_nodes[i - 1];
+        const auto &end_nodes = resolved_nodes[i];
+        if (start_nodes.empty() || end_nodes.empty())
         {
-            std::vector<LegResult> one_to_many_results;
-            for (auto const &end_node : resolved_nodes[i])
-            {
-                one_to_many_results.push_back(RouteDirect(start_node, end_node));
-            }
-            many_to_many_results.push_back(one_to_many_results);
+            leg_tables.emplace_back();
+            continue;
         }
-        leg_results.push_back(many_to_many_results);
-    }
 
-    return leg_results;
-}
+        std::vector<PhantomNode> phantom_nodes;
+        phantom_nodes.reserve(start_nodes.size() + end_nodes.size());
+        phantom_nodes.insert(phantom_nodes.end(), start_nodes.begin(), start_nodes.end());
+        phantom_nodes.insert(phantom_nodes.end(), end_nodes.begin(), end_nodes.end());
 
-int GetTime(PhantomNode const &node, bool traversed_in_reverse)
-{
-    return traversed_in_reverse ? node.reverse_weight : node.forward_weight;
+        std::vector<std::size_t> source_indices(start_nodes.size());
+        std::iota(source_indices.begin(), source_indices.end(), 0);
+        std::vector<std::size_t> target_indices(end_nodes.size());
+        std::iota(target_indices.begin(), target_indices.end(), start_nodes.size());
+
+        leg_tables.push_back(distance_table(phantom_nodes, source_indices, target_indices));
+    }
+
+    return leg_tables;
 }
 
-LegResult SmoothViaPlugin::RouteDirect(const PhantomNode &from, const PhantomNode &to)
+template <typename DataFacadeT>
+LegResult SmoothViaPlugin<DataFacadeT>::RouteDirect(const PhantomNode &from, const PhantomNode &to)
 {
-    InternalRouteResult raw_route;
+    InternalRouteResult raw_route(SearchEngineData::GetRequestArena());
     raw_route.segment_end_coordinates.emplace_back(PhantomNodes{from, to});
 
     shortest_path(
@@ -235,7 +355,6 @@ LegResult SmoothViaPlugin::RouteDirect(const PhantomNode &from, const PhantomNod
 
     if (INVALID_EDGE_WEIGHT == raw_route.shortest_path_length)
     {
-        std::cout << "Error occurred, single path not found" << std::endl;
         return {static_cast<double>(std::numeric_limits<int>::max()),
                 static_cast<double>(std::numeric_limits<int>::max()),
                 {}};
@@ -243,11 +362,8 @@ LegResult SmoothViaPlugin::RouteDirect(const PhantomNode &from, const PhantomNod
 
     LegResult result{0, 0.0, {}};
 
-    if (raw_route.unpacked_path_segments.size() != 1)
-    {
-        std::cout << "unpacked path segments have unexpected size"
-                  << raw_route.unpacked_path_segments.size() << std::endl;
-    }
+    BOOST_ASSERT_MSG(raw_route.unpacked_path_segments.size() == 1,
+                     "unpacked path segments have unexpected size");
 
     result.polyline.push_back(raw_route.segment_end_coordinates[0].source_phantom.location);
     for (auto const &data : raw_route.unpacked_path_segments[0])
@@ -262,21 +378,14 @@ LegResult SmoothViaPlugin::RouteDirect(const PhantomNode &from, const PhantomNod
                                                                              result.polyline[i]);
     }
 
-    result.duration = GetTime(raw_route.segment_end_coordinates[0].source_phantom,
-                              raw_route.source_traversed_in_reverse[0]);
-    for (auto const &data : raw_route.unpacked_path_segments[0])
-    {
-        result.duration += data.duration_until_turn;
-    }
-    result.duration += GetTime(raw_route.segment_end_coordinates[0].target_phantom,
-                               raw_route.target_traversed_in_reverse[0]); // TODO intermediate
-    // phantoms are counted
-    // twice
-
-    result.duration /= 10;
+    // the weight of the search, the same metric as the leg tables
+    result.duration = static_cast<double>(raw_route.shortest_path_length) / 10.;
 
     return result;
 }
+
+template class SmoothViaPlugin<datafacade::InternalDataFacade>;
+template class SmoothViaPlugin<datafacade::SharedDataFacade>;
 }
 }
 }
@@ -1,5 +1,8 @@
 #include "engine/plugins/table.hpp"
 
+#include "engine/datafacade/internal_datafacade.hpp"
+#include "engine/datafacade/shared_datafacade.hpp"
+
 #include "engine/api/table_api.hpp"
 #include "engine/api/table_parameters.hpp"
 #include "engine/routing_algorithms/many_to_many.hpp"
@@ -16,6 +19,8 @@
 
 #include <boost/assert.hpp>
 
+#include <tbb/task_arena.h>
+
 namespace osrm
 {
 namespace engine
@@ -23,13 +28,20 @@ namespace engine
 namespace plugins
 {
 
-TablePlugin::TablePlugin(datafacade::BaseDataFacade &facade, const int max_locations_distance_table)
+template <typename DataFacadeT>
+TablePlugin<DataFacadeT>::TablePlugin(DataFacadeT &facade,
+                                      const int max_locations_distance_table,
+                                      const int parallel_threshold_,
+                                      const int max_threads_)
     : BasePlugin{facade}, distance_table(&facade, heaps),
-      max_locations_distance_table(max_locations_distance_table)
+      max_locations_distance_table(max_locations_distance_table),
+      parallel_threshold(parallel_threshold_), max_threads(max_threads_)
 {
 }
 
-Status TablePlugin::HandleRequest(const api::TableParameters &params, util::json::Object &result)
+template <typename DataFacadeT>
+Status TablePlugin<DataFacadeT>::HandleRequest(const api::TableParameters &params,
+                                               util::json::Object &result)
 {
     BOOST_ASSERT(params.IsValid());
 
@@ -60,7 +72,31 @@ Status TablePlugin::HandleRequest(const api::TableParameters &params, util::json
 
     // auto snapped_phantoms = SnapPhantomNodes(GetPhantomNodes(params));
     auto snapped_phantoms = SnapPhantomNodes(GetPhantomNodes(params));
-    auto result_table = distance_table(snapped_phantoms, params.sources, params.destinations);
+    const auto max_weight = GetMaxWeight(params.max_duration);
+    const auto number_of_nearest = params.k ? *params.k : 0;
+    std::vector<EdgeWeight> result_table;
+    if (parallel_threshold > 0 &&
+        num_sources * num_destinations >= static_cast<std::size_t>(parallel_threshold))
+    {
+        // an arena per request, so max_threads bounds each request and not all of them together
+        tbb::task_arena arena(max_threads);
+        arena.execute([&] {
+            result_table = distance_table(snapped_phantoms,
+                                          params.sources,
+                                          params.destinations,
+                                          max_weight,
+                                          number_of_nearest,
+                                          true);
+        });
+    }
+    else
+    {
+        result_table = distance_table(snapped_phantoms,
+                                      params.sources,
+                                      params.destinations,
+                                      max_weight,
+                                      number_of_nearest);
+    }
 
     if (result_table.empty())
     {
@@ -72,6 +108,9 @@ Status TablePlugin::HandleRequest(const api::TableParameters &params, util::json
 
     return Status::Ok;
 }
+
+template class TablePlugin<datafacade::InternalDataFacade>;
+template class TablePlugin<datafacade::SharedDataFacade>;
 }
 }
 }
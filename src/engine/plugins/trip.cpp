@@ -1,5 +1,8 @@
 #include "engine/plugins/trip.hpp"
 
+#include "engine/datafacade/internal_datafacade.hpp"
+#include "engine/datafacade/shared_datafacade.hpp"
+
 #include "extractor/tarjan_scc.hpp"
 
 #include "engine/api/trip_api.hpp"
@@ -114,10 +117,12 @@ SCC_Component SplitUnaccessibleLocations(const std::size_t number_of_locations,
     return SCC_Component(std::move(components), std::move(range));
 }
 
-InternalRouteResult TripPlugin::ComputeRoute(const std::vector<PhantomNode> &snapped_phantoms,
-                                             const std::vector<NodeID> &trip)
+template <typename DataFacadeT>
+InternalRouteResult
+TripPlugin<DataFacadeT>::ComputeRoute(const std::vector<PhantomNode> &snapped_phantoms,
+                                      const std::vector<NodeID> &trip)
 {
-    InternalRouteResult min_route;
+    InternalRouteResult min_route(SearchEngineData::GetRequestArena());
     // given he final trip, compute total duration and return the route and location permutation
     PhantomNodes viapoint;
     const auto start = std::begin(trip);
@@ -140,8 +145,9 @@ InternalRouteResult TripPlugin::ComputeRoute(const std::vector<PhantomNode> &sna
     return min_route;
 }
 
-Status TripPlugin::HandleRequest(const api::TripParameters &parameters,
-                                 util::json::Object &json_result)
+template <typename DataFacadeT>
+Status TripPlugin<DataFacadeT>::HandleRequest(const api::TripParameters &parameters,
+                                              util::json::Object &json_result)
 {
     BOOST_ASSERT(parameters.IsValid());
 
@@ -239,6 +245,9 @@ Status TripPlugin::HandleRequest(const api::TripParameters &parameters,
 
     return Status::Ok;
 }
+
+template class TripPlugin<datafacade::InternalDataFacade>;
+template class TripPlugin<datafacade::SharedDataFacade>;
 }
 }
 }
@@ -1,6 +1,8 @@
 #include "engine/plugins/viaroute.hpp"
 #include "engine/api/route_api.hpp"
 #include "engine/datafacade/datafacade_base.hpp"
+#include "engine/datafacade/internal_datafacade.hpp"
+#include "engine/datafacade/shared_datafacade.hpp"
 #include "engine/status.hpp"
 
 #include "util/for_each_pair.hpp"
@@ -21,14 +23,16 @@ namespace engine
 namespace plugins
 {
 
-ViaRoutePlugin::ViaRoutePlugin(datafacade::BaseDataFacade &facade_, int max_locations_viaroute)
+template <typename DataFacadeT>
+ViaRoutePlugin<DataFacadeT>::ViaRoutePlugin(DataFacadeT &facade_, int max_locations_viaroute)
     : BasePlugin(facade_), shortest_path(&facade_, heaps), alternative_path(&facade_, heaps),
       direct_shortest_path(&facade_, heaps), max_locations_viaroute(max_locations_viaroute)
 {
 }
 
-Status ViaRoutePlugin::HandleRequest(const api::RouteParameters &route_parameters,
-                                     util::json::Object &json_result)
+template <typename DataFacadeT>
+Status ViaRoutePlugin<DataFacadeT>::HandleRequest(const api::RouteParameters &route_parameters,
+                                                  util::json::Object &json_result)
 {
     BOOST_ASSERT(route_parameters.IsValid());
 
@@ -63,7 +67,7 @@ Status ViaRoutePlugin::HandleRequest(const api::RouteParameters &route_parameter
                                                    ? *route_parameters.continue_straight
                                                    : facade.GetContinueStraightDefault();
 
-    InternalRouteResult raw_route;
+    InternalRouteResult raw_route(SearchEngineData::GetRequestArena());
     auto build_phantom_pairs = [&raw_route, continue_straight_at_waypoint](
         const PhantomNode &first_node, const PhantomNode &second_node) {
         raw_route.segment_end_coordinates.push_back(PhantomNodes{first_node, second_node});
@@ -128,6 +132,9 @@ Status ViaRoutePlugin::HandleRequest(const api::RouteParameters &route_parameter
 
     return Status::Ok;
 }
+
+template class ViaRoutePlugin<datafacade::InternalDataFacade>;
+template class ViaRoutePlugin<datafacade::SharedDataFacade>;
 }
 }
 }
@@ -86,8 +86,11 @@ std::string encodePolyline(CoordVectorForwardIter begin, CoordVectorForwardIter
     return encode(delta_numbers);
 }
 
-std::vector<util::Coordinate> decodePolyline(const std::string &geometry_string)
+std::vector<util::Coordinate> decodePolyline(const std::string &geometry_string,
+                                             const double precision)
 {
+    const double polyline_to_coordinate = COORDINATE_PRECISION / precision;
+
     std::vector<util::Coordinate> new_coordinates;
     int index = 0, len = geometry_string.size();
     int lat = 0, lng = 0;
@@ -116,8 +119,8 @@ std::vector<util::Coordinate> decodePolyline(const std::string &geometry_string)
         lng += dlng;
 
         util::Coordinate p;
-        p.lat = util::FixedLatitude{static_cast<std::int32_t>(lat * detail::POLYLINE_TO_COORDINATE)};
-        p.lon = util::FixedLongitude{static_cast<std::int32_t>(lng * detail::POLYLINE_TO_COORDINATE)};
+        p.lat = util::FixedLatitude{static_cast<std::int32_t>(lat * polyline_to_coordinate)};
+        p.lon = util::FixedLongitude{static_cast<std::int32_t>(lng * polyline_to_coordinate)};
         new_coordinates.push_back(p);
     }
 
@@ -7,74 +7,88 @@ namespace osrm
 namespace engine
 {
 
-SearchEngineData::SearchEngineHeapPtr SearchEngineData::forward_heap_1;
-SearchEngineData::SearchEngineHeapPtr SearchEngineData::reverse_heap_1;
-SearchEngineData::SearchEngineHeapPtr SearchEngineData::forward_heap_2;
-SearchEngineData::SearchEngineHeapPtr SearchEngineData::reverse_heap_2;
-SearchEngineData::SearchEngineHeapPtr SearchEngineData::forward_heap_3;
-SearchEngineData::SearchEngineHeapPtr SearchEngineData::reverse_heap_3;
+namespace
+{
+// Cleanup of the thread local pointers, hands the heap back instead of deleting it
+void ReturnToPool(SearchEngineData::QueryHeap *heap)
+{
+    SearchEngineData::heap_pool.Release(std::unique_ptr<SearchEngineData::QueryHeap>(heap));
+}
 
-void SearchEngineData::InitializeOrClearFirstThreadLocalStorage(const unsigned number_of_nodes)
+void InitializeOrClear(SearchEngineData::SearchEngineHeapPtr &heap,
+                       const unsigned number_of_nodes,
+                       const HeapSize expected_size = HeapSize::Sparse)
 {
-    if (forward_heap_1.get())
+    if (heap.get())
     {
-        forward_heap_1->Clear();
+        heap->Clear();
     }
     else
     {
-        forward_heap_1.reset(new QueryHeap(number_of_nodes));
+        heap.reset(SearchEngineData::heap_pool.Acquire(number_of_nodes, expected_size).release());
     }
+}
+}
 
-    if (reverse_heap_1.get())
-    {
-        reverse_heap_1->Clear();
-    }
-    else
+// defined before the thread local pointers, so it outlives them
+SearchEngineData::QueryHeapPool SearchEngineData::heap_pool;
+
+SearchEngineData::SearchEngineHeapPtr SearchEngineData::forward_heap_1(ReturnToPool);
+SearchEngineData::SearchEngineHeapPtr SearchEngineData::reverse_heap_1(ReturnToPool);
+SearchEngineData::SearchEngineHeapPtr SearchEngineData::forward_heap_2(ReturnToPool);
+SearchEngineData::SearchEngineHeapPtr SearchEngineData::reverse_heap_2(ReturnToPool);
+SearchEngineData::SearchEngineHeapPtr SearchEngineData::forward_heap_3(ReturnToPool);
+SearchEngineData::SearchEngineHeapPtr SearchEngineData::reverse_heap_3(ReturnToPool);
+
+SearchEngineData::UnpackingBufferPtr SearchEngineData::unpacking_buffer;
+
+SearchEngineData::UnpackingBuffer &SearchEngineData::GetUnpackingBuffer()
+{
+    if (!unpacking_buffer.get())
     {
-        reverse_heap_1.reset(new QueryHeap(number_of_nodes));
+        unpacking_buffer.reset(new UnpackingBuffer());
     }
+    return *unpacking_buffer;
 }
 
-void SearchEngineData::InitializeOrClearSecondThreadLocalStorage(const unsigned number_of_nodes)
+SearchEngineData::RequestArenaPtr SearchEngineData::request_arena;
+
+util::Arena &SearchEngineData::GetRequestArena()
 {
-    if (forward_heap_2.get())
-    {
-        forward_heap_2->Clear();
-    }
-    else
+    if (!request_arena.get())
     {
-        forward_heap_2.reset(new QueryHeap(number_of_nodes));
+        request_arena.reset(new util::Arena());
     }
+    return *request_arena;
+}
 
-    if (reverse_heap_2.get())
-    {
-        reverse_heap_2->Clear();
-    }
-    else
-    {
-        reverse_heap_2.reset(new QueryHeap(number_of_nodes));
-    }
+void SearchEngineData::InitializeOrClearFirstThreadLocalStorage(const unsigned number_of_nodes,
+                                                                const HeapSize expected_size)
+{
+    InitializeOrClear(forward_heap_1, number_of_nodes, expected_size);
+    InitializeOrClear(reverse_heap_1, number_of_nodes, expected_size);
+}
+
+void SearchEngineData::InitializeOrClearSecondThreadLocalStorage(const unsigned number_of_nodes)
+{
+    InitializeOrClear(forward_heap_2, number_of_nodes);
+    InitializeOrClear(reverse_heap_2, number_of_nodes);
 }
 
 void SearchEngineData::InitializeOrClearThirdThreadLocalStorage(const unsigned number_of_nodes)
 {
-    if (forward_heap_3.get())
-    {
-        forward_heap_3->Clear();
-    }
-    else
-    {
-        forward_heap_3.reset(new QueryHeap(number_of_nodes));
-    }
+    InitializeOrClear(forward_heap_3, number_of_nodes);
+    InitializeOrClear(reverse_heap_3, number_of_nodes);
+}
 
-    if (reverse_heap_3.get())
-    {
-        reverse_heap_3->Clear();
-    }
-    else
-    {
-        reverse_heap_3.reset(new QueryHeap(number_of_nodes));
-    }
+void SearchEngineData::ReleaseThreadLocalStorage()
+{
+    forward_heap_1.reset();
+    reverse_heap_1.reset();
+    forward_heap_2.reset();
+    reverse_heap_2.reset();
+    forward_heap_3.reset();
+    reverse_heap_3.reset();
 }
 }
 }
@@ -59,9 +59,25 @@ engine::Status OSRM::MultiTarget(const engine::api::MultiTargetParameters &param
     return engine_->MultiTarget(params, result);
 }
 
+engine::Status
+OSRM::MultiTargetBatch(const std::vector<engine::api::MultiTargetParameters> &queries,
+                       const engine::api::MultiTargetBatchHandler &handler)
+{
+    return engine_->MultiTargetBatch(queries, handler);
+}
+
 engine::Status OSRM::SmoothVia(const engine::api::SmoothViaParameters &params, json::Object &result)
 {
     return engine_->SmoothVia(params, result);
 }
 
+void OSRM::SmoothViaCounters(json::Object &result) const { engine_->SmoothViaCounters(result); }
+
+void OSRM::PhantomNodeCacheCounters(json::Object &result) const
+{
+    engine_->PhantomNodeCacheCounters(result);
+}
+
+void OSRM::HeapPoolCounters(json::Object &result) const { engine_->HeapPoolCounters(result); }
+
 } // ns osrm
@@ -1,8 +1,10 @@
 #include "server/api/parameters_parser.hpp"
 
 #include "server/api/match_parameter_grammar.hpp"
+#include "server/api/multi_target_parameter_grammar.hpp"
 #include "server/api/nearest_parameter_grammar.hpp"
 #include "server/api/route_parameters_grammar.hpp"
+#include "server/api/smooth_via_parameter_grammar.hpp"
 #include "server/api/table_parameter_grammar.hpp"
 #include "server/api/tile_parameter_grammar.hpp"
 #include "server/api/trip_parameter_grammar.hpp"
@@ -26,7 +28,9 @@ using is_grammar_t =
                                std::is_same<NearestParametersGrammar<>, T>::value ||
                                std::is_same<TripParametersGrammar<>, T>::value ||
                                std::is_same<MatchParametersGrammar<>, T>::value ||
-                               std::is_same<TileParametersGrammar<>, T>::value>;
+                               std::is_same<TileParametersGrammar<>, T>::value ||
+                               std::is_same<MultiTargetParametersGrammar<>, T>::value ||
+                               std::is_same<SmoothViaParametersGrammar<>, T>::value>;
 
 template <typename ParameterT,
           typename GrammarT,
@@ -106,6 +110,22 @@ boost::optional<engine::api::TileParameters> parseParameters(std::string::iterat
     return detail::parseParameters<engine::api::TileParameters, TileParametersGrammar<>>(iter, end);
 }
 
+template <>
+boost::optional<engine::api::MultiTargetParameters>
+parseParameters(std::string::iterator &iter, const std::string::iterator end)
+{
+    return detail::parseParameters<engine::api::MultiTargetParameters,
+                                   MultiTargetParametersGrammar<>>(iter, end);
+}
+
+template <>
+boost::optional<engine::api::SmoothViaParameters>
+parseParameters(std::string::iterator &iter, const std::string::iterator end)
+{
+    return detail::parseParameters<engine::api::SmoothViaParameters,
+                                   SmoothViaParametersGrammar<>>(iter, end);
+}
+
 } // ns api
 } // ns server
 } // ns osrm
@@ -0,0 +1,61 @@
+#include "server/service/smooth_via_service.hpp"
+
+#include "server/api/parameters_parser.hpp"
+#include "engine/api/smooth_via_parameters.hpp"
+
+#include "util/json_container.hpp"
+
+namespace osrm
+{
+namespace server
+{
+namespace service
+{
+
+namespace
+{
+std::string getWrongOptionHelp(const engine::api::SmoothViaParameters &parameters)
+{
+    std::string help;
+
+    if (parameters.waypoints.size() < 3)
+    {
+        help = "Number of waypoints needs to be at least three.";
+    }
+
+    return help;
+}
+} // anon. ns
+
+engine::Status
+SmoothViaService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &result)
+{
+    result = util::json::Object();
+    auto &json_result = result.get<util::json::Object>();
+
+    auto query_iterator = query.begin();
+    auto parameters =
+        api::parseParameters<engine::api::SmoothViaParameters>(query_iterator, query.end());
+    if (!parameters || query_iterator != query.end())
+    {
+        const auto position = std::distance(query.begin(), query_iterator);
+        json_result.values["code"] = "InvalidQuery";
+        json_result.values["message"] =
+            "Query string malformed close to position " + std::to_string(prefix_length + position);
+        return engine::Status::Error;
+    }
+    BOOST_ASSERT(parameters);
+
+    if (!parameters->IsValid())
+    {
+        json_result.values["code"] = "InvalidOptions";
+        json_result.values["message"] = getWrongOptionHelp(*parameters);
+        return engine::Status::Error;
+    }
+    BOOST_ASSERT(parameters->IsValid());
+
+    return BaseService::routing_machine.SmoothVia(*parameters, json_result);
+}
+}
+}
+}
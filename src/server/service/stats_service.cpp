@@ -0,0 +1,33 @@
+#include "server/service/stats_service.hpp"
+
+#include "util/json_container.hpp"
+
+namespace osrm
+{
+namespace server
+{
+namespace service
+{
+
+engine::Status
+StatsService::RunQuery(std::size_t /* prefix_length */, std::string &query, ResultT &result)
+{
+    result = util::json::Object();
+    auto &json_result = result.get<util::json::Object>();
+
+    if (query == "smoothvia")
+    {
+        util::json::Object counters;
+        BaseService::routing_machine.SmoothViaCounters(counters);
+        json_result.values["code"] = "Ok";
+        json_result.values["smoothvia"] = std::move(counters);
+        return engine::Status::Ok;
+    }
+
+    json_result.values["code"] = "InvalidQuery";
+    json_result.values["message"] = "Unknown counters " + query + ", supported is smoothvia";
+    return engine::Status::Error;
+}
+}
+}
+}
@@ -7,6 +7,8 @@
 
 #include <boost/format.hpp>
 
+#include <cmath>
+
 namespace osrm
 {
 namespace server
@@ -54,6 +56,16 @@ std::string getWrongOptionHelp(const engine::api::TableParameters &parameters)
         help = "Number of coordinates needs to be at least two.";
     }
 
+    if (help.empty() && parameters.max_duration &&
+        (!std::isfinite(*parameters.max_duration) || *parameters.max_duration < 0))
+    {
+        help = "max_duration needs to be a non-negative number of seconds.";
+    }
+    if (help.empty() && parameters.k && *parameters.k == 0)
+    {
+        help = "k needs to be at least one.";
+    }
+
     return help;
 }
 } // anon. ns
@@ -1,8 +1,11 @@
 #include "server/service_handler.hpp"
 
 #include "server/service/match_service.hpp"
+#include "server/service/multi_target_service.hpp"
 #include "server/service/nearest_service.hpp"
 #include "server/service/route_service.hpp"
+#include "server/service/smooth_via_service.hpp"
+#include "server/service/stats_service.hpp"
 #include "server/service/table_service.hpp"
 #include "server/service/tile_service.hpp"
 #include "server/service/trip_service.hpp"
@@ -23,6 +26,10 @@ ServiceHandler::ServiceHandler(osrm::EngineConfig &config) : routing_machine(con
     service_map["trip"] = util::make_unique<service::TripService>(routing_machine);
     service_map["match"] = util::make_unique<service::MatchService>(routing_machine);
     service_map["tile"] = util::make_unique<service::TileService>(routing_machine);
+    // Service names are alphanumeric only, see the url grammar
+    service_map["multitarget"] = util::make_unique<service::MultiTargetService>(routing_machine);
+    service_map["smoothvia"] = util::make_unique<service::SmoothViaService>(routing_machine);
+    service_map["stats"] = util::make_unique<service::StatsService>(routing_machine);
 }
 
 engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
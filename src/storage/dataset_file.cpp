@@ -0,0 +1,170 @@
+#include "storage/dataset_file.hpp"
+#include "util/exception.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/crc.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace osrm
+{
+namespace storage
+{
+
+namespace
+{
+const constexpr char DATASET_MAGIC[8] = {'O', 'S', 'R', 'M', 'D', 'A', 'T', 'A'};
+
+std::uint32_t getBlockChecksum(const SharedDataLayout &layout,
+                               const char *data,
+                               const SharedDataLayout::BlockID bid)
+{
+    boost::crc_32_type crc;
+    crc.process_bytes(data + layout.GetBlockOffset(bid), layout.GetBlockSize(bid));
+    return crc.checksum();
+}
+}
+
+constexpr std::uint32_t DatasetHeader::CURRENT_VERSION;
+
+DatasetFileWriter::DatasetFileWriter(const boost::filesystem::path &path_)
+    : path(path_), temporary_path(path_.string() + ".tmp")
+{
+}
+
+DatasetFileWriter::~DatasetFileWriter()
+{
+    if (region.is_open())
+    {
+        region.close();
+        boost::system::error_code error;
+        boost::filesystem::remove(temporary_path, error);
+    }
+}
+
+char *DatasetFileWriter::Allocate(const SharedDataLayout &layout)
+{
+    std::copy(DATASET_MAGIC, DATASET_MAGIC + sizeof(DATASET_MAGIC), header.magic);
+    header.version = DatasetHeader::CURRENT_VERSION;
+    header.number_of_blocks = SharedDataLayout::NUM_BLOCKS;
+    header.fingerprint = util::FingerPrint::GetValid();
+    header.layout = layout;
+    header.data_offset = SharedDataLayout::AlignBlockOffset(sizeof(DatasetHeader));
+    header.data_size = layout.GetSizeOfLayout();
+
+    // a new file is zero-filled, the same as the padding behind the header
+    boost::iostreams::mapped_file_params params(temporary_path.string());
+    params.flags = boost::iostreams::mapped_file::readwrite;
+    params.new_file_size = header.data_offset + header.data_size;
+    try
+    {
+        region.open(params);
+    }
+    catch (const std::exception &exc)
+    {
+        throw util::exception("Creating " + temporary_path.string() + " failed: " + exc.what());
+    }
+    return region.data() + header.data_offset;
+}
+
+void DatasetFileWriter::Commit()
+{
+    BOOST_ASSERT(region.is_open());
+    const char *data = region.data() + header.data_offset;
+    for (auto i = 0; i < SharedDataLayout::NUM_BLOCKS; ++i)
+    {
+        const auto bid = static_cast<SharedDataLayout::BlockID>(i);
+        header.block_offsets[i] = header.layout.GetBlockOffset(bid);
+        header.block_checksums[i] = getBlockChecksum(header.layout, data, bid);
+    }
+    std::memcpy(region.data(), &header, sizeof(DatasetHeader));
+
+    try
+    {
+        region.close();
+    }
+    catch (const std::exception &exc)
+    {
+        throw util::exception("Writing " + temporary_path.string() + " failed: " + exc.what());
+    }
+    boost::filesystem::rename(temporary_path, path);
+}
+
+void CheckDatasetHeader(const boost::filesystem::path &path,
+                        const DatasetHeader &header,
+                        const std::uint64_t file_size)
+{
+    if (file_size < sizeof(DatasetHeader) ||
+        !std::equal(DATASET_MAGIC, DATASET_MAGIC + sizeof(DATASET_MAGIC), header.magic))
+    {
+        throw util::exception(path.string() + " is not a dataset file");
+    }
+
+    const auto valid = util::FingerPrint::GetValid();
+    if (header.version != DatasetHeader::CURRENT_VERSION ||
+        header.number_of_blocks != SharedDataLayout::NUM_BLOCKS ||
+        !valid.IsMagicNumberOK(header.fingerprint) || !valid.TestContractor(header.fingerprint) ||
+        !valid.TestGraphUtil(header.fingerprint) || !valid.TestRTree(header.fingerprint) ||
+        !valid.TestQueryObjects(header.fingerprint))
+    {
+        throw util::exception(path.string() +
+                              " was prepared with a different build, reprocess it");
+    }
+
+    if (header.data_offset % SharedDataLayout::BLOCK_ALIGNMENT != 0 ||
+        header.data_offset > file_size ||
+        header.data_size != header.layout.GetSizeOfLayout() ||
+        header.data_size > file_size - header.data_offset)
+    {
+        throw util::exception(path.string() + " is truncated");
+    }
+
+    for (auto i = 0; i < SharedDataLayout::NUM_BLOCKS; ++i)
+    {
+        const auto bid = static_cast<SharedDataLayout::BlockID>(i);
+        if (header.block_offsets[i] != header.layout.GetBlockOffset(bid))
+        {
+            throw util::exception(path.string() + " has a misaligned block " +
+                                  block_id_to_name[i]);
+        }
+    }
+}
+
+bool CheckDatasetBlock(const DatasetHeader &header,
+                       const char *data,
+                       const SharedDataLayout::BlockID bid)
+{
+    return header.block_checksums[bid] == getBlockChecksum(header.layout, data, bid);
+}
+
+DatasetFile::DatasetFile(const boost::filesystem::path &path, const bool map, const bool verify)
+    : file(path, map)
+{
+    if (file.GetSize() < sizeof(DatasetHeader))
+    {
+        throw util::exception(path.string() + " is not a dataset file");
+    }
+    header = file.ReadValue<DatasetHeader>();
+    CheckDatasetHeader(path, header, file.GetSize());
+    data = file.GetData() + header.data_offset;
+
+    if (!verify)
+    {
+        return;
+    }
+    for (auto i = 0; i < SharedDataLayout::NUM_BLOCKS; ++i)
+    {
+        const auto bid = static_cast<SharedDataLayout::BlockID>(i);
+        if (!CheckDatasetBlock(header, data, bid))
+        {
+            throw util::exception(path.string() + " has a corrupted block " +
+                                  block_id_to_name[i]);
+        }
+    }
+}
+}
+}
@@ -1,3 +1,4 @@
+#include "contractor/core_landmarks.hpp"
 #include "contractor/query_edge.hpp"
 #include "extractor/compressed_edge_container.hpp"
 #include "extractor/guidance/turn_instruction.hpp"
@@ -5,37 +6,57 @@
 #include "extractor/profile_properties.hpp"
 #include "extractor/query_node.hpp"
 #include "extractor/travel_mode.hpp"
+#include "storage/dataset_file.hpp"
 #include "storage/shared_barriers.hpp"
 #include "storage/shared_datatype.hpp"
 #include "storage/shared_memory.hpp"
 #include "storage/storage.hpp"
 #include "engine/datafacade/datafacade_base.hpp"
 #include "util/coordinate.hpp"
+#include "util/edge_direction_split.hpp"
 #include "util/exception.hpp"
 #include "util/fingerprint.hpp"
 #include "util/io.hpp"
 #include "util/packed_vector.hpp"
 #include "util/range_table.hpp"
 #include "util/shared_memory_vector_wrapper.hpp"
+#include "util/shortcut_children.hpp"
 #include "util/simple_logger.hpp"
 #include "util/static_graph.hpp"
 #include "util/static_rtree.hpp"
+#include "util/timing_util.hpp"
 #include "util/typedefs.hpp"
 
 #ifdef __linux__
 #include <sys/mman.h>
 #endif
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include <boost/filesystem/fstream.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
 #include <boost/iostreams/seek.hpp>
 
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
 #include <cstdint>
 
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <initializer_list>
 #include <iterator>
 #include <new>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -45,7 +66,8 @@ namespace storage
 using RTreeLeaf = engine::datafacade::BaseDataFacade::RTreeLeaf;
 using RTreeNode =
     util::StaticRTree<RTreeLeaf, util::ShM<util::Coordinate, true>::vector, true>::TreeNode;
-using QueryGraph = util::StaticGraph<contractor::QueryEdge::EdgeData>;
+// the graph lives in shared memory, same type as in the SharedDataFacade
+using QueryGraph = util::StaticGraph<contractor::QueryEdge::EdgeData, true>;
 
 // delete a shared memory region. report warning if it could not be deleted
 void deleteRegion(const SharedDataType region)
@@ -76,6 +98,128 @@ void deleteRegion(const SharedDataType region)
     }
 }
 
+// Reads ranges of a file from several threads at once with large reads straight into their
+// destination. With direct_io the reads bypass the page cache, which needs the ranges and
+// buffers to be page aligned.
+class ParallelFileReader
+{
+  public:
+    ParallelFileReader(const boost::filesystem::path &path_, const bool direct_io) : path(path_)
+    {
+#ifndef _WIN32
+        int flags = O_RDONLY;
+#ifdef O_DIRECT
+        if (direct_io)
+        {
+            flags |= O_DIRECT;
+        }
+#endif
+        fd = ::open(path.c_str(), flags);
+        if (fd < 0 && direct_io)
+        {
+            // e.g. tmpfs does not support direct I/O
+            util::SimpleLogger().Write(logWARNING) << "Could not open " << path.string()
+                                                   << " for direct I/O, using the page cache";
+            fd = ::open(path.c_str(), O_RDONLY);
+        }
+        if (fd < 0)
+        {
+            throw util::exception("Could not open " + path.string() + " for reading.");
+        }
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#else
+        (void)direct_io;
+#endif
+    }
+
+    ~ParallelFileReader()
+    {
+#ifndef _WIN32
+        ::close(fd);
+#endif
+    }
+
+    ParallelFileReader(const ParallelFileReader &) = delete;
+    ParallelFileReader &operator=(const ParallelFileReader &) = delete;
+
+    void Read(std::uint64_t offset, std::uint64_t size, char *buffer) const
+    {
+#ifndef _WIN32
+        while (size > 0)
+        {
+            const auto result = ::pread(fd, buffer, size, offset);
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (result <= 0)
+            {
+                throw util::exception("Reading " + path.string() + " failed");
+            }
+            offset += result;
+            size -= result;
+            buffer += result;
+        }
+#else
+        boost::filesystem::ifstream stream(path, std::ios::binary);
+        stream.seekg(offset);
+        if (!stream.read(buffer, size))
+        {
+            throw util::exception("Reading " + path.string() + " failed");
+        }
+#endif
+    }
+
+  private:
+    boost::filesystem::path path;
+#ifndef _WIN32
+    int fd = -1;
+#endif
+};
+
+// size of the reads a block of a dataset file is split into
+const constexpr std::uint64_t DATASET_READ_SIZE = 64 * 1024 * 1024;
+// number of original edges and nodes read from their files at once
+const constexpr std::size_t READ_BUFFER_ENTRIES = 1024 * 1024;
+
+void logThroughput(const std::string &name, const std::uint64_t bytes, const double seconds)
+{
+    const double megabytes = bytes / (1024. * 1024.);
+    util::SimpleLogger().Write() << std::fixed << std::setprecision(2) << name << ": "
+                                 << megabytes << " MB in " << seconds << " s ("
+                                 << (seconds > 0 ? megabytes / seconds : 0) << " MB/s)";
+}
+
+// Logs the throughput of loading a group of blocks once it goes out of scope
+class BlockTimer
+{
+  public:
+    BlockTimer(const SharedDataLayout &layout,
+               std::string name_,
+               const std::initializer_list<SharedDataLayout::BlockID> blocks)
+        : name(std::move(name_)), bytes(0), start(std::chrono::steady_clock::now())
+    {
+        for (const auto bid : blocks)
+        {
+            bytes += layout.GetBlockSize(bid);
+        }
+    }
+
+    ~BlockTimer()
+    {
+        const auto seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        logThroughput(name, bytes, seconds);
+    }
+
+  private:
+    std::string name;
+    std::uint64_t bytes;
+    std::chrono::steady_clock::time_point start;
+};
+
 Storage::Storage(StorageConfig config_) : config(std::move(config_)) {}
 
 int Storage::Run()
@@ -94,16 +238,10 @@ int Storage::Run()
     }
 #endif
 
-    try
-    {
-        boost::interprocess::scoped_lock<boost::interprocess::named_mutex> pending_lock(
-            barrier.pending_update_mutex);
-    }
-    catch (...)
-    {
-        // hard unlock in case of any exception.
-        barrier.pending_update_mutex.unlock();
-    }
+    // only one osrm-datastore updates the regions at a time, osrm-unlock-all releases the lock
+    // of one that crashed
+    boost::interprocess::scoped_lock<boost::interprocess::named_mutex> update_lock(
+        barrier.update_mutex);
 
     // determine segment to use
     bool segment2_in_use = SharedMemory::RegionExists(LAYOUT_2);
@@ -121,6 +259,122 @@ int Storage::Run()
     // Allocate a memory layout in shared memory, deallocate previous
     auto *layout_memory = makeSharedMemory(layout_region, sizeof(SharedDataLayout));
     auto shared_layout_ptr = new (layout_memory->Ptr()) SharedDataLayout();
+
+    SharedMemory *data_memory = nullptr;
+    const auto allocate_shared_memory = [&](const SharedDataLayout &layout) {
+        util::SimpleLogger().Write() << "allocating shared memory of " << layout.GetSizeOfLayout()
+                                     << " bytes";
+        data_memory = makeSharedMemory(
+            data_region, layout.GetSizeOfLayout(), false, true, config.use_huge_pages);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        // only a hint, the kernel decides whether shared memory gets transparent huge pages
+        madvise(data_memory->Ptr(), layout.GetSizeOfLayout(), MADV_HUGEPAGE);
+#endif
+        return static_cast<char *>(data_memory->Ptr());
+    };
+
+    tbb::task_arena arena(config.requested_num_threads > 0
+                              ? static_cast<int>(config.requested_num_threads)
+                              : static_cast<int>(tbb::task_arena::automatic));
+    TIMER_START(load);
+    arena.execute([&] {
+        if (boost::filesystem::exists(config.dataset_path))
+        {
+            LoadDataset(*shared_layout_ptr, allocate_shared_memory);
+        }
+        else
+        {
+            PopulateData(*shared_layout_ptr, allocate_shared_memory);
+        }
+    });
+    TIMER_STOP(load);
+    logThroughput("loaded all blocks", shared_layout_ptr->GetSizeOfLayout(), TIMER_SEC(load));
+#ifdef __linux__
+    // all pages are touched by now, so this is what the queries get
+    data_memory->LogPageSizes();
+#endif
+
+    SharedMemory *data_type_memory =
+        makeSharedMemory(CURRENT_REGIONS, sizeof(SharedCurrentRegions), true, false);
+    auto *current_regions = static_cast<SharedCurrentRegions *>(data_type_memory->Ptr());
+
+    // Queries pick the new dataset up with their next query. The previous regions are only
+    // marked for removal, the kernel frees them once the last engine using them detached.
+    auto regions = current_regions->Load();
+    regions.layout = layout_region;
+    regions.data = data_region;
+    regions.timestamp += 1;
+    current_regions->Store(regions);
+    deleteRegion(previous_data_region);
+    deleteRegion(previous_layout_region);
+    util::SimpleLogger().Write() << "all data loaded";
+
+    return EXIT_SUCCESS;
+}
+
+void Storage::WriteDataset(const boost::filesystem::path &dataset_path)
+{
+    SharedDataLayout layout;
+    DatasetFileWriter writer(dataset_path);
+    PopulateData(layout, [&](const SharedDataLayout &data_layout) {
+        util::SimpleLogger().Write() << "writing dataset of " << data_layout.GetSizeOfLayout()
+                                     << " bytes to " << dataset_path.string();
+        return writer.Allocate(data_layout);
+    });
+    writer.Commit();
+}
+
+// Reads a dataset file into the data returned by allocate. The blocks are laid out the same as
+// in memory, so every block is read with a few large reads of its pages, all blocks in
+// parallel. The checksums are compared once a block is read.
+void Storage::LoadDataset(SharedDataLayout &layout, const AllocateData &allocate)
+{
+    util::SimpleLogger().Write() << "load dataset from: " << config.dataset_path;
+
+    DatasetHeader header{};
+    {
+        boost::filesystem::ifstream header_stream(config.dataset_path, std::ios::binary);
+        header_stream.read(reinterpret_cast<char *>(&header), sizeof(DatasetHeader));
+    }
+    CheckDatasetHeader(
+        config.dataset_path, header, boost::filesystem::file_size(config.dataset_path));
+    layout = header.layout;
+    char *data = allocate(layout);
+
+    const ParallelFileReader reader(config.dataset_path, config.use_direct_io);
+    tbb::parallel_for(0, static_cast<int>(SharedDataLayout::NUM_BLOCKS), [&](const int index) {
+        const auto bid = static_cast<SharedDataLayout::BlockID>(index);
+        // the pages up to the next block, with the canaries around the block
+        const std::uint64_t begin = index == 0 ? 0 : layout.GetBlockOffset(bid);
+        const std::uint64_t end =
+            layout.GetBlockOffset(static_cast<SharedDataLayout::BlockID>(index + 1));
+
+        TIMER_START(block);
+        const auto number_of_reads = (end - begin + DATASET_READ_SIZE - 1) / DATASET_READ_SIZE;
+        tbb::parallel_for<std::uint64_t>(0, number_of_reads, [&](const std::uint64_t read) {
+            const auto offset = begin + read * DATASET_READ_SIZE;
+            const auto size = std::min(DATASET_READ_SIZE, end - offset);
+            reader.Read(header.data_offset + offset, size, data + offset);
+        });
+        if (!CheckDatasetBlock(header, data, bid))
+        {
+            throw util::exception(config.dataset_path.string() + " has a corrupted block " +
+                                  block_id_to_name[index]);
+        }
+        TIMER_STOP(block);
+
+        if (layout.GetBlockSize(bid) > 0)
+        {
+            logThroughput(block_id_to_name[index], layout.GetBlockSize(bid), TIMER_SEC(block));
+        }
+    });
+}
+
+// Reads the blocks from the files of the dataset. The data is zero-initialized memory
+// returned by allocate once the layout is known.
+void Storage::PopulateData(SharedDataLayout &layout, const AllocateData &allocate)
+{
+    SharedDataLayout *const shared_layout_ptr = &layout;
     auto absolute_file_index_path = boost::filesystem::absolute(config.file_index_path);
 
     shared_layout_ptr->SetBlockSize<char>(SharedDataLayout::FILE_INDEX_PATH,
@@ -201,6 +455,9 @@ int Storage::Run()
         util::SimpleLogger().Write(logWARNING) << ".hsgr was prepared with different build. "
                                                   "Reprocess to get rid of this warning.";
     }
+    std::uint32_t edge_order_version = 0;
+    hsgr_input_stream.read((char *)&edge_order_version, sizeof(std::uint32_t));
+    util::CheckEdgeOrderVersion(config.hsgr_data_path.string(), edge_order_version);
 
     // load checksum
     unsigned checksum = 0;
@@ -220,6 +477,60 @@ int Storage::Run()
     // BOOST_ASSERT_MSG(0 != number_of_graph_edges, "number of graph edges is zero");
     shared_layout_ptr->SetBlockSize<QueryGraph::EdgeArrayEntry>(SharedDataLayout::GRAPH_EDGE_LIST,
                                                                 number_of_graph_edges);
+    // the node list ends with a sentinel
+    shared_layout_ptr->SetBlockSize<util::EdgeDirectionSplit>(
+        SharedDataLayout::GRAPH_EDGE_DIRECTION_SPLITS, number_of_graph_nodes - 1);
+
+    // count the children of the shortcuts, they are resolved once the graph is in shared memory
+    std::uint64_t number_of_shortcut_children = 0;
+    {
+        boost::filesystem::ifstream edge_input_stream(config.hsgr_data_path, std::ios::binary);
+        edge_input_stream.seekg(hsgr_input_stream.tellg() +
+                                static_cast<std::streamoff>(number_of_graph_nodes *
+                                                            sizeof(QueryGraph::NodeArrayEntry)));
+        std::vector<QueryGraph::EdgeArrayEntry> edge_buffer(1024 * 1024);
+        for (std::uint64_t remaining = number_of_graph_edges; remaining > 0;)
+        {
+            const auto number_of_edges = std::min<std::uint64_t>(remaining, edge_buffer.size());
+            edge_input_stream.read(reinterpret_cast<char *>(edge_buffer.data()),
+                                   number_of_edges * sizeof(QueryGraph::EdgeArrayEntry));
+            if (!edge_input_stream)
+            {
+                throw util::exception("Could not read the edges of " +
+                                      config.hsgr_data_path.string());
+            }
+            for (std::uint64_t edge = 0; edge < number_of_edges; ++edge)
+            {
+                number_of_shortcut_children +=
+                    util::GetNumberOfShortcutChildren(edge_buffer[edge].data);
+            }
+            remaining -= number_of_edges;
+        }
+    }
+    shared_layout_ptr->SetBlockSize<EdgeID>(SharedDataLayout::SHORTCUT_CHILDREN_OFFSETS,
+                                            number_of_graph_edges + 1);
+    shared_layout_ptr->SetBlockSize<util::ShortcutChildren>(SharedDataLayout::SHORTCUT_CHILDREN,
+                                                            number_of_shortcut_children);
+
+    // load node and edge length sizes. This file is optional, without it distances are
+    // computed from the unpacked geometry.
+    std::vector<EdgeLength> node_lengths;
+    std::vector<EdgeLength> edge_lengths;
+    boost::filesystem::ifstream lengths_input_stream(config.lengths_path, std::ios::binary);
+    if (!lengths_input_stream || !util::readAndCheckFingerprint(lengths_input_stream) ||
+        !util::deserializeVector(lengths_input_stream, node_lengths) ||
+        !util::deserializeVector(lengths_input_stream, edge_lengths) ||
+        edge_lengths.size() != number_of_graph_edges)
+    {
+        util::SimpleLogger().Write(logWARNING) << "Could not read lengths from "
+                                               << config.lengths_path.string();
+        node_lengths.clear();
+        edge_lengths.clear();
+    }
+    shared_layout_ptr->SetBlockSize<EdgeLength>(SharedDataLayout::GRAPH_NODE_LENGTHS,
+                                                node_lengths.size());
+    shared_layout_ptr->SetBlockSize<EdgeLength>(SharedDataLayout::GRAPH_EDGE_LENGTHS,
+                                                edge_lengths.size());
 
     // load rsearch tree size
     boost::filesystem::ifstream tree_node_file(config.ram_index_path, std::ios::binary);
@@ -249,6 +560,22 @@ int Storage::Run()
     shared_layout_ptr->SetBlockSize<unsigned>(SharedDataLayout::CORE_MARKER,
                                               number_of_core_markers);
 
+    // load the core landmarks. They are optional, without them the core is searched without a
+    // goal direction.
+    contractor::CoreLandmarks core_landmarks;
+    if (!contractor::readCoreLandmarks(config.landmarks_path, checksum, core_landmarks))
+    {
+        util::SimpleLogger().Write(logWARNING) << "Could not read landmarks from "
+                                               << config.landmarks_path.string();
+        core_landmarks = contractor::CoreLandmarks();
+    }
+    shared_layout_ptr->SetBlockSize<NodeID>(SharedDataLayout::CORE_LANDMARKS,
+                                            core_landmarks.landmarks.size());
+    shared_layout_ptr->SetBlockSize<NodeID>(SharedDataLayout::CORE_LANDMARK_INDEX,
+                                            core_landmarks.core_index.size());
+    shared_layout_ptr->SetBlockSize<util::LandmarkDistance>(
+        SharedDataLayout::CORE_LANDMARK_DISTANCES, core_landmarks.distances.size());
+
     // load coordinate size
     boost::filesystem::ifstream nodes_input_stream(config.nodes_data_path, std::ios::binary);
     if (!nodes_input_stream)
@@ -402,11 +729,8 @@ int Storage::Run()
     shared_layout_ptr->SetBlockSize<util::guidance::EntryClass>(SharedDataLayout::ENTRY_CLASS,
                                                                 entry_class_table.size());
 
-    // allocate shared memory block
-    util::SimpleLogger().Write() << "allocating shared memory of "
-                                 << shared_layout_ptr->GetSizeOfLayout() << " bytes";
-    auto *shared_memory = makeSharedMemory(data_region, shared_layout_ptr->GetSizeOfLayout());
-    char *shared_memory_ptr = static_cast<char *>(shared_memory->Ptr());
+    // allocate the data block
+    char *shared_memory_ptr = allocate(*shared_layout_ptr);
 
     // read actual data into shared memory object //
 
@@ -427,333 +751,457 @@ int Storage::Run()
               absolute_file_index_path.string().end(),
               file_index_path_ptr);
 
-    // Loading street names
-    unsigned *name_offsets_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-        shared_memory_ptr, SharedDataLayout::NAME_OFFSETS);
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_OFFSETS) > 0)
-    {
-        name_stream.read((char *)name_offsets_ptr,
-                         shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_OFFSETS));
-    }
-
-    unsigned *name_blocks_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-        shared_memory_ptr, SharedDataLayout::NAME_BLOCKS);
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_BLOCKS) > 0)
-    {
-        name_stream.read((char *)name_blocks_ptr,
-                         shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_BLOCKS));
-    }
-
-    char *name_char_ptr = shared_layout_ptr->GetBlockPtr<char, true>(
-        shared_memory_ptr, SharedDataLayout::NAME_CHAR_LIST);
-    unsigned temp_length = 0;
-    name_stream.read((char *)&temp_length, sizeof(unsigned));
-
-    BOOST_ASSERT_MSG(shared_layout_ptr->AlignBlockSize(temp_length) ==
-                         shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_CHAR_LIST),
-                     "Name file corrupted!");
-
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_CHAR_LIST) > 0)
-    {
-        name_stream.read(name_char_ptr,
-                         shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_CHAR_LIST));
-    }
-    name_stream.close();
-
-    // make sure do write canary...
-    auto *turn_lane_data_ptr =
-        shared_layout_ptr->GetBlockPtr<util::guidance::LaneTupelIdPair, true>(
-            shared_memory_ptr, SharedDataLayout::TURN_LANE_DATA);
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::TURN_LANE_DATA) > 0)
-    {
-        lane_data_stream.read(reinterpret_cast<char *>(turn_lane_data_ptr),
-                              shared_layout_ptr->GetBlockSize(SharedDataLayout::TURN_LANE_DATA));
-    }
-    lane_data_stream.close();
-
-    auto *turn_lane_offset_ptr = shared_layout_ptr->GetBlockPtr<std::uint32_t, true>(
-        shared_memory_ptr, SharedDataLayout::LANE_DESCRIPTION_OFFSETS);
-    if (!lane_description_offsets.empty())
-    {
-        BOOST_ASSERT(shared_layout_ptr->GetBlockSize(SharedDataLayout::LANE_DESCRIPTION_OFFSETS) >=
-                     sizeof(lane_description_offsets[0]) * lane_description_offsets.size());
-        std::copy(
-            lane_description_offsets.begin(), lane_description_offsets.end(), turn_lane_offset_ptr);
-        std::vector<std::uint32_t> tmp;
-        lane_description_offsets.swap(tmp);
-    }
-
-    auto *turn_lane_mask_ptr =
-        shared_layout_ptr->GetBlockPtr<extractor::guidance::TurnLaneType::Mask, true>(
-            shared_memory_ptr, SharedDataLayout::LANE_DESCRIPTION_MASKS);
-    if (!lane_description_masks.empty())
-    {
-        BOOST_ASSERT(shared_layout_ptr->GetBlockSize(SharedDataLayout::LANE_DESCRIPTION_MASKS) >=
-                     sizeof(lane_description_masks[0]) * lane_description_masks.size());
-        std::copy(lane_description_masks.begin(), lane_description_masks.end(), turn_lane_mask_ptr);
-        std::vector<extractor::guidance::TurnLaneType::Mask> tmp;
-        lane_description_masks.swap(tmp);
-    }
-
-    // load original edge information
-    NodeID *via_node_ptr = shared_layout_ptr->GetBlockPtr<NodeID, true>(
-        shared_memory_ptr, SharedDataLayout::VIA_NODE_LIST);
-
-    unsigned *name_id_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-        shared_memory_ptr, SharedDataLayout::NAME_ID_LIST);
-
-    extractor::TravelMode *travel_mode_ptr =
-        shared_layout_ptr->GetBlockPtr<extractor::TravelMode, true>(shared_memory_ptr,
-                                                                    SharedDataLayout::TRAVEL_MODE);
-
-    LaneDataID *lane_data_id_ptr = shared_layout_ptr->GetBlockPtr<LaneDataID, true>(
-        shared_memory_ptr, SharedDataLayout::LANE_DATA_ID);
-
-    extractor::guidance::TurnInstruction *turn_instructions_ptr =
-        shared_layout_ptr->GetBlockPtr<extractor::guidance::TurnInstruction, true>(
-            shared_memory_ptr, SharedDataLayout::TURN_INSTRUCTION);
-
-    EntryClassID *entry_class_id_ptr = shared_layout_ptr->GetBlockPtr<EntryClassID, true>(
-        shared_memory_ptr, SharedDataLayout::ENTRY_CLASSID);
-
-    extractor::OriginalEdgeData current_edge_data;
-    for (unsigned i = 0; i < number_of_original_edges; ++i)
-    {
-        edges_input_stream.read((char *)&(current_edge_data), sizeof(extractor::OriginalEdgeData));
-        via_node_ptr[i] = current_edge_data.via_node;
-        name_id_ptr[i] = current_edge_data.name_id;
-        travel_mode_ptr[i] = current_edge_data.travel_mode;
-        lane_data_id_ptr[i] = current_edge_data.lane_data_id;
-        turn_instructions_ptr[i] = current_edge_data.turn_instruction;
-        entry_class_id_ptr[i] = current_edge_data.entry_classid;
-    }
-    edges_input_stream.close();
-
-    // load compressed geometry
-    unsigned temporary_value;
-    unsigned *geometries_index_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-        shared_memory_ptr, SharedDataLayout::GEOMETRIES_INDEX);
-    geometry_input_stream.seekg(0, geometry_input_stream.beg);
-    geometry_input_stream.read((char *)&temporary_value, sizeof(unsigned));
-    BOOST_ASSERT(temporary_value ==
-                 shared_layout_ptr->num_entries[SharedDataLayout::GEOMETRIES_INDEX]);
-
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_INDEX) > 0)
-    {
-        geometry_input_stream.read(
-            (char *)geometries_index_ptr,
-            shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_INDEX));
-    }
-    extractor::CompressedEdgeContainer::CompressedEdge *geometries_list_ptr =
-        shared_layout_ptr->GetBlockPtr<extractor::CompressedEdgeContainer::CompressedEdge, true>(
-            shared_memory_ptr, SharedDataLayout::GEOMETRIES_LIST);
-
-    geometry_input_stream.read((char *)&temporary_value, sizeof(unsigned));
-    BOOST_ASSERT(temporary_value ==
-                 shared_layout_ptr->num_entries[SharedDataLayout::GEOMETRIES_LIST]);
-
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_LIST) > 0)
-    {
-        geometry_input_stream.read(
-            (char *)geometries_list_ptr,
-            shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_LIST));
-    }
-
-    // load datasource information (if it exists)
-    uint8_t *datasources_list_ptr = shared_layout_ptr->GetBlockPtr<uint8_t, true>(
-        shared_memory_ptr, SharedDataLayout::DATASOURCES_LIST);
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::DATASOURCES_LIST) > 0)
-    {
-        geometry_datasource_input_stream.read(
-            reinterpret_cast<char *>(datasources_list_ptr),
-            shared_layout_ptr->GetBlockSize(SharedDataLayout::DATASOURCES_LIST));
-    }
-
-    // load datasource name information (if it exists)
-    char *datasource_name_data_ptr = shared_layout_ptr->GetBlockPtr<char, true>(
-        shared_memory_ptr, SharedDataLayout::DATASOURCE_NAME_DATA);
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::DATASOURCE_NAME_DATA) > 0)
-    {
-        util::SimpleLogger().Write()
-            << "Copying " << (m_datasource_name_data.end() - m_datasource_name_data.begin())
-            << " chars into name data ptr";
-        std::copy(
-            m_datasource_name_data.begin(), m_datasource_name_data.end(), datasource_name_data_ptr);
-    }
-
-    auto datasource_name_offsets_ptr = shared_layout_ptr->GetBlockPtr<std::size_t, true>(
-        shared_memory_ptr, SharedDataLayout::DATASOURCE_NAME_OFFSETS);
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::DATASOURCE_NAME_OFFSETS) > 0)
-    {
-        std::copy(m_datasource_name_offsets.begin(),
-                  m_datasource_name_offsets.end(),
-                  datasource_name_offsets_ptr);
-    }
-
-    auto datasource_name_lengths_ptr = shared_layout_ptr->GetBlockPtr<std::size_t, true>(
-        shared_memory_ptr, SharedDataLayout::DATASOURCE_NAME_LENGTHS);
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::DATASOURCE_NAME_LENGTHS) > 0)
-    {
-        std::copy(m_datasource_name_lengths.begin(),
-                  m_datasource_name_lengths.end(),
-                  datasource_name_lengths_ptr);
-    }
+    // the files are independent of each other, each is read by a task of its own
+    tbb::task_group tasks;
+    tasks.run([&] {
+        const BlockTimer timer(layout,
+                               "names",
+                               {SharedDataLayout::NAME_OFFSETS,
+                                SharedDataLayout::NAME_BLOCKS,
+                                SharedDataLayout::NAME_CHAR_LIST});
+        // Loading street names
+        unsigned *name_offsets_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+            shared_memory_ptr, SharedDataLayout::NAME_OFFSETS);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_OFFSETS) > 0)
+        {
+            name_stream.read((char *)name_offsets_ptr,
+                             shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_OFFSETS));
+        }
 
-    // Loading list of coordinates
-    util::Coordinate *coordinates_ptr = shared_layout_ptr->GetBlockPtr<util::Coordinate, true>(
-        shared_memory_ptr, SharedDataLayout::COORDINATE_LIST);
-    std::uint64_t *osmnodeid_ptr = shared_layout_ptr->GetBlockPtr<std::uint64_t, true>(
-        shared_memory_ptr, SharedDataLayout::OSM_NODE_ID_LIST);
-    util::PackedVector<OSMNodeID, true> osmnodeid_list;
-    osmnodeid_list.reset(
-        osmnodeid_ptr, shared_layout_ptr->num_entries[storage::SharedDataLayout::OSM_NODE_ID_LIST]);
-
-    extractor::QueryNode current_node;
-    for (unsigned i = 0; i < coordinate_list_size; ++i)
-    {
-        nodes_input_stream.read((char *)&current_node, sizeof(extractor::QueryNode));
-        coordinates_ptr[i] = util::Coordinate(current_node.lon, current_node.lat);
-        osmnodeid_list.push_back(current_node.node_id);
-    }
-    nodes_input_stream.close();
+        unsigned *name_blocks_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+            shared_memory_ptr, SharedDataLayout::NAME_BLOCKS);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_BLOCKS) > 0)
+        {
+            name_stream.read((char *)name_blocks_ptr,
+                             shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_BLOCKS));
+        }
 
-    // store timestamp
-    char *timestamp_ptr =
-        shared_layout_ptr->GetBlockPtr<char, true>(shared_memory_ptr, SharedDataLayout::TIMESTAMP);
-    std::copy(m_timestamp.c_str(), m_timestamp.c_str() + m_timestamp.length(), timestamp_ptr);
+        char *name_char_ptr = shared_layout_ptr->GetBlockPtr<char, true>(
+            shared_memory_ptr, SharedDataLayout::NAME_CHAR_LIST);
+        unsigned temp_length = 0;
+        name_stream.read((char *)&temp_length, sizeof(unsigned));
 
-    // store search tree portion of rtree
-    char *rtree_ptr = shared_layout_ptr->GetBlockPtr<char, true>(shared_memory_ptr,
-                                                                 SharedDataLayout::R_SEARCH_TREE);
+        BOOST_ASSERT_MSG(shared_layout_ptr->AlignBlockSize(temp_length) ==
+                             shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_CHAR_LIST),
+                         "Name file corrupted!");
 
-    if (tree_size > 0)
-    {
-        tree_node_file.read(rtree_ptr, sizeof(RTreeNode) * tree_size);
-    }
-    tree_node_file.close();
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_CHAR_LIST) > 0)
+        {
+            name_stream.read(name_char_ptr,
+                             shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_CHAR_LIST));
+        }
+        name_stream.close();
+    });
+
+    tasks.run([&] {
+        const BlockTimer timer(layout,
+                               "turn lanes",
+                               {SharedDataLayout::TURN_LANE_DATA,
+                                SharedDataLayout::LANE_DESCRIPTION_OFFSETS,
+                                SharedDataLayout::LANE_DESCRIPTION_MASKS});
+        // make sure do write canary...
+        auto *turn_lane_data_ptr =
+            shared_layout_ptr->GetBlockPtr<util::guidance::LaneTupelIdPair, true>(
+                shared_memory_ptr, SharedDataLayout::TURN_LANE_DATA);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::TURN_LANE_DATA) > 0)
+        {
+            lane_data_stream.read(
+                reinterpret_cast<char *>(turn_lane_data_ptr),
+                shared_layout_ptr->GetBlockSize(SharedDataLayout::TURN_LANE_DATA));
+        }
+        lane_data_stream.close();
 
-    // load core markers
-    std::vector<char> unpacked_core_markers(number_of_core_markers);
-    core_marker_file.read((char *)unpacked_core_markers.data(),
-                          sizeof(char) * number_of_core_markers);
+        auto *turn_lane_offset_ptr = shared_layout_ptr->GetBlockPtr<std::uint32_t, true>(
+            shared_memory_ptr, SharedDataLayout::LANE_DESCRIPTION_OFFSETS);
+        if (!lane_description_offsets.empty())
+        {
+            BOOST_ASSERT(
+                shared_layout_ptr->GetBlockSize(SharedDataLayout::LANE_DESCRIPTION_OFFSETS) >=
+                sizeof(lane_description_offsets[0]) * lane_description_offsets.size());
+            std::copy(lane_description_offsets.begin(),
+                      lane_description_offsets.end(),
+                      turn_lane_offset_ptr);
+            std::vector<std::uint32_t> tmp;
+            lane_description_offsets.swap(tmp);
+        }
 
-    unsigned *core_marker_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-        shared_memory_ptr, SharedDataLayout::CORE_MARKER);
+        auto *turn_lane_mask_ptr =
+            shared_layout_ptr->GetBlockPtr<extractor::guidance::TurnLaneType::Mask, true>(
+                shared_memory_ptr, SharedDataLayout::LANE_DESCRIPTION_MASKS);
+        if (!lane_description_masks.empty())
+        {
+            BOOST_ASSERT(
+                shared_layout_ptr->GetBlockSize(SharedDataLayout::LANE_DESCRIPTION_MASKS) >=
+                sizeof(lane_description_masks[0]) * lane_description_masks.size());
+            std::copy(
+                lane_description_masks.begin(), lane_description_masks.end(), turn_lane_mask_ptr);
+            std::vector<extractor::guidance::TurnLaneType::Mask> tmp;
+            lane_description_masks.swap(tmp);
+        }
+    });
+
+    tasks.run([&] {
+        const BlockTimer timer(layout,
+                               "original edges",
+                               {SharedDataLayout::VIA_NODE_LIST,
+                                SharedDataLayout::NAME_ID_LIST,
+                                SharedDataLayout::TRAVEL_MODE,
+                                SharedDataLayout::LANE_DATA_ID,
+                                SharedDataLayout::TURN_INSTRUCTION,
+                                SharedDataLayout::ENTRY_CLASSID});
+        // load original edge information
+        NodeID *via_node_ptr = shared_layout_ptr->GetBlockPtr<NodeID, true>(
+            shared_memory_ptr, SharedDataLayout::VIA_NODE_LIST);
+
+        unsigned *name_id_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+            shared_memory_ptr, SharedDataLayout::NAME_ID_LIST);
+
+        extractor::TravelMode *travel_mode_ptr =
+            shared_layout_ptr->GetBlockPtr<extractor::TravelMode, true>(
+                shared_memory_ptr, SharedDataLayout::TRAVEL_MODE);
+
+        LaneDataID *lane_data_id_ptr = shared_layout_ptr->GetBlockPtr<LaneDataID, true>(
+            shared_memory_ptr, SharedDataLayout::LANE_DATA_ID);
+
+        extractor::guidance::TurnInstruction *turn_instructions_ptr =
+            shared_layout_ptr->GetBlockPtr<extractor::guidance::TurnInstruction, true>(
+                shared_memory_ptr, SharedDataLayout::TURN_INSTRUCTION);
+
+        EntryClassID *entry_class_id_ptr = shared_layout_ptr->GetBlockPtr<EntryClassID, true>(
+            shared_memory_ptr, SharedDataLayout::ENTRY_CLASSID);
+
+        std::vector<extractor::OriginalEdgeData> edge_buffer(
+            std::min<std::size_t>(number_of_original_edges, READ_BUFFER_ENTRIES));
+        for (unsigned i = 0; i < number_of_original_edges;)
+        {
+            const auto count =
+                std::min<std::size_t>(number_of_original_edges - i, edge_buffer.size());
+            edges_input_stream.read(reinterpret_cast<char *>(edge_buffer.data()),
+                                    count * sizeof(extractor::OriginalEdgeData));
+            for (std::size_t index = 0; index < count; ++index, ++i)
+            {
+                const auto &current_edge_data = edge_buffer[index];
+                via_node_ptr[i] = current_edge_data.via_node;
+                name_id_ptr[i] = current_edge_data.name_id;
+                travel_mode_ptr[i] = current_edge_data.travel_mode;
+                lane_data_id_ptr[i] = current_edge_data.lane_data_id;
+                turn_instructions_ptr[i] = current_edge_data.turn_instruction;
+                entry_class_id_ptr[i] = current_edge_data.entry_classid;
+            }
+        }
+        edges_input_stream.close();
+    });
+
+    tasks.run([&] {
+        const BlockTimer timer(layout,
+                               "geometries",
+                               {SharedDataLayout::GEOMETRIES_INDEX,
+                                SharedDataLayout::GEOMETRIES_LIST,
+                                SharedDataLayout::DATASOURCES_LIST,
+                                SharedDataLayout::DATASOURCE_NAME_DATA,
+                                SharedDataLayout::DATASOURCE_NAME_OFFSETS,
+                                SharedDataLayout::DATASOURCE_NAME_LENGTHS});
+        // load compressed geometry
+        unsigned temporary_value;
+        unsigned *geometries_index_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+            shared_memory_ptr, SharedDataLayout::GEOMETRIES_INDEX);
+        geometry_input_stream.seekg(0, geometry_input_stream.beg);
+        geometry_input_stream.read((char *)&temporary_value, sizeof(unsigned));
+        BOOST_ASSERT(temporary_value ==
+                     shared_layout_ptr->num_entries[SharedDataLayout::GEOMETRIES_INDEX]);
+
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_INDEX) > 0)
+        {
+            geometry_input_stream.read(
+                (char *)geometries_index_ptr,
+                shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_INDEX));
+        }
+        extractor::CompressedEdgeContainer::CompressedEdge *geometries_list_ptr =
+            shared_layout_ptr
+                ->GetBlockPtr<extractor::CompressedEdgeContainer::CompressedEdge, true>(
+                    shared_memory_ptr, SharedDataLayout::GEOMETRIES_LIST);
 
-    for (auto i = 0u; i < number_of_core_markers; ++i)
-    {
-        BOOST_ASSERT(unpacked_core_markers[i] == 0 || unpacked_core_markers[i] == 1);
+        geometry_input_stream.read((char *)&temporary_value, sizeof(unsigned));
+        BOOST_ASSERT(temporary_value ==
+                     shared_layout_ptr->num_entries[SharedDataLayout::GEOMETRIES_LIST]);
 
-        if (unpacked_core_markers[i] == 1)
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_LIST) > 0)
         {
-            const unsigned bucket = i / 32;
-            const unsigned offset = i % 32;
-            const unsigned value = [&] {
-                unsigned return_value = 0;
-                if (0 != offset)
-                {
-                    return_value = core_marker_ptr[bucket];
-                }
-                return return_value;
-            }();
+            geometry_input_stream.read(
+                (char *)geometries_list_ptr,
+                shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_LIST));
+        }
 
-            core_marker_ptr[bucket] = (value | (1u << offset));
+        // load datasource information (if it exists)
+        uint8_t *datasources_list_ptr = shared_layout_ptr->GetBlockPtr<uint8_t, true>(
+            shared_memory_ptr, SharedDataLayout::DATASOURCES_LIST);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::DATASOURCES_LIST) > 0)
+        {
+            geometry_datasource_input_stream.read(
+                reinterpret_cast<char *>(datasources_list_ptr),
+                shared_layout_ptr->GetBlockSize(SharedDataLayout::DATASOURCES_LIST));
         }
-    }
 
-    // load the nodes of the search graph
-    QueryGraph::NodeArrayEntry *graph_node_list_ptr =
-        shared_layout_ptr->GetBlockPtr<QueryGraph::NodeArrayEntry, true>(
-            shared_memory_ptr, SharedDataLayout::GRAPH_NODE_LIST);
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GRAPH_NODE_LIST) > 0)
-    {
-        hsgr_input_stream.read((char *)graph_node_list_ptr,
-                               shared_layout_ptr->GetBlockSize(SharedDataLayout::GRAPH_NODE_LIST));
-    }
+        // load datasource name information (if it exists)
+        char *datasource_name_data_ptr = shared_layout_ptr->GetBlockPtr<char, true>(
+            shared_memory_ptr, SharedDataLayout::DATASOURCE_NAME_DATA);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::DATASOURCE_NAME_DATA) > 0)
+        {
+            util::SimpleLogger().Write()
+                << "Copying " << (m_datasource_name_data.end() - m_datasource_name_data.begin())
+                << " chars into name data ptr";
+            std::copy(m_datasource_name_data.begin(),
+                      m_datasource_name_data.end(),
+                      datasource_name_data_ptr);
+        }
 
-    // load the edges of the search graph
-    QueryGraph::EdgeArrayEntry *graph_edge_list_ptr =
-        shared_layout_ptr->GetBlockPtr<QueryGraph::EdgeArrayEntry, true>(
-            shared_memory_ptr, SharedDataLayout::GRAPH_EDGE_LIST);
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GRAPH_EDGE_LIST) > 0)
-    {
-        hsgr_input_stream.read((char *)graph_edge_list_ptr,
-                               shared_layout_ptr->GetBlockSize(SharedDataLayout::GRAPH_EDGE_LIST));
-    }
-    hsgr_input_stream.close();
+        auto datasource_name_offsets_ptr = shared_layout_ptr->GetBlockPtr<std::size_t, true>(
+            shared_memory_ptr, SharedDataLayout::DATASOURCE_NAME_OFFSETS);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::DATASOURCE_NAME_OFFSETS) > 0)
+        {
+            std::copy(m_datasource_name_offsets.begin(),
+                      m_datasource_name_offsets.end(),
+                      datasource_name_offsets_ptr);
+        }
 
-    // load profile properties
-    auto profile_properties_ptr =
-        shared_layout_ptr->GetBlockPtr<extractor::ProfileProperties, true>(
-            shared_memory_ptr, SharedDataLayout::PROPERTIES);
-    boost::filesystem::ifstream profile_properties_stream(config.properties_path);
-    if (!profile_properties_stream)
-    {
-        util::exception("Could not open " + config.properties_path.string() + " for reading!");
-    }
-    profile_properties_stream.read(reinterpret_cast<char *>(profile_properties_ptr),
-                                   sizeof(extractor::ProfileProperties));
+        auto datasource_name_lengths_ptr = shared_layout_ptr->GetBlockPtr<std::size_t, true>(
+            shared_memory_ptr, SharedDataLayout::DATASOURCE_NAME_LENGTHS);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::DATASOURCE_NAME_LENGTHS) > 0)
+        {
+            std::copy(m_datasource_name_lengths.begin(),
+                      m_datasource_name_lengths.end(),
+                      datasource_name_lengths_ptr);
+        }
+    });
+
+    tasks.run([&] {
+        const BlockTimer timer(layout,
+                               "coordinates",
+                               {SharedDataLayout::COORDINATE_LIST,
+                                SharedDataLayout::OSM_NODE_ID_LIST});
+        // Loading list of coordinates
+        util::Coordinate *coordinates_ptr = shared_layout_ptr->GetBlockPtr<util::Coordinate, true>(
+            shared_memory_ptr, SharedDataLayout::COORDINATE_LIST);
+        std::uint64_t *osmnodeid_ptr = shared_layout_ptr->GetBlockPtr<std::uint64_t, true>(
+            shared_memory_ptr, SharedDataLayout::OSM_NODE_ID_LIST);
+        util::PackedVector<OSMNodeID, true> osmnodeid_list;
+        osmnodeid_list.reset(
+            osmnodeid_ptr,
+            shared_layout_ptr->num_entries[storage::SharedDataLayout::OSM_NODE_ID_LIST]);
+
+        std::vector<extractor::QueryNode> node_buffer(
+            std::min<std::size_t>(coordinate_list_size, READ_BUFFER_ENTRIES));
+        for (unsigned i = 0; i < coordinate_list_size;)
+        {
+            const auto count = std::min<std::size_t>(coordinate_list_size - i, node_buffer.size());
+            nodes_input_stream.read(reinterpret_cast<char *>(node_buffer.data()),
+                                    count * sizeof(extractor::QueryNode));
+            for (std::size_t index = 0; index < count; ++index, ++i)
+            {
+                const auto &current_node = node_buffer[index];
+                coordinates_ptr[i] = util::Coordinate(current_node.lon, current_node.lat);
+                osmnodeid_list.push_back(current_node.node_id);
+            }
+        }
+        nodes_input_stream.close();
+    });
+
+    tasks.run([&] {
+        const BlockTimer timer(layout,
+                               "search tree",
+                               {SharedDataLayout::TIMESTAMP,
+                                SharedDataLayout::R_SEARCH_TREE});
+        // store timestamp
+        char *timestamp_ptr = shared_layout_ptr->GetBlockPtr<char, true>(
+            shared_memory_ptr, SharedDataLayout::TIMESTAMP);
+        std::copy(m_timestamp.c_str(), m_timestamp.c_str() + m_timestamp.length(), timestamp_ptr);
+
+        // store search tree portion of rtree
+        char *rtree_ptr = shared_layout_ptr->GetBlockPtr<char, true>(
+            shared_memory_ptr, SharedDataLayout::R_SEARCH_TREE);
+
+        if (tree_size > 0)
+        {
+            tree_node_file.read(rtree_ptr, sizeof(RTreeNode) * tree_size);
+        }
+        tree_node_file.close();
+    });
+
+    tasks.run([&] {
+        const BlockTimer timer(layout,
+                               "core",
+                               {SharedDataLayout::CORE_MARKER,
+                                SharedDataLayout::CORE_LANDMARKS,
+                                SharedDataLayout::CORE_LANDMARK_INDEX,
+                                SharedDataLayout::CORE_LANDMARK_DISTANCES});
+        // load core markers
+        std::vector<char> unpacked_core_markers(number_of_core_markers);
+        core_marker_file.read((char *)unpacked_core_markers.data(),
+                              sizeof(char) * number_of_core_markers);
+
+        unsigned *core_marker_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+            shared_memory_ptr, SharedDataLayout::CORE_MARKER);
+
+        for (auto i = 0u; i < number_of_core_markers; ++i)
+        {
+            BOOST_ASSERT(unpacked_core_markers[i] == 0 || unpacked_core_markers[i] == 1);
 
-    // load intersection classes
-    if (!bearing_class_id_table.empty())
-    {
-        auto bearing_id_ptr = shared_layout_ptr->GetBlockPtr<BearingClassID, true>(
-            shared_memory_ptr, SharedDataLayout::BEARING_CLASSID);
-        std::copy(bearing_class_id_table.begin(), bearing_class_id_table.end(), bearing_id_ptr);
-    }
+            if (unpacked_core_markers[i] == 1)
+            {
+                const unsigned bucket = i / 32;
+                const unsigned offset = i % 32;
+                const unsigned value = [&] {
+                    unsigned return_value = 0;
+                    if (0 != offset)
+                    {
+                        return_value = core_marker_ptr[bucket];
+                    }
+                    return return_value;
+                }();
+
+                core_marker_ptr[bucket] = (value | (1u << offset));
+            }
+        }
 
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::BEARING_OFFSETS) > 0)
-    {
-        auto *bearing_offsets_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-            shared_memory_ptr, SharedDataLayout::BEARING_OFFSETS);
-        std::copy(bearing_offsets_data.begin(), bearing_offsets_data.end(), bearing_offsets_ptr);
-    }
+        // load the core landmarks
+        std::copy(core_landmarks.landmarks.begin(),
+                  core_landmarks.landmarks.end(),
+                  shared_layout_ptr->GetBlockPtr<NodeID, true>(shared_memory_ptr,
+                                                               SharedDataLayout::CORE_LANDMARKS));
+        std::copy(core_landmarks.core_index.begin(),
+                  core_landmarks.core_index.end(),
+                  shared_layout_ptr->GetBlockPtr<NodeID, true>(
+                      shared_memory_ptr, SharedDataLayout::CORE_LANDMARK_INDEX));
+        std::copy(core_landmarks.distances.begin(),
+                  core_landmarks.distances.end(),
+                  shared_layout_ptr->GetBlockPtr<util::LandmarkDistance, true>(
+                      shared_memory_ptr, SharedDataLayout::CORE_LANDMARK_DISTANCES));
+    });
+
+    tasks.run([&] {
+        const BlockTimer timer(layout,
+                               "search graph",
+                               {SharedDataLayout::GRAPH_NODE_LIST,
+                                SharedDataLayout::GRAPH_EDGE_LIST,
+                                SharedDataLayout::GRAPH_EDGE_DIRECTION_SPLITS,
+                                SharedDataLayout::SHORTCUT_CHILDREN_OFFSETS,
+                                SharedDataLayout::SHORTCUT_CHILDREN,
+                                SharedDataLayout::GRAPH_NODE_LENGTHS,
+                                SharedDataLayout::GRAPH_EDGE_LENGTHS});
+        // load the nodes of the search graph
+        QueryGraph::NodeArrayEntry *graph_node_list_ptr =
+            shared_layout_ptr->GetBlockPtr<QueryGraph::NodeArrayEntry, true>(
+                shared_memory_ptr, SharedDataLayout::GRAPH_NODE_LIST);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GRAPH_NODE_LIST) > 0)
+        {
+            hsgr_input_stream.read(
+                (char *)graph_node_list_ptr,
+                shared_layout_ptr->GetBlockSize(SharedDataLayout::GRAPH_NODE_LIST));
+        }
 
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::BEARING_BLOCKS) > 0)
-    {
-        auto *bearing_blocks_ptr =
-            shared_layout_ptr->GetBlockPtr<typename util::RangeTable<16, true>::BlockT, true>(
-                shared_memory_ptr, SharedDataLayout::BEARING_BLOCKS);
-        std::copy(bearing_blocks_data.begin(), bearing_blocks_data.end(), bearing_blocks_ptr);
-    }
+        // load the edges of the search graph
+        QueryGraph::EdgeArrayEntry *graph_edge_list_ptr =
+            shared_layout_ptr->GetBlockPtr<QueryGraph::EdgeArrayEntry, true>(
+                shared_memory_ptr, SharedDataLayout::GRAPH_EDGE_LIST);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GRAPH_EDGE_LIST) > 0)
+        {
+            hsgr_input_stream.read(
+                (char *)graph_edge_list_ptr,
+                shared_layout_ptr->GetBlockSize(SharedDataLayout::GRAPH_EDGE_LIST));
+        }
+        hsgr_input_stream.close();
 
-    if (!bearing_class_table.empty())
-    {
-        auto bearing_class_ptr = shared_layout_ptr->GetBlockPtr<DiscreteBearing, true>(
-            shared_memory_ptr, SharedDataLayout::BEARING_VALUES);
-        std::copy(bearing_class_table.begin(), bearing_class_table.end(), bearing_class_ptr);
-    }
+        // split the adjacency of every node by direction and resolve the shortcut children
+        {
+            util::ShM<QueryGraph::NodeArrayEntry, true>::vector node_list(
+                graph_node_list_ptr,
+                shared_layout_ptr->num_entries[SharedDataLayout::GRAPH_NODE_LIST]);
+            util::ShM<QueryGraph::EdgeArrayEntry, true>::vector edge_list(
+                graph_edge_list_ptr,
+                shared_layout_ptr->num_entries[SharedDataLayout::GRAPH_EDGE_LIST]);
+            const QueryGraph graph(node_list, edge_list);
+            util::BuildEdgeDirectionSplits(
+                graph,
+                shared_layout_ptr->GetBlockPtr<util::EdgeDirectionSplit, true>(
+                    shared_memory_ptr, SharedDataLayout::GRAPH_EDGE_DIRECTION_SPLITS));
+            util::BuildShortcutChildren(
+                graph,
+                shared_layout_ptr->GetBlockPtr<EdgeID, true>(
+                    shared_memory_ptr, SharedDataLayout::SHORTCUT_CHILDREN_OFFSETS),
+                shared_layout_ptr->GetBlockPtr<util::ShortcutChildren, true>(
+                    shared_memory_ptr, SharedDataLayout::SHORTCUT_CHILDREN));
+        }
 
-    if (!entry_class_table.empty())
-    {
-        auto entry_class_ptr = shared_layout_ptr->GetBlockPtr<util::guidance::EntryClass, true>(
-            shared_memory_ptr, SharedDataLayout::ENTRY_CLASS);
-        std::copy(entry_class_table.begin(), entry_class_table.end(), entry_class_ptr);
-    }
+        // load the lengths of the search graph nodes and edges (if they exist)
+        EdgeLength *graph_node_lengths_ptr = shared_layout_ptr->GetBlockPtr<EdgeLength, true>(
+            shared_memory_ptr, SharedDataLayout::GRAPH_NODE_LENGTHS);
+        std::copy(node_lengths.begin(), node_lengths.end(), graph_node_lengths_ptr);
+
+        EdgeLength *graph_edge_lengths_ptr = shared_layout_ptr->GetBlockPtr<EdgeLength, true>(
+            shared_memory_ptr, SharedDataLayout::GRAPH_EDGE_LENGTHS);
+        std::copy(edge_lengths.begin(), edge_lengths.end(), graph_edge_lengths_ptr);
+    });
+
+    tasks.run([&] {
+        const BlockTimer timer(layout,
+                               "intersection classes",
+                               {SharedDataLayout::PROPERTIES,
+                                SharedDataLayout::BEARING_CLASSID,
+                                SharedDataLayout::BEARING_OFFSETS,
+                                SharedDataLayout::BEARING_BLOCKS,
+                                SharedDataLayout::BEARING_VALUES,
+                                SharedDataLayout::ENTRY_CLASS});
+        // load profile properties
+        auto profile_properties_ptr =
+            shared_layout_ptr->GetBlockPtr<extractor::ProfileProperties, true>(
+                shared_memory_ptr, SharedDataLayout::PROPERTIES);
+        boost::filesystem::ifstream profile_properties_stream(config.properties_path);
+        if (!profile_properties_stream)
+        {
+            util::exception("Could not open " + config.properties_path.string() + " for reading!");
+        }
+        profile_properties_stream.read(reinterpret_cast<char *>(profile_properties_ptr),
+                                       sizeof(extractor::ProfileProperties));
 
-    // acquire lock
-    SharedMemory *data_type_memory =
-        makeSharedMemory(CURRENT_REGIONS, sizeof(SharedDataTimestamp), true, false);
-    SharedDataTimestamp *data_timestamp_ptr =
-        static_cast<SharedDataTimestamp *>(data_type_memory->Ptr());
+        // load intersection classes
+        if (!bearing_class_id_table.empty())
+        {
+            auto bearing_id_ptr = shared_layout_ptr->GetBlockPtr<BearingClassID, true>(
+                shared_memory_ptr, SharedDataLayout::BEARING_CLASSID);
+            std::copy(bearing_class_id_table.begin(), bearing_class_id_table.end(), bearing_id_ptr);
+        }
 
-    boost::interprocess::scoped_lock<boost::interprocess::named_mutex> query_lock(
-        barrier.query_mutex);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::BEARING_OFFSETS) > 0)
+        {
+            auto *bearing_offsets_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+                shared_memory_ptr, SharedDataLayout::BEARING_OFFSETS);
+            std::copy(
+                bearing_offsets_data.begin(), bearing_offsets_data.end(), bearing_offsets_ptr);
+        }
 
-    // notify all processes that were waiting for this condition
-    if (0 < barrier.number_of_queries)
-    {
-        barrier.no_running_queries_condition.wait(query_lock);
-    }
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::BEARING_BLOCKS) > 0)
+        {
+            auto *bearing_blocks_ptr =
+                shared_layout_ptr->GetBlockPtr<typename util::RangeTable<16, true>::BlockT, true>(
+                    shared_memory_ptr, SharedDataLayout::BEARING_BLOCKS);
+            std::copy(bearing_blocks_data.begin(), bearing_blocks_data.end(), bearing_blocks_ptr);
+        }
 
-    data_timestamp_ptr->layout = layout_region;
-    data_timestamp_ptr->data = data_region;
-    data_timestamp_ptr->timestamp += 1;
-    deleteRegion(previous_data_region);
-    deleteRegion(previous_layout_region);
-    util::SimpleLogger().Write() << "all data loaded";
+        if (!bearing_class_table.empty())
+        {
+            auto bearing_class_ptr = shared_layout_ptr->GetBlockPtr<DiscreteBearing, true>(
+                shared_memory_ptr, SharedDataLayout::BEARING_VALUES);
+            std::copy(bearing_class_table.begin(), bearing_class_table.end(), bearing_class_ptr);
+        }
 
-    return EXIT_SUCCESS;
+        if (!entry_class_table.empty())
+        {
+            auto entry_class_ptr = shared_layout_ptr->GetBlockPtr<util::guidance::EntryClass, true>(
+                shared_memory_ptr, SharedDataLayout::ENTRY_CLASS);
+            std::copy(entry_class_table.begin(), entry_class_table.end(), entry_class_ptr);
+        }
+    });
+    tasks.wait();
 }
 }
 }
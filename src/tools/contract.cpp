@@ -1,5 +1,7 @@
 #include "contractor/contractor.hpp"
 #include "contractor/contractor_config.hpp"
+#include "storage/storage.hpp"
+#include "storage/storage_config.hpp"
 #include "util/simple_logger.hpp"
 #include "util/version.hpp"
 
@@ -39,6 +41,10 @@ return_code parseArguments(int argc, char *argv[], contractor::ContractorConfig
         "core,k",
         boost::program_options::value<double>(&contractor_config.core_factor)->default_value(1.0),
         "Percentage of the graph (in vertices) to contract [0..1]")(
+        "core-landmarks",
+        boost::program_options::value<unsigned>(&contractor_config.number_of_core_landmarks)
+            ->default_value(16),
+        "Number of landmarks for goal directed searches on the core, 0 to disable them")(
         "segment-speed-file",
         boost::program_options::value<std::vector<std::string>>(
             &contractor_config.segment_speed_lookup_paths)
@@ -52,7 +58,21 @@ return_code parseArguments(int argc, char *argv[], contractor::ContractorConfig
         "level-cache,o",
         boost::program_options::value<bool>(&contractor_config.use_cached_priority)
             ->default_value(false),
-        "Use .level file to retain the contaction level for each node from the last run.");
+        "Use .level file to retain the contaction level for each node from the last run.")(
+        "customize",
+        boost::program_options::value<bool>(&contractor_config.use_cached_hierarchy)
+            ->default_value(false),
+        "Keep the hierarchy (.hsgr) of the last run and only recompute its weights from the "
+        "speed and penalty files. The last run has to use --customizable.")(
+        "customizable",
+        boost::program_options::value<bool>(&contractor_config.customizable)
+            ->default_value(false),
+        "Contract without witness searches, so that routes stay optimal when --customize "
+        "applies new speeds later on. The hierarchy gets more shortcuts.")(
+        "dataset",
+        boost::program_options::value<bool>(&contractor_config.write_dataset)
+            ->default_value(true),
+        "Write all data used for routing into a single .dataset file");
 
     // hidden options, will be allowed on command line, but will not be shown to the user
     boost::program_options::options_description hidden_options("Hidden options");
@@ -153,7 +173,23 @@ int main(int argc, char *argv[]) try
 
     tbb::task_scheduler_init init(contractor_config.requested_num_threads);
 
-    return contractor::Contractor(contractor_config).Run();
+    const auto result = contractor::Contractor(contractor_config).Run();
+    if (result != EXIT_SUCCESS)
+    {
+        return result;
+    }
+
+    if (contractor_config.write_dataset)
+    {
+        storage::Storage(storage::StorageConfig(contractor_config.osrm_input_path))
+            .WriteDataset(contractor_config.dataset_output_path);
+    }
+    else
+    {
+        // a dataset of a previous run would be used instead of the new files
+        boost::filesystem::remove(contractor_config.dataset_output_path);
+    }
+    return EXIT_SUCCESS;
 }
 catch (const std::bad_alloc &e)
 {
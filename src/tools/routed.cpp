@@ -59,11 +59,19 @@ inline unsigned generateServerProgramOptions(const int argc,
                                              int &ip_port,
                                              int &requested_num_threads,
                                              bool &use_shared_memory,
+                                             bool &use_mmap,
+                                             bool &verify_dataset,
                                              bool &trial,
                                              int &max_locations_trip,
                                              int &max_locations_viaroute,
                                              int &max_locations_distance_table,
-                                             int &max_locations_map_matching)
+                                             int &max_locations_map_matching,
+                                             int &multi_target_parallel_threshold,
+                                             int &max_multi_target_threads,
+                                             int &table_parallel_threshold,
+                                             int &max_table_threads,
+                                             int &phantom_node_cache_size,
+                                             int &max_full_size_heaps)
 {
     using boost::program_options::value;
     using boost::filesystem::path;
@@ -89,6 +97,12 @@ inline unsigned generateServerProgramOptions(const int argc,
         ("shared-memory,s",
          value<bool>(&use_shared_memory)->implicit_value(true)->default_value(false),
          "Load data from shared memory") //
+        ("mmap",
+         value<bool>(&use_mmap)->implicit_value(true)->default_value(false),
+         "Map the data files into memory instead of reading them") //
+        ("verify-dataset",
+         value<bool>(&verify_dataset)->implicit_value(true)->default_value(false),
+         "Verify the checksums of a mapped dataset file on startup") //
         ("max-viaroute-size",
          value<int>(&max_locations_viaroute)->default_value(500),
          "Max. locations supported in viaroute query") //
@@ -100,7 +114,26 @@ inline unsigned generateServerProgramOptions(const int argc,
          "Max. locations supported in distance table query") //
         ("max-matching-size",
          value<int>(&max_locations_map_matching)->default_value(100),
-         "Max. locations supported in map matching query");
+         "Max. locations supported in map matching query") //
+        ("multi-target-parallel-threshold",
+         value<int>(&multi_target_parallel_threshold)->default_value(-1),
+         "Min. targets for which a multi target query is split across threads, -1 disables") //
+        ("multi-target-threads",
+         value<int>(&max_multi_target_threads)->default_value(4),
+         "Max. threads used by a single multi target query") //
+        ("table-parallel-threshold",
+         value<int>(&table_parallel_threshold)->default_value(-1),
+         "Min. entries for which a distance table query is split across threads, -1 disables") //
+        ("table-threads",
+         value<int>(&max_table_threads)->default_value(4),
+         "Max. threads used by a single distance table query") //
+        ("phantom-node-cache-size",
+         value<int>(&phantom_node_cache_size)->default_value(-1),
+         "Max. snapped coordinates remembered for multi target and smooth via queries, -1 "
+         "disables") //
+        ("max-full-size-heaps",
+         value<int>(&max_full_size_heaps)->default_value(-1),
+         "Max. full-size search heaps kept between requests, -1 for unlimited");
 
     // hidden options, will be allowed on command line, but will not be shown to the user
     boost::program_options::options_description hidden_options("Hidden options");
@@ -177,11 +210,19 @@ int main(int argc, const char *argv[]) try
                                                               ip_port,
                                                               requested_thread_num,
                                                               config.use_shared_memory,
+                                                              config.use_mmap,
+                                                              config.verify_dataset,
                                                               trial_run,
                                                               config.max_locations_trip,
                                                               config.max_locations_viaroute,
                                                               config.max_locations_distance_table,
-                                                              config.max_locations_map_matching);
+                                                              config.max_locations_map_matching,
+                                                              config.multi_target_parallel_threshold,
+                                                              config.max_multi_target_threads,
+                                                              config.table_parallel_threshold,
+                                                              config.max_table_threads,
+                                                              config.phantom_node_cache_size,
+                                                              config.max_full_size_heaps);
     if (init_result == INIT_OK_DO_NOT_START_ENGINE)
     {
         return EXIT_SUCCESS;
@@ -12,7 +12,10 @@ using namespace osrm;
 // generate boost::program_options object for the routing part
 bool generateDataStoreOptions(const int argc,
                               const char *argv[],
-                              boost::filesystem::path &base_path)
+                              boost::filesystem::path &base_path,
+                              unsigned &requested_num_threads,
+                              bool &use_direct_io,
+                              bool &use_huge_pages)
 {
     // declare a group of options that will be allowed only on command line
     boost::program_options::options_description generic_options("Options");
@@ -21,6 +24,20 @@ bool generateDataStoreOptions(const int argc,
     // declare a group of options that will be allowed both on command line
     // as well as in a config file
     boost::program_options::options_description config_options("Configuration");
+    config_options.add_options()(
+        "threads,t",
+        boost::program_options::value<unsigned>(&requested_num_threads)->default_value(0),
+        "Number of threads loading the data, 0 for one per core")(
+        "direct-io",
+        boost::program_options::value<bool>(&use_direct_io)
+            ->implicit_value(true)
+            ->default_value(false),
+        "Read the .dataset file with direct I/O, bypassing the page cache")(
+        "huge-pages",
+        boost::program_options::value<bool>(&use_huge_pages)
+            ->implicit_value(true)
+            ->default_value(false),
+        "Back the data with huge pages, which have to be reserved with vm.nr_hugepages");
 
     // hidden options, will be allowed on command line but will not be shown to the user
     boost::program_options::options_description hidden_options("Hidden options");
@@ -78,11 +95,18 @@ int main(const int argc, const char *argv[]) try
     util::LogPolicy::GetInstance().Unmute();
 
     boost::filesystem::path base_path;
-    if (!generateDataStoreOptions(argc, argv, base_path))
+    unsigned requested_num_threads = 0;
+    bool use_direct_io = false;
+    bool use_huge_pages = false;
+    if (!generateDataStoreOptions(
+            argc, argv, base_path, requested_num_threads, use_direct_io, use_huge_pages))
     {
         return EXIT_SUCCESS;
     }
     storage::StorageConfig config(base_path);
+    config.requested_num_threads = requested_num_threads;
+    config.use_direct_io = use_direct_io;
+    config.use_huge_pages = use_huge_pages;
     if (!config.IsValid())
     {
         util::SimpleLogger().Write(logWARNING) << "Config contains invalid file paths. Exiting!";
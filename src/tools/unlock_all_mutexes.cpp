@@ -8,8 +8,6 @@ int main() try
     osrm::util::LogPolicy::GetInstance().Unmute();
     osrm::util::SimpleLogger().Write() << "Releasing all locks";
     osrm::storage::SharedBarriers barrier;
-    barrier.pending_update_mutex.unlock();
-    barrier.query_mutex.unlock();
     barrier.update_mutex.unlock();
     return 0;
 }
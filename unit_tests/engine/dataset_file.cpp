@@ -0,0 +1,134 @@
+#include "storage/dataset_file.hpp"
+#include "storage/shared_datatype.hpp"
+#include "util/exception.hpp"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(dataset_file)
+
+using namespace osrm;
+using namespace osrm::storage;
+
+const static std::string DATASET_TMP_FILE = "test_dataset_file.tmp";
+
+namespace
+{
+// layout with a few blocks of odd sizes, the values of a block are its id
+std::vector<char> WriteTestDataset(SharedDataLayout &layout)
+{
+    layout.SetBlockSize<std::uint32_t>(SharedDataLayout::NAME_OFFSETS, 3);
+    layout.SetBlockSize<char>(SharedDataLayout::NAME_CHAR_LIST, 5000);
+    layout.SetBlockSize<std::uint64_t>(SharedDataLayout::COORDINATE_LIST, 7);
+    layout.SetBlockSize<unsigned>(SharedDataLayout::CORE_MARKER, 40);
+
+    std::vector<char> data(layout.GetSizeOfLayout(), 0);
+    for (auto i = 0; i < SharedDataLayout::NUM_BLOCKS; ++i)
+    {
+        const auto bid = static_cast<SharedDataLayout::BlockID>(i);
+        char *block = layout.GetBlockPtr<char, true>(data.data(), bid);
+        std::fill(block, block + layout.GetBlockSize(bid), static_cast<char>(i));
+    }
+    DatasetFileWriter writer(DATASET_TMP_FILE);
+    std::copy(data.begin(), data.end(), writer.Allocate(layout));
+    writer.Commit();
+    return data;
+}
+}
+
+BOOST_AUTO_TEST_CASE(blocks_are_page_aligned)
+{
+    SharedDataLayout layout;
+    layout.SetBlockSize<char>(SharedDataLayout::NAME_OFFSETS, 4093);
+    layout.SetBlockSize<char>(SharedDataLayout::NAME_BLOCKS, 4096);
+
+    std::uint64_t previous_end = 0;
+    for (auto i = 0; i < SharedDataLayout::NUM_BLOCKS; ++i)
+    {
+        const auto bid = static_cast<SharedDataLayout::BlockID>(i);
+        const auto offset = layout.GetBlockOffset(bid);
+        BOOST_CHECK_EQUAL(offset % SharedDataLayout::BLOCK_ALIGNMENT, 0);
+        // room for the canaries in front of and behind the blocks
+        BOOST_CHECK_GE(offset, previous_end + 2 * sizeof(CANARY));
+        previous_end = offset + layout.GetBlockSize(bid);
+    }
+    BOOST_CHECK_GE(layout.GetSizeOfLayout(), previous_end + sizeof(CANARY));
+}
+
+BOOST_AUTO_TEST_CASE(blocks_are_read_in_place)
+{
+    SharedDataLayout layout;
+    const auto data = WriteTestDataset(layout);
+
+    for (const bool map : {true, false})
+    {
+        DatasetFile dataset(DATASET_TMP_FILE, map, true);
+        BOOST_CHECK(dataset.GetLayout().num_entries == layout.num_entries);
+        BOOST_CHECK(dataset.GetLayout().entry_size == layout.entry_size);
+        BOOST_REQUIRE_EQUAL(dataset.GetDataSize(), data.size());
+        BOOST_CHECK(std::equal(data.begin(), data.end(), dataset.GetData()));
+
+        auto dataset_layout = dataset.GetLayout();
+        const auto *coordinates = dataset_layout.GetBlockPtr<std::uint64_t>(
+            const_cast<char *>(dataset.GetData()), SharedDataLayout::COORDINATE_LIST);
+        if (map)
+        {
+            BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(coordinates) %
+                                  SharedDataLayout::BLOCK_ALIGNMENT,
+                              0);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(broken_datasets_are_rejected)
+{
+    SharedDataLayout layout;
+    WriteTestDataset(layout);
+    const auto file_size = boost::filesystem::file_size(DATASET_TMP_FILE);
+
+    // flip a byte of the name characters
+    {
+        boost::filesystem::fstream stream(
+            DATASET_TMP_FILE, std::ios::binary | std::ios::in | std::ios::out);
+        stream.seekp(file_size - layout.GetSizeOfLayout() +
+                     layout.GetBlockOffset(SharedDataLayout::NAME_CHAR_LIST) + 100);
+        stream.put(1);
+    }
+    BOOST_CHECK_THROW(DatasetFile(DATASET_TMP_FILE, true, true), util::exception);
+    BOOST_CHECK_THROW(DatasetFile(DATASET_TMP_FILE, false, true), util::exception);
+    // blocks are only checked when asked to
+    BOOST_CHECK_NO_THROW(DatasetFile(DATASET_TMP_FILE, true, false));
+
+    WriteTestDataset(layout);
+    boost::filesystem::resize_file(DATASET_TMP_FILE, file_size - 1);
+    BOOST_CHECK_THROW(DatasetFile(DATASET_TMP_FILE, false, false), util::exception);
+
+    {
+        boost::filesystem::ofstream stream(DATASET_TMP_FILE, std::ios::binary);
+        const std::vector<char> zeros(2 * sizeof(DatasetHeader), 0);
+        stream.write(zeros.data(), zeros.size());
+    }
+    BOOST_CHECK_THROW(DatasetFile(DATASET_TMP_FILE, true, false), util::exception);
+}
+
+BOOST_AUTO_TEST_CASE(uncommitted_datasets_keep_the_previous_one)
+{
+    SharedDataLayout layout;
+    const auto data = WriteTestDataset(layout);
+
+    {
+        DatasetFileWriter writer(DATASET_TMP_FILE);
+        writer.Allocate(layout)[0] = 1;
+    }
+    BOOST_CHECK(!boost::filesystem::exists(DATASET_TMP_FILE + ".tmp"));
+
+    DatasetFile dataset(DATASET_TMP_FILE, false, true);
+    BOOST_REQUIRE_EQUAL(dataset.GetDataSize(), data.size());
+    BOOST_CHECK(std::equal(data.begin(), data.end(), dataset.GetData()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
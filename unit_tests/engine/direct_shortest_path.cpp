@@ -0,0 +1,53 @@
+#include "engine/routing_algorithms/direct_shortest_path.hpp"
+#include "util/typedefs.hpp"
+
+#include "mocks/graph_datafacade.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+
+BOOST_AUTO_TEST_SUITE(direct_shortest_path)
+
+using namespace osrm;
+using namespace osrm::test;
+
+// The searches have to handle edges of all direction groups
+void RequireAllEdgeDirections(const GraphDataFacade &facade)
+{
+    const auto &edges = facade.GetContractedEdges();
+    BOOST_REQUIRE(std::any_of(edges.begin(), edges.end(), [](const contractor::QueryEdge &edge) {
+        return edge.data.forward && edge.data.backward;
+    }));
+    BOOST_REQUIRE(std::any_of(edges.begin(), edges.end(), [](const contractor::QueryEdge &edge) {
+        return !edge.data.forward && edge.data.backward;
+    }));
+}
+
+BOOST_AUTO_TEST_CASE(weights_match_dijkstra)
+{
+    for (const unsigned seed : {3, 17, 29})
+    {
+        const auto graph = MakeRandomGraphWithBidirectionalEdges(seed);
+        GraphDataFacade facade(graph);
+        BOOST_REQUIRE_EQUAL(facade.GetCoreSize(), 0);
+        RequireAllEdgeDirections(facade);
+
+        CheckRandomShortestPaths(facade, graph, seed + 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(weights_match_dijkstra_with_core)
+{
+    for (const unsigned seed : {5, 23})
+    {
+        const auto graph = MakeRandomGraphWithBidirectionalEdges(seed);
+        GraphDataFacade facade(graph, 0.8);
+        BOOST_REQUIRE(facade.GetCoreSize() > 0);
+        RequireAllEdgeDirections(facade);
+
+        CheckRandomShortestPaths(facade, graph, seed + 1);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,156 @@
+#include "contractor/graph_customizer.hpp"
+#include "util/exception.hpp"
+#include "util/typedefs.hpp"
+
+#include "mocks/graph_datafacade.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(graph_customizer)
+
+using namespace osrm;
+using namespace osrm::test;
+
+using contractor::GraphCustomizer;
+
+namespace
+{
+// Same edges with new node weights and turn penalties, both directions of a bidirectional edge
+// get different weights
+EdgeBasedGraph UpdateWeights(EdgeBasedGraph graph, const unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<EdgeWeight> node_weight(1, 1000);
+    std::uniform_int_distribution<EdgeWeight> penalty(0, 300);
+    for (auto &weight : graph.node_weights)
+    {
+        weight = node_weight(generator);
+    }
+    for (auto &edge : graph.edges)
+    {
+        edge.weight = graph.node_weights[edge.source] + penalty(generator);
+    }
+    return graph;
+}
+
+std::vector<contractor::QueryEdge> Customize(const GraphDataFacade &contracted,
+                                             const EdgeBasedGraph &graph)
+{
+    const GraphCustomizer::QueryGraph query_graph(graph.GetNumberOfNodes(),
+                                                  contracted.GetContractedEdges());
+    const GraphCustomizer customizer(query_graph);
+
+    util::DeallocatingVector<extractor::EdgeBasedEdge> input_edges;
+    for (const auto &edge : graph.edges)
+    {
+        input_edges.push_back(edge);
+    }
+    std::vector<EdgeLength> node_lengths;
+    for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+    {
+        node_lengths.push_back(graph.GetNodeLength(node));
+    }
+
+    util::DeallocatingVector<contractor::QueryEdge> edges;
+    customizer.Run(input_edges, node_lengths, edges);
+    return std::vector<contractor::QueryEdge>(edges.begin(), edges.end());
+}
+
+std::vector<bool> GetCoreMarker(const GraphDataFacade &facade, const unsigned number_of_nodes)
+{
+    std::vector<bool> is_core_node;
+    if (facade.GetCoreSize() > 0)
+    {
+        for (const auto node : util::irange(0u, number_of_nodes))
+        {
+            is_core_node.push_back(facade.IsCoreNode(node));
+        }
+    }
+    return is_core_node;
+}
+
+// Customizes the hierarchy contracted on graph with the weights of updated. Routes on the
+// customized graph have the weights of plain Dijkstra searches on updated.
+void CheckCustomizedRandomQueries(const EdgeBasedGraph &graph,
+                                  const EdgeBasedGraph &updated,
+                                  const double core_factor,
+                                  const unsigned seed)
+{
+    const GraphDataFacade contracted(graph, core_factor, true);
+    BOOST_REQUIRE_EQUAL(contracted.GetCoreSize() > 0, core_factor < 1.0);
+
+    GraphDataFacade facade(updated,
+                           Customize(contracted, updated),
+                           GetCoreMarker(contracted, graph.GetNumberOfNodes()));
+    CheckRandomShortestPaths(facade, updated, seed);
+}
+}
+
+BOOST_AUTO_TEST_CASE(customized_weights_match_dijkstra)
+{
+    for (const unsigned seed : {3, 17, 29})
+    {
+        const auto graph = MakeRandomGraphWithBidirectionalEdges(seed);
+        CheckCustomizedRandomQueries(graph, UpdateWeights(graph, seed + 1), 1.0, seed + 2);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(customized_weights_match_dijkstra_with_core)
+{
+    for (const unsigned seed : {5, 23})
+    {
+        const auto graph = MakeRandomGraphWithBidirectionalEdges(seed);
+        CheckCustomizedRandomQueries(graph, UpdateWeights(graph, seed + 1), 0.8, seed + 2);
+    }
+}
+
+// Customizing with the weights the hierarchy was contracted with keeps them
+BOOST_AUTO_TEST_CASE(same_weights_keep_the_hierarchy)
+{
+    const auto graph = MakeRandomGraphWithBidirectionalEdges(7);
+    CheckCustomizedRandomQueries(graph, graph, 1.0, 8);
+}
+
+BOOST_AUTO_TEST_CASE(witness_pruned_hierarchies_are_rejected)
+{
+    const auto graph = MakeRandomGraphWithBidirectionalEdges(11);
+    const GraphDataFacade contracted(graph);
+    const GraphCustomizer::QueryGraph query_graph(graph.GetNumberOfNodes(),
+                                                  contracted.GetContractedEdges());
+    BOOST_CHECK_THROW(GraphCustomizer{query_graph}, util::exception);
+}
+
+BOOST_AUTO_TEST_CASE(new_edges_are_rejected)
+{
+    const auto graph = MakeRandomGraphWithBidirectionalEdges(13);
+    const GraphDataFacade contracted(graph, 1.0, true);
+
+    // an edge between two nodes the hierarchy does not connect
+    const auto &edges = contracted.GetContractedEdges();
+    const auto connected = [&edges](const NodeID source, const NodeID target) {
+        return std::any_of(edges.begin(), edges.end(), [&](const contractor::QueryEdge &edge) {
+            return (edge.source == source && edge.target == target) ||
+                   (edge.source == target && edge.target == source);
+        });
+    };
+    NodeID target = 1;
+    while (connected(0, target))
+    {
+        ++target;
+    }
+    auto updated = graph;
+    updated.edges.emplace_back(0,
+                               target,
+                               static_cast<NodeID>(updated.edges.size()),
+                               updated.node_weights[0],
+                               true,
+                               false);
+
+    BOOST_CHECK_THROW(Customize(contracted, updated), util::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,8 @@
 #include "engine/guidance/assemble_overview.hpp"
 #include "engine/guidance/assemble_route.hpp"
 #include "engine/guidance/assemble_steps.hpp"
+#include "engine/guidance/post_processing.hpp"
+#include "util/arena.hpp"
 
 #include <boost/test/test_case_template.hpp>
 #include <boost/test/unit_test.hpp>
@@ -17,4 +19,65 @@ BOOST_AUTO_TEST_CASE(rfc4648_test_vectors)
     // TODO(daniel-j-h):
 }
 
+// Steps assembled in an arena keep all their containers in it while they are post-processed
+BOOST_AUTO_TEST_CASE(post_processing_keeps_the_arena)
+{
+    using namespace osrm;
+    using namespace osrm::engine::guidance;
+    using namespace osrm::extractor::guidance;
+
+    util::Arena arena;
+    const util::ArenaAllocator<RouteStep> allocator(arena);
+
+    const util::Coordinate location{util::FloatLongitude{7.4}, util::FloatLatitude{43.7}};
+    const auto make_step = [&](const TurnInstruction instruction,
+                               const WaypointType waypoint_type,
+                               const std::size_t geometry_begin,
+                               const std::vector<short> &bearings) {
+        const Intersection intersection{
+            location,
+            util::ArenaVector<short>(bearings.begin(), bearings.end(), allocator),
+            util::ArenaVector<bool>(bearings.size(), true, allocator),
+            0,
+            bearings.size() - 1,
+            util::guidance::LaneTupel(),
+            {}};
+        return RouteStep{0,
+                         "street",
+                         "",
+                         "",
+                         "",
+                         1.,
+                         10.,
+                         TRAVEL_MODE_DRIVING,
+                         StepManeuver{location, 0, 90, instruction, waypoint_type, 0},
+                         geometry_begin,
+                         geometry_begin + 2,
+                         util::ArenaVector<Intersection>({intersection}, allocator)};
+    };
+
+    RouteStepList steps(allocator);
+    steps.push_back(make_step(TurnInstruction::NO_TURN(), WaypointType::Depart, 0, {90}));
+    steps.push_back(make_step({TurnType::Suppressed, DirectionModifier::Straight},
+                              WaypointType::None,
+                              1,
+                              {0, 90, 270}));
+    steps.push_back(make_step(TurnInstruction::NO_TURN(), WaypointType::Arrive, 2, {270}));
+
+    steps = buildIntersections(std::move(steps));
+
+    BOOST_REQUIRE_EQUAL(steps.size(), 2);
+    BOOST_CHECK_EQUAL(steps.front().intersections.size(), 2);
+    BOOST_CHECK(steps.get_allocator().GetArena() == &arena);
+    for (const auto &step : steps)
+    {
+        BOOST_CHECK(step.intersections.get_allocator().GetArena() == &arena);
+        for (const auto &intersection : step.intersections)
+        {
+            BOOST_CHECK(intersection.bearings.get_allocator().GetArena() == &arena);
+            BOOST_CHECK(intersection.entry.get_allocator().GetArena() == &arena);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
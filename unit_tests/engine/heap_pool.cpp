@@ -0,0 +1,373 @@
+#include "engine/heap_pool.hpp"
+#include "util/binary_heap.hpp"
+#include "util/d_ary_heap.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(heap_pool)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+struct TestData
+{
+    NodeID parent;
+};
+
+// one page of 16 slots per 16 nodes, so the footprint follows the inserted nodes
+using TestHeap =
+    util::DAryHeap<NodeID, NodeID, int, TestData, util::GenerationStorage<NodeID, NodeID, 4>>;
+using TestPool = HeapPool<TestHeap>;
+
+constexpr std::size_t NUM_NODES = 10000;
+
+void FillHeap(TestHeap &heap, const NodeID number_of_nodes)
+{
+    for (NodeID node = 0; node < number_of_nodes; ++node)
+    {
+        heap.Insert(node, node, TestData{node});
+    }
+}
+
+BOOST_AUTO_TEST_CASE(reuse_most_recently_returned)
+{
+    TestPool pool;
+
+    auto first = pool.Acquire(NUM_NODES);
+    auto second = pool.Acquire(NUM_NODES);
+    const auto first_address = first.get();
+    const auto second_address = second.get();
+    FillHeap(*second, 10);
+
+    pool.Release(std::move(first));
+    pool.Release(std::move(second));
+
+    auto counters = pool.GetCounters();
+    BOOST_CHECK_EQUAL(counters.created, 2);
+    BOOST_CHECK_EQUAL(counters.checked_out, 0);
+    BOOST_CHECK_EQUAL(counters.high_water_mark, 2);
+    BOOST_CHECK_EQUAL(counters.idle, 2);
+
+    auto heap = pool.Acquire(NUM_NODES);
+    BOOST_CHECK_EQUAL(heap.get(), second_address);
+    // handed out cleared
+    BOOST_CHECK(heap->Empty());
+    BOOST_CHECK(!heap->WasInserted(0));
+
+    auto other = pool.Acquire(NUM_NODES);
+    BOOST_CHECK_EQUAL(other.get(), first_address);
+
+    counters = pool.GetCounters();
+    BOOST_CHECK_EQUAL(counters.created, 2);
+    BOOST_CHECK_EQUAL(counters.reused, 2);
+    BOOST_CHECK_EQUAL(counters.idle, 0);
+    BOOST_CHECK_EQUAL(counters.idle_bytes, 0);
+
+    pool.Release(std::move(heap));
+    pool.Release(std::move(other));
+}
+
+BOOST_AUTO_TEST_CASE(evict_least_recently_used_full_size_heaps)
+{
+    // a search of the whole graph needs a few hundred KiB, the page table alone some KiB
+    TestPool pool(2, 64 * 1024);
+
+    std::vector<std::unique_ptr<TestHeap>> heaps;
+    std::vector<TestHeap *> addresses;
+    for (int i = 0; i < 4; ++i)
+    {
+        heaps.push_back(pool.Acquire(NUM_NODES));
+        addresses.push_back(heaps.back().get());
+    }
+    // the first three searched the whole graph, the last one is sparse
+    for (int i = 0; i < 3; ++i)
+    {
+        FillHeap(*heaps[i], NUM_NODES);
+    }
+    FillHeap(*heaps[3], 2);
+    BOOST_CHECK_LT(heaps[3]->MemoryUsage(), 64 * 1024);
+
+    for (auto &heap : heaps)
+    {
+        pool.Release(std::move(heap));
+    }
+
+    auto counters = pool.GetCounters();
+    BOOST_CHECK_EQUAL(counters.high_water_mark, 4);
+    BOOST_CHECK_EQUAL(counters.idle, 3);
+    BOOST_CHECK_EQUAL(counters.idle_full_size, 2);
+    BOOST_CHECK_EQUAL(counters.evicted, 1);
+
+    // the first full-size heap was returned first and is gone
+    heaps.clear();
+    for (int i = 0; i < 3; ++i)
+    {
+        heaps.push_back(pool.Acquire(NUM_NODES));
+    }
+    BOOST_CHECK_EQUAL(heaps[0].get(), addresses[3]);
+    BOOST_CHECK_EQUAL(heaps[1].get(), addresses[2]);
+    BOOST_CHECK_EQUAL(heaps[2].get(), addresses[1]);
+    // searched the whole graph again, so they are not shrunk
+    FillHeap(*heaps[1], NUM_NODES);
+    FillHeap(*heaps[2], NUM_NODES);
+
+    for (auto &heap : heaps)
+    {
+        pool.Release(std::move(heap));
+    }
+
+    pool.SetMaxFullSizeHeaps(0);
+    counters = pool.GetCounters();
+    BOOST_CHECK_EQUAL(counters.idle, 1);
+    BOOST_CHECK_EQUAL(counters.idle_full_size, 0);
+    BOOST_CHECK_EQUAL(counters.evicted, 3);
+}
+
+BOOST_AUTO_TEST_CASE(drop_heaps_of_other_datasets)
+{
+    TestPool pool;
+
+    auto stale = pool.Acquire(NUM_NODES);
+    pool.Release(pool.Acquire(NUM_NODES));
+
+    // a dataset with a different number of nodes was loaded
+    auto heap = pool.Acquire(2 * NUM_NODES);
+    pool.Release(std::move(stale));
+
+    auto counters = pool.GetCounters();
+    BOOST_CHECK_EQUAL(counters.created, 3);
+    BOOST_CHECK_EQUAL(counters.evicted, 2);
+    BOOST_CHECK_EQUAL(counters.idle, 0);
+
+    pool.Release(std::move(heap));
+    BOOST_CHECK_EQUAL(pool.GetCounters().idle, 1);
+}
+
+// While queries on the old and on the new dataset overlap, each one only gets heaps built for
+// its own node count and the idle heaps of both are kept
+BOOST_AUTO_TEST_CASE(keep_heaps_of_overlapping_datasets)
+{
+    TestPool pool;
+
+    auto old_heap = pool.Acquire(NUM_NODES);
+    auto old_query = pool.Acquire(NUM_NODES);
+    const auto old_address = old_heap.get();
+    auto new_heap = pool.Acquire(2 * NUM_NODES);
+    const auto new_address = new_heap.get();
+    pool.Release(std::move(old_heap));
+    pool.Release(std::move(new_heap));
+    BOOST_CHECK_EQUAL(pool.GetCounters().idle, 2);
+
+    for (int round = 0; round < 2; ++round)
+    {
+        new_heap = pool.Acquire(2 * NUM_NODES);
+        BOOST_CHECK_EQUAL(new_heap.get(), new_address);
+        FillHeap(*new_heap, 2 * NUM_NODES);
+        old_heap = pool.Acquire(NUM_NODES);
+        BOOST_CHECK_EQUAL(old_heap.get(), old_address);
+        FillHeap(*old_heap, NUM_NODES);
+        pool.Release(std::move(old_heap));
+        pool.Release(std::move(new_heap));
+    }
+
+    auto counters = pool.GetCounters();
+    BOOST_CHECK_EQUAL(counters.created, 3);
+    BOOST_CHECK_EQUAL(counters.evicted, 0);
+
+    // the last query on the old dataset frees its heaps
+    pool.Acquire(2 * NUM_NODES).swap(new_heap);
+    pool.Release(std::move(old_query));
+    counters = pool.GetCounters();
+    BOOST_CHECK_EQUAL(counters.evicted, 2);
+    BOOST_CHECK_EQUAL(counters.idle, 0);
+    pool.Release(std::move(new_heap));
+}
+
+BOOST_AUTO_TEST_CASE(cap_counts_checked_out_heaps)
+{
+    TestPool pool(1, 64 * 1024);
+
+    auto first = pool.Acquire(NUM_NODES);
+    FillHeap(*first, NUM_NODES);
+    pool.Release(std::move(first));
+    BOOST_CHECK_EQUAL(pool.GetCounters().full_size, 1);
+
+    // the full-size heap is still in use while another one grows to full size
+    first = pool.Acquire(NUM_NODES, HeapSize::FullSize);
+    FillHeap(*first, NUM_NODES);
+    auto second = pool.Acquire(NUM_NODES);
+    const auto second_address = second.get();
+    FillHeap(*second, NUM_NODES);
+    pool.Release(std::move(second));
+
+    auto counters = pool.GetCounters();
+    BOOST_CHECK_EQUAL(counters.evicted, 1);
+    BOOST_CHECK_EQUAL(counters.idle, 0);
+    BOOST_CHECK_EQUAL(counters.full_size, 1);
+
+    pool.Release(std::move(first));
+    counters = pool.GetCounters();
+    BOOST_CHECK_EQUAL(counters.idle, 1);
+    BOOST_CHECK_EQUAL(counters.idle_full_size, 1);
+    BOOST_CHECK_EQUAL(counters.full_size, 1);
+    first = pool.Acquire(NUM_NODES);
+    BOOST_CHECK_NE(first.get(), second_address);
+    pool.Release(std::move(first));
+}
+
+BOOST_AUTO_TEST_CASE(acquire_prefers_expected_size)
+{
+    TestPool pool(TestPool::UNLIMITED, 64 * 1024);
+
+    auto full_size = pool.Acquire(NUM_NODES);
+    auto sparse = pool.Acquire(NUM_NODES);
+    const auto full_size_address = full_size.get();
+    const auto sparse_address = sparse.get();
+    FillHeap(*full_size, NUM_NODES);
+    FillHeap(*sparse, 2);
+
+    for (const auto first_size : {HeapSize::Sparse, HeapSize::FullSize})
+    {
+        pool.Release(std::move(sparse));
+        pool.Release(std::move(full_size));
+        if (first_size == HeapSize::Sparse)
+        {
+            sparse = pool.Acquire(NUM_NODES, HeapSize::Sparse);
+            full_size = pool.Acquire(NUM_NODES, HeapSize::FullSize);
+        }
+        else
+        {
+            full_size = pool.Acquire(NUM_NODES, HeapSize::FullSize);
+            sparse = pool.Acquire(NUM_NODES, HeapSize::Sparse);
+        }
+        BOOST_CHECK_EQUAL(sparse.get(), sparse_address);
+        BOOST_CHECK_EQUAL(full_size.get(), full_size_address);
+        FillHeap(*full_size, NUM_NODES);
+        FillHeap(*sparse, 2);
+    }
+
+    // without one of the expected size any idle heap is handed out
+    pool.Release(std::move(full_size));
+    full_size = pool.Acquire(NUM_NODES, HeapSize::Sparse);
+    BOOST_CHECK_EQUAL(full_size.get(), full_size_address);
+    pool.Release(std::move(full_size));
+    pool.Release(std::move(sparse));
+}
+
+BOOST_AUTO_TEST_CASE(shrink_full_size_heaps_after_short_searches)
+{
+    TestPool pool(TestPool::UNLIMITED, 64 * 1024);
+
+    auto heap = pool.Acquire(NUM_NODES);
+    FillHeap(*heap, NUM_NODES);
+    const auto full_size_bytes = heap->MemoryUsage();
+    pool.Release(std::move(heap));
+    BOOST_CHECK_EQUAL(pool.GetCounters().idle_full_size, 1);
+    BOOST_CHECK_EQUAL(pool.GetCounters().shrunk, 0);
+
+    heap = pool.Acquire(NUM_NODES);
+    FillHeap(*heap, 20);
+    pool.Release(std::move(heap));
+
+    auto counters = pool.GetCounters();
+    BOOST_CHECK_EQUAL(counters.shrunk, 1);
+    BOOST_CHECK_EQUAL(counters.idle_full_size, 0);
+    BOOST_CHECK_EQUAL(counters.full_size, 0);
+    BOOST_CHECK_LT(counters.idle_bytes, full_size_bytes / 4);
+
+    // the shrunk heap grows again
+    heap = pool.Acquire(NUM_NODES);
+    BOOST_CHECK(!heap->WasInserted(0));
+    FillHeap(*heap, NUM_NODES);
+    for (NodeID node = 0; node < NUM_NODES; ++node)
+    {
+        BOOST_CHECK_EQUAL(heap->GetData(node).parent, node);
+    }
+    pool.Release(std::move(heap));
+}
+
+template <typename Heap> void CheckPoolOfHeap()
+{
+    HeapPool<Heap> pool(HeapPool<Heap>::UNLIMITED, 0);
+
+    auto heap = pool.Acquire(NUM_NODES);
+    heap->Insert(1, 1, TestData{1});
+    pool.Release(std::move(heap));
+
+    heap = pool.Acquire(NUM_NODES);
+    BOOST_CHECK(heap->Empty());
+    BOOST_CHECK(!heap->WasInserted(1));
+    pool.Release(std::move(heap));
+    BOOST_CHECK_EQUAL(pool.GetCounters().created, 1);
+}
+
+// Heaps over the other index storages are shrunk as well when they are returned
+BOOST_AUTO_TEST_CASE(pool_heaps_of_all_storages)
+{
+    CheckPoolOfHeap<util::DAryHeap<NodeID, NodeID, int, TestData>>();
+    CheckPoolOfHeap<util::BinaryHeap<NodeID, NodeID, int, TestData>>();
+    CheckPoolOfHeap<
+        util::BinaryHeap<NodeID, NodeID, int, TestData, util::MapStorage<NodeID, NodeID>>>();
+    CheckPoolOfHeap<util::BinaryHeap<NodeID,
+                                     NodeID,
+                                     int,
+                                     TestData,
+                                     util::UnorderedMapStorage<NodeID, NodeID>>>();
+}
+
+// Threads check heaps out of their own shards and out of other ones, and return heaps that
+// other threads checked out
+BOOST_AUTO_TEST_CASE(concurrent_acquire_and_release)
+{
+    TestPool pool(2, 64 * 1024);
+
+    const int number_of_threads = 8;
+    std::atomic<int> failures{0};
+    std::vector<std::unique_ptr<TestHeap>> handed_over(number_of_threads);
+    std::vector<std::thread> threads;
+    for (int index = 0; index < number_of_threads; ++index)
+    {
+        threads.emplace_back([&, index] {
+            for (int round = 0; round < 200; ++round)
+            {
+                auto heap = pool.Acquire(NUM_NODES, round % 2 == 0 ? HeapSize::Sparse
+                                                                   : HeapSize::FullSize);
+                if (!heap->Empty())
+                {
+                    ++failures;
+                }
+                FillHeap(*heap, round % 7 == 0 ? NUM_NODES : 30);
+                pool.Release(std::move(heap));
+            }
+            handed_over[index] = pool.Acquire(NUM_NODES);
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    BOOST_CHECK_EQUAL(failures, 0);
+
+    auto counters = pool.GetCounters();
+    BOOST_CHECK_EQUAL(counters.checked_out, number_of_threads);
+    BOOST_CHECK_LE(counters.high_water_mark, number_of_threads);
+    for (auto &heap : handed_over)
+    {
+        pool.Release(std::move(heap));
+    }
+
+    counters = pool.GetCounters();
+    BOOST_CHECK_EQUAL(counters.checked_out, 0);
+    BOOST_CHECK_EQUAL(counters.idle, counters.created - counters.evicted);
+    BOOST_CHECK_LE(counters.idle_full_size, 2);
+    BOOST_CHECK_EQUAL(counters.full_size, counters.idle_full_size);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,137 @@
+#include "engine/routing_algorithms/many_to_many.hpp"
+#include "engine/phantom_node.hpp"
+#include "engine/search_engine_data.hpp"
+#include "util/integer_range.hpp"
+#include "util/typedefs.hpp"
+
+#include "mocks/graph_datafacade.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(many_to_many)
+
+using namespace osrm;
+using namespace osrm::engine;
+using namespace osrm::test;
+
+using ManyToManyRouting = routing_algorithms::ManyToManyRouting<GraphDataFacade>;
+
+// Table of plain Dijkstra searches with the bounds of ManyToManyRouting applied: weights above
+// max_weight are invalid, and with number_of_nearest set only that many of the closest targets
+// of every source are kept, ties going to the first target.
+std::vector<EdgeWeight> DijkstraTable(const EdgeBasedGraph &graph,
+                                      const std::vector<PhantomNode> &phantoms,
+                                      const std::vector<std::size_t> &source_indices,
+                                      const std::vector<std::size_t> &target_indices,
+                                      const EdgeWeight max_weight,
+                                      const std::size_t number_of_nearest)
+{
+    std::vector<std::size_t> all_indices(phantoms.size());
+    std::iota(all_indices.begin(), all_indices.end(), 0);
+    const auto &sources = source_indices.empty() ? all_indices : source_indices;
+    const auto &targets = target_indices.empty() ? all_indices : target_indices;
+
+    std::vector<EdgeWeight> table;
+    for (const auto source : sources)
+    {
+        const auto dijkstra = DijkstraSearch(graph, phantoms[source]);
+        std::vector<EdgeWeight> row;
+        for (const auto target : targets)
+        {
+            const auto &phantom = phantoms[target];
+            const auto weight = dijkstra[phantom.forward_segment_id.id].first +
+                                phantom.GetForwardWeightPlusOffset();
+            row.push_back(weight > max_weight ? INVALID_EDGE_WEIGHT : weight);
+        }
+
+        if (number_of_nearest > 0 && number_of_nearest < row.size())
+        {
+            std::vector<std::size_t> order(row.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&row](const auto lhs, const auto rhs) {
+                return row[lhs] < row[rhs];
+            });
+            for (auto iter = order.begin() + number_of_nearest; iter != order.end(); ++iter)
+            {
+                row[*iter] = INVALID_EDGE_WEIGHT;
+            }
+        }
+        table.insert(table.end(), row.begin(), row.end());
+    }
+    return table;
+}
+
+// The searches run sequentially and in parallel have to fill in the table of plain Dijkstra
+// searches
+BOOST_AUTO_TEST_CASE(parallel_matches_sequential)
+{
+    const auto graph = MakeRandomGraph(300, 900, 100, 10, 41);
+    GraphDataFacade facade(graph);
+
+    SearchEngineData::ThreadLocalStorageScope heaps_scope;
+    SearchEngineData engine_working_data;
+    ManyToManyRouting routing(&facade, engine_working_data);
+
+    // Phantom nodes on distinct nodes. A target behind the source on the same node is only
+    // reached through the loop weights of the hierarchy, which Dijkstra does not know about.
+    std::mt19937 generator(43);
+    std::vector<NodeID> nodes(graph.GetNumberOfNodes());
+    std::iota(nodes.begin(), nodes.end(), 0);
+    std::shuffle(nodes.begin(), nodes.end(), generator);
+    std::uniform_real_distribution<double> fraction(0., 1.);
+
+    std::vector<PhantomNode> phantoms;
+    for (unsigned index = 0; index < 40; ++index)
+    {
+        phantoms.push_back(facade.MakePhantom(nodes[index], fraction(generator)));
+    }
+    const std::vector<std::size_t> sources{0, 3, 5, 7, 11, 13, 17, 19, 23, 29};
+    const std::vector<std::size_t> destinations{1, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22};
+
+    const auto check = [&](const std::vector<std::size_t> &source_indices,
+                           const std::vector<std::size_t> &target_indices,
+                           const EdgeWeight max_weight,
+                           const std::size_t number_of_nearest) {
+        const auto expected = DijkstraTable(
+            graph, phantoms, source_indices, target_indices, max_weight, number_of_nearest);
+        BOOST_CHECK(std::any_of(expected.begin(), expected.end(), [](const EdgeWeight weight) {
+            return weight != INVALID_EDGE_WEIGHT;
+        }));
+        BOOST_CHECK(std::any_of(expected.begin(), expected.end(), [](const EdgeWeight weight) {
+            return weight == INVALID_EDGE_WEIGHT;
+        }) == (max_weight != INVALID_EDGE_WEIGHT || number_of_nearest > 0));
+
+        for (const bool parallel : {false, true})
+        {
+            const auto table = routing(phantoms,
+                                       source_indices,
+                                       target_indices,
+                                       max_weight,
+                                       number_of_nearest,
+                                       parallel);
+            BOOST_REQUIRE_EQUAL(table.size(), expected.size());
+            for (const auto index : util::irange<std::size_t>(0, table.size()))
+            {
+                BOOST_CHECK_EQUAL(table[index], expected[index]);
+            }
+        }
+    };
+
+    for (const EdgeWeight max_weight : {INVALID_EDGE_WEIGHT, 300})
+    {
+        for (const std::size_t number_of_nearest : {0, 3})
+        {
+            check({}, {}, max_weight, number_of_nearest);
+            check(sources, destinations, max_weight, number_of_nearest);
+            check(sources, {}, max_weight, number_of_nearest);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
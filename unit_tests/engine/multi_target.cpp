@@ -0,0 +1,403 @@
+#include "engine/routing_algorithms/multi_target.hpp"
+#include "engine/phantom_node.hpp"
+#include "engine/search_engine_data.hpp"
+#include "util/coordinate_calculation.hpp"
+#include "util/typedefs.hpp"
+
+#include "mocks/graph_datafacade.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(multi_target)
+
+using namespace osrm;
+using namespace osrm::engine;
+using namespace osrm::test;
+
+template <bool forward>
+using MultiTargetRouting = routing_algorithms::MultiTargetRouting<GraphDataFacade, forward>;
+
+// Chain of number_of_nodes nodes of about 111 m along the prime meridian
+EdgeBasedGraph MakeChain(const unsigned number_of_nodes)
+{
+    EdgeBasedGraph graph;
+    for (unsigned node = 0; node < number_of_nodes; ++node)
+    {
+        graph.start_coordinates.push_back(
+            {util::FixedLongitude{0}, util::FixedLatitude{static_cast<int>(node * 1000)}});
+        graph.end_coordinates.push_back(
+            {util::FixedLongitude{0}, util::FixedLatitude{static_cast<int>((node + 1) * 1000)}});
+        graph.node_weights.push_back(10);
+        if (node > 0)
+        {
+            graph.edges.emplace_back(node - 1, node, node - 1, 10, true, false);
+        }
+    }
+    return graph;
+}
+
+// Length from the phantom location to the end of its node in the unit of the searches
+std::int32_t GetRemainingLength(const EdgeBasedGraph &graph, const PhantomNode &phantom)
+{
+    return static_cast<std::int32_t>(
+        std::round(util::coordinate_calculation::greatCircleDistance(
+                       phantom.location, graph.end_coordinates[phantom.forward_segment_id.id]) *
+                   20.));
+}
+
+// Expected duration and distance from source to target, source has to be before target if both
+// are on the same node
+std::pair<double, double>
+ExpectedPath(const EdgeBasedGraph &graph, const PhantomNode &source, const PhantomNode &target)
+{
+    const NodeID source_node = source.forward_segment_id.id;
+    const NodeID target_node = target.forward_segment_id.id;
+
+    // the path counts the first and the last node from the phantom locations only
+    const auto source_length = static_cast<std::int32_t>(graph.GetNodeLength(source_node));
+    const auto target_length = static_cast<std::int32_t>(graph.GetNodeLength(target_node));
+    const std::int32_t end_lengths = GetRemainingLength(graph, source) - source_length +
+                                     target_length - GetRemainingLength(graph, target);
+
+    WeightAndLength path{0, 0};
+    if (source_node == target_node)
+    {
+        BOOST_REQUIRE(source.forward_weight <= target.forward_weight);
+        path.first -= source.forward_weight;
+    }
+    else
+    {
+        path = DijkstraSearch(graph, source)[target_node];
+        if (INVALID_EDGE_WEIGHT == path.first)
+        {
+            return std::make_pair(INVALID_EDGE_WEIGHT, 0);
+        }
+    }
+
+    return std::make_pair(static_cast<double>(path.first + target.forward_weight) / 10.,
+                          static_cast<double>(std::max(path.second + end_lengths, 0)) / 20.);
+}
+
+// Random phantom nodes, the first one is the source. Targets on the node of the source are placed
+// behind it.
+std::vector<PhantomNode> MakePhantoms(const GraphDataFacade &facade,
+                                      const unsigned number_of_nodes,
+                                      const unsigned number_of_phantoms,
+                                      std::mt19937 &generator)
+{
+    std::uniform_int_distribution<NodeID> node(0, number_of_nodes - 1);
+    std::uniform_real_distribution<double> fraction(0., 1.);
+
+    std::vector<PhantomNode> phantoms;
+    const NodeID source_node = node(generator);
+    const double source_fraction = fraction(generator);
+    phantoms.push_back(facade.MakePhantom(source_node, source_fraction));
+    for (unsigned index = 1; index < number_of_phantoms; ++index)
+    {
+        const NodeID target_node = node(generator);
+        const double target_fraction = fraction(generator);
+        phantoms.push_back(facade.MakePhantom(
+            target_node,
+            target_node == source_node ? std::max(source_fraction, target_fraction)
+                                       : target_fraction));
+    }
+    return phantoms;
+}
+
+// Checks both search directions against Dijkstra searches
+void CheckRandomQueries(GraphDataFacade &facade,
+                        const EdgeBasedGraph &graph,
+                        const unsigned number_of_queries,
+                        const unsigned seed)
+{
+    SearchEngineData::ThreadLocalStorageScope heaps_scope;
+    SearchEngineData engine_working_data;
+    MultiTargetRouting<true> forward_routing(&facade, engine_working_data);
+    MultiTargetRouting<false> backward_routing(&facade, engine_working_data);
+
+    std::mt19937 generator(seed);
+    for (unsigned query = 0; query < number_of_queries; ++query)
+    {
+        const auto phantoms = MakePhantoms(facade, graph.GetNumberOfNodes(), 20, generator);
+
+        const auto forward_results = forward_routing(phantoms);
+        const auto backward_results = backward_routing(phantoms);
+        BOOST_REQUIRE_EQUAL(forward_results->size(), phantoms.size() - 1);
+        BOOST_REQUIRE_EQUAL(backward_results->size(), phantoms.size() - 1);
+
+        for (std::size_t index = 1; index < phantoms.size(); ++index)
+        {
+            const auto expected_forward = ExpectedPath(graph, phantoms[0], phantoms[index]);
+            BOOST_CHECK_EQUAL((*forward_results)[index - 1].first, expected_forward.first);
+            BOOST_CHECK_EQUAL((*forward_results)[index - 1].second, expected_forward.second);
+
+            // a target on the node of the source is behind it
+            if (phantoms[index].forward_segment_id.id != phantoms[0].forward_segment_id.id)
+            {
+                const auto expected_backward = ExpectedPath(graph, phantoms[index], phantoms[0]);
+                BOOST_CHECK_EQUAL((*backward_results)[index - 1].first, expected_backward.first);
+                BOOST_CHECK_EQUAL((*backward_results)[index - 1].second,
+                                  expected_backward.second);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(lengths_with_phantom_offsets)
+{
+    const auto graph = MakeChain(5);
+    GraphDataFacade facade(graph);
+
+    SearchEngineData::ThreadLocalStorageScope heaps_scope;
+    SearchEngineData engine_working_data;
+    MultiTargetRouting<true> forward_routing(&facade, engine_working_data);
+    MultiTargetRouting<false> backward_routing(&facade, engine_working_data);
+
+    // from node 0 to the middle of node 3 and within node 1
+    const auto source = facade.MakePhantom(0, 0.3);
+    const auto target = facade.MakePhantom(3, 0.5);
+    const auto local_source = facade.MakePhantom(1, 0.2);
+    const auto local_target = facade.MakePhantom(1, 0.7);
+
+    // the chain is straight, so the distances are the ones between the locations
+    const double distance =
+        util::coordinate_calculation::greatCircleDistance(source.location, target.location);
+    const double local_distance = util::coordinate_calculation::greatCircleDistance(
+        local_source.location, local_target.location);
+
+    for (const bool with_lengths : {true, false})
+    {
+        facade.SetHasLengths(with_lengths);
+
+        const auto forward_results = forward_routing({source, target});
+        BOOST_CHECK_EQUAL((*forward_results)[0].first, (3 * 10 - 3 + 5) / 10.);
+        BOOST_CHECK_CLOSE((*forward_results)[0].second, distance, 0.1);
+
+        const auto backward_results = backward_routing({target, source});
+        BOOST_CHECK_EQUAL((*backward_results)[0].first, (*forward_results)[0].first);
+        BOOST_CHECK_CLOSE((*backward_results)[0].second, distance, 0.1);
+
+        const auto local_results = forward_routing({local_source, local_target});
+        BOOST_CHECK_EQUAL((*local_results)[0].first, (7 - 2) / 10.);
+        BOOST_CHECK_CLOSE((*local_results)[0].second, local_distance, 0.1);
+
+        // no distance without calculate_distance
+        const auto duration_results = forward_routing({source, target}, false);
+        BOOST_CHECK_EQUAL((*duration_results)[0].first, (*forward_results)[0].first);
+        BOOST_CHECK_EQUAL((*duration_results)[0].second, 0.);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(lengths_match_dijkstra)
+{
+    // large weights make paths of equal weight unlikely
+    const auto graph = MakeRandomGraph(200, 600, 100000, 10000, 7);
+    GraphDataFacade facade(graph);
+    BOOST_REQUIRE_EQUAL(facade.GetCoreSize(), 0);
+
+    CheckRandomQueries(facade, graph, 10, 11);
+}
+
+BOOST_AUTO_TEST_CASE(lengths_match_dijkstra_with_core)
+{
+    const auto graph = MakeRandomGraph(200, 600, 100000, 10000, 5);
+    GraphDataFacade facade(graph, 0.8);
+    BOOST_REQUIRE(facade.GetCoreSize() > 0);
+
+    CheckRandomQueries(facade, graph, 10, 13);
+}
+
+// The number_of_nearest closest targets keep the results of the unbounded query, ties go to the
+// smaller index, all other targets are null. With and without lengths, without them the paths
+// of the nearest targets are unpacked.
+void CheckNearestTargets(GraphDataFacade &facade,
+                         const EdgeBasedGraph &graph,
+                         const std::size_t number_of_nearest,
+                         const unsigned seed)
+{
+    SearchEngineData::ThreadLocalStorageScope heaps_scope;
+    SearchEngineData engine_working_data;
+    MultiTargetRouting<true> routing(&facade, engine_working_data);
+
+    std::mt19937 generator(seed);
+    for (unsigned query = 0; query < 10; ++query)
+    {
+        const auto phantoms = MakePhantoms(facade, graph.GetNumberOfNodes(), 20, generator);
+        facade.SetHasLengths(query % 2 == 0);
+        const auto all_results = routing(phantoms);
+
+        std::vector<std::size_t> order(all_results->size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(
+            order.begin(), order.end(), [&](const std::size_t lhs, const std::size_t rhs) {
+                return (*all_results)[lhs].first < (*all_results)[rhs].first;
+            });
+        std::vector<bool> is_nearest(all_results->size(), false);
+        for (std::size_t index = 0; index < number_of_nearest; ++index)
+        {
+            is_nearest[order[index]] = (*all_results)[order[index]].first != INVALID_EDGE_WEIGHT;
+        }
+
+        for (const bool calculate_distance : {true, false})
+        {
+            const auto results =
+                routing(phantoms, calculate_distance, INVALID_EDGE_WEIGHT, number_of_nearest);
+            BOOST_REQUIRE_EQUAL(results->size(), all_results->size());
+            for (std::size_t index = 0; index < results->size(); ++index)
+            {
+                if (is_nearest[index])
+                {
+                    BOOST_CHECK_EQUAL((*results)[index].first, (*all_results)[index].first);
+                    BOOST_CHECK_EQUAL((*results)[index].second,
+                                      calculate_distance ? (*all_results)[index].second : 0.);
+                }
+                else
+                {
+                    BOOST_CHECK_EQUAL((*results)[index].first, INVALID_EDGE_WEIGHT);
+                }
+            }
+        }
+    }
+    facade.SetHasLengths(true);
+}
+
+BOOST_AUTO_TEST_CASE(nearest_targets)
+{
+    const auto graph = MakeRandomGraph(200, 600, 100000, 10000, 7);
+    GraphDataFacade facade(graph);
+    BOOST_REQUIRE_EQUAL(facade.GetCoreSize(), 0);
+
+    CheckNearestTargets(facade, graph, 5, 19);
+}
+
+BOOST_AUTO_TEST_CASE(nearest_targets_with_core)
+{
+    const auto graph = MakeRandomGraph(200, 600, 100000, 10000, 5);
+    GraphDataFacade facade(graph, 0.8);
+    BOOST_REQUIRE(facade.GetCoreSize() > 0);
+
+    CheckNearestTargets(facade, graph, 5, 29);
+}
+
+// Threads sweeping parts of the targets from a shared source search space get the results of a
+// single query
+BOOST_AUTO_TEST_CASE(shared_source_search_space)
+{
+    const auto graph = MakeRandomGraph(200, 600, 100, 10, 31);
+    GraphDataFacade facade(graph);
+    BOOST_REQUIRE_EQUAL(facade.GetCoreSize(), 0);
+
+    SearchEngineData::ThreadLocalStorageScope heaps_scope;
+    SearchEngineData engine_working_data;
+    MultiTargetRouting<true> forward_routing(&facade, engine_working_data);
+    MultiTargetRouting<false> backward_routing(&facade, engine_working_data);
+    BOOST_REQUIRE(forward_routing.CanShareSourceSearchSpace());
+
+    const auto check = [&](const auto &routing, const std::vector<PhantomNode> &phantoms,
+                           const EdgeWeight max_weight) {
+        const auto expected = routing(phantoms, true, max_weight);
+
+        SearchEngineData::QueryHeap source_heap(graph.GetNumberOfNodes());
+        routing.SearchSourceSearchSpace(phantoms, true, max_weight, source_heap);
+
+        const std::size_t number_of_chunks = 4;
+        std::vector<std::vector<std::pair<double, double>>> chunk_results(number_of_chunks);
+        std::vector<std::thread> threads;
+        for (std::size_t chunk = 0; chunk < number_of_chunks; ++chunk)
+        {
+            threads.emplace_back([&, chunk] {
+                SearchEngineData::ThreadLocalStorageScope thread_heaps_scope;
+                std::vector<PhantomNode> chunk_phantoms{phantoms.front()};
+                for (std::size_t index = 1 + chunk; index < phantoms.size();
+                     index += number_of_chunks)
+                {
+                    chunk_phantoms.push_back(phantoms[index]);
+                }
+                chunk_results[chunk] = *routing(chunk_phantoms, source_heap, true, max_weight);
+            });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        for (std::size_t index = 1; index < phantoms.size(); ++index)
+        {
+            const auto &result =
+                chunk_results[(index - 1) % number_of_chunks][(index - 1) / number_of_chunks];
+            BOOST_CHECK_EQUAL(result.first, (*expected)[index - 1].first);
+            BOOST_CHECK_EQUAL(result.second, (*expected)[index - 1].second);
+        }
+    };
+
+    std::mt19937 generator(37);
+    for (unsigned query = 0; query < 10; ++query)
+    {
+        const auto phantoms = MakePhantoms(facade, graph.GetNumberOfNodes(), 21, generator);
+        for (const EdgeWeight max_weight : {INVALID_EDGE_WEIGHT, 500})
+        {
+            check(forward_routing, phantoms, max_weight);
+            check(backward_routing, phantoms, max_weight);
+        }
+    }
+}
+
+// Small weights make many paths of equal weight, the target sweep and the searches per target
+// have to break the ties the same way
+BOOST_AUTO_TEST_CASE(sweep_matches_search_per_target)
+{
+    for (const unsigned seed : {3u, 17u, 23u})
+    {
+        const auto graph = MakeRandomGraph(200, 600, 3, 1, seed);
+        GraphDataFacade sweep_facade(graph);
+        BOOST_REQUIRE_EQUAL(sweep_facade.GetCoreSize(), 0);
+
+        // a single core node makes the same hierarchy use the searches per target
+        std::vector<bool> is_core_node(graph.GetNumberOfNodes(), false);
+        is_core_node.front() = true;
+        GraphDataFacade search_facade(graph, sweep_facade.GetContractedEdges(), is_core_node);
+        BOOST_REQUIRE_EQUAL(search_facade.GetCoreSize(), 1);
+
+        SearchEngineData::ThreadLocalStorageScope heaps_scope;
+        SearchEngineData engine_working_data;
+        MultiTargetRouting<true> sweep_forward(&sweep_facade, engine_working_data);
+        MultiTargetRouting<false> sweep_backward(&sweep_facade, engine_working_data);
+        MultiTargetRouting<true> search_forward(&search_facade, engine_working_data);
+        MultiTargetRouting<false> search_backward(&search_facade, engine_working_data);
+
+        std::mt19937 generator(seed);
+        for (unsigned query = 0; query < 10; ++query)
+        {
+            const auto phantoms =
+                MakePhantoms(sweep_facade, graph.GetNumberOfNodes(), 20, generator);
+            const auto weights = DijkstraSearch(graph, phantoms[0]);
+
+            const auto swept = sweep_forward(phantoms);
+            const auto searched = search_forward(phantoms);
+            BOOST_CHECK(*swept == *searched);
+            BOOST_CHECK(*sweep_backward(phantoms) == *search_backward(phantoms));
+
+            for (std::size_t index = 1; index < phantoms.size(); ++index)
+            {
+                const NodeID target_node = phantoms[index].forward_segment_id.id;
+                if (target_node != phantoms[0].forward_segment_id.id)
+                {
+                    const EdgeWeight weight =
+                        weights[target_node].first + phantoms[index].forward_weight;
+                    BOOST_CHECK_EQUAL((*swept)[index - 1].first, weight / 10.);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
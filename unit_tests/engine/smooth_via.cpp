@@ -0,0 +1,111 @@
+#include "engine/plugins/smooth_via.hpp"
+#include "engine/phantom_node.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(smooth_via)
+
+using namespace osrm;
+using namespace osrm::engine;
+using namespace osrm::engine::plugins;
+
+namespace
+{
+std::vector<std::vector<PhantomNode>> MakeWaypoints(const std::vector<std::size_t> &sizes)
+{
+    std::vector<std::vector<PhantomNode>> waypoints;
+    for (const auto size : sizes)
+    {
+        waypoints.emplace_back(size);
+    }
+    return waypoints;
+}
+}
+
+BOOST_AUTO_TEST_CASE(best_chain_minimizes_the_table_weights)
+{
+    const auto waypoints = MakeWaypoints({2, 3, 2});
+    // row-major, sources by targets
+    const std::vector<std::vector<EdgeWeight>> leg_tables = {
+        {10, 50, 30, 20, 5, INVALID_EDGE_WEIGHT},
+        {40, 10, 100, 100, INVALID_EDGE_WEIGHT, 1}};
+
+    const auto chain = FindBestChain(waypoints, leg_tables);
+    // 0 -> 0 -> 1: 10 + 10, the cheapest first leg 1 -> 1 leads to 5 + 100 at least
+    BOOST_CHECK_EQUAL(chain.weight, 20);
+    const std::vector<std::size_t> expected_candidates = {0, 0, 1};
+    BOOST_CHECK_EQUAL_COLLECTIONS(chain.candidates.begin(),
+                                  chain.candidates.end(),
+                                  expected_candidates.begin(),
+                                  expected_candidates.end());
+}
+
+BOOST_AUTO_TEST_CASE(best_chain_without_route)
+{
+    const auto waypoints = MakeWaypoints({1, 2, 1});
+    const std::vector<std::vector<EdgeWeight>> leg_tables = {
+        {10, INVALID_EDGE_WEIGHT}, {INVALID_EDGE_WEIGHT, 20}};
+
+    BOOST_CHECK(FindBestChain(waypoints, leg_tables).candidates.empty());
+
+    // a waypoint without candidates
+    BOOST_CHECK(FindBestChain(MakeWaypoints({1, 0, 1}), {{}, {}}).candidates.empty());
+}
+
+// A leg the direct search can not route is dropped and the next best chain is routed instead
+BOOST_AUTO_TEST_CASE(route_next_chain_after_failed_leg)
+{
+    const auto waypoints = MakeWaypoints({2, 3, 2});
+    const std::vector<std::vector<EdgeWeight>> tables = {
+        {10, 50, 30, 20, 5, INVALID_EDGE_WEIGHT},
+        {40, 10, 100, 100, INVALID_EDGE_WEIGHT, 1}};
+    // the first leg of the best chain 0 -> 0 -> 1 fails
+    const auto route_leg = [](const std::size_t layer,
+                              const std::size_t source,
+                              const std::size_t target) {
+        const bool fails = layer == 1 && source == 0 && target == 0;
+        return LegResult{fails ? static_cast<double>(std::numeric_limits<int>::max()) : 1.,
+                         fails ? static_cast<double>(std::numeric_limits<int>::max()) : 2.,
+                         {}};
+    };
+
+    auto leg_tables = tables;
+    std::vector<LegResult> legs;
+    std::uint64_t failed_legs = 0;
+    auto chain = RouteBestChain(waypoints, leg_tables, 3, route_leg, legs, failed_legs);
+    // 1 -> 0 -> 1: 20 + 10
+    BOOST_CHECK_EQUAL(chain.weight, 30);
+    const std::vector<std::size_t> expected_candidates = {1, 0, 1};
+    BOOST_CHECK_EQUAL_COLLECTIONS(chain.candidates.begin(),
+                                  chain.candidates.end(),
+                                  expected_candidates.begin(),
+                                  expected_candidates.end());
+    BOOST_CHECK_EQUAL(failed_legs, 1);
+    BOOST_REQUIRE_EQUAL(legs.size(), 2);
+    for (const auto &leg : legs)
+    {
+        BOOST_CHECK_EQUAL(leg.distance, 2.);
+    }
+
+    // no other chain is tried
+    leg_tables = tables;
+    failed_legs = 0;
+    chain = RouteBestChain(waypoints, leg_tables, 1, route_leg, legs, failed_legs);
+    BOOST_CHECK(chain.candidates.empty());
+    BOOST_CHECK(legs.empty());
+    BOOST_CHECK_EQUAL(failed_legs, 1);
+}
+
+BOOST_AUTO_TEST_CASE(best_chain_of_empty_input)
+{
+    BOOST_CHECK(FindBestChain({}, {}).candidates.empty());
+    BOOST_CHECK(FindBestChain(MakeWaypoints({3}), {}).candidates.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,212 @@
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "args.hpp"
+#include "coordinates.hpp"
+#include "fixture.hpp"
+
+#include "osrm/multi_target_parameters.hpp"
+
+#include "osrm/coordinate.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/json_container.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/status.hpp"
+
+#include <algorithm>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(multi_target)
+
+BOOST_AUTO_TEST_CASE(test_multi_target_batch_matches_single_queries)
+{
+    const auto args = get_args();
+    BOOST_REQUIRE_EQUAL(args.size(), 1);
+
+    using namespace osrm;
+
+    auto osrm = getOSRM(args[0]);
+
+    const auto locations = get_locations_in_big_component();
+
+    std::vector<MultiTargetParameters> queries(2);
+    queries[0].coordinates = {locations[0], locations[1], locations[2]};
+    queries[1].coordinates = {locations[2], locations[0], locations[1]};
+    queries[1].forward = false;
+
+    std::vector<json::Object> batch_results;
+    const auto rc = osrm.MultiTargetBatch(
+        queries, [&](const std::size_t index, const Status status, json::Object &result) {
+            BOOST_CHECK_EQUAL(index, batch_results.size());
+            BOOST_CHECK(status == Status::Ok);
+            batch_results.push_back(std::move(result));
+        });
+
+    BOOST_CHECK(rc == Status::Ok);
+    BOOST_REQUIRE_EQUAL(batch_results.size(), queries.size());
+
+    for (std::size_t index = 0; index < queries.size(); ++index)
+    {
+        json::Object single_result;
+        BOOST_CHECK(osrm.MultiTarget(queries[index], single_result) == Status::Ok);
+
+        const auto &single_costs = single_result.values.at("costs").get<json::Array>().values;
+        const auto &batch_costs =
+            batch_results[index].values.at("costs").get<json::Array>().values;
+        BOOST_REQUIRE_EQUAL(single_costs.size(), queries[index].coordinates.size() - 1);
+        BOOST_REQUIRE_EQUAL(batch_costs.size(), single_costs.size());
+
+        for (std::size_t target = 0; target < single_costs.size(); ++target)
+        {
+            const auto &single_cost = single_costs[target].get<json::Object>();
+            const auto &batch_cost = batch_costs[target].get<json::Object>();
+            BOOST_CHECK_EQUAL(single_cost.values.at("duration").get<json::Number>().value,
+                              batch_cost.values.at("duration").get<json::Number>().value);
+            BOOST_CHECK_EQUAL(single_cost.values.at("distance").get<json::Number>().value,
+                              batch_cost.values.at("distance").get<json::Number>().value);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_multi_target_batch_reports_invalid_queries)
+{
+    const auto args = get_args();
+    BOOST_REQUIRE_EQUAL(args.size(), 1);
+
+    using namespace osrm;
+
+    auto osrm = getOSRM(args[0]);
+
+    std::vector<MultiTargetParameters> queries(2);
+    queries[0].coordinates = {get_dummy_location()};
+    queries[1].coordinates = {get_dummy_location(), get_dummy_location()};
+
+    std::vector<Status> statuses;
+    const auto rc = osrm.MultiTargetBatch(
+        queries, [&](const std::size_t, const Status status, json::Object &) {
+            statuses.push_back(status);
+        });
+
+    BOOST_CHECK(rc == Status::Error);
+    BOOST_REQUIRE_EQUAL(statuses.size(), queries.size());
+    BOOST_CHECK(statuses[0] == Status::Error);
+    BOOST_CHECK(statuses[1] == Status::Ok);
+}
+
+BOOST_AUTO_TEST_CASE(test_multi_target_max_duration_and_k)
+{
+    const auto args = get_args();
+    BOOST_REQUIRE_EQUAL(args.size(), 1);
+
+    using namespace osrm;
+
+    auto osrm = getOSRM(args[0]);
+
+    const auto locations = get_locations_in_big_component();
+
+    for (const bool forward : {true, false})
+    {
+        MultiTargetParameters params;
+        params.forward = forward;
+        params.coordinates = {locations[0], locations[1], locations[2], locations[0]};
+
+        json::Object unbounded_result;
+        BOOST_REQUIRE(osrm.MultiTarget(params, unbounded_result) == Status::Ok);
+        std::vector<double> durations;
+        for (const auto &cost : unbounded_result.values.at("costs").get<json::Array>().values)
+        {
+            durations.push_back(
+                cost.get<json::Object>().values.at("duration").get<json::Number>().value);
+        }
+        BOOST_REQUIRE_EQUAL(durations.size(), 3);
+        const auto sorted_durations = [&] {
+            auto sorted = durations;
+            std::sort(sorted.begin(), sorted.end());
+            return sorted;
+        }();
+
+        // targets that are excluded by a bound have a null duration and distance
+        const auto check_bounded = [&](const MultiTargetParameters &bounded_params,
+                                       const std::size_t expected_number_of_costs) {
+            json::Object result;
+            BOOST_REQUIRE(osrm.MultiTarget(bounded_params, result) == Status::Ok);
+            const auto &costs = result.values.at("costs").get<json::Array>().values;
+            BOOST_REQUIRE_EQUAL(costs.size(), durations.size());
+
+            std::size_t number_of_costs = 0;
+            for (std::size_t target = 0; target < costs.size(); ++target)
+            {
+                const auto &cost = costs[target].get<json::Object>();
+                const auto &duration = cost.values.at("duration");
+                if (duration.is<json::Null>())
+                {
+                    BOOST_CHECK(cost.values.at("distance").is<json::Null>());
+                    continue;
+                }
+                ++number_of_costs;
+                BOOST_CHECK_EQUAL(duration.get<json::Number>().value, durations[target]);
+                BOOST_CHECK(durations[target] <= sorted_durations[expected_number_of_costs - 1]);
+            }
+            BOOST_CHECK_EQUAL(number_of_costs, expected_number_of_costs);
+        };
+
+        auto nearest_params = params;
+        nearest_params.k = 1;
+        check_bounded(nearest_params, 1);
+
+        auto bounded_params = params;
+        bounded_params.max_duration = sorted_durations[1];
+        check_bounded(bounded_params, 2);
+    }
+}
+
+// Requests split across threads return the same costs as the ones routed in one piece
+BOOST_AUTO_TEST_CASE(test_multi_target_parallel_matches_sequential)
+{
+    const auto args = get_args();
+    BOOST_REQUIRE_EQUAL(args.size(), 1);
+
+    using namespace osrm;
+
+    auto sequential_osrm = getOSRM(args[0]);
+
+    EngineConfig config;
+    config.storage_config = {args[0]};
+    config.use_shared_memory = false;
+    config.multi_target_parallel_threshold = 1;
+    config.max_multi_target_threads = 3;
+    OSRM parallel_osrm{config};
+
+    const auto locations = get_locations_in_big_component();
+
+    for (const bool forward : {true, false})
+    {
+        MultiTargetParameters params;
+        params.forward = forward;
+        params.coordinates = {locations[0], locations[1], locations[2], locations[0],
+                              locations[2], locations[1], locations[1]};
+
+        json::Object sequential_result;
+        json::Object parallel_result;
+        BOOST_REQUIRE(sequential_osrm.MultiTarget(params, sequential_result) == Status::Ok);
+        BOOST_REQUIRE(parallel_osrm.MultiTarget(params, parallel_result) == Status::Ok);
+
+        const auto &sequential_costs =
+            sequential_result.values.at("costs").get<json::Array>().values;
+        const auto &parallel_costs = parallel_result.values.at("costs").get<json::Array>().values;
+        BOOST_REQUIRE_EQUAL(sequential_costs.size(), params.coordinates.size() - 1);
+        BOOST_REQUIRE_EQUAL(parallel_costs.size(), sequential_costs.size());
+
+        for (std::size_t target = 0; target < sequential_costs.size(); ++target)
+        {
+            const auto &sequential_cost = sequential_costs[target].get<json::Object>();
+            const auto &parallel_cost = parallel_costs[target].get<json::Object>();
+            BOOST_CHECK_EQUAL(sequential_cost.values.at("duration").get<json::Number>().value,
+                              parallel_cost.values.at("duration").get<json::Number>().value);
+            BOOST_CHECK_EQUAL(sequential_cost.values.at("distance").get<json::Number>().value,
+                              parallel_cost.values.at("distance").get<json::Number>().value);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,135 @@
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "args.hpp"
+#include "coordinates.hpp"
+
+#include "storage/storage.hpp"
+#include "storage/storage_config.hpp"
+
+#include "osrm/coordinate.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/json_container.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/route_parameters.hpp"
+#include "osrm/smooth_via_parameters.hpp"
+#include "osrm/status.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(shared_dataset)
+
+namespace
+{
+int PublishDataset(const std::string &base_path)
+{
+    return osrm::storage::Storage(osrm::storage::StorageConfig(base_path)).Run();
+}
+
+double GetDuration(osrm::json::Object &result)
+{
+    using namespace osrm;
+    auto &routes = result.values.at("routes").get<json::Array>().values;
+    return routes.at(0).get<json::Object>().values.at("duration").get<json::Number>().value;
+}
+
+double GetRequests(osrm::OSRM &osrm)
+{
+    using namespace osrm;
+    json::Object counters;
+    osrm.SmoothViaCounters(counters);
+    return counters.values.at("requests").get<json::Number>().value;
+}
+
+double GetPhantomNodeCacheCounter(osrm::OSRM &osrm, const std::string &name)
+{
+    using namespace osrm;
+    json::Object counters;
+    osrm.PhantomNodeCacheCounters(counters);
+    return counters.values.at(name).get<json::Number>().value;
+}
+}
+
+// Queries keep running while osrm-datastore publishes the dataset again and the counters of the
+// engine survive the swap
+BOOST_AUTO_TEST_CASE(test_swap_dataset_while_querying)
+{
+    const auto args = get_args();
+    BOOST_REQUIRE_EQUAL(args.size(), 1);
+
+    using namespace osrm;
+
+    BOOST_REQUIRE_EQUAL(PublishDataset(args[0]), EXIT_SUCCESS);
+
+    EngineConfig config;
+    config.use_shared_memory = true;
+    config.phantom_node_cache_size = 100;
+    OSRM osrm{config};
+
+    const auto locations = get_locations_in_big_component();
+
+    RouteParameters params;
+    params.coordinates = {locations[0], locations[1]};
+
+    json::Object reference;
+    BOOST_REQUIRE(osrm.Route(params, reference) == Status::Ok);
+    const auto reference_duration = GetDuration(reference);
+
+    SmoothViaParameters smooth_via_params;
+    smooth_via_params.waypoints = {{locations[0]}, {locations[1]}};
+    json::Object smooth_via_result;
+    BOOST_REQUIRE(osrm.SmoothVia(smooth_via_params, smooth_via_result) == Status::Ok);
+    BOOST_CHECK_EQUAL(GetRequests(osrm), 1);
+    BOOST_CHECK_EQUAL(GetPhantomNodeCacheCounter(osrm, "invalidations"), 0);
+    BOOST_CHECK_EQUAL(GetPhantomNodeCacheCounter(osrm, "size"), 2);
+
+    std::atomic<bool> done{false};
+    std::atomic<unsigned> failures{0};
+    std::atomic<unsigned> number_of_queries{0};
+    std::vector<std::thread> queries;
+    for (int index = 0; index < 4; ++index)
+    {
+        queries.emplace_back([&] {
+            while (!done)
+            {
+                json::Object result;
+                if (osrm.Route(params, result) != Status::Ok ||
+                    GetDuration(result) != reference_duration)
+                {
+                    ++failures;
+                }
+                ++number_of_queries;
+            }
+        });
+    }
+
+    for (int swap = 0; swap < 2; ++swap)
+    {
+        BOOST_CHECK_EQUAL(PublishDataset(args[0]), EXIT_SUCCESS);
+    }
+    // make sure queries run on the last dataset
+    const auto published_at = number_of_queries.load();
+    while (number_of_queries < published_at + 10)
+    {
+        std::this_thread::yield();
+    }
+    done = true;
+    for (auto &query : queries)
+    {
+        query.join();
+    }
+    BOOST_CHECK_EQUAL(failures, 0);
+
+    BOOST_REQUIRE(osrm.SmoothVia(smooth_via_params, smooth_via_result) == Status::Ok);
+    BOOST_CHECK_EQUAL(GetRequests(osrm), 2);
+    // the last dataset started with a cache of its own, the counters go on
+    BOOST_CHECK_GE(GetPhantomNodeCacheCounter(osrm, "invalidations"), 1);
+    BOOST_CHECK_EQUAL(GetPhantomNodeCacheCounter(osrm, "misses"), 4);
+    BOOST_CHECK_EQUAL(GetPhantomNodeCacheCounter(osrm, "size"), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -161,4 +161,57 @@ BOOST_AUTO_TEST_CASE(test_table_three_coordinates_matrix)
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_table_max_duration_and_k)
+{
+    const auto args = get_args();
+    BOOST_REQUIRE_EQUAL(args.size(), 1);
+
+    using namespace osrm;
+
+    auto osrm = getOSRM(args[0]);
+
+    TableParameters params;
+    params.coordinates = get_locations_in_big_component();
+    params.sources.push_back(0);
+
+    json::Object unbounded_result;
+    BOOST_REQUIRE(osrm.Table(params, unbounded_result) == Status::Ok);
+    const auto &unbounded_row = unbounded_result.values.at("durations")
+                                    .get<json::Array>()
+                                    .values.at(0)
+                                    .get<json::Array>()
+                                    .values;
+    BOOST_REQUIRE_EQUAL(unbounded_row.size(), params.coordinates.size());
+
+    // the source itself is the closest destination
+    params.k = 1;
+    json::Object nearest_result;
+    BOOST_REQUIRE(osrm.Table(params, nearest_result) == Status::Ok);
+    const auto &nearest_row =
+        nearest_result.values.at("durations").get<json::Array>().values.at(0).get<json::Array>();
+    BOOST_CHECK_EQUAL(nearest_row.values.at(0).get<json::Number>().value, 0.);
+    BOOST_CHECK(nearest_row.values.at(1).is<json::Null>());
+    BOOST_CHECK(nearest_row.values.at(2).is<json::Null>());
+
+    params.k = boost::none;
+    params.max_duration = unbounded_row.at(1).get<json::Number>().value;
+    json::Object bounded_result;
+    BOOST_REQUIRE(osrm.Table(params, bounded_result) == Status::Ok);
+    const auto &bounded_row =
+        bounded_result.values.at("durations").get<json::Array>().values.at(0).get<json::Array>();
+    for (std::size_t destination = 0; destination < unbounded_row.size(); ++destination)
+    {
+        const auto duration = unbounded_row[destination].get<json::Number>().value;
+        if (duration <= *params.max_duration)
+        {
+            BOOST_CHECK_EQUAL(bounded_row.values.at(destination).get<json::Number>().value,
+                              duration);
+        }
+        else
+        {
+            BOOST_CHECK(bounded_row.values.at(destination).is<json::Null>());
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
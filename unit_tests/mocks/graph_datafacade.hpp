@@ -0,0 +1,419 @@
+#ifndef GRAPH_DATAFACADE_HPP
+#define GRAPH_DATAFACADE_HPP
+
+// Data facade over a small edge-based graph that is contracted in memory, to test the routing
+// algorithms against plain Dijkstra searches. Every edge-based node is a single segment, its
+// geometry is the id of the node and ends at the end coordinate of the node.
+
+#include "contractor/graph_contractor.hpp"
+#include "contractor/query_edge.hpp"
+#include "engine/internal_route_result.hpp"
+#include "engine/phantom_node.hpp"
+#include "engine/routing_algorithms/direct_shortest_path.hpp"
+#include "engine/search_engine_data.hpp"
+#include "extractor/edge_based_edge.hpp"
+#include "util/coordinate_calculation.hpp"
+#include "util/deallocating_vector.hpp"
+#include "util/edge_direction_split.hpp"
+#include "util/shortcut_children.hpp"
+#include "util/static_graph.hpp"
+#include "util/typedefs.hpp"
+
+#include "mocks/mock_datafacade.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace test
+{
+
+// Edge-based graph with the geometry of its nodes
+struct EdgeBasedGraph
+{
+    std::vector<util::Coordinate> start_coordinates;
+    std::vector<util::Coordinate> end_coordinates;
+    // weight of traversing a node, the part of the edge weights that is not a turn penalty
+    std::vector<EdgeWeight> node_weights;
+    std::vector<extractor::EdgeBasedEdge> edges;
+
+    unsigned GetNumberOfNodes() const { return static_cast<unsigned>(node_weights.size()); }
+
+    // Length of a node in decimeters as computed by osrm-contract
+    EdgeLength GetNodeLength(const NodeID node) const
+    {
+        return static_cast<EdgeLength>(std::round(
+            util::coordinate_calculation::greatCircleDistance(start_coordinates[node],
+                                                              end_coordinates[node]) *
+            10.));
+    }
+};
+
+// Random edge-based graph on number_of_nodes nodes around (0, 0). Every edge gets the weight of
+// its source node plus a turn penalty of at most max_penalty. Small weights make many paths of
+// equal weight.
+inline EdgeBasedGraph MakeRandomGraph(const unsigned number_of_nodes,
+                                      const unsigned number_of_edges,
+                                      const EdgeWeight max_node_weight,
+                                      const EdgeWeight max_penalty,
+                                      const unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> coordinate(-10000, 10000);
+    std::uniform_int_distribution<EdgeWeight> node_weight(1, max_node_weight);
+    std::uniform_int_distribution<EdgeWeight> penalty(0, max_penalty);
+    std::uniform_int_distribution<NodeID> node(0, number_of_nodes - 1);
+
+    EdgeBasedGraph graph;
+    for (unsigned index = 0; index < number_of_nodes; ++index)
+    {
+        for (auto *coordinates : {&graph.start_coordinates, &graph.end_coordinates})
+        {
+            const util::FixedLongitude lon{coordinate(generator)};
+            const util::FixedLatitude lat{coordinate(generator)};
+            coordinates->push_back({lon, lat});
+        }
+        graph.node_weights.push_back(node_weight(generator));
+    }
+
+    // a cycle through all nodes keeps the graph strongly connected
+    const auto add_edge = [&](const NodeID source, const NodeID target) {
+        graph.edges.emplace_back(source,
+                                 target,
+                                 static_cast<NodeID>(graph.edges.size()),
+                                 graph.node_weights[source] + penalty(generator),
+                                 true,
+                                 false);
+    };
+    for (NodeID source = 0; source < number_of_nodes; ++source)
+    {
+        add_edge(source, (source + 1) % number_of_nodes);
+    }
+    while (graph.edges.size() < number_of_edges)
+    {
+        const NodeID source = node(generator);
+        const NodeID target = node(generator);
+        if (source != target)
+        {
+            add_edge(source, target);
+        }
+    }
+    return graph;
+}
+
+// Random graph in which every third edge can also be used in reverse at the same weight. The
+// contractor merges such pairs into bidirectional edges, so the search graph holds edges of
+// all three direction groups. An edge still weighs at least as much as its source node.
+inline EdgeBasedGraph MakeRandomGraphWithBidirectionalEdges(const unsigned seed)
+{
+    auto graph = MakeRandomGraph(300, 700, 1000, 100, seed);
+    const auto number_of_edges = graph.edges.size();
+    for (std::size_t index = 0; index < number_of_edges; index += 3)
+    {
+        const NodeID source = graph.edges[index].source;
+        const NodeID target = graph.edges[index].target;
+        const EdgeWeight penalty = graph.edges[index].weight - graph.node_weights[source];
+        const EdgeWeight weight =
+            std::max(graph.node_weights[source], graph.node_weights[target]) + penalty;
+        graph.edges[index].weight = weight;
+        graph.edges.emplace_back(
+            target, source, static_cast<NodeID>(graph.edges.size()), weight, true, false);
+    }
+    return graph;
+}
+
+class GraphDataFacade : public MockDataFacade
+{
+  public:
+    using QueryGraph = util::StaticGraph<EdgeData>;
+
+    // Contracts all but (1 - core_factor) of the nodes like osrm-contract does, without witness
+    // searches if customizable is set.
+    GraphDataFacade(const EdgeBasedGraph &graph_,
+                    const double core_factor = 1.0,
+                    const bool customizable = false)
+        : graph(graph_), with_lengths(true)
+    {
+        for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+        {
+            node_lengths.push_back(graph.GetNodeLength(node));
+        }
+
+        util::DeallocatingVector<extractor::EdgeBasedEdge> input_edges;
+        for (const auto &edge : graph.edges)
+        {
+            input_edges.push_back(edge);
+        }
+
+        util::DeallocatingVector<contractor::QueryEdge> contracted_edges;
+        std::vector<bool> is_core_node;
+        {
+            std::vector<EdgeWeight> node_weights(graph.node_weights);
+            contractor::GraphContractor graph_contractor(graph.GetNumberOfNodes(),
+                                                         input_edges,
+                                                         {},
+                                                         std::move(node_weights),
+                                                         node_lengths);
+            graph_contractor.Run(core_factor, customizable);
+            graph_contractor.GetEdges(contracted_edges);
+            graph_contractor.GetCoreMarker(is_core_node);
+        }
+
+        Build(std::vector<contractor::QueryEdge>(contracted_edges.begin(), contracted_edges.end()),
+              std::move(is_core_node));
+    }
+
+    // Uses an already contracted graph
+    GraphDataFacade(const EdgeBasedGraph &graph_,
+                    std::vector<contractor::QueryEdge> contracted_edges,
+                    std::vector<bool> is_core_node = {})
+        : graph(graph_), with_lengths(true)
+    {
+        for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+        {
+            node_lengths.push_back(graph.GetNodeLength(node));
+        }
+        Build(std::move(contracted_edges), std::move(is_core_node));
+    }
+
+    // Without lengths distances are computed from the geometry
+    void SetHasLengths(const bool with_lengths_) { with_lengths = with_lengths_; }
+
+    const std::vector<contractor::QueryEdge> &GetContractedEdges() const
+    {
+        return contracted_edges;
+    }
+
+    // Phantom node on the forward segment of node, at fraction of its length
+    engine::PhantomNode MakePhantom(const NodeID node, const double fraction) const
+    {
+        const auto location = util::coordinate_calculation::interpolateLinear(
+            fraction, graph.start_coordinates[node], graph.end_coordinates[node]);
+        const auto weight =
+            static_cast<int>(std::round(fraction * graph.node_weights[node]));
+        return engine::PhantomNode{{node, true},
+                                   {SPECIAL_SEGMENTID, false},
+                                   0,
+                                   weight,
+                                   INVALID_EDGE_WEIGHT,
+                                   0,
+                                   0,
+                                   node,
+                                   SPECIAL_EDGEID,
+                                   false,
+                                   0,
+                                   location,
+                                   location,
+                                   0,
+                                   TRAVEL_MODE_DRIVING,
+                                   TRAVEL_MODE_INACCESSIBLE};
+    }
+
+    unsigned GetNumberOfNodes() const override { return query_graph->GetNumberOfNodes(); }
+    unsigned GetNumberOfEdges() const override { return query_graph->GetNumberOfEdges(); }
+    unsigned GetOutDegree(const NodeID n) const override { return query_graph->GetOutDegree(n); }
+    NodeID GetTarget(const EdgeID e) const override { return query_graph->GetTarget(e); }
+    const EdgeData &GetEdgeData(const EdgeID e) const override
+    {
+        return query_graph->GetEdgeData(e);
+    }
+    bool HasLengths() const override { return with_lengths; }
+    EdgeLength GetNodeLength(const NodeID n) const override { return node_lengths[n]; }
+    EdgeLength GetEdgeLength(const EdgeID e) const override { return edge_lengths[e]; }
+    EdgeID BeginEdges(const NodeID n) const override { return query_graph->BeginEdges(n); }
+    EdgeID EndEdges(const NodeID n) const override { return query_graph->EndEdges(n); }
+    util::DirectedEdgeRanges GetDirectedEdgeRanges(const NodeID node) const override
+    {
+        const auto &split = edge_direction_splits[node];
+        return {query_graph->BeginEdges(node),
+                split.first_bidirectional,
+                split.first_backward_only,
+                query_graph->EndEdges(node)};
+    }
+    util::ShortcutChildren GetShortcutChildren(const EdgeID shortcut,
+                                               const bool forward) const override
+    {
+        return shortcut_children[forward ? shortcut_children_offsets[shortcut]
+                                         : shortcut_children_offsets[shortcut + 1] - 1];
+    }
+    engine::datafacade::EdgeRange GetAdjacentEdgeRange(const NodeID node) const override
+    {
+        return query_graph->GetAdjacentEdgeRange(node);
+    }
+    util::Coordinate GetCoordinateOfNode(const unsigned id) const override
+    {
+        return graph.end_coordinates[id];
+    }
+    unsigned GetGeometryIndexForEdgeID(const unsigned id) const override
+    {
+        // the original edges of the contracted graph have the ids of the edge-based edges,
+        // unpacking an edge yields the geometry of its source node
+        return graph.edges[id].source;
+    }
+    void GetUncompressedGeometry(const EdgeID id, std::vector<NodeID> &result_nodes) const override
+    {
+        result_nodes.assign(1, id);
+    }
+    void GetUncompressedWeights(const EdgeID id,
+                                std::vector<EdgeWeight> &result_weights) const override
+    {
+        result_weights.assign(1, graph.node_weights[id]);
+    }
+    extractor::TravelMode GetTravelModeForEdgeID(const unsigned /* id */) const override
+    {
+        return TRAVEL_MODE_DRIVING;
+    }
+    bool IsCoreNode(const NodeID id) const override
+    {
+        return !is_core_node.empty() && is_core_node[id];
+    }
+    std::size_t GetCoreSize() const override
+    {
+        return std::count(is_core_node.begin(), is_core_node.end(), true);
+    }
+
+  private:
+    void Build(std::vector<contractor::QueryEdge> edges, std::vector<bool> is_core_node_)
+    {
+        std::sort(edges.begin(), edges.end());
+        contracted_edges = edges;
+        is_core_node = std::move(is_core_node_);
+
+        query_graph.reset(new QueryGraph(graph.GetNumberOfNodes(), edges));
+        std::transform(edges.begin(),
+                       edges.end(),
+                       std::back_inserter(edge_lengths),
+                       [](const contractor::QueryEdge &edge) { return edge.length; });
+        util::BuildEdgeDirectionSplits(*query_graph, std::back_inserter(edge_direction_splits));
+        util::BuildShortcutChildren(*query_graph,
+                                    std::back_inserter(shortcut_children_offsets),
+                                    std::back_inserter(shortcut_children));
+    }
+
+    EdgeBasedGraph graph;
+    bool with_lengths;
+    std::vector<EdgeLength> node_lengths;
+    std::vector<EdgeLength> edge_lengths;
+    std::vector<contractor::QueryEdge> contracted_edges;
+    std::vector<bool> is_core_node;
+    std::unique_ptr<QueryGraph> query_graph;
+    std::vector<util::EdgeDirectionSplit> edge_direction_splits;
+    std::vector<EdgeID> shortcut_children_offsets;
+    std::vector<util::ShortcutChildren> shortcut_children;
+};
+
+// Weight and length of the best path, compared by weight first
+using WeightAndLength = std::pair<EdgeWeight, std::int32_t>;
+
+// Plain Dijkstra search on the edge-based graph from the phantom node source to every node. The
+// result is the weight of the best path up to the source location plus its length in the unit
+// of engine::HeapData::length, i.e. the path counts its first and last node once and all others
+// twice. Ties in the weight go to the shorter length. Backward searches from a target to all
+// sources if forward is false.
+inline std::vector<WeightAndLength> DijkstraSearch(const EdgeBasedGraph &graph,
+                                                   const engine::PhantomNode &source,
+                                                   const bool forward = true)
+{
+    const auto number_of_nodes = graph.GetNumberOfNodes();
+    std::vector<std::vector<std::pair<NodeID, EdgeWeight>>> adjacency(number_of_nodes);
+    for (const auto &edge : graph.edges)
+    {
+        if (forward)
+        {
+            adjacency[edge.source].emplace_back(edge.target, edge.weight);
+        }
+        else
+        {
+            adjacency[edge.target].emplace_back(edge.source, edge.weight);
+        }
+    }
+
+    const WeightAndLength unreached{INVALID_EDGE_WEIGHT, 0};
+    std::vector<WeightAndLength> results(number_of_nodes, unreached);
+    using Entry = std::tuple<EdgeWeight, std::int32_t, NodeID>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+    const NodeID root = source.forward_segment_id.id;
+    const auto weight = source.GetForwardWeightPlusOffset();
+    results[root] = {forward ? -weight : weight, 0};
+    queue.emplace(results[root].first, 0, root);
+
+    while (!queue.empty())
+    {
+        const auto entry = queue.top();
+        queue.pop();
+        const NodeID node = std::get<2>(entry);
+        if (results[node] != WeightAndLength{std::get<0>(entry), std::get<1>(entry)})
+        {
+            continue;
+        }
+        for (const auto &edge : adjacency[node])
+        {
+            const WeightAndLength candidate{
+                results[node].first + edge.second,
+                results[node].second +
+                    static_cast<std::int32_t>(graph.GetNodeLength(node) +
+                                              graph.GetNodeLength(edge.first))};
+            if (results[edge.first] == unreached || candidate < results[edge.first])
+            {
+                results[edge.first] = candidate;
+                queue.emplace(candidate.first, candidate.second, edge.first);
+            }
+        }
+    }
+    return results;
+}
+
+// Routes random pairs of phantom nodes with DirectShortestPathRouting on the facade and checks
+// their weights against plain Dijkstra searches on the graph
+inline void
+CheckRandomShortestPaths(GraphDataFacade &facade, const EdgeBasedGraph &graph, const unsigned seed)
+{
+    engine::SearchEngineData::ThreadLocalStorageScope heaps_scope;
+    engine::SearchEngineData engine_working_data;
+    engine::routing_algorithms::DirectShortestPathRouting<GraphDataFacade> routing(
+        &facade, engine_working_data);
+
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<NodeID> node(0, graph.GetNumberOfNodes() - 1);
+    std::uniform_real_distribution<double> fraction(0., 1.);
+
+    for (unsigned query = 0; query < 20; ++query)
+    {
+        const auto source = facade.MakePhantom(node(generator), fraction(generator));
+        const auto dijkstra = DijkstraSearch(graph, source);
+        for (unsigned target_index = 0; target_index < 10; ++target_index)
+        {
+            const auto target = facade.MakePhantom(node(generator), fraction(generator));
+            if (source.forward_segment_id.id == target.forward_segment_id.id)
+            {
+                continue;
+            }
+
+            engine::InternalRouteResult result;
+            routing({engine::PhantomNodes{source, target}}, result);
+
+            const auto expected = dijkstra[target.forward_segment_id.id].first;
+            BOOST_REQUIRE(expected != INVALID_EDGE_WEIGHT);
+            BOOST_CHECK_EQUAL(result.shortest_path_length,
+                              expected + target.GetForwardWeightPlusOffset());
+        }
+    }
+}
+}
+}
+
+#endif // GRAPH_DATAFACADE_HPP
@@ -16,7 +16,7 @@ namespace osrm
 namespace test
 {
 
-class MockDataFacade final : public engine::datafacade::BaseDataFacade
+class MockDataFacade : public engine::datafacade::BaseDataFacade
 {
   private:
     EdgeData foo;
@@ -27,8 +27,20 @@ class MockDataFacade final : public engine::datafacade::BaseDataFacade
     unsigned GetOutDegree(const NodeID /* n */) const override { return 0; }
     NodeID GetTarget(const EdgeID /* e */) const override { return SPECIAL_NODEID; }
     const EdgeData &GetEdgeData(const EdgeID /* e */) const override { return foo; }
+    bool HasLengths() const override { return false; }
+    EdgeLength GetNodeLength(const NodeID /* n */) const override { return 0; }
+    EdgeLength GetEdgeLength(const EdgeID /* e */) const override { return 0; }
     EdgeID BeginEdges(const NodeID /* n */) const override { return SPECIAL_EDGEID; }
     EdgeID EndEdges(const NodeID /* n */) const override { return SPECIAL_EDGEID; }
+    osrm::util::DirectedEdgeRanges GetDirectedEdgeRanges(const NodeID /* node */) const override
+    {
+        return {SPECIAL_EDGEID, SPECIAL_EDGEID, SPECIAL_EDGEID, SPECIAL_EDGEID};
+    }
+    osrm::util::ShortcutChildren GetShortcutChildren(const EdgeID /* shortcut */,
+                                                     const bool /* forward */) const override
+    {
+        return {SPECIAL_EDGEID, SPECIAL_EDGEID};
+    }
     osrm::engine::datafacade::EdgeRange GetAdjacentEdgeRange(const NodeID /* node */) const override
     {
         return util::irange(static_cast<EdgeID>(0), static_cast<EdgeID>(0));
@@ -176,6 +188,12 @@ class MockDataFacade final : public engine::datafacade::BaseDataFacade
     std::string GetPronunciationForID(const unsigned /* name_id */) const override { return ""; }
     std::string GetDestinationsForID(const unsigned /* name_id */) const override { return ""; }
     std::size_t GetCoreSize() const override { return 0; }
+    unsigned GetNumberOfLandmarks() const override { return 0; }
+    const osrm::util::LandmarkDistance *
+    GetLandmarkDistances(const NodeID /* id */) const override
+    {
+        return nullptr;
+    }
     std::string GetTimestamp() const override { return ""; }
     bool GetContinueStraightDefault() const override { return true; }
     BearingClassID GetBearingClassID(const NodeID /*id*/) const override { return 0; };
@@ -4,8 +4,10 @@
 
 #include "engine/api/base_parameters.hpp"
 #include "engine/api/match_parameters.hpp"
+#include "engine/api/multi_target_parameters.hpp"
 #include "engine/api/nearest_parameters.hpp"
 #include "engine/api/route_parameters.hpp"
+#include "engine/api/smooth_via_parameters.hpp"
 #include "engine/api/table_parameters.hpp"
 #include "engine/api/tile_parameters.hpp"
 #include "engine/api/trip_parameters.hpp"
@@ -325,6 +327,23 @@ BOOST_AUTO_TEST_CASE(valid_table_urls)
     CHECK_EQUAL_RANGE(reference_1.bearings, result_3->bearings);
     CHECK_EQUAL_RANGE(reference_1.radiuses, result_3->radiuses);
     CHECK_EQUAL_RANGE(reference_1.coordinates, result_3->coordinates);
+
+    auto result_4 = parseParameters<TableParameters>("1,2;3,4?sources=0&max_duration=90.5&k=1");
+    BOOST_CHECK(result_4);
+    BOOST_CHECK(result_4->max_duration);
+    BOOST_CHECK_EQUAL(*result_4->max_duration, 90.5);
+    BOOST_CHECK(result_4->k);
+    BOOST_CHECK_EQUAL(*result_4->k, 1UL);
+    BOOST_CHECK(!result_1->max_duration);
+    BOOST_CHECK(!result_1->k);
+
+    // parsed, but out of bounds
+    for (const auto bounds : {"max_duration=-1", "max_duration=nan", "max_duration=inf", "k=0"})
+    {
+        const auto result = parseParameters<TableParameters>(std::string("1,2;3,4?") + bounds);
+        BOOST_REQUIRE(result);
+        BOOST_CHECK(!result->IsValid());
+    }
 }
 
 BOOST_AUTO_TEST_CASE(valid_match_urls)
@@ -400,4 +419,79 @@ BOOST_AUTO_TEST_CASE(valid_trip_urls)
     CHECK_EQUAL_RANGE(reference_1.coordinates, result_1->coordinates);
 }
 
+BOOST_AUTO_TEST_CASE(valid_multi_target_urls)
+{
+    std::vector<util::Coordinate> coords_1 = {{util::FloatLongitude{1}, util::FloatLatitude{2}},
+                                              {util::FloatLongitude{3}, util::FloatLatitude{4}}};
+
+    MultiTargetParameters reference_1{};
+    reference_1.coordinates = coords_1;
+    auto result_1 = parseParameters<MultiTargetParameters>("1,2;3,4");
+    BOOST_CHECK(result_1);
+    BOOST_CHECK_EQUAL(reference_1.forward, result_1->forward);
+    BOOST_CHECK_EQUAL(reference_1.calculate_distance, result_1->calculate_distance);
+    CHECK_EQUAL_RANGE(reference_1.coordinates, result_1->coordinates);
+
+    auto result_2 =
+        parseParameters<MultiTargetParameters>("1,2;3,4?direction=backward&distance=false");
+    BOOST_CHECK(result_2);
+    BOOST_CHECK_EQUAL(result_2->forward, false);
+    BOOST_CHECK_EQUAL(result_2->calculate_distance, false);
+    CHECK_EQUAL_RANGE(reference_1.coordinates, result_2->coordinates);
+
+    // polyline6 keeps the full coordinate precision
+    std::vector<util::Coordinate> coords_3 = {
+        {util::FloatLongitude{13.388860}, util::FloatLatitude{52.517037}},
+        {util::FloatLongitude{13.397634}, util::FloatLatitude{52.529407}}};
+    auto result_3 = parseParameters<MultiTargetParameters>("polyline6(yikdcBwbepXcdWkcP)");
+    BOOST_CHECK(result_3);
+    CHECK_EQUAL_RANGE(coords_3, result_3->coordinates);
+
+    auto result_4 = parseParameters<MultiTargetParameters>("1,2;3,4?max_duration=600&k=10");
+    BOOST_CHECK(result_4);
+    BOOST_CHECK(result_4->max_duration);
+    BOOST_CHECK_EQUAL(*result_4->max_duration, 600.);
+    BOOST_CHECK(result_4->k);
+    BOOST_CHECK_EQUAL(*result_4->k, 10UL);
+    BOOST_CHECK(!result_1->max_duration);
+    BOOST_CHECK(!result_1->k);
+
+    // parsed, but out of bounds
+    for (const auto bounds : {"max_duration=-1", "max_duration=nan", "max_duration=inf", "k=0"})
+    {
+        const auto result =
+            parseParameters<MultiTargetParameters>(std::string("1,2;3,4?") + bounds);
+        BOOST_REQUIRE(result);
+        BOOST_CHECK(!result->IsValid());
+    }
+
+    BOOST_CHECK_EQUAL(testInvalidOptions<MultiTargetParameters>("1,2;3,4?direction=up"), 18UL);
+}
+
+BOOST_AUTO_TEST_CASE(valid_smooth_via_urls)
+{
+    std::vector<std::vector<util::Coordinate>> waypoints_1 = {
+        {{util::FloatLongitude{1}, util::FloatLatitude{2}},
+         {util::FloatLongitude{1.5}, util::FloatLatitude{2}}},
+        {{util::FloatLongitude{3}, util::FloatLatitude{4}}},
+        {{util::FloatLongitude{5}, util::FloatLatitude{6}}}};
+
+    auto result_1 = parseParameters<SmoothViaParameters>("1,2|1.5,2;3,4;5,6");
+    BOOST_CHECK(result_1);
+    BOOST_CHECK_EQUAL(result_1->debug, false);
+    BOOST_REQUIRE_EQUAL(result_1->waypoints.size(), waypoints_1.size());
+    for (std::size_t i = 0; i < waypoints_1.size(); ++i)
+    {
+        CHECK_EQUAL_RANGE(waypoints_1[i], result_1->waypoints[i]);
+    }
+
+    auto result_2 = parseParameters<SmoothViaParameters>("polyline(_af@_pR_af@?);3,4;5,6?debug=true");
+    BOOST_CHECK(result_2);
+    BOOST_CHECK_EQUAL(result_2->debug, true);
+    BOOST_REQUIRE_EQUAL(result_2->waypoints.size(), 3);
+    BOOST_CHECK_EQUAL(result_2->waypoints[0].size(), 2);
+
+    BOOST_CHECK_EQUAL(testInvalidOptions<SmoothViaParameters>("1,2;3,4?radiuses=1;2"), 8UL);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
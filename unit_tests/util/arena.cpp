@@ -0,0 +1,100 @@
+#include "util/arena.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(arena)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(allocations_are_aligned_and_disjoint)
+{
+    Arena arena(64);
+
+    auto *byte = static_cast<char *>(arena.Allocate(1, 1));
+    auto *number = static_cast<std::uint64_t *>(arena.Allocate(8, alignof(std::uint64_t)));
+    // larger than a block
+    auto *large = static_cast<char *>(arena.Allocate(200, 1));
+
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(number) % alignof(std::uint64_t), 0);
+    BOOST_CHECK(byte + 1 <= reinterpret_cast<char *>(number));
+
+    *byte = 1;
+    *number = 2;
+    for (int index = 0; index < 200; ++index)
+    {
+        large[index] = 3;
+    }
+    BOOST_CHECK_EQUAL(*byte, 1);
+    BOOST_CHECK_EQUAL(*number, 2);
+
+    const auto &statistics = arena.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.allocations, 3);
+    BOOST_CHECK_EQUAL(statistics.bytes, 209);
+    BOOST_CHECK_EQUAL(statistics.block_allocations, 2);
+}
+
+BOOST_AUTO_TEST_CASE(release_retains_a_single_block)
+{
+    Arena arena(64, 1024);
+
+    for (int index = 0; index < 10; ++index)
+    {
+        arena.Allocate(60, 1);
+    }
+    BOOST_CHECK_GT(arena.GetStatistics().block_allocations, 1);
+
+    // everything is merged into one block, the same requests fit into it
+    arena.Release();
+    const auto block_allocations = arena.GetStatistics().block_allocations;
+    const auto capacity = arena.GetStatistics().capacity;
+    BOOST_CHECK_GE(capacity, 600);
+    BOOST_CHECK_LE(capacity, 1024);
+
+    for (int index = 0; index < 10; ++index)
+    {
+        arena.Allocate(60, 1);
+    }
+    arena.Release();
+    BOOST_CHECK_EQUAL(arena.GetStatistics().block_allocations, block_allocations);
+    BOOST_CHECK_EQUAL(arena.GetStatistics().capacity, capacity);
+    BOOST_CHECK_EQUAL(arena.GetStatistics().releases, 2);
+}
+
+BOOST_AUTO_TEST_CASE(release_limits_retained_memory)
+{
+    Arena arena(64, 128);
+
+    arena.Allocate(1000, 1);
+    arena.Release();
+    BOOST_CHECK_EQUAL(arena.GetStatistics().capacity, 128);
+}
+
+BOOST_AUTO_TEST_CASE(vector_allocates_from_arena)
+{
+    Arena arena;
+    ArenaVector<int> values{ArenaAllocator<int>(arena)};
+    for (int index = 0; index < 100; ++index)
+    {
+        values.push_back(index);
+    }
+
+    BOOST_CHECK_EQUAL(values.size(), 100);
+    BOOST_CHECK_EQUAL(values[99], 99);
+    BOOST_CHECK_GT(arena.GetStatistics().allocations, 0);
+
+    // copies keep using the arena, vectors without one use the heap
+    const auto allocations = arena.GetStatistics().allocations;
+    ArenaVector<int> copy = values;
+    BOOST_CHECK_EQUAL(arena.GetStatistics().allocations, allocations + 1);
+    BOOST_CHECK(copy.get_allocator() == values.get_allocator());
+
+    ArenaVector<int> heap_values(10, 1);
+    BOOST_CHECK(heap_values.get_allocator().GetArena() == nullptr);
+    BOOST_CHECK_EQUAL(arena.GetStatistics().allocations, allocations + 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
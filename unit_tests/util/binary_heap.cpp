@@ -25,7 +25,8 @@ typedef int TestKey;
 typedef int TestWeight;
 typedef boost::mpl::list<ArrayStorage<TestNodeID, TestKey>,
                          MapStorage<TestNodeID, TestKey>,
-                         UnorderedMapStorage<TestNodeID, TestKey>>
+                         UnorderedMapStorage<TestNodeID, TestKey>,
+                         GenerationStorage<TestNodeID, TestKey, 4>>
     storage_types;
 
 template <unsigned NUM_ELEM> struct RandomDataFixture
@@ -157,4 +158,50 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(decrease_key_test, T, storage_types, RandomData
     }
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(clear_test, T, storage_types, RandomDataFixture<NUM_NODES>)
+{
+    BinaryHeap<TestNodeID, TestKey, TestWeight, TestData, T> heap(NUM_NODES);
+
+    for (unsigned round = 0; round < 3; ++round)
+    {
+        for (unsigned i = round; i < NUM_NODES; i += 3)
+        {
+            heap.Insert(ids[order[i]], weights[order[i]], data[order[i]]);
+        }
+
+        heap.Clear();
+        BOOST_CHECK(heap.Empty());
+        for (auto id : ids)
+        {
+            BOOST_CHECK(!heap.WasInserted(id));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(generation_storage_allocates_touched_pages)
+{
+    GenerationStorage<TestNodeID, TestKey, 4> storage(NUM_NODES);
+    BOOST_CHECK_EQUAL(storage.NumberOfAllocatedPages(), 0);
+    BOOST_CHECK_EQUAL(storage.peek_index(42), std::numeric_limits<TestKey>::max());
+    BOOST_CHECK_EQUAL(storage.NumberOfAllocatedPages(), 0);
+
+    storage[42] = 7;
+    storage[43] = 8;
+    storage[99] = 9;
+    BOOST_CHECK_EQUAL(storage.NumberOfAllocatedPages(), 2);
+    BOOST_CHECK_EQUAL(storage.peek_index(42), 7);
+    BOOST_CHECK_EQUAL(storage.peek_index(43), 8);
+    BOOST_CHECK_EQUAL(storage.peek_index(99), 9);
+    BOOST_CHECK_EQUAL(storage.peek_index(41), std::numeric_limits<TestKey>::max());
+
+    storage.Clear();
+    BOOST_CHECK_EQUAL(storage.peek_index(42), std::numeric_limits<TestKey>::max());
+    BOOST_CHECK_EQUAL(storage.peek_index(99), std::numeric_limits<TestKey>::max());
+    BOOST_CHECK_EQUAL(storage.NumberOfAllocatedPages(), 2);
+
+    storage[42] = 1;
+    BOOST_CHECK_EQUAL(storage.peek_index(42), 1);
+    BOOST_CHECK_EQUAL(storage.peek_index(43), std::numeric_limits<TestKey>::max());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
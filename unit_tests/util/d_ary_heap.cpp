@@ -0,0 +1,153 @@
+#include "util/binary_heap.hpp"
+#include "util/d_ary_heap.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(d_ary_heap)
+
+using namespace osrm;
+using namespace osrm::util;
+
+struct TestData
+{
+    unsigned value;
+};
+
+typedef NodeID TestNodeID;
+typedef int TestKey;
+typedef int TestWeight;
+template <typename Storage, unsigned Arity>
+using TestHeap = DAryHeap<TestNodeID, TestKey, TestWeight, TestData, Storage, Arity>;
+typedef boost::mpl::list<TestHeap<ArrayStorage<TestNodeID, TestKey>, 2>,
+                         TestHeap<ArrayStorage<TestNodeID, TestKey>, 4>,
+                         TestHeap<MapStorage<TestNodeID, TestKey>, 4>,
+                         TestHeap<UnorderedMapStorage<TestNodeID, TestKey>, 8>,
+                         TestHeap<GenerationStorage<TestNodeID, TestKey, 4>, 4>>
+    heap_types;
+
+constexpr unsigned NUM_NODES = 100;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(insert_delete_min_test, Heap, heap_types)
+{
+    Heap heap(NUM_NODES);
+
+    std::vector<TestNodeID> order(NUM_NODES);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937 g(15);
+    std::shuffle(order.begin(), order.end(), g);
+
+    for (const auto id : order)
+    {
+        BOOST_CHECK(!heap.WasInserted(id));
+        heap.Insert(id, (id + 1) * 100, TestData{id * 3});
+        BOOST_CHECK(heap.WasInserted(id));
+        BOOST_CHECK(!heap.WasRemoved(id));
+    }
+    BOOST_CHECK_EQUAL(heap.Size(), NUM_NODES);
+
+    for (TestNodeID id = 0; id < NUM_NODES; ++id)
+    {
+        BOOST_CHECK_EQUAL(heap.GetData(id).value, id * 3);
+        BOOST_CHECK_EQUAL(heap.GetKey(id), static_cast<TestWeight>((id + 1) * 100));
+    }
+
+    for (TestNodeID id = 0; id < NUM_NODES; ++id)
+    {
+        BOOST_CHECK_EQUAL(heap.Min(), id);
+        BOOST_CHECK_EQUAL(heap.MinKey(), static_cast<TestWeight>((id + 1) * 100));
+        BOOST_CHECK_EQUAL(heap.DeleteMin(), id);
+        BOOST_CHECK(heap.WasRemoved(id));
+        // removed nodes keep their key and data
+        BOOST_CHECK_EQUAL(heap.GetKey(id), static_cast<TestWeight>((id + 1) * 100));
+    }
+    BOOST_CHECK(heap.Empty());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(delete_all_clear_test, Heap, heap_types)
+{
+    Heap heap(NUM_NODES);
+
+    for (TestNodeID id = 0; id < NUM_NODES; ++id)
+    {
+        heap.Insert(id, id, TestData{id});
+    }
+
+    heap.DeleteAll();
+    BOOST_CHECK(heap.Empty());
+    for (TestNodeID id = 0; id < NUM_NODES; ++id)
+    {
+        BOOST_CHECK(heap.WasInserted(id));
+        BOOST_CHECK(heap.WasRemoved(id));
+    }
+
+    heap.Clear();
+    for (TestNodeID id = 0; id < NUM_NODES; ++id)
+    {
+        BOOST_CHECK(!heap.WasInserted(id));
+    }
+}
+
+// Runs the same random operations on a BinaryHeap and compares every result. The weights
+// are unique, so both heaps have to agree on the order of the nodes.
+BOOST_AUTO_TEST_CASE_TEMPLATE(binary_heap_equivalence_test, Heap, heap_types)
+{
+    Heap heap(NUM_NODES);
+    BinaryHeap<TestNodeID, TestKey, TestWeight, TestData, ArrayStorage<TestNodeID, TestKey>>
+        reference(NUM_NODES);
+
+    std::mt19937 g(42);
+    std::uniform_int_distribution<TestNodeID> node_dist(0, NUM_NODES - 1);
+    std::uniform_int_distribution<int> operation_dist(0, 2);
+
+    // multiples of NUM_NODES plus the node ID keep all weights unique
+    TestWeight next_weight = 1000 * NUM_NODES;
+    for (unsigned round = 0; round < 10000; ++round)
+    {
+        const auto node = node_dist(g);
+        next_weight -= NUM_NODES;
+        const TestWeight weight = next_weight + node;
+
+        switch (operation_dist(g))
+        {
+        case 0:
+            if (!reference.WasInserted(node))
+            {
+                heap.Insert(node, weight, TestData{node});
+                reference.Insert(node, weight, TestData{node});
+            }
+            break;
+        case 1:
+            if (reference.WasInserted(node) && !reference.WasRemoved(node))
+            {
+                heap.DecreaseKey(node, weight);
+                reference.DecreaseKey(node, weight);
+            }
+            break;
+        case 2:
+            if (!reference.Empty())
+            {
+                BOOST_REQUIRE_EQUAL(heap.MinKey(), reference.MinKey());
+                BOOST_REQUIRE_EQUAL(heap.DeleteMin(), reference.DeleteMin());
+            }
+            break;
+        }
+
+        BOOST_REQUIRE_EQUAL(heap.Size(), reference.Size());
+        if (reference.Empty())
+        {
+            heap.Clear();
+            reference.Clear();
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
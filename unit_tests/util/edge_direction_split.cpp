@@ -0,0 +1,105 @@
+#include "contractor/query_edge.hpp"
+#include "util/edge_direction_split.hpp"
+#include "util/exception.hpp"
+#include "util/static_graph.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(edge_direction_split)
+
+using namespace osrm;
+using namespace osrm::util;
+
+using QueryEdge = contractor::QueryEdge;
+using TestGraph = StaticGraph<QueryEdge::EdgeData>;
+
+constexpr unsigned NUM_NODES = 50;
+
+QueryEdge
+MakeEdge(const NodeID source, const NodeID target, const bool forward, const bool backward)
+{
+    QueryEdge::EdgeData data;
+    data.distance = 1;
+    data.forward = forward;
+    data.backward = backward;
+    return QueryEdge(source, target, data);
+}
+
+BOOST_AUTO_TEST_CASE(ranges_hold_the_edges_of_each_direction)
+{
+    std::mt19937 g(7);
+    std::uniform_int_distribution<NodeID> node_dist(0, NUM_NODES - 1);
+    std::uniform_int_distribution<int> direction_dist(0, 2);
+
+    std::vector<QueryEdge> edges;
+    for (unsigned i = 0; i < 500; ++i)
+    {
+        const auto direction = direction_dist(g);
+        edges.push_back(MakeEdge(node_dist(g), node_dist(g), direction != 2, direction != 0));
+    }
+    std::sort(edges.begin(), edges.end());
+    const TestGraph graph(NUM_NODES, edges);
+
+    std::vector<EdgeDirectionSplit> splits;
+    BuildEdgeDirectionSplits(graph, std::back_inserter(splits));
+    BOOST_REQUIRE_EQUAL(splits.size(), NUM_NODES);
+
+    for (NodeID node = 0; node < NUM_NODES; ++node)
+    {
+        const DirectedEdgeRanges ranges{graph.BeginEdges(node),
+                                        splits[node].first_bidirectional,
+                                        splits[node].first_backward_only,
+                                        graph.EndEdges(node)};
+        std::vector<EdgeID> forward, backward;
+        for (const auto edge : graph.GetAdjacentEdgeRange(node))
+        {
+            const auto &data = graph.GetEdgeData(edge);
+            if (data.forward)
+            {
+                forward.push_back(edge);
+            }
+            if (data.backward)
+            {
+                backward.push_back(edge);
+            }
+        }
+
+        std::vector<EdgeID> forward_range, backward_range;
+        for (const auto edge : ranges.Forward())
+        {
+            forward_range.push_back(edge);
+        }
+        for (const auto edge : ranges.Backward())
+        {
+            backward_range.push_back(edge);
+        }
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            forward.begin(), forward.end(), forward_range.begin(), forward_range.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            backward.begin(), backward.end(), backward_range.begin(), backward_range.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ungrouped_edges_throw)
+{
+    // sorted by target only, as written by older versions
+    std::vector<QueryEdge> edges{MakeEdge(0, 1, false, true), MakeEdge(0, 2, true, false)};
+    std::vector<TestGraph::NodeArrayEntry> nodes{{0}, {2}, {2}, {2}};
+    std::vector<TestGraph::EdgeArrayEntry> edge_array;
+    for (const auto &edge : edges)
+    {
+        edge_array.push_back({edge.target, edge.data});
+    }
+    const TestGraph graph(nodes, edge_array);
+
+    std::vector<EdgeDirectionSplit> splits;
+    BOOST_CHECK_THROW(BuildEdgeDirectionSplits(graph, std::back_inserter(splits)), exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
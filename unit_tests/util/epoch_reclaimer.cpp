@@ -0,0 +1,153 @@
+#include "util/epoch_reclaimer.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(epoch_reclaimer)
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+// Counts the objects that were deleted
+struct Tracked
+{
+    explicit Tracked(std::atomic<unsigned> &deleted_) : deleted(deleted_) {}
+    ~Tracked()
+    {
+        alive = false;
+        ++deleted;
+    }
+
+    std::atomic<unsigned> &deleted;
+    std::atomic<bool> alive{true};
+};
+}
+
+BOOST_AUTO_TEST_CASE(retired_objects_wait_for_readers)
+{
+    std::atomic<unsigned> deleted{0};
+    EpochReclaimer reclaimer;
+
+    {
+        const auto pin = reclaimer.Enter();
+        reclaimer.Retire(std::unique_ptr<Tracked>(new Tracked(deleted)));
+        BOOST_CHECK_EQUAL(deleted, 0);
+        BOOST_CHECK_EQUAL(reclaimer.GetNumberOfRetired(), 1);
+    }
+    // the reader deleted it when it was done
+    BOOST_CHECK_EQUAL(deleted, 1);
+    BOOST_CHECK_EQUAL(reclaimer.GetNumberOfRetired(), 0);
+
+    // without readers it is deleted right away
+    reclaimer.Retire(std::unique_ptr<Tracked>(new Tracked(deleted)));
+    BOOST_CHECK_EQUAL(deleted, 2);
+}
+
+BOOST_AUTO_TEST_CASE(only_the_outermost_pin_counts)
+{
+    std::atomic<unsigned> deleted{0};
+    EpochReclaimer reclaimer;
+
+    {
+        const auto outer = reclaimer.Enter();
+        reclaimer.Retire(std::unique_ptr<Tracked>(new Tracked(deleted)));
+        {
+            const auto inner = reclaimer.Enter();
+        }
+        BOOST_CHECK_EQUAL(deleted, 0);
+    }
+    BOOST_CHECK_EQUAL(deleted, 1);
+}
+
+BOOST_AUTO_TEST_CASE(readers_of_later_epochs_do_not_delay)
+{
+    std::atomic<unsigned> deleted{0};
+    EpochReclaimer reclaimer;
+
+    std::atomic<bool> pinned{false};
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        const auto pin = reclaimer.Enter();
+        pinned = true;
+        while (!done)
+        {
+            std::this_thread::yield();
+        }
+    });
+    while (!pinned)
+    {
+        std::this_thread::yield();
+    }
+
+    // retired after the reader pinned its epoch
+    reclaimer.Retire(std::unique_ptr<Tracked>(new Tracked(deleted)));
+    BOOST_CHECK_EQUAL(deleted, 0);
+    done = true;
+    reader.join();
+    BOOST_CHECK_EQUAL(deleted, 1);
+
+    // the reader thread is gone, pins of this thread are independent of its slot
+    {
+        const auto pin = reclaimer.Enter();
+        reclaimer.Retire(std::unique_ptr<Tracked>(new Tracked(deleted)));
+    }
+    BOOST_CHECK_EQUAL(deleted, 2);
+}
+
+// Readers never see a deleted object while a writer keeps replacing it
+BOOST_AUTO_TEST_CASE(concurrent_readers_and_writer)
+{
+    std::atomic<unsigned> deleted{0};
+    std::atomic<bool> done{false};
+    std::atomic<unsigned> failures{0};
+    {
+        EpochReclaimer reclaimer;
+        std::atomic<Tracked *> current{new Tracked(deleted)};
+
+        std::vector<std::thread> readers;
+        for (int index = 0; index < 4; ++index)
+        {
+            readers.emplace_back([&] {
+                while (!done)
+                {
+                    const auto pin = reclaimer.Enter();
+                    const Tracked *object = current.load();
+                    for (int check = 0; check < 10; ++check)
+                    {
+                        if (!object->alive)
+                        {
+                            ++failures;
+                        }
+                    }
+                }
+            });
+        }
+
+        const unsigned number_of_updates = 2000;
+        for (unsigned update = 0; update < number_of_updates; ++update)
+        {
+            Tracked *previous = current.load();
+            current.store(new Tracked(deleted));
+            reclaimer.Retire(std::unique_ptr<Tracked>(previous));
+        }
+        done = true;
+        for (auto &reader : readers)
+        {
+            reader.join();
+        }
+
+        BOOST_CHECK_EQUAL(failures, 0);
+        reclaimer.TryReclaim();
+        BOOST_CHECK_EQUAL(deleted, number_of_updates);
+        delete current.load();
+    }
+    BOOST_CHECK_EQUAL(deleted, 2001);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
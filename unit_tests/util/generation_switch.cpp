@@ -0,0 +1,169 @@
+#include "util/generation_switch.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(generation_switch)
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+// Remembers the key it was built for and whether it was deleted
+struct Generation
+{
+    Generation(const unsigned key_, std::atomic<unsigned> &deleted_) : key(key_), deleted(deleted_)
+    {
+    }
+    ~Generation()
+    {
+        alive = false;
+        ++deleted;
+    }
+
+    const unsigned key;
+    std::atomic<unsigned> &deleted;
+    std::atomic<bool> alive{true};
+};
+
+using Switch = GenerationSwitch<unsigned, Generation>;
+}
+
+BOOST_AUTO_TEST_CASE(switches_to_the_latest_key)
+{
+    std::atomic<unsigned> deleted{0};
+    {
+        const auto make = [&](const unsigned key) {
+            return std::unique_ptr<Generation>(new Generation(key, deleted));
+        };
+        Switch generations(1, make);
+
+        unsigned latest_key = 1;
+        const auto latest = [&] { return latest_key; };
+        const auto get_key = [](Generation &generation) { return generation.key; };
+
+        BOOST_CHECK_EQUAL(generations.Run(latest, make, get_key), 1);
+        BOOST_CHECK_EQUAL(generations.GetNumberOfUpdates(), 0);
+
+        latest_key = 2;
+        BOOST_CHECK_EQUAL(generations.Run(latest, make, get_key), 2);
+        BOOST_CHECK_EQUAL(generations.GetNumberOfUpdates(), 1);
+        // no query uses the first generation anymore
+        BOOST_CHECK_EQUAL(deleted, 1);
+    }
+    BOOST_CHECK_EQUAL(deleted, 2);
+}
+
+BOOST_AUTO_TEST_CASE(failed_keys_are_retried)
+{
+    std::atomic<unsigned> deleted{0};
+    unsigned number_of_failures = 1;
+    const auto make = [&](const unsigned key) {
+        if (number_of_failures > 0)
+        {
+            --number_of_failures;
+            throw std::runtime_error("transient failure");
+        }
+        return std::unique_ptr<Generation>(new Generation(key, deleted));
+    };
+    const auto get_key = [](Generation &generation) { return generation.key; };
+
+    {
+        number_of_failures = 0;
+        Switch generations(1, make, std::chrono::hours(1));
+        number_of_failures = 1;
+
+        // keeps the current generation and does not retry before the delay
+        BOOST_CHECK_EQUAL(generations.Run([] { return 2u; }, make, get_key), 1);
+        BOOST_CHECK_EQUAL(generations.Run([] { return 2u; }, make, get_key), 1);
+        // another key is tried right away
+        BOOST_CHECK_EQUAL(generations.Run([] { return 3u; }, make, get_key), 3);
+    }
+
+    {
+        number_of_failures = 0;
+        Switch generations(1, make, std::chrono::milliseconds(0));
+        number_of_failures = 1;
+
+        BOOST_CHECK_EQUAL(generations.Run([] { return 2u; }, make, get_key), 1);
+        BOOST_CHECK_EQUAL(generations.Run([] { return 2u; }, make, get_key), 2);
+    }
+}
+
+// Readers never use a deleted generation and always see the latest key eventually while a writer
+// keeps publishing new keys
+BOOST_AUTO_TEST_CASE(switches_while_readers_run)
+{
+    std::atomic<unsigned> deleted{0};
+    std::atomic<unsigned> created{0};
+    std::atomic<unsigned> latest_key{0};
+    std::atomic<unsigned> failures{0};
+    std::atomic<bool> done{false};
+    {
+        const auto make = [&](const unsigned key) {
+            ++created;
+            return std::unique_ptr<Generation>(new Generation(key, deleted));
+        };
+        Switch generations(0, make);
+
+        std::vector<std::thread> readers;
+        for (int index = 0; index < 4; ++index)
+        {
+            readers.emplace_back([&] {
+                unsigned last_key = 0;
+                while (!done)
+                {
+                    generations.Run([&] { return latest_key.load(); },
+                                    make,
+                                    [&](Generation &generation) {
+                                        for (int check = 0; check < 10; ++check)
+                                        {
+                                            if (!generation.alive)
+                                            {
+                                                ++failures;
+                                            }
+                                        }
+                                        // generations are only ever replaced by newer ones
+                                        if (generation.key < last_key)
+                                        {
+                                            ++failures;
+                                        }
+                                        last_key = std::max(last_key, generation.key);
+                                    });
+                }
+            });
+        }
+
+        const unsigned number_of_keys = 200;
+        for (unsigned key = 1; key <= number_of_keys; ++key)
+        {
+            latest_key = key;
+            // wait until a reader switched to the key
+            while (generations.Run([&] { return latest_key.load(); },
+                                   make,
+                                   [](Generation &generation) { return generation.key; }) != key)
+            {
+                std::this_thread::yield();
+            }
+        }
+        done = true;
+        for (auto &reader : readers)
+        {
+            reader.join();
+        }
+
+        BOOST_CHECK_EQUAL(failures, 0);
+        BOOST_CHECK_EQUAL(created, number_of_keys + 1);
+    }
+    BOOST_CHECK_EQUAL(deleted, created);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
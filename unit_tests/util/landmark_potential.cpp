@@ -0,0 +1,179 @@
+#include "util/landmark_potential.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <queue>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(landmark_potential)
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+struct Edge
+{
+    NodeID source;
+    NodeID target;
+    EdgeWeight weight;
+};
+
+std::vector<EdgeWeight>
+dijkstra(const std::vector<Edge> &edges, const NodeID number_of_nodes, const NodeID source)
+{
+    std::vector<std::vector<std::pair<NodeID, EdgeWeight>>> adjacency(number_of_nodes);
+    for (const auto &edge : edges)
+    {
+        adjacency[edge.source].emplace_back(edge.target, edge.weight);
+    }
+
+    using Entry = std::pair<EdgeWeight, NodeID>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    std::vector<EdgeWeight> distances(number_of_nodes, INVALID_EDGE_WEIGHT);
+    distances[source] = 0;
+    queue.emplace(0, source);
+    while (!queue.empty())
+    {
+        EdgeWeight distance;
+        NodeID node;
+        std::tie(distance, node) = queue.top();
+        queue.pop();
+        if (distance > distances[node])
+        {
+            continue;
+        }
+        for (const auto &next : adjacency[node])
+        {
+            if (distance + next.second < distances[next.first])
+            {
+                distances[next.first] = distance + next.second;
+                queue.emplace(distances[next.first], next.first);
+            }
+        }
+    }
+    return distances;
+}
+
+std::vector<Edge> reversed(std::vector<Edge> edges)
+{
+    for (auto &edge : edges)
+    {
+        std::swap(edge.source, edge.target);
+    }
+    return edges;
+}
+}
+
+// The potential has to be a lower bound of the distance to the closest goal and consistent on
+// random graphs, which are usually not strongly connected.
+BOOST_AUTO_TEST_CASE(bound_is_admissible_and_consistent)
+{
+    std::mt19937 generator(42);
+    for (int round = 0; round < 50; ++round)
+    {
+        const NodeID number_of_nodes = 2 + generator() % 40;
+        std::vector<Edge> edges;
+        for (NodeID index = 0; index < 2 * number_of_nodes; ++index)
+        {
+            const NodeID source = generator() % number_of_nodes;
+            const NodeID target = generator() % number_of_nodes;
+            if (source != target)
+            {
+                edges.push_back({source, target, static_cast<EdgeWeight>(1 + generator() % 20)});
+            }
+        }
+
+        const unsigned number_of_landmarks = 1 + generator() % 4;
+        std::vector<LandmarkDistance> distances(number_of_nodes * number_of_landmarks);
+        for (unsigned landmark = 0; landmark < number_of_landmarks; ++landmark)
+        {
+            const NodeID landmark_node = generator() % number_of_nodes;
+            const auto from_landmark = dijkstra(edges, number_of_nodes, landmark_node);
+            const auto to_landmark = dijkstra(reversed(edges), number_of_nodes, landmark_node);
+            for (NodeID node = 0; node < number_of_nodes; ++node)
+            {
+                distances[node * number_of_landmarks + landmark] = {to_landmark[node],
+                                                                    from_landmark[node]};
+            }
+        }
+
+        std::vector<std::pair<NodeID, EdgeWeight>> goals;
+        for (unsigned index = 0, count = 1 + generator() % 3; index < count; ++index)
+        {
+            goals.emplace_back(generator() % number_of_nodes,
+                               static_cast<EdgeWeight>(generator() % 10) - 2);
+        }
+
+        for (const bool towards_goals : {true, false})
+        {
+            LandmarkPotential potential(number_of_landmarks, towards_goals);
+            // distance of every node to the closest goal plus its offset
+            std::vector<EdgeWeight> exact(number_of_nodes, INVALID_EDGE_WEIGHT);
+            for (const auto &goal : goals)
+            {
+                potential.AddGoal(&distances[goal.first * number_of_landmarks], goal.second);
+                const auto goal_distances =
+                    dijkstra(towards_goals ? reversed(edges) : edges, number_of_nodes, goal.first);
+                for (NodeID node = 0; node < number_of_nodes; ++node)
+                {
+                    if (goal_distances[node] != INVALID_EDGE_WEIGHT)
+                    {
+                        exact[node] = std::min(exact[node], goal_distances[node] + goal.second);
+                    }
+                }
+            }
+
+            const auto node_potential = [&](const NodeID node) {
+                return potential(&distances[node * number_of_landmarks]);
+            };
+
+            for (NodeID node = 0; node < number_of_nodes; ++node)
+            {
+                // nodes the bound prunes can not reach any goal
+                if (node_potential(node) == INVALID_EDGE_WEIGHT)
+                {
+                    BOOST_CHECK_EQUAL(exact[node], INVALID_EDGE_WEIGHT);
+                }
+                else if (exact[node] != INVALID_EDGE_WEIGHT)
+                {
+                    BOOST_CHECK_LE(node_potential(node), exact[node]);
+                }
+            }
+
+            for (const auto &edge : edges)
+            {
+                // edges in search direction
+                const auto from = towards_goals ? edge.source : edge.target;
+                const auto to = towards_goals ? edge.target : edge.source;
+                if (node_potential(from) != INVALID_EDGE_WEIGHT &&
+                    node_potential(to) != INVALID_EDGE_WEIGHT)
+                {
+                    BOOST_CHECK_LE(node_potential(from), edge.weight + node_potential(to));
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(missing_distances_disable_the_bound)
+{
+    const LandmarkDistance distances[] = {{10, 10}, {0, 0}};
+
+    LandmarkPotential potential(1, true);
+    BOOST_CHECK_EQUAL(potential(&distances[0]), INVALID_EDGE_WEIGHT);
+
+    potential.AddGoal(&distances[1], 3);
+    BOOST_CHECK_EQUAL(potential(&distances[0]), 13);
+    BOOST_CHECK_EQUAL(potential(nullptr), 3);
+
+    potential.AddGoal(nullptr, 5);
+    BOOST_CHECK_EQUAL(potential(&distances[0]), 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
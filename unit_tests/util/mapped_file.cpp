@@ -0,0 +1,70 @@
+#include "util/exception.hpp"
+#include "util/io.hpp"
+#include "util/mapped_file.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+const static std::string MAPPED_TMP_FILE = "test_mapped_file.tmp";
+
+BOOST_AUTO_TEST_SUITE(mapped_file)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(blocks_are_read_in_place)
+{
+    std::vector<int> data_in(53);
+    for (std::size_t i = 0; i < data_in.size(); ++i)
+        data_in[i] = i;
+    serializeVector(MAPPED_TMP_FILE, data_in);
+
+    for (const bool map : {true, false})
+    {
+        MappedFile file(MAPPED_TMP_FILE, map);
+        BOOST_CHECK(file.ReadAndCheckFingerprint());
+        const auto data_out = file.ReadVector<int>();
+        BOOST_CHECK(file.AtEnd());
+
+        BOOST_REQUIRE_EQUAL(data_in.size(), data_out.size());
+        for (std::size_t i = 0; i < data_in.size(); ++i)
+            BOOST_CHECK_EQUAL(data_out[i], data_in[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(broken_files_are_rejected)
+{
+    {
+        std::ofstream stream(MAPPED_TMP_FILE, std::ios::binary);
+        const std::uint64_t count = 10;
+        const std::uint32_t values[] = {1, 2, 3};
+        stream.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        stream.write(reinterpret_cast<const char *>(values), sizeof(values));
+        const char tail = 0;
+        stream.write(&tail, 1);
+    }
+
+    for (const bool map : {true, false})
+    {
+        MappedFile file(MAPPED_TMP_FILE, map);
+        // more elements than the file holds
+        BOOST_CHECK_THROW(file.ReadVector<std::uint32_t>(), exception);
+
+        MappedFile misaligned(MAPPED_TMP_FILE, map);
+        misaligned.ReadValue<std::uint64_t>();
+        misaligned.ReadValue<char>();
+        BOOST_CHECK_THROW(misaligned.ReadBlock<std::uint32_t>(1), exception);
+
+        // no fingerprint at all
+        MappedFile unchecked(MAPPED_TMP_FILE, map);
+        BOOST_CHECK(!unchecked.ReadAndCheckFingerprint());
+    }
+
+    BOOST_CHECK_THROW(MappedFile("does_not_exist.tmp", true), exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,78 @@
+#include "util/sharded_clock_cache.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(sharded_clock_cache)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(find_inserted)
+{
+    ShardedClockCache<int, std::string> cache(10, 2);
+
+    std::string value;
+    BOOST_CHECK(!cache.Find(1, value));
+
+    BOOST_CHECK(!cache.Insert(1, "one"));
+    BOOST_CHECK(!cache.Insert(2, "two"));
+    BOOST_CHECK(cache.Find(1, value));
+    BOOST_CHECK_EQUAL(value, "one");
+    BOOST_CHECK(cache.Find(2, value));
+    BOOST_CHECK_EQUAL(value, "two");
+
+    // overwrites without evicting
+    BOOST_CHECK(!cache.Insert(1, "uno"));
+    BOOST_CHECK(cache.Find(1, value));
+    BOOST_CHECK_EQUAL(value, "uno");
+    BOOST_CHECK_EQUAL(cache.Size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(evict_unreferenced_first)
+{
+    ShardedClockCache<int, int> cache(3, 1);
+
+    cache.Insert(1, 1);
+    cache.Insert(2, 2);
+    cache.Insert(3, 3);
+
+    // every entry starts out referenced, so the first eviction clears all flags and
+    // then takes the oldest entry
+    BOOST_CHECK(cache.Insert(4, 4));
+    int value;
+    BOOST_CHECK(!cache.Find(1, value));
+
+    // 2 gets a second chance, 3 is evicted instead
+    BOOST_CHECK(cache.Find(2, value));
+    BOOST_CHECK(cache.Insert(5, 5));
+    BOOST_CHECK(cache.Find(2, value));
+    BOOST_CHECK(!cache.Find(3, value));
+    BOOST_CHECK(cache.Find(4, value));
+    BOOST_CHECK(cache.Find(5, value));
+    BOOST_CHECK_EQUAL(cache.Size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(clear)
+{
+    ShardedClockCache<int, int> cache(100);
+    for (int i = 0; i < 100; ++i)
+    {
+        cache.Insert(i, i);
+    }
+    BOOST_CHECK(cache.Size() > 0);
+    BOOST_CHECK(cache.Size() <= 112);
+
+    cache.Clear();
+    BOOST_CHECK_EQUAL(cache.Size(), 0);
+    int value;
+    BOOST_CHECK(!cache.Find(42, value));
+
+    cache.Insert(42, 42);
+    BOOST_CHECK(cache.Find(42, value));
+    BOOST_CHECK_EQUAL(value, 42);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
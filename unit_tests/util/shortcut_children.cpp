@@ -0,0 +1,105 @@
+#include "contractor/query_edge.hpp"
+#include "util/shortcut_children.hpp"
+#include "util/static_graph.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(shortcut_children)
+
+using namespace osrm;
+using namespace osrm::util;
+
+using QueryEdge = contractor::QueryEdge;
+using TestGraph = StaticGraph<QueryEdge::EdgeData>;
+
+QueryEdge MakeEdge(const NodeID source,
+                   const NodeID target,
+                   const int distance,
+                   const bool forward,
+                   const bool backward,
+                   const NodeID middle = SPECIAL_NODEID)
+{
+    QueryEdge::EdgeData data;
+    data.distance = distance;
+    data.forward = forward;
+    data.backward = backward;
+    data.shortcut = middle != SPECIAL_NODEID;
+    data.id = data.shortcut ? middle : 0;
+    return QueryEdge(source, target, data);
+}
+
+EdgeID FindEdge(const TestGraph &graph,
+                const NodeID source,
+                const NodeID target,
+                const bool forward,
+                const bool backward)
+{
+    for (const auto edge : graph.GetAdjacentEdgeRange(source))
+    {
+        const auto &data = graph.GetEdgeData(edge);
+        if (graph.GetTarget(edge) == target && data.forward == forward &&
+            data.backward == backward)
+        {
+            return edge;
+        }
+    }
+    return SPECIAL_EDGEID;
+}
+
+BOOST_AUTO_TEST_CASE(children_of_bidirectional_shortcut)
+{
+    // Node 0 was contracted first: 1 -> 0 -> 2 and 2 -> 0 -> 1 both have weight 5 and are merged
+    // into a single shortcut, but they consist of different edges.
+    std::vector<QueryEdge> edges{MakeEdge(0, 1, 2, false, true),
+                                 MakeEdge(0, 1, 1, true, false),
+                                 MakeEdge(0, 2, 3, true, false),
+                                 MakeEdge(0, 2, 4, false, true),
+                                 MakeEdge(1, 2, 5, true, true, 0)};
+    std::sort(edges.begin(), edges.end());
+    const TestGraph graph(3, edges);
+
+    std::vector<EdgeID> offsets;
+    std::vector<ShortcutChildren> children;
+    BuildShortcutChildren(graph, std::back_inserter(offsets), std::back_inserter(children));
+
+    BOOST_REQUIRE_EQUAL(offsets.size(), graph.GetNumberOfEdges() + 1);
+    BOOST_REQUIRE_EQUAL(children.size(), 2);
+
+    const auto shortcut = FindEdge(graph, 1, 2, true, true);
+    BOOST_REQUIRE_EQUAL(offsets[shortcut + 1] - offsets[shortcut], 2);
+
+    // 1 -> 0 -> 2
+    const auto &forward = children[offsets[shortcut]];
+    BOOST_CHECK_EQUAL(forward.first, FindEdge(graph, 0, 1, false, true));
+    BOOST_CHECK_EQUAL(forward.second, FindEdge(graph, 0, 2, true, false));
+    BOOST_CHECK_EQUAL(forward.first, FindPackedPathEdge(graph, 1, 0));
+    BOOST_CHECK_EQUAL(forward.second, FindPackedPathEdge(graph, 0, 2));
+
+    // 2 -> 0 -> 1
+    const auto &backward = children[offsets[shortcut + 1] - 1];
+    BOOST_CHECK_EQUAL(backward.first, FindEdge(graph, 0, 2, false, true));
+    BOOST_CHECK_EQUAL(backward.second, FindEdge(graph, 0, 1, true, false));
+}
+
+BOOST_AUTO_TEST_CASE(packed_path_edge_prefers_smallest_forward_edge)
+{
+    std::vector<QueryEdge> edges{MakeEdge(0, 1, 7, true, false),
+                                 MakeEdge(0, 1, 3, true, false),
+                                 MakeEdge(1, 0, 1, false, true)};
+    std::sort(edges.begin(), edges.end());
+    const TestGraph graph(2, edges);
+
+    const auto edge = FindPackedPathEdge(graph, 0, 1);
+    BOOST_REQUIRE_NE(edge, SPECIAL_EDGEID);
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(edge).distance, 3);
+
+    // the backward edge of 1 leads from 0 to 1, nothing leads back
+    BOOST_CHECK_EQUAL(FindPackedPathEdge(graph, 1, 0), SPECIAL_EDGEID);
+}
+
+BOOST_AUTO_TEST_SUITE_END()